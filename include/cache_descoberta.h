@@ -0,0 +1,68 @@
+#pragma once
+
+// Cache da descoberta de dispositivos na NVS (boot a quente)
+//
+// A instalação quase nunca muda entre um boot e outro. Depois de cada
+// varredura a tabela de dispositivos (barramento, ID, baud rate, tipo e os
+// registradores 0x07D0/0x07D1) vai para a NVS. No boot seguinte cada entrada
+// é conferida com uma única leitura, e só as que não respondem voltam a ser
+// procuradas, em vez de varrer IDs × baud rates.
+//
+// O blob tem cabeçalho com versão e CRC16 das entradas: cache de outra versão
+// do firmware ou corrompido é ignorado. salvar() só grava quando o conteúdo
+// mudou, para poupar a flash.
+
+#include <stdint.h>
+#include "hal.h"
+#include "registro_dispositivos.h"
+#include "tipos.h"
+
+#define CACHE_CHAVE_NVS "dispositivos"
+#define CACHE_VERSAO 1
+#define CACHE_MAX_ENTRADAS (HAL_MAX_BARRAMENTOS * REGISTRO_MAX_POR_BARRAMENTO)
+
+struct EntradaCache {
+  uint32_t baud_rate;
+  uint16_t config_id;       // 0x07D0
+  uint16_t config_baud;     // 0x07D1
+  uint8_t barramento;
+  uint8_t id;
+  uint8_t tipo;             // TipoDispositivo
+  uint8_t reservado;
+};
+
+struct CabecalhoCache {
+  uint16_t versao;
+  uint16_t num_entradas;
+  uint16_t crc;             // CRC16/MODBUS das entradas
+  uint16_t reservado;
+};
+
+static_assert(sizeof(EntradaCache) == 12, "formato do cache na NVS");
+static_assert(sizeof(CabecalhoCache) == 8, "formato do cache na NVS");
+
+class CacheDescoberta {
+public:
+  bool carregar();    // false se ausente, de outra versão ou corrompido
+  // Grava as entradas dos barramentos em uso; true se gravou (conteúdo mudou)
+  bool salvar(const RegistroDispositivos& registro, uint8_t num_barramentos);
+  void apagar();
+
+  bool valido() const { return valido_; }
+  uint16_t quantidade() const { return valido_ ? blob_.cabecalho.num_entradas : 0; }
+  const EntradaCache& entrada(uint16_t i) const { return blob_.entradas[i]; }
+  static DeviceInfo paraDeviceInfo(const EntradaCache& entrada);
+
+private:
+  // Cabeçalho e entradas contíguos, gravados como um único blob
+  struct Blob {
+    CabecalhoCache cabecalho;
+    EntradaCache entradas[CACHE_MAX_ENTRADAS];
+  };
+  static size_t tamanho(uint16_t num_entradas) {
+    return sizeof(CabecalhoCache) + (size_t)num_entradas * sizeof(EntradaCache);
+  }
+
+  Blob blob_ = {};
+  bool valido_ = false;
+};
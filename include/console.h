@@ -0,0 +1,146 @@
+#pragma once
+
+// Console serial: leitura de linhas sem bloquear, tabela de comandos e
+// comandos longos em fatias
+//
+// LeitorLinha recebe os bytes à medida que chegam (Serial.read()) e entrega
+// a linha quando vê CR ou LF, sem esperar o timeout do Stream e sem String:
+// o buffer é fixo, a linha sai em minúsculas e sem espaços nas pontas.
+// Backspace apaga o último caractere. Uma linha maior que o buffer é
+// descartada até o fim e contada.
+//
+// Os comandos ficam numa tabela (nome, uso, ajuda, tarefa dona e função);
+// procurarComando() separa a primeira palavra e devolve o resto da linha
+// como argumentos. A ajuda do boot e a de comando desconhecido saem da
+// mesma tabela.
+//
+// TrabalhoConsole roda um comando longo (scan, diag, stress) em fatias: cada
+// chamada de fatia() faz uma parte curta (uma sonda, uma transação) e volta
+// para a aquisição, que segue liberando as fontes entre uma fatia e outra.
+// O maior tempo de uma fatia é o quanto o comando segura a amostragem.
+//
+// SaidaConsole leva o texto dos comandos e das fatias para fora da
+// aquisição: quem roda o comando formata num anel de bytes e a tarefa de
+// saída escreve na Serial só o que cabe no buffer da UART, sem esperar. O
+// texto só aparece para a saída em confirmar() (fim do passo da aquisição):
+// o relatório e o log não entram no meio de uma resposta. Anel cheio
+// descarta a escrita inteira e conta os bytes ('console'). No modo direto
+// (boot, antes das tarefas) as escritas vão na hora para a Serial.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define CONSOLE_MAX_LINHA 48
+#define CONSOLE_SAIDA_BYTES 8192     // Anel da saída dos comandos (potência de 2)
+#define CONSOLE_SAIDA_MAX_ESCRITA 192   // Um printf formatado
+
+class LeitorLinha {
+public:
+  // true quando 'byte' fechou uma linha não vazia (ver linha())
+  bool alimentar(int byte);
+  const char* linha() const { return linha_; }
+  uint32_t linhas() const { return linhas_; }
+  uint32_t descartadas() const { return descartadas_; }   // Maiores que o buffer
+
+private:
+  char buffer_[CONSOLE_MAX_LINHA];
+  char linha_[CONSOLE_MAX_LINHA] = "";
+  uint8_t tamanho_ = 0;
+  bool descartando_ = false;
+  uint32_t linhas_ = 0;
+  uint32_t descartadas_ = 0;
+};
+
+// Tarefa que executa o comando. Os da aquisição vão pela fila de comandos;
+// os que usam o barramento 0 são recusados enquanto há um trabalho em
+// andamento. 'dump' é da saída, dona do diário.
+enum TarefaComando : uint8_t {
+  COMANDO_AQUISICAO,
+  COMANDO_BARRAMENTO,
+  COMANDO_SAIDA
+};
+
+typedef void (*ExecutarComando)(const char* argumentos);
+
+struct EntradaComando {
+  const char* nome;          // Primeira palavra da linha
+  const char* uso;           // Nome e argumentos, para a ajuda
+  const char* ajuda;
+  TarefaComando tarefa;
+  ExecutarComando executar;
+};
+
+// Entrada da primeira palavra de 'linha' (nullptr se não há); 'argumentos'
+// aponta para o resto da linha, sem espaços no início
+const EntradaComando* procurarComando(const EntradaComando* tabela, size_t n, const char* linha,
+                                      const char** argumentos);
+
+// Fatia de um comando longo: false quando o comando terminou
+typedef bool (*PassoTrabalho)();
+
+class TrabalhoConsole {
+public:
+  // false se já há um trabalho em andamento
+  bool iniciar(const char* nome, PassoTrabalho passo, bool usa_barramento);
+  // O passo vê o pedido na próxima fatia, arruma o que deixou pela metade
+  // (baud rate do barramento) e retorna false
+  void cancelar() { cancelado_ = ativo(); }
+  bool cancelado() const { return cancelado_; }
+
+  // Roda uma fatia; false quando o trabalho terminou (ou não havia)
+  bool fatia();
+
+  bool ativo() const { return passo_ != nullptr; }
+  bool usaBarramento() const { return ativo() && usa_barramento_; }
+  const char* nome() const { return nome_; }
+  uint32_t fatias() const { return fatias_; }
+  uint32_t ultimaFatiaUs() const { return ultima_fatia_us_; }
+  uint32_t maiorFatiaUs() const { return maior_fatia_us_; }
+  uint32_t decorridoMs() const;   // Desde iniciar()
+
+private:
+  PassoTrabalho passo_ = nullptr;
+  const char* nome_ = "";
+  bool usa_barramento_ = false;
+  bool cancelado_ = false;
+  uint32_t fatias_ = 0;
+  uint32_t ultima_fatia_us_ = 0;
+  uint32_t maior_fatia_us_ = 0;
+  uint32_t inicio_ms_ = 0;
+};
+
+// Um produtor (a aquisição) e um consumidor (a tarefa de saída)
+class SaidaConsole {
+  static_assert((CONSOLE_SAIDA_BYTES & (CONSOLE_SAIDA_BYTES - 1)) == 0, "capacidade deve ser potencia de 2");
+
+public:
+  // Produtor. Mesma interface da Serial para o texto dos comandos.
+  int printf(const char* formato, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* texto);
+  size_t println(const char* texto = "");
+  // Publica o que foi escrito desde a última confirmação
+  void confirmar();
+  void direto(bool ativo) { direto_ = ativo; }
+
+  // Consumidor: escreve na Serial até 'max' bytes confirmados; quantos foram
+  size_t escoar(size_t max);
+  // Confirmados e ainda não escritos (leitura aproximada de qualquer tarefa)
+  uint32_t pendentes() const {
+    return confirmada_.load(std::memory_order_acquire) - leitura_.load(std::memory_order_acquire);
+  }
+  uint32_t ocupacaoMaxima() const { return ocupacao_max_.load(std::memory_order_relaxed); }
+  uint32_t descartados() const { return descartados_.load(std::memory_order_relaxed); }
+  static constexpr uint32_t capacidade() { return CONSOLE_SAIDA_BYTES; }
+
+private:
+  size_t escrever(const char* dados, size_t n);
+
+  char anel_[CONSOLE_SAIDA_BYTES];
+  uint32_t escrita_ = 0;                    // Só o produtor: inclui o não confirmado
+  std::atomic<uint32_t> confirmada_{0};
+  std::atomic<uint32_t> leitura_{0};
+  std::atomic<uint32_t> ocupacao_max_{0};
+  std::atomic<uint32_t> descartados_{0};    // Bytes
+  bool direto_ = true;
+};
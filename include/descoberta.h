@@ -0,0 +1,76 @@
+#pragma once
+
+// Motor de descoberta de dispositivos no barramento RS-485 (APENAS LEITURA)
+//
+// Substitui a varredura bruta (8 baud rates × IDs com timeout de 2 s):
+//  - timeouts derivados do baud rate (3,5 caracteres + turnaround do sensor)
+//  - baud rate abandonado cedo quando só chega lixo (bytes sem CRC válido),
+//    nas respostas ou na linha antes da sonda, sem nenhum dispositivo nele
+//  - faixa de IDs configurável até 247
+//  - cada dispositivo é entregue ao callback assim que responde, com o tipo
+//    sondado em 0x0001, que só a biruta tem (exceção na sonda: o 0x0000 é
+//    relido como input register)
+// A varredura avança uma sonda por passo(), então pode ser intercalada com
+// outras tarefas; executar() roda tudo de uma vez.
+
+#include <stdint.h>
+#include "tipos.h"
+
+#define DESCOBERTA_MAX_BAUDS 8
+
+struct ConfigDescoberta {
+  // Do mais provável para o menos provável (4800 é o padrão de fábrica)
+  uint32_t baud_rates[DESCOBERTA_MAX_BAUDS] = {4800, 9600, 2400, 19200, 38400, 57600, 115200, 1200};
+  uint8_t num_baud_rates = 8;
+  uint8_t id_inicial = 1;
+  uint8_t id_final = 5;            // Até MODBUS_ID_MAX (247)
+  uint32_t turnaround_us = 20000;  // Tempo máximo de resposta do sensor
+  uint8_t esperados = 0;           // Encerra ao encontrar N dispositivos (0 = sem limite)
+  bool baud_unico = false;         // Não testa outros baud rates depois de achar dispositivos
+  uint8_t limite_lixo = 2;         // Sondas com lixo (seguidas ou não) para abandonar o baud rate
+  uint8_t barramento = 0;          // Barramento RS-485 varrido (HAL)
+};
+
+struct DispositivoEncontrado {
+  uint8_t barramento;
+  uint8_t id;
+  uint32_t baud_rate;
+  uint16_t valor_principal;        // Registrador 0x0000 (0 se nem a releitura respondeu)
+  TipoDispositivo tipo;
+  uint32_t latencia_us;
+};
+
+typedef void (*CallbackDescoberta)(const DispositivoEncontrado& dispositivo, void* contexto);
+
+class Descoberta {
+public:
+  void iniciar(const ConfigDescoberta& config, CallbackDescoberta callback, void* contexto = nullptr);
+  bool passo();                    // Executa uma sonda; false quando a varredura terminou
+  void executar();
+  void cancelar() { ativa_ = false; }
+
+  bool ativa() const { return ativa_; }
+  uint16_t encontrados() const { return encontrados_; }
+  uint32_t sondas() const { return sondas_; }
+  uint8_t baudsAbandonados() const { return bauds_abandonados_; }
+  uint32_t duracaoMs() const { return duracao_ms_; }
+
+private:
+  void proximoBaud();
+  bool linhaComLixo();
+  TipoDispositivo sondarTipo(uint8_t id, uint8_t codigo_sonda, uint16_t& valor);
+
+  ConfigDescoberta config_;
+  CallbackDescoberta callback_ = nullptr;
+  void* contexto_ = nullptr;
+  bool ativa_ = false;
+  uint8_t indice_baud_ = 0;
+  uint16_t id_atual_ = 0;
+  uint8_t lixo_no_baud_ = 0;
+  uint16_t encontrados_no_baud_ = 0;
+  uint16_t encontrados_ = 0;
+  uint32_t sondas_ = 0;
+  uint8_t bauds_abandonados_ = 0;
+  uint32_t inicio_ms_ = 0;
+  uint32_t duracao_ms_ = 0;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+// Diário de amostras na flash: log circular só de acréscimo
+//
+// Quando o enlace cai, as amostras ficam aqui. A partição é dividida em
+// blocos do tamanho de um setor (HAL_FLASH_SETOR). Cada bloco tem um
+// cabeçalho e registros de tamanho fixo:
+//
+//   cabeçalho (16 B): mágica, sequência do bloco, tempo do primeiro registro,
+//                     versão, CRC16 do cabeçalho
+//   registro (25 B):  tempo (s) + carga da telemetria (19 B) + CRC16
+//
+// Os blocos são escritos em anel: cada setor é apagado uma vez por volta
+// (desgaste uniforme) e o mais antigo dá lugar ao novo quando a partição
+// enche. O tempo do primeiro registro de cada bloco é um índice esparso.
+// consultar() acha o bloco inicial por busca binária nos cabeçalhos e só
+// percorre os registros da faixa pedida.
+//
+// Queda de energia: um bloco só conta com o cabeçalho íntegro, e um registro
+// só com o CRC certo. Uma gravação cortada no meio deixa no máximo um
+// registro inválido, que é pulado. montar() acha o bloco de maior sequência
+// e o primeiro registro livre (todo 0xFF) por busca binária.
+//
+// Tempo do diário: segundos, contínuos entre boots. Sem RTC, cada boot
+// continua do último registro gravado (o tempo desligado não conta).
+//
+// Um único dono (a tarefa de saída): sem trava.
+
+#include <stdint.h>
+#include "hal.h"
+#include "telemetria.h"
+
+#define DIARIO_MAGICA 0x54534D41u   // "AMST"
+#define DIARIO_VERSAO 1
+#define DIARIO_TAM_CABECALHO 16
+#define DIARIO_TAM_REGISTRO (4 + TELEMETRIA_TAM_CARGA + 2)
+#define DIARIO_REGISTROS_POR_BLOCO ((HAL_FLASH_SETOR - DIARIO_TAM_CABECALHO) / DIARIO_TAM_REGISTRO)
+
+struct CabecalhoBloco {
+  uint32_t magica;
+  uint32_t sequencia;          // Crescente: o maior é o bloco em escrita
+  uint32_t tempo_inicial_s;    // Tempo do primeiro registro do bloco
+  uint16_t versao;
+  uint16_t crc;                // CRC16 dos campos anteriores
+};
+
+static_assert(sizeof(CabecalhoBloco) == DIARIO_TAM_CABECALHO, "formato do cabeçalho na flash");
+
+struct RegistroDiario {
+  uint32_t tempo_s;
+  RegistroTelemetria amostra;
+};
+
+// false interrompe a consulta
+typedef bool (*CallbackDiario)(const RegistroDiario& registro, void* contexto);
+
+class DiarioAmostras {
+public:
+  bool montar();                       // false sem partição
+  bool montado() const { return num_blocos_ > 0; }
+
+  // Tempo do diário agora: continua do último registro, avança com millis()
+  uint32_t tempoAgora() const;
+  bool anexar(const RegistroTelemetria& amostra, uint32_t tempo_s);
+
+  // Registros com tempo em [de_s, ate_s], em ordem; retorna quantos entregou
+  uint32_t consultar(uint32_t de_s, uint32_t ate_s, CallbackDiario callback, void* contexto);
+
+  uint16_t numBlocos() const { return num_blocos_; }
+  uint16_t blocosUsados() const { return usados_; }
+  uint32_t registros() const;
+  uint32_t tempoMaisAntigo() const { return tempo_antigo_s_; }
+  uint32_t tempoMaisRecente() const { return ultimo_tempo_s_; }
+  uint32_t falhasGravacao() const { return falhas_gravacao_; }
+  // Da última consulta: blocos percorridos e registros pulados (CRC inválido)
+  uint16_t blocosLidosNaConsulta() const { return blocos_lidos_; }
+  uint32_t invalidosNaConsulta() const { return invalidos_; }
+
+private:
+  uint32_t enderecoBloco(uint16_t fisico) const { return (uint32_t)fisico * HAL_FLASH_SETOR; }
+  uint32_t enderecoRegistro(uint16_t fisico, uint16_t slot) const {
+    return enderecoBloco(fisico) + DIARIO_TAM_CABECALHO + (uint32_t)slot * DIARIO_TAM_REGISTRO;
+  }
+  uint16_t fisico(uint16_t logico) const { return (uint16_t)((cauda_ + logico) % num_blocos_); }
+
+  bool lerCabecalho(uint16_t fisico, CabecalhoBloco& cabecalho) const;
+  bool slotLivre(uint16_t fisico, uint16_t slot) const;
+  bool lerRegistro(uint16_t fisico, uint16_t slot, RegistroDiario& registro) const;
+  uint16_t primeiroLivre(uint16_t fisico) const;
+  bool abrirBloco(uint32_t tempo_s);
+
+  uint16_t num_blocos_ = 0;
+  uint16_t cauda_ = 0;           // Bloco físico mais antigo
+  uint16_t cabeca_ = 0;          // Bloco físico em escrita
+  uint16_t usados_ = 0;
+  uint16_t slot_ = 0;            // Próximo registro livre na cabeça
+  uint32_t sequencia_ = 0;       // Do bloco da cabeça
+  uint32_t tempo_antigo_s_ = 0;
+  uint32_t ultimo_tempo_s_ = 0;
+  uint32_t base_s_ = 0;          // Tempo do diário na montagem
+  uint32_t montagem_ms_ = 0;
+  bool vazio_ = true;
+  uint32_t invalidos_ = 0;
+  uint32_t falhas_gravacao_ = 0;
+  uint16_t blocos_lidos_ = 0;
+};
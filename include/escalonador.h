@@ -0,0 +1,80 @@
+#pragma once
+
+// Escalonador de amostragem por prazo (EDF) para as fontes de dados
+//
+// Cada fonte (anemômetro, biruta, MAX6675, UV...) tem período e prioridade
+// próprios. A cada período a fonte é liberada com prazo no fim do período;
+// passo() inicia as fontes liberadas em ordem de prazo (empate: menor valor
+// de prioridade primeiro). Fontes do barramento só são iniciadas quando a
+// fila do mestre Modbus está vazia: a decisão EDF é tomada a cada transação,
+// e a próxima leitura entra logo atrás da que está na linha.
+//
+// Um prazo é perdido quando a fonte termina depois do fim do seu período,
+// ou nem chega a ser iniciada dentro dele.
+
+#include <stdint.h>
+
+#define ESCALONADOR_MAX_FONTES 8
+
+enum InicioFonte : uint8_t {
+  FONTE_OCUPADA,     // Não pôde começar agora; tenta de novo no próximo passo
+  FONTE_INICIADA,    // Leitura assíncrona em andamento: chamar concluir() ao terminar
+  FONTE_CONCLUIDA    // Leitura síncrona já terminou
+};
+
+typedef InicioFonte (*IniciarFonte)(uint8_t fonte, void* contexto);
+
+struct FonteAmostragem {
+  const char* nome;
+  uint32_t periodo_ms;
+  uint8_t prioridade;          // Desempate entre prazos iguais (0 = mais alta)
+  bool usa_barramento;
+  bool ativa;
+  IniciarFonte iniciar;
+  void* contexto;
+
+  // Estado do job atual
+  uint32_t liberacao_ms;       // Início do período atual
+  uint32_t prazo_ms;           // Fim do período atual
+  bool agendada;               // Já teve a primeira liberação
+  bool pendente;               // Liberada e ainda não iniciada
+  bool em_andamento;
+
+  // Estatísticas desde a ativação
+  uint32_t inicio_estatisticas_ms;
+  uint32_t execucoes;
+  uint32_t prazos_perdidos;
+  uint32_t atraso_max_ms;      // Maior tempo entre liberação e conclusão
+};
+
+class Escalonador {
+public:
+  // Retorna o índice da fonte ou -1 se não houver espaço
+  int8_t adicionar(const char* nome, uint32_t periodo_ms, uint8_t prioridade,
+                   bool usa_barramento, IniciarFonte iniciar, void* contexto = nullptr);
+  void configurar(uint8_t fonte, uint32_t periodo_ms, uint8_t prioridade);
+  void ativar(uint8_t fonte, bool ativa);
+  void zerarEstatisticas(uint32_t agora_ms);
+
+  // Inicia o que estiver vencido; 'barramento_livre' = fila do mestre vazia
+  void passo(uint32_t agora_ms, bool barramento_livre);
+  void concluir(uint8_t fonte, uint32_t agora_ms);   // Fim de uma leitura FONTE_INICIADA
+
+  bool ocioso() const;            // Nenhuma fonte em andamento
+  // Outra fonte do barramento mais prioritária que 'fonte' liberada e
+  // esperando: quem só usa o tempo livre (sondas) cede a vez
+  bool barramentoDisputado(uint8_t fonte) const;
+  uint8_t numFontes() const { return num_fontes_; }
+  const FonteAmostragem& fonte(uint8_t i) const { return fontes_[i]; }
+  int8_t procurar(const char* nome) const;
+
+  // Execuções por segundo desde a ativação (ou do último zerarEstatisticas)
+  float taxaAlcancada(uint8_t fonte, uint32_t agora_ms) const;
+
+private:
+  void liberar(FonteAmostragem& f, uint32_t agora_ms);
+  void registrarConclusao(FonteAmostragem& f, uint32_t agora_ms);
+
+  FonteAmostragem fontes_[ESCALONADOR_MAX_FONTES];
+  uint8_t num_fontes_ = 0;
+};
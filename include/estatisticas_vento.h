@@ -0,0 +1,105 @@
+#pragma once
+
+// Estatísticas de vento incrementais (padrão OMM)
+//
+// Alimentadas a cada leitura, custo constante por atualização e memória fixa:
+//  - médias de velocidade de 2 e 10 minutos
+//  - rajada: maior média de 3 s nos últimos 10 minutos (e a menor, calmaria)
+//  - direção média vetorial (componentes seno/cosseno, não média de graus)
+//  - desvio padrão da velocidade e da direção (Yamartino) em 10 minutos
+//
+// As leituras caem em baldes de 1 s num anel de 10 minutos. Cada janela
+// mantém somas corridas: o segundo que entra é somado e o que sai da janela
+// é subtraído. As somas são inteiras (dm/s e componentes × 10000), então
+// somar e subtrair é exato e a variância não acumula deriva de ponto
+// flutuante, que é o que o Welford resolve para somas em float. As médias de
+// 3 s entram em deques monotônicos: máximo e mínimo deslizantes em O(1)
+// amortizado. resumo() só lê as somas, sem varrer o histórico.
+
+#include <stdint.h>
+#include "tipos.h"
+
+#define VENTO_JANELA_LONGA_S 600    // 10 minutos
+#define VENTO_JANELA_CURTA_S 120    // 2 minutos
+#define VENTO_JANELA_RAJADA_S 3
+
+// Máximo (ou mínimo) deslizante de valores indexados por segundo
+template <uint16_t N, bool MAXIMO>
+class ExtremoDeslizante {
+public:
+  void inserir(uint32_t segundo, uint16_t valor) {
+    // Quem não pode mais ser o extremo sai pelo fim
+    while (tamanho_ && !domina(valores_[indice(tamanho_ - 1)], valor)) tamanho_--;
+    if (tamanho_ == N) descartarInicio();
+    segundos_[indice(tamanho_)] = (uint16_t)segundo;
+    valores_[indice(tamanho_)] = valor;
+    tamanho_++;
+  }
+
+  // Remove os itens mais antigos que 'janela' segundos
+  void expirar(uint32_t segundo, uint16_t janela) {
+    while (tamanho_ && (uint16_t)((uint16_t)segundo - segundos_[inicio_]) >= janela) descartarInicio();
+  }
+
+  bool vazio() const { return tamanho_ == 0; }
+  uint16_t valor() const { return valores_[inicio_]; }
+  void zerar() { inicio_ = tamanho_ = 0; }
+
+private:
+  static bool domina(uint16_t antigo, uint16_t novo) { return MAXIMO ? antigo > novo : antigo < novo; }
+  uint16_t indice(uint16_t i) const { return (uint16_t)((inicio_ + i) % N); }
+  void descartarInicio() {
+    inicio_ = (uint16_t)((inicio_ + 1) % N);
+    tamanho_--;
+  }
+
+  uint16_t segundos_[N];     // Segundo do item (módulo 65536; janela < 65536)
+  uint16_t valores_[N];
+  uint16_t inicio_ = 0;
+  uint16_t tamanho_ = 0;
+};
+
+class EstatisticasVento {
+public:
+  void adicionarVelocidade(uint32_t agora_ms, uint16_t vento_dms);
+  void adicionarDirecao(uint32_t agora_ms, uint16_t graus);
+  ResumoVento resumo(uint32_t agora_ms);
+  void zerar();
+
+private:
+  struct Balde {
+    uint32_t soma_dms;
+    uint32_t soma_quadrados;
+    int32_t soma_cos;          // Componentes unitários × 10000
+    int32_t soma_sen;
+    uint16_t leituras_vento;
+    uint16_t leituras_direcao;
+  };
+
+  struct Janela {
+    uint64_t soma_dms;
+    uint64_t soma_quadrados;
+    int64_t soma_cos;
+    int64_t soma_sen;
+    uint32_t leituras_vento;
+    uint32_t leituras_direcao;
+
+    void somar(const Balde& b);
+    void subtrair(const Balde& b);
+  };
+
+  void avancar(uint32_t agora_ms);
+  void fecharSegundo();
+  Balde& balde(uint32_t segundo) { return baldes_[segundo % VENTO_JANELA_LONGA_S]; }
+
+  Balde baldes_[VENTO_JANELA_LONGA_S] = {};
+  Janela curta_ = {};
+  Janela longa_ = {};
+  ExtremoDeslizante<VENTO_JANELA_LONGA_S, true> rajada_;
+  ExtremoDeslizante<VENTO_JANELA_LONGA_S, false> calmaria_;
+
+  bool iniciado_ = false;
+  uint32_t segundo_ = 0;              // Segundo corrente (contador próprio, sem volta do millis)
+  uint32_t inicio_segundo_ms_ = 0;
+  uint32_t segundos_preenchidos_ = 0; // Segundos desde zerar(), até a janela longa
+};
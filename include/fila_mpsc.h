@@ -0,0 +1,76 @@
+#pragma once
+
+// Fila circular sem trava para vários produtores e um consumidor (MPSC)
+//
+// Cada célula tem um número de sequência (fila limitada de Vyukov). O
+// produtor reserva a posição com um compare-and-swap no índice de escrita,
+// copia o item e só então publica a célula (release); o consumidor só lê a
+// célula publicada (acquire). Nenhum lado espera o outro: fila cheia descarta
+// o item novo e conta o descarte. Um produtor interrompido entre a reserva e
+// a publicação só atrasa o consumidor, que vê a fila vazia até lá.
+//
+// N precisa ser potência de 2; os índices crescem livremente e são mascarados.
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint32_t N>
+class FilaMpsc {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "capacidade deve ser potencia de 2");
+
+public:
+  FilaMpsc() {
+    for (uint32_t i = 0; i < N; i++) celulas_[i].sequencia.store(i, std::memory_order_relaxed);
+  }
+
+  // Produtores (qualquer tarefa, qualquer núcleo)
+  bool inserir(const T& item) {
+    uint32_t posicao = escrita_.load(std::memory_order_relaxed);
+    for (;;) {
+      Celula& celula = celulas_[posicao & (N - 1)];
+      int32_t diferenca = (int32_t)(celula.sequencia.load(std::memory_order_acquire) - posicao);
+      if (diferenca == 0) {
+        if (escrita_.compare_exchange_weak(posicao, posicao + 1, std::memory_order_relaxed)) {
+          celula.item = item;
+          celula.sequencia.store(posicao + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diferenca < 0) {
+        descartes_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        posicao = escrita_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumidor (uma única tarefa)
+  bool retirar(T& item) {
+    uint32_t posicao = leitura_.load(std::memory_order_relaxed);
+    Celula& celula = celulas_[posicao & (N - 1)];
+    if (celula.sequencia.load(std::memory_order_acquire) != posicao + 1) return false;
+    item = celula.item;
+    celula.sequencia.store(posicao + N, std::memory_order_release);
+    leitura_.store(posicao + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Leituras aproximadas, seguras de qualquer tarefa
+  uint32_t ocupacao() const {
+    return escrita_.load(std::memory_order_acquire) - leitura_.load(std::memory_order_acquire);
+  }
+  uint32_t descartes() const { return descartes_.load(std::memory_order_relaxed); }
+  uint32_t inseridos() const { return escrita_.load(std::memory_order_relaxed); }
+  static constexpr uint32_t capacidade() { return N; }
+
+private:
+  struct Celula {
+    std::atomic<uint32_t> sequencia;
+    T item;
+  };
+
+  Celula celulas_[N];
+  std::atomic<uint32_t> escrita_{0};
+  std::atomic<uint32_t> leitura_{0};
+  std::atomic<uint32_t> descartes_{0};
+};
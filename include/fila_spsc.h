@@ -0,0 +1,61 @@
+#pragma once
+
+// Fila circular sem trava para um produtor e um consumidor (SPSC)
+//
+// Cada índice só é escrito por um lado: 'escrita_' pelo produtor, 'leitura_'
+// pelo consumidor. A ordem acquire/release garante que o consumidor só vê o
+// slot depois de preenchido, mesmo com produtor e consumidor em núcleos
+// diferentes do ESP32. Nunca bloqueia: fila cheia descarta o item novo e
+// conta o descarte (pressão de retorno visível em 'status').
+//
+// N precisa ser potência de 2; os índices crescem livremente e são mascarados.
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint32_t N>
+class FilaSpsc {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "capacidade deve ser potencia de 2");
+
+public:
+  // Produtor
+  bool inserir(const T& item) {
+    uint32_t escrita = escrita_.load(std::memory_order_relaxed);
+    uint32_t ocupacao = escrita - leitura_.load(std::memory_order_acquire);
+    if (ocupacao >= N) {
+      descartes_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    itens_[escrita & (N - 1)] = item;
+    escrita_.store(escrita + 1, std::memory_order_release);
+    if (ocupacao + 1 > ocupacao_max_.load(std::memory_order_relaxed)) {
+      ocupacao_max_.store(ocupacao + 1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // Consumidor
+  bool retirar(T& item) {
+    uint32_t leitura = leitura_.load(std::memory_order_relaxed);
+    if (leitura == escrita_.load(std::memory_order_acquire)) return false;
+    item = itens_[leitura & (N - 1)];
+    leitura_.store(leitura + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Leituras aproximadas, seguras de qualquer tarefa
+  uint32_t ocupacao() const {
+    return escrita_.load(std::memory_order_acquire) - leitura_.load(std::memory_order_acquire);
+  }
+  uint32_t ocupacaoMaxima() const { return ocupacao_max_.load(std::memory_order_relaxed); }
+  uint32_t descartes() const { return descartes_.load(std::memory_order_relaxed); }
+  uint32_t inseridos() const { return escrita_.load(std::memory_order_relaxed); }
+  static constexpr uint32_t capacidade() { return N; }
+
+private:
+  T itens_[N];
+  std::atomic<uint32_t> escrita_{0};
+  std::atomic<uint32_t> leitura_{0};
+  std::atomic<uint32_t> ocupacao_max_{0};
+  std::atomic<uint32_t> descartes_{0};
+};
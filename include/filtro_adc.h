@@ -0,0 +1,63 @@
+#pragma once
+
+// Filtro de decimação para o ADC contínuo (sensor UV)
+//
+//   códigos 12 bits (DMA, ~20 kHz) -> CIC ordem 3 ÷R -> mediana de 5 -> IIR 1ª ordem
+//
+// O CIC faz a sobreamostragem com só somas inteiras por amostra (os
+// integradores dão a volta em aritmética modular, o que o pente desfaz) e
+// ganha resolução abaixo de 1 LSB. A mediana remove picos isolados que o
+// CIC espalharia; o IIR define a banda final. O ruído é o desvio padrão
+// (Welford) da saída da mediana desde a última retirada, em códigos do ADC.
+//
+// Portável: o HAL só entrega códigos brutos; a calibração (curva do eFuse no
+// ESP32) é aplicada no valor já filtrado.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FILTRO_CIC_ORDEM 3
+#define FILTRO_CIC_DECIMACAO_MAX 80   // 4095 · R³ cabe em 31 bits
+#define FILTRO_MEDIANA 5
+
+struct SaidaFiltro {
+  float codigo;        // Valor filtrado (códigos do ADC, com fração)
+  float ruido;         // Desvio padrão na janela (códigos do ADC)
+  uint32_t amostras;   // Saídas do CIC na janela
+};
+
+class FiltroAdc {
+public:
+  // 'alfa' do IIR: constante de tempo ≈ R / (alfa · taxa de entrada)
+  void configurar(uint16_t decimacao, float alfa);
+  void processar(const uint16_t* codigos, size_t n);
+  bool retirar(SaidaFiltro& saida);   // false se nada novo desde a última retirada
+
+  uint32_t entradas() const { return entradas_; }
+  uint16_t decimacao() const { return decimacao_; }
+
+private:
+  void decimada(float valor);
+  float mediana() const;
+
+  uint16_t decimacao_ = 64;
+  float alfa_ = 0.05f;
+  float escala_cic_ = 1.0f / (64.0f * 64.0f * 64.0f);
+
+  uint32_t integradores_[FILTRO_CIC_ORDEM] = {};
+  uint32_t atrasos_pente_[FILTRO_CIC_ORDEM] = {};
+  uint16_t contador_ = 0;
+  uint32_t entradas_ = 0;
+
+  float janela_mediana_[FILTRO_MEDIANA] = {};
+  uint8_t ocupacao_mediana_ = 0;
+  uint8_t posicao_mediana_ = 0;
+
+  float iir_ = 0.0f;
+  bool iir_iniciado_ = false;
+
+  // Welford da janela de saída
+  uint32_t n_ = 0;
+  float media_ = 0.0f;
+  float m2_ = 0.0f;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+// Gerador de carga do barramento RS-485 (comando 'stress')
+//
+// Procura a maior taxa de leituras que o barramento sustenta. A rampa começa
+// em 'taxa_inicial' e multiplica a taxa por 1,5 a cada degrau. As requisições
+// saem no instante marcado, sem esperar as anteriores (malha aberta). A rampa
+// para no primeiro degrau em que:
+//   - a taxa de sucesso cai abaixo de 'sucesso_minimo';
+//   - o p95 passa de 'fator_latencia' × o p95 do primeiro degrau;
+//   - a vazão fica abaixo de 'fracao_vazao' × a taxa pedida;
+//   - a fila do mestre transborda.
+// Esse degrau é o joelho. Um último degrau roda sem ritmo, com uma
+// requisição na linha por vez, e mede a vazão máxima com só o silêncio de
+// 3,5 caracteres entre quadros.
+//
+// As requisições se alternam entre os alvos e três formatos: 0x0000 x1,
+// 0x0000 x2 na biruta (x1 nos outros) e 0x07D0 x2 (0x03). Assim variam o
+// tamanho da resposta e a mistura de dispositivos.
+//
+// A latência vai do enfileiramento à resposta, com a espera na fila: acima
+// do joelho é ela que cresce. Roda no baud rate atual do barramento do
+// mestre: executar() bloqueia até o fim; iniciar() + passo() avançam a rampa
+// aos poucos, sem bloquear (comando 'stress' em fatias). Funciona igual com
+// sensores reais e no build nativo.
+
+#include <stdint.h>
+#include "hal.h"
+#include "metricas_modbus.h"
+#include "modbus_async.h"
+#include "tipos.h"
+
+#define CARGA_MAX_DEGRAUS 16
+#define CARGA_MAX_ALVOS 16
+
+struct ConfigCarga {
+  uint32_t taxa_inicial = 2;           // Requisições/s do primeiro degrau
+  uint32_t duracao_degrau_ms = 2000;
+  float sucesso_minimo = 99.0f;        // %
+  float fator_latencia = 2.0f;
+  float fracao_vazao = 0.9f;
+};
+
+struct DegrauCarga {
+  uint32_t taxa_pedida;                // Requisições/s (0 = sem ritmo)
+  float vazao;                         // Respostas válidas/s
+  float registradores_s;
+  uint32_t enviadas;
+  uint32_t sucessos;
+  uint32_t descartadas;                // Fila do mestre cheia no instante marcado
+  uint32_t p50_us, p95_us, p99_us, maximo_us;
+  bool joelho;
+
+  float sucessoPct() const { return enviadas ? 100.0f * sucessos / enviadas : 0.0f; }
+};
+
+class GeradorCarga {
+public:
+  void configurar(const ConfigCarga& config) { config_ = config; }
+  void limparAlvos() { num_alvos_ = 0; }
+  bool adicionarAlvo(uint8_t id, TipoDispositivo tipo);
+  uint8_t numAlvos() const { return num_alvos_; }
+
+  // Rampa + degrau sem ritmo; retorna o número de degraus medidos
+  uint8_t executar(MestreModbusAsync& mestre);
+
+  // Mesma rampa sem bloquear: passo() processa o mestre, envia o que já está
+  // marcado e fecha o degrau vencido. false quando a rampa terminou.
+  void iniciar(MestreModbusAsync& mestre);
+  bool passo();
+
+  uint8_t numDegraus() const { return num_degraus_; }
+  const DegrauCarga& degrau(uint8_t i) const { return degraus_[i]; }
+  int8_t joelho() const { return joelho_; }           // Índice do degrau do joelho (-1 se não houve)
+  float vazaoSustentavel() const;                     // Maior vazão antes do joelho
+
+private:
+  struct Alvo {
+    uint8_t id;
+    TipoDispositivo tipo;
+  };
+  // Uma por requisição na fila do mestre ou na linha (FIFO: o anel acompanha a fila)
+  struct Pendente {
+    GeradorCarga* gerador;
+    uint32_t enfileirada_us;
+  };
+
+  void abrirDegrau(uint32_t taxa);
+  void fecharDegrau(DegrauCarga& degrau);
+  bool enfileirar(MestreModbusAsync& mestre);
+  bool passouDoJoelho(const DegrauCarga& degrau) const;
+  static void aoConcluir(const RequisicaoModbus& requisicao, uint8_t resultado,
+                         const RespostaModbus& resposta, void* contexto);
+
+  ConfigCarga config_;
+  Alvo alvos_[CARGA_MAX_ALVOS];
+  uint8_t num_alvos_ = 0;
+  uint32_t sequencia_ = 0;
+
+  Pendente pendentes_[FILA_MODBUS_MAX + 1];
+  uint8_t proximo_pendente_ = 0;
+
+  // Degrau em andamento
+  MestreModbusAsync* mestre_ = nullptr;
+  bool ativo_ = false;
+  uint32_t inicio_us_ = 0;
+  uint32_t duracao_us_ = 0;
+  uint32_t intervalo_us_ = 0;
+  uint32_t marcado_us_ = 0;            // Próximo envio, relativo ao início do degrau
+  HistogramaLatencia latencia_;
+  uint32_t sucessos_ = 0;
+  uint32_t concluidas_ = 0;
+  uint32_t registradores_ = 0;
+
+  DegrauCarga degraus_[CARGA_MAX_DEGRAUS];
+  uint8_t num_degraus_ = 0;
+  int8_t joelho_ = -1;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+// Camada de abstração de hardware (HAL)
+//
+// O firmware fala com o hardware SOMENTE através destas funções:
+//  - ESP32 (src/esp32/): Serial2/Serial1 + MAX485, MAX6675 e ADC por DMA
+//  - Nativo (src/native/): barramentos RS-485 simulados com anemômetros e
+//    birutas (ver include/native/rs485_sim.h) e relógio virtual para benchmarks
+
+#include <Arduino.h>
+#include "modbus_codec.h"
+
+// Configurações de Hardware
+#define RS485_DE_RE_PIN 4      // Pino DE/RE do MAX485
+#define RS485_RX_PIN 16        // RX2 do ESP32 (RO do MAX485)
+#define RS485_TX_PIN 17        // TX2 do ESP32 (DI do MAX485)
+#define MAX6675_CS_PIN 19      // CS do MAX6675
+#define MAX6675_CLK_PIN 23     // CLK do MAX6675
+#define MAX6675_DO_PIN 18      // DO do MAX6675
+#define UV_SENSOR_PIN 32       // Pino analógico do sensor UV
+#define ESCRAVO_DE_RE_PIN 27   // DE/RE do segundo MAX485 (porta do SCADA)
+#define ESCRAVO_RX_PIN 25      // RX1 do ESP32
+#define ESCRAVO_TX_PIN 26      // TX1 do ESP32
+
+// Barramentos RS-485 de sensores. O ESP32 tem 3 UARTs e a UART0 é o console:
+// o barramento 1 usa a UART1 e o MAX485 da porta do escravo, então com
+// BARRAMENTOS_RS485=2 o escravo Modbus fica desativado.
+#define HAL_MAX_BARRAMENTOS 2
+#ifndef BARRAMENTOS_RS485
+#define BARRAMENTOS_RS485 1    // Barramentos em uso (1 = só Serial2)
+#endif
+
+// Inicialização dos pinos (DE/RE, UV) e periféricos locais
+void halIniciar();
+
+// --- RS-485 (nível de byte) ---
+// 'barramento' 0 = Serial2 nos pinos 16/17 (DE/RE 4); 1 = Serial1 nos pinos
+// 25/26 (DE/RE 27). Cada barramento tem um único dono (uma tarefa).
+void halRs485Iniciar(uint8_t barramento, uint32_t baud);   // 8N1
+uint32_t halRs485Baud(uint8_t barramento);
+void halRs485Direcao(uint8_t barramento, bool transmitir); // DE/RE do MAX485
+size_t halRs485Escrever(uint8_t barramento, const uint8_t* dados, size_t len);
+void halRs485AguardarEnvio(uint8_t barramento);            // Bloqueia até o último bit sair
+bool halRs485EnvioConcluido(uint8_t barramento);           // Último bit já saiu? (não bloqueia)
+int halRs485Disponivel(uint8_t barramento);
+int halRs485Ler(uint8_t barramento);
+void halRs485Descartar(uint8_t barramento);                // Esvazia o buffer de recepção
+
+// --- RS-485 do escravo (segunda UART, lado do SCADA) ---
+void halEscravoIniciar(uint32_t baud);      // Serial1 8N1 nos pinos 25/26
+uint32_t halEscravoBaud();
+void halEscravoDirecao(bool transmitir);
+size_t halEscravoEscrever(const uint8_t* dados, size_t len);
+bool halEscravoEnvioConcluido();
+int halEscravoDisponivel();
+int halEscravoLer();
+
+// --- Sensores locais ---
+float halLerTemperatura();                  // MAX6675 em °C (NAN em caso de erro)
+
+// --- ADC contínuo (sensor UV) ---
+// O ADC amostra UV_SENSOR_PIN continuamente e o DMA enche o buffer do driver
+// sem a CPU; halAdcLer() só copia o que já foi convertido (não bloqueia).
+// Esvaziar pelo menos a cada ~50 ms a 20 kHz, ou o driver descarta blocos.
+bool halAdcIniciar(uint32_t taxa_hz);
+size_t halAdcLer(uint16_t* codigos, size_t max);   // Códigos brutos 0-4095
+uint32_t halAdcEstouros();                         // Vezes que o buffer do DMA encheu
+float halAdcMilivolts(float codigo);               // Curva de calibração (eFuse no ESP32)
+const char* halAdcCalibracao();                    // Origem da curva
+
+// --- Memória não volátil (NVS no ESP32) ---
+// Blobs pequenos por chave (até 15 caracteres). Cada gravação gasta a flash:
+// gravar só quando o conteúdo mudou.
+size_t halNvsLer(const char* chave, void* dados, size_t max);   // Bytes lidos (0 se ausente ou maior que 'max')
+bool halNvsGravar(const char* chave, const void* dados, size_t len);
+void halNvsApagar(const char* chave);
+
+// --- Flash de dados (partição "amostras" no ESP32) ---
+// NOR: apagar deixa o setor inteiro em 0xFF e gravar só leva bits de 1 a 0.
+// Endereços relativos ao início da partição.
+#define HAL_FLASH_SETOR 4096
+uint32_t halFlashTamanho();                                        // 0 se não há partição
+bool halFlashLer(uint32_t endereco, void* dados, size_t len);
+bool halFlashGravar(uint32_t endereco, const void* dados, size_t len);
+bool halFlashApagarSetor(uint32_t endereco);                       // Setor que começa em 'endereco'
+
+// --- Tarefas ---
+// Cada tarefa é uma função de passo, curta e não bloqueante. No ESP32 vira uma
+// tarefa FreeRTOS fixada em 'nucleo', que chama o passo e dorme 'intervalo_ms'
+// (mínimo de 1 tick). No nativo, halExecutarTarefas() chama os passos em
+// rodízio, na ordem de criação, sobre o relógio virtual.
+#define HAL_MAX_TAREFAS (4 + HAL_MAX_BARRAMENTOS - 1)   // Pipeline, escravo e um por barramento extra
+#define NUCLEO_AQUISICAO 1      // APP_CPU: só os barramentos RS-485
+#define NUCLEO_PROCESSAMENTO 0  // PRO_CPU: processamento e saída serial
+
+typedef void (*PassoTarefa)();
+bool halCriarTarefa(const char* nome, PassoTarefa passo, uint8_t nucleo,
+                    uint8_t prioridade, uint32_t intervalo_ms);
+void halExecutarTarefas();                  // Chamado pelo loop()
+
+// --- Temporizador de amostragem ---
+// Chama 'callback' a cada 'periodo_us' pelo relógio do hardware, sem somar o
+// atraso de quem atende, e acorda a tarefa de 'acordar' (criada antes com
+// halCriarTarefa) sem esperar o fim do seu intervalo. No ESP32 é um esp_timer
+// periódico: o callback roda na tarefa do esp_timer, curto e sem Serial. No
+// nativo, halExecutarTarefas() o chama no instante exato do relógio virtual.
+typedef void (*CallbackTemporizador)();
+bool halTemporizadorIniciar(uint32_t periodo_us, CallbackTemporizador callback, PassoTarefa acordar);
+
+// --- Medição ---
+uint32_t halCiclos();                       // Contador de ciclos da CPU
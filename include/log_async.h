@@ -0,0 +1,165 @@
+#pragma once
+
+// Log assíncrono com níveis eliminados na compilação
+//
+// Quem registra não formata nem espera a UART: LOG_AVISO("biruta", fmt, ...)
+// copia o ponteiro do formato, a tag do módulo e os argumentos (números por
+// valor, textos %s copiados, até LOG_MAX_TEXTO bytes no total) para uma fila
+// sem trava com vários produtores. A tarefa de saída, a de menor prioridade,
+// formata e escreve poucas linhas por passo. Fila cheia descarta a linha e
+// conta o descarte ('status'); nunca bloqueia. Com a saída binária a Serial
+// só leva quadros COBS: as linhas são retiradas sem formatar e contadas
+// como suprimidas.
+//
+// O formato precisa ser um literal (ou durar para sempre): só o ponteiro vai
+// para a fila. Os argumentos são conferidos contra o formato como no printf.
+//
+// Níveis acima de LOG_NIVEL (build_flags, padrão INFO) viram código nenhum:
+// nem os argumentos são avaliados. Um arquivo pode mudar o seu nível
+// definindo LOG_NIVEL_LOCAL antes de incluir este cabeçalho.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "fila_mpsc.h"
+
+#define LOG_NIVEL_NENHUM 0
+#define LOG_NIVEL_ERRO 1
+#define LOG_NIVEL_AVISO 2
+#define LOG_NIVEL_INFO 3
+#define LOG_NIVEL_DEPURACAO 4
+
+#ifndef LOG_NIVEL
+#define LOG_NIVEL LOG_NIVEL_INFO
+#endif
+#ifndef LOG_NIVEL_LOCAL
+#define LOG_NIVEL_LOCAL LOG_NIVEL
+#endif
+
+#define LOG_CAPACIDADE 32          // Linhas na fila (potência de 2)
+#define LOG_MAX_ARGUMENTOS 6
+#define LOG_MAX_TEXTO 32           // Cópias dos argumentos %s de uma linha
+#define LOG_MAX_LINHA 160          // Linha formatada, com a tag
+
+enum TipoArgumentoLog : uint8_t {
+  LOG_ARG_INTEIRO,
+  LOG_ARG_NATURAL,
+  LOG_ARG_REAL,
+  LOG_ARG_TEXTO,                   // Deslocamento em 'texto'
+  LOG_ARG_PONTEIRO
+};
+
+struct RegistroLog {
+  const char* formato;
+  const char* tag;
+  uint8_t nivel;
+  uint8_t num_argumentos;
+  uint8_t uso_texto;
+  uint8_t tipos[LOG_MAX_ARGUMENTOS];
+  uint8_t bytes[LOG_MAX_ARGUMENTOS];   // Tamanho do tipo original (%x de um int negativo)
+  union {
+    int64_t inteiro;
+    uint64_t natural;
+    double real;
+    const void* ponteiro;
+    uint8_t texto;
+  } valores[LOG_MAX_ARGUMENTOS];
+  char texto[LOG_MAX_TEXTO];
+};
+
+// Linha pronta: "[tag] mensagem"; devolve o tamanho (sem o '\0')
+size_t formatarRegistroLog(const RegistroLog& registro, char* destino, size_t tamanho);
+
+class LogAssincrono {
+public:
+  template <typename... Argumentos>
+  void emitir(uint8_t nivel, const char* tag, const char* formato, Argumentos... argumentos) {
+    static_assert(sizeof...(Argumentos) <= LOG_MAX_ARGUMENTOS, "argumentos demais para uma linha de log");
+    RegistroLog registro;
+    registro.formato = formato;
+    registro.tag = tag;
+    registro.nivel = nivel;
+    registro.num_argumentos = 0;
+    registro.uso_texto = 0;
+    (adicionar(registro, argumentos), ...);
+    fila_.inserir(registro);
+  }
+
+  // Consumidor (tarefa de saída): próxima linha formatada; false se vazia
+  bool formatarProxima(char* destino, size_t tamanho);
+  // Idem, jogando a linha fora sem formatar (saída binária)
+  bool suprimirProxima();
+
+  uint32_t emitidas() const { return fila_.inseridos(); }
+  uint32_t descartadas() const { return fila_.descartes(); }
+  uint32_t suprimidas() const { return suprimidas_; }
+  uint32_t pendentes() const { return fila_.ocupacao(); }
+
+private:
+  template <typename T>
+  static void adicionar(RegistroLog& registro, T valor) {
+    uint8_t i = registro.num_argumentos++;
+    registro.bytes[i] = sizeof(T);
+    if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value) {
+      registro.tipos[i] = LOG_ARG_TEXTO;
+      registro.valores[i].texto = copiarTexto(registro, valor);
+    } else if constexpr (std::is_pointer<T>::value) {
+      registro.tipos[i] = LOG_ARG_PONTEIRO;
+      registro.valores[i].ponteiro = valor;
+    } else if constexpr (std::is_floating_point<T>::value) {
+      registro.tipos[i] = LOG_ARG_REAL;
+      registro.valores[i].real = valor;
+    } else if constexpr (std::is_enum<T>::value || std::is_signed<T>::value) {
+      registro.tipos[i] = LOG_ARG_INTEIRO;
+      registro.valores[i].inteiro = (int64_t)valor;
+    } else {
+      static_assert(std::is_integral<T>::value, "tipo de argumento não suportado no log");
+      registro.tipos[i] = LOG_ARG_NATURAL;
+      registro.valores[i].natural = (uint64_t)valor;
+    }
+  }
+  static uint8_t copiarTexto(RegistroLog& registro, const char* texto);
+
+  FilaMpsc<RegistroLog, LOG_CAPACIDADE> fila_;
+  uint32_t suprimidas_ = 0;   // Só o consumidor escreve
+};
+
+extern LogAssincrono log_sistema;
+
+// Só para o compilador conferir o formato (-Wformat); nunca é chamada
+inline void logConferirFormato(const char* formato, ...) __attribute__((format(printf, 1, 2)));
+inline void logConferirFormato(const char* formato, ...) { (void)formato; }
+
+#define LOG_EMITIR(nivel, tag, formato, ...)                               \
+  do {                                                                     \
+    if (false) logConferirFormato(formato, ##__VA_ARGS__);                 \
+    log_sistema.emitir(nivel, tag, formato, ##__VA_ARGS__);                \
+  } while (0)
+#define LOG_DESLIGADO(formato, ...)                                        \
+  do {                                                                     \
+    if (false) logConferirFormato(formato, ##__VA_ARGS__);                 \
+  } while (0)
+
+#if LOG_NIVEL_LOCAL >= LOG_NIVEL_ERRO
+#define LOG_ERRO(tag, formato, ...) LOG_EMITIR(LOG_NIVEL_ERRO, tag, formato, ##__VA_ARGS__)
+#else
+#define LOG_ERRO(tag, formato, ...) LOG_DESLIGADO(formato, ##__VA_ARGS__)
+#endif
+
+#if LOG_NIVEL_LOCAL >= LOG_NIVEL_AVISO
+#define LOG_AVISO(tag, formato, ...) LOG_EMITIR(LOG_NIVEL_AVISO, tag, formato, ##__VA_ARGS__)
+#else
+#define LOG_AVISO(tag, formato, ...) LOG_DESLIGADO(formato, ##__VA_ARGS__)
+#endif
+
+#if LOG_NIVEL_LOCAL >= LOG_NIVEL_INFO
+#define LOG_INFO(tag, formato, ...) LOG_EMITIR(LOG_NIVEL_INFO, tag, formato, ##__VA_ARGS__)
+#else
+#define LOG_INFO(tag, formato, ...) LOG_DESLIGADO(formato, ##__VA_ARGS__)
+#endif
+
+#if LOG_NIVEL_LOCAL >= LOG_NIVEL_DEPURACAO
+#define LOG_DEPURACAO(tag, formato, ...) LOG_EMITIR(LOG_NIVEL_DEPURACAO, tag, formato, ##__VA_ARGS__)
+#else
+#define LOG_DEPURACAO(tag, formato, ...) LOG_DESLIGADO(formato, ##__VA_ARGS__)
+#endif
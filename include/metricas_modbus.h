@@ -0,0 +1,124 @@
+#pragma once
+
+// Métricas do barramento Modbus, sempre ligadas
+//
+// Cada transação do mestre (assíncrona ou bloqueante) passa por registrar():
+// contadores de timeouts, erros de CRC, exceções e retentativas, bytes na
+// linha e histogramas de latência por dispositivo e por código de função.
+// O custo é um índice de tabela e alguns incrementos, sem heap.
+//
+// Latência: do fim do envio da requisição ao último byte da resposta, o mesmo
+// intervalo de ResultadoLeitura::latencia_us. Os histogramas são logarítmicos,
+// com 4 faixas por oitava (erro de até 25% no percentil) de 256 µs a 4 s.
+//
+// Uma instância por barramento, escrita só pela tarefa dona do barramento.
+// Outras tarefas leem sem trava (os valores podem estar uma transação atrás)
+// e pedem para zerar com pedirZerar(): a dona zera antes da próxima
+// transação. As sondas da varredura só contam bytes e ocupação (suspender()):
+// os timeouts dos IDs vazios não são falhas de dispositivo.
+
+#include <atomic>
+#include <stdint.h>
+#include "hal.h"
+#include "modbus_rtu.h"
+
+#define METRICAS_MAX_DISPOSITIVOS 16   // Por barramento; os demais IDs somam em "outros"
+#define METRICAS_OITAVA_MIN 8          // 2^8 = 256 µs
+#define METRICAS_OITAVAS 14            // Até 2^22 µs (~4 s)
+#define METRICAS_FAIXAS (1 + METRICAS_OITAVAS * 4)
+
+class HistogramaLatencia {
+public:
+  void registrar(uint32_t us);
+  void zerar();
+
+  uint32_t total() const { return total_; }
+  uint32_t maximo() const { return maximo_; }
+  uint32_t media() const { return total_ ? (uint32_t)(soma_ / total_) : 0; }
+  // Limite superior da faixa que contém o percentil 'p' (0-100), limitado ao máximo
+  uint32_t percentil(float p) const;
+
+  static uint8_t faixa(uint32_t us);
+  static uint32_t limiteSuperior(uint8_t faixa);
+
+private:
+  uint32_t contagens_[METRICAS_FAIXAS] = {};
+  uint32_t total_ = 0;
+  uint32_t maximo_ = 0;
+  uint64_t soma_ = 0;
+};
+
+struct ContadoresModbus {
+  uint32_t transacoes = 0;
+  uint32_t sucessos = 0;
+  uint32_t timeouts = 0;
+  uint32_t erros_crc = 0;        // CRC inválido ou quadro truncado
+  uint32_t excecoes = 0;         // Resposta de exceção do escravo
+  uint32_t outros_erros = 0;     // ID ou função trocados na resposta
+  uint32_t retentativas = 0;     // Transações refeitas pelo planejador
+
+  void contar(uint8_t resultado);
+};
+
+struct MetricasDispositivo {
+  uint8_t id = 0;                // 0 = "outros"
+  ContadoresModbus contadores;
+  HistogramaLatencia latencia;
+};
+
+struct MetricasFuncao {
+  uint8_t funcao = 0;
+  ContadoresModbus contadores;
+  HistogramaLatencia latencia;
+};
+
+class MetricasBarramento {
+public:
+  // 'duracao_us': do fim do envio ao fim da transação (resposta ou timeout)
+  void registrar(uint8_t id, uint8_t funcao, uint8_t resultado, uint32_t duracao_us,
+                 uint16_t bytes_recebidos, uint32_t baud);
+  void registrarRetentativa(uint8_t id, uint8_t funcao);
+  void suspender(bool suspensa) { suspensa_ = suspensa; }
+  void pedirZerar() { zerar_pedido_ = true; }
+
+  const ContadoresModbus& contadores() const { return total_; }
+  uint8_t numDispositivos() const { return num_dispositivos_; }
+  const MetricasDispositivo& dispositivo(uint8_t i) const { return dispositivos_[i]; }
+  const MetricasDispositivo& outros() const { return outros_; }
+  uint8_t numFuncoes() const { return num_funcoes_; }
+  const MetricasFuncao& funcao(uint8_t i) const { return funcoes_[i]; }
+
+  uint64_t bytesEnviados() const { return bytes_enviados_; }
+  uint64_t bytesRecebidos() const { return bytes_recebidos_; }
+  uint32_t sondas() const { return sondas_; }
+  uint32_t janelaMs() const { return millis() - inicio_ms_; }
+  // Fração da janela com bytes na linha / com o barramento ocupado pelo mestre (0-1)
+  float utilizacao() const;
+  float ocupacao() const;
+
+private:
+  void zerarAgora();
+  MetricasDispositivo& slotDispositivo(uint8_t id);
+  MetricasFuncao* slotFuncao(uint8_t funcao);
+
+  MetricasDispositivo dispositivos_[METRICAS_MAX_DISPOSITIVOS];
+  MetricasDispositivo outros_;
+  uint8_t slot_por_id_[MODBUS_ID_MAX + 1] = {};   // Índice + 1 em dispositivos_ (0 = sem slot)
+  uint8_t num_dispositivos_ = 0;
+
+  static const uint8_t MAX_FUNCOES = 4;            // 0x03, 0x04, 0x06... o excedente fica só no total
+  MetricasFuncao funcoes_[MAX_FUNCOES];
+  uint8_t num_funcoes_ = 0;
+
+  ContadoresModbus total_;
+  uint64_t bytes_enviados_ = 0;
+  uint64_t bytes_recebidos_ = 0;
+  uint64_t linha_us_ = 0;          // Tempo dos bytes na linha
+  uint64_t ocupado_us_ = 0;        // Envio + espera pela resposta
+  uint32_t sondas_ = 0;
+  uint32_t inicio_ms_ = 0;
+  bool suspensa_ = false;
+  std::atomic<bool> zerar_pedido_{false};
+};
+
+MetricasBarramento& metricasModbus(uint8_t barramento = 0);
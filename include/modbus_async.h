@@ -0,0 +1,91 @@
+#pragma once
+
+// Mestre Modbus RTU assíncrono (não bloqueante)
+//
+// Máquina de estados sobre o HAL RS-485, com o mesmo controle DE/RE do
+// preTransmission/postTransmission:
+//
+//   OCIOSO -> TRANSMITINDO -> TURNAROUND -> RECEBENDO -> CONCLUIDO -> OCIOSO
+//                                  |                        ^
+//                                  +------- timeout --------+
+//
+// Um mestre por barramento RS-485, usado só pela tarefa dona do barramento.
+// As requisições entram numa fila; processar() só avança o que já está pronto
+// na linha e retorna imediatamente. O resultado é entregue ao callback de
+// cada requisição (MB_SUCESSO, exceção do escravo ou MB_ERRO_*) com uma vista
+// sobre o quadro recebido: os registradores são lidos direto do buffer de
+// recepção, que só é reutilizado depois que o callback retorna.
+
+#include <stdint.h>
+#include "hal.h"
+#include "modbus_rtu.h"
+
+#define FILA_MODBUS_MAX 8
+
+enum EstadoMestre : uint8_t {
+  MESTRE_OCIOSO,
+  MESTRE_TRANSMITINDO,   // Quadro saindo pela UART (DE alto)
+  MESTRE_TURNAROUND,     // Aguardando o primeiro byte da resposta
+  MESTRE_RECEBENDO,      // Bytes chegando até completar o quadro
+  MESTRE_CONCLUIDO       // Resposta (ou timeout) pronta para o callback
+};
+
+struct RequisicaoModbus;
+typedef void (*CallbackModbus)(const RequisicaoModbus& requisicao, uint8_t resultado,
+                               const RespostaModbus& resposta, void* contexto);
+
+struct RequisicaoModbus {
+  uint8_t id;
+  uint8_t funcao;
+  uint16_t registrador;
+  uint16_t quantidade;
+  CallbackModbus callback;
+  void* contexto;
+  uint32_t turnaround_us = 0;   // Espera pelo primeiro byte; 0 = a do mestre
+};
+
+class MestreModbusAsync {
+public:
+  void iniciar(uint32_t turnaround_us = 20000, uint8_t barramento = 0);
+  bool enfileirar(const RequisicaoModbus& requisicao);  // false se a fila estiver cheia
+  void processar();
+
+  bool ocioso() const { return estado_ == MESTRE_OCIOSO && pendentes_ == 0; }
+  EstadoMestre estado() const { return estado_; }
+  uint8_t pendentes() const { return pendentes_; }
+  uint8_t barramento() const { return barramento_; }
+  uint32_t transacoes() const { return transacoes_; }
+  uint32_t timeouts() const { return timeouts_; }
+  // Instante (micros) do último byte da última resposta, ou da desistência.
+  // Válido no callback: é o carimbo de tempo da captura.
+  uint32_t capturaUs() const { return captura_us_; }
+  // Tempo de barramento da última transação (envio + espera pela resposta
+  // ou pelo timeout). Válido no callback.
+  uint32_t duracaoUs() const { return fim_quadro_us_ - inicio_us_; }
+
+private:
+  void transmitir();
+  void concluir(uint8_t resultado);
+
+  RequisicaoModbus fila_[FILA_MODBUS_MAX];
+  uint8_t inicio_fila_ = 0;
+  uint8_t pendentes_ = 0;
+
+  EstadoMestre estado_ = MESTRE_OCIOSO;
+  RequisicaoModbus atual_;
+  uint8_t resposta_[MODBUS_TAM_MAX_RESPOSTA];
+  uint16_t recebidos_ = 0;
+  uint16_t esperados_ = 5;
+  uint8_t resultado_ = MB_SUCESSO;
+  RespostaModbus vista_;
+
+  uint8_t barramento_ = 0;
+  uint32_t turnaround_us_ = 20000;
+  uint32_t marca_us_ = 0;          // Início do estado atual / último byte recebido
+  uint32_t fim_quadro_us_ = 0;     // Fim da última transação (silêncio entre quadros)
+  uint32_t fim_envio_us_ = 0;      // Fim do envio da requisição atual (latência)
+  uint32_t inicio_us_ = 0;         // Início do envio da requisição atual
+  uint32_t captura_us_ = 0;
+  uint32_t transacoes_ = 0;
+  uint32_t timeouts_ = 0;
+};
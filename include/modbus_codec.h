@@ -0,0 +1,76 @@
+#pragma once
+
+// Codec Modbus RTU próprio: montagem de quadros, CRC16 e tempos derivados do baud rate
+//
+// Requisições são montadas no buffer do chamador. Respostas são validadas no
+// próprio buffer de recepção e lidas por uma vista (RespostaModbus), sem
+// cópia intermediária: quem consome decodifica os registradores direto nos
+// campos da amostra. O CRC usa uma tabela de 256 entradas gerada em tempo de
+// compilação (um acesso à tabela por byte em vez de 8 deslocamentos).
+//
+// Não depende do HAL: o coletor do host (tools/coletor) usa o mesmo codec.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Códigos de função Modbus usados pelo firmware (APENAS LEITURA)
+#define MB_FC_READ_HOLDING 0x03
+#define MB_FC_READ_INPUT   0x04
+// Exceção opt-in: só o otimizador de baud rate, com ESCRITA_BAUD_RATE no build
+#define MB_FC_WRITE_SINGLE 0x06
+
+// Códigos de resultado (mesmos valores do ModbusMaster, para manter os logs comparáveis)
+#define MB_SUCESSO            0x00
+#define MB_EXC_FUNCAO_ILEGAL  0x01
+#define MB_EXC_ENDERECO_ILEGAL 0x02
+#define MB_EXC_VALOR_ILEGAL   0x03
+#define MB_EXC_FALHA_ESCRAVO  0x04
+#define MB_ERRO_ID_INVALIDO   0xE0
+#define MB_ERRO_FUNCAO        0xE1
+#define MB_ERRO_TIMEOUT       0xE2
+#define MB_ERRO_CRC           0xE3
+
+#define MODBUS_ID_MAX 247              // Maior endereço de escravo válido
+#define MODBUS_MAX_REGISTRADORES 125   // Limite de uma leitura (0x03/0x04)
+#define MODBUS_TAM_REQUISICAO 8        // id + função + registrador + quantidade + CRC
+#define MODBUS_TAM_MAX_RESPOSTA (5 + 255)
+
+uint16_t modbusCrc16(const uint8_t* dados, size_t len);
+bool modbusCrcValido(const uint8_t* quadro, size_t len);
+
+// Monta uma requisição de leitura (0x03/0x04) em 'quadro' e retorna o tamanho
+size_t modbusMontarLeitura(uint8_t* quadro, uint8_t id, uint8_t funcao,
+                           uint16_t registrador, uint16_t quantidade);
+
+// Tamanho total esperado da resposta a partir dos 3 primeiros bytes (0 se ainda não há bytes suficientes)
+size_t modbusTamanhoResposta(const uint8_t* resposta, size_t recebidos);
+
+// Vista sobre uma resposta de leitura já validada, apontando para o buffer
+// de recepção: válida enquanto o buffer não for reutilizado
+struct RespostaModbus {
+  const uint8_t* quadro = nullptr;
+  uint8_t num_registradores = 0;
+
+  uint16_t registrador(uint16_t i) const {
+    return (uint16_t)((quadro[3 + 2 * i] << 8) | quadro[4 + 2 * i]);
+  }
+};
+
+// Valida a resposta no lugar (tamanho, CRC, id, função, exceção) e preenche a
+// vista. Retorna MB_SUCESSO, a exceção do escravo ou MB_ERRO_*.
+uint8_t modbusValidarResposta(const uint8_t* resposta, size_t len, uint8_t id, uint8_t funcao,
+                              RespostaModbus& vista);
+
+// Como modbusValidarResposta, copiando até 'quantidade' registradores para 'destino'
+uint8_t modbusDecodificarResposta(const uint8_t* resposta, size_t len, uint8_t id, uint8_t funcao,
+                                  uint16_t quantidade, uint16_t* destino);
+
+// Tempo de um caractere 8N1 (10 bits) em µs
+inline uint32_t modbusTempoCaractereUs(uint32_t baud) {
+  return (uint32_t)(10000000UL / baud);
+}
+
+// Silêncio de fim de quadro (3,5 caracteres); a especificação fixa 1750 µs acima de 19200 bps
+inline uint32_t modbusT35Us(uint32_t baud) {
+  return baud > 19200 ? 1750 : modbusTempoCaractereUs(baud) * 7 / 2;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// Escravo Modbus RTU (gateway para SCADA) na segunda UART
+//
+// Responde a 'Read Input Registers' (0x04) a partir de um mapa em memória,
+// publicado pelo processamento a cada amostra: o SCADA nunca espera pelo
+// turnaround dos sensores nem disputa o barramento deles.
+//
+// MapaEscravo é um seqlock: o escritor marca a versão como ímpar durante a
+// cópia e o leitor descarta leituras com versão ímpar ou alterada. Uma
+// resposta é sempre uma única publicação inteira, nunca campos misturados de
+// duas amostras. Se a publicação estiver em andamento (escritor interrompido
+// no mesmo núcleo), o escravo responde com a última cópia consistente em vez
+// de esperar.
+
+#include <stdint.h>
+#include <atomic>
+#include "hal.h"
+#include "modbus_rtu.h"
+
+// Mapa de input registers (0x04)
+enum RegistroEscravo : uint16_t {
+  REG_ESC_VENTO_DMS,           // Velocidade × 10 (m/s)
+  REG_ESC_DIRECAO_GRAUS,       // 0-360°
+  REG_ESC_DIRECAO_BRUTA,       // 0-7
+  REG_ESC_TEMPERATURA_DC,      // °C × 10, complemento de 2
+  REG_ESC_UV_DEC,              // Índice UV × 10
+  REG_ESC_FLAGS,               // FLAG_TLM_* (lib/telemetria)
+  REG_ESC_TIMESTAMP_H,         // millis() da amostra, 32 bits
+  REG_ESC_TIMESTAMP_L,
+  REG_ESC_SEQUENCIA_H,         // Número sequencial da amostra, 32 bits
+  REG_ESC_SEQUENCIA_L,
+  REG_ESC_VENTO_MEDIO_DMS,     // Média das leituras válidas desde o boot
+  REG_ESC_VENTO_MAXIMO_DMS,    // Maior leitura desde o boot
+  REG_ESC_FALHAS_ANEMOMETRO,   // Falhas consecutivas de leitura
+  REG_ESC_FALHAS_BIRUTA,
+  REG_ESC_TIMEOUTS,            // Timeouts do mestre no barramento dos sensores
+  REG_ESC_DESCARTES,           // Amostras descartadas no pipeline
+  REG_ESC_VENTO_2MIN_DMS,      // Média de 2 min × 10 (ResumoVento)
+  REG_ESC_VENTO_10MIN_DMS,     // Média de 10 min × 10
+  REG_ESC_RAJADA_DMS,          // Maior média de 3 s em 10 min × 10
+  REG_ESC_DIRECAO_2MIN_GRAUS,  // Direção média vetorial de 2 min
+  REG_ESC_DIRECAO_10MIN_GRAUS,
+  REG_ESC_DESVIO_DIRECAO_DG,   // Desvio padrão da direção em 10 min × 10
+  ESCRAVO_NUM_REGISTROS
+};
+
+class MapaEscravo {
+public:
+  // Um único escritor (tarefa de processamento)
+  void publicar(const uint16_t* registros);
+  // Qualquer tarefa: false se não obteve uma cópia consistente
+  bool copiar(uint16_t* destino) const;
+  uint32_t publicacoes() const { return versao_.load(std::memory_order_relaxed) / 2; }
+
+private:
+  std::atomic<uint32_t> versao_{0};
+  uint16_t registros_[ESCRAVO_NUM_REGISTROS] = {};
+};
+
+class EscravoModbus {
+public:
+  void iniciar(uint8_t id, const MapaEscravo* mapa);
+  void processar();                 // Não bloqueia: uma chamada por passo da tarefa
+
+  uint8_t id() const { return id_; }
+  uint32_t respostas() const { return respostas_; }
+  uint32_t excecoes() const { return excecoes_; }
+  uint32_t errosCrc() const { return erros_crc_; }
+  uint32_t copiasAntigas() const { return copias_antigas_; }   // Respostas com a cópia anterior
+
+private:
+  void atender();
+  void responder(const uint8_t* quadro, size_t len);
+  void responderExcecao(uint8_t funcao, uint8_t codigo);
+
+  const MapaEscravo* mapa_ = nullptr;
+  uint16_t copia_[ESCRAVO_NUM_REGISTROS] = {};
+  uint8_t id_ = 1;
+
+  uint8_t quadro_[256];
+  uint16_t recebidos_ = 0;
+  uint32_t ultimo_byte_us_ = 0;
+  bool transmitindo_ = false;
+
+  uint32_t respostas_ = 0;
+  uint32_t excecoes_ = 0;
+  uint32_t erros_crc_ = 0;
+  uint32_t copias_antigas_ = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+// Transações Modbus RTU bloqueantes no barramento do HAL
+//
+// Montagem, CRC e validação ficam no codec (modbus_codec.h); aqui ficam a
+// troca de quadros com timeouts derivados do baud rate e as leituras avulsas.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hal.h"
+#include "modbus_codec.h"
+#include "perfis_dispositivo.h"
+
+#define MODBUS_TURNAROUND_COMANDOS_US 100000   // Leituras avulsas do console: folga para sensores lentos
+
+struct ResultadoLeitura {
+  uint8_t codigo;            // MB_SUCESSO, exceção do escravo ou MB_ERRO_*
+  uint16_t bytes_recebidos;  // Bytes recebidos, válidos ou não
+  uint32_t latencia_us;      // Do fim da requisição ao último byte da resposta
+};
+
+// Leitura bloqueante no baud rate atual do barramento, com timeouts derivados
+// do baud rate: espera o primeiro byte por 1 caractere + 3,5 caracteres +
+// 'turnaround_us' e encerra o quadro após 3,5 caracteres de silêncio. A
+// resposta fica em 'buffer' (MODBUS_TAM_MAX_RESPOSTA bytes) e 'vista' aponta para ela.
+ResultadoLeitura modbusLerQuadro(uint8_t id, uint8_t funcao, uint16_t registrador,
+                                 uint16_t quantidade, uint32_t turnaround_us,
+                                 uint8_t* buffer, RespostaModbus& vista, uint8_t barramento = 0);
+
+// Idem, copiando os registradores para 'destino'
+ResultadoLeitura modbusLerComTimeout(uint8_t id, uint8_t funcao, uint16_t registrador,
+                                     uint16_t quantidade, uint16_t* destino,
+                                     uint32_t turnaround_us, uint8_t barramento = 0);
+
+// Leitura avulsa de um bloco de perfil (perfis_dispositivo.h), decodificada em 'destino'
+template <typename Bloco, typename Destino>
+uint8_t modbusLerBloco(uint8_t id, Destino& destino) {
+  uint8_t buffer[MODBUS_TAM_MAX_RESPOSTA];
+  RespostaModbus vista;
+  uint8_t codigo = modbusLerQuadro(id, Bloco::funcao, Bloco::inicio, Bloco::quantidade,
+                                   MODBUS_TURNAROUND_COMANDOS_US, buffer, vista).codigo;
+  if (codigo == MB_SUCESSO) Bloco::decodificar(vista, destino);
+  return codigo;
+}
+
+#ifdef ESCRITA_BAUD_RATE
+// A única escrita do firmware, só com ESCRITA_BAUD_RATE no build: o código de
+// baud rate (0x07D1, função 0x06) de um sensor, usado pelo otimizador de baud
+// rate (otimizador_baud.h). A resposta é o eco da requisição, ainda no baud
+// rate antigo; MB_SUCESSO só com o eco idêntico.
+ResultadoLeitura modbusEscreverCodigoBaud(uint8_t id, uint16_t codigo, uint32_t turnaround_us,
+                                          uint8_t barramento = 0);
+#endif
+
+// Leituras avulsas (console, diagnóstico) no barramento dos sensores principais; retornam só o código
+inline uint8_t modbusLerInput(uint8_t id, uint16_t registrador, uint16_t quantidade, uint16_t* destino) {
+  return modbusLerComTimeout(id, MB_FC_READ_INPUT, registrador, quantidade, destino, MODBUS_TURNAROUND_COMANDOS_US).codigo;
+}
+
+inline uint8_t modbusLerHolding(uint8_t id, uint16_t registrador, uint16_t quantidade, uint16_t* destino) {
+  return modbusLerComTimeout(id, MB_FC_READ_HOLDING, registrador, quantidade, destino, MODBUS_TURNAROUND_COMANDOS_US).codigo;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+// Núcleo Arduino mínimo para o build nativo (Linux)
+//
+// Só o que o firmware usa: String, Serial (console em stdin/stdout), tempo e
+// GPIO. O tempo é VIRTUAL: millis()/micros() só avançam com delay(),
+// delayMicroseconds() e yield(), o que permite simular minutos de barramento
+// RS-485 em milissegundos de CPU. Implementação em src/native/hal_native.cpp.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using std::isnan;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define SERIAL_8N1 0x800001c
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+class String {
+public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+
+  bool operator==(const char* o) const { return s_ == o; }
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator!=(const char* o) const { return s_ != o; }
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+
+  bool startsWith(const char* prefixo) const { return s_.rfind(prefixo, 0) == 0; }
+  void toLowerCase() { for (auto& c : s_) c = (char)tolower((unsigned char)c); }
+  void trim() {
+    size_t ini = s_.find_first_not_of(" \t\r\n");
+    size_t fim = s_.find_last_not_of(" \t\r\n");
+    s_ = (ini == std::string::npos) ? std::string() : s_.substr(ini, fim - ini + 1);
+  }
+
+private:
+  std::string s_;
+};
+
+// Console: saída em stdout, entrada não bloqueante de stdin (ou injetada).
+// A UART é modelada no relógio virtual, como no driver do ESP32: o FIFO de
+// 128 bytes mais o buffer de setTxBufferSize() esvaziam no baud rate, e uma
+// escrita que não cabe prende quem escreveu até sobrar espaço. Vale também
+// com a saída silenciada ou capturada.
+#define SERIAL_FIFO_TX 128
+
+class HardwareSerial {
+public:
+  void begin(unsigned long baud) { baud_ = baud; }
+  size_t setTxBufferSize(size_t tamanho) { buffer_tx_ = tamanho; return tamanho; }
+  int availableForWrite();   // Bytes que cabem sem esperar
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* s);
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t println(const char* s = "");
+  size_t println(const String& s) { return println(s.c_str()); }
+  size_t write(const uint8_t* dados, size_t len);
+  void flush() { fflush(stdout); }
+
+  int available();
+  int read();
+  String readString();
+
+  // Exclusivo do build nativo
+  void injetar(const char* texto);   // Simula texto digitado no console
+  void silenciar(bool mudo) { mudo_ = mudo; }
+  bool silenciado() const { return mudo_; }
+  void capturar(std::string* destino) { captura_ = destino; }   // write() vai para 'destino' (nullptr: stdout)
+  uint64_t esperaTxUs() const { return espera_tx_us_; }        // Total em que escritas ficaram presas
+  uint64_t maiorEsperaTxUs() const { return maior_espera_tx_us_; }
+  void zerarEsperaTx() { espera_tx_us_ = maior_espera_tx_us_ = 0; }
+
+private:
+  void lerStdin();
+  void transmitir(size_t len);
+  std::string entrada_;
+  std::string* captura_ = nullptr;
+  bool mudo_ = false;
+  unsigned long baud_ = 115200;
+  size_t buffer_tx_ = 0;
+  uint64_t fim_tx_ns_ = 0;            // Último byte enfileirado sai da linha
+  uint64_t espera_tx_us_ = 0;
+  uint64_t maior_espera_tx_us_ = 0;
+};
+
+extern HardwareSerial Serial;
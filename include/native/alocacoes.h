@@ -0,0 +1,26 @@
+#pragma once
+
+// Contagem de alocações no heap do build nativo
+//
+// operator new/delete são substituídos em src/native/alocacoes.cpp e contam
+// toda alocação feita pelo firmware. O HAL nativo (barramento simulado e
+// console, que no ESP32 seriam hardware) roda dentro de ForaDaContagem.
+// Uso típico: medir o antes/depois de um loop() e exigir zero alocações.
+
+#include <cstdint>
+
+struct ContagemAlocacoes {
+  uint64_t alocacoes = 0;
+  uint64_t bytes = 0;
+};
+
+ContagemAlocacoes simAlocacoes();
+
+// Suspende a contagem no escopo atual (pode ser aninhado)
+class ForaDaContagem {
+public:
+  ForaDaContagem();
+  ~ForaDaContagem();
+  ForaDaContagem(const ForaDaContagem&) = delete;
+  ForaDaContagem& operator=(const ForaDaContagem&) = delete;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+// Barramento RS-485 simulado para o build nativo
+//
+// Emula transmissores SN-3000-FSJT-N01 (anemômetro) e SN-3000-FXJT-N01 (biruta)
+// com o mapa de registradores dos manuais:
+//   0x0000  anemômetro: velocidade × 10 | biruta: direção 0-7
+//   0x0001  biruta: direção em graus (0-360°)
+//   0x07D0  endereço do dispositivo (1-254)
+//   0x07D1  código de baud rate (0=2400 ... 6=115200, 7=1200)
+// Leitura com 0x03/0x04; 0x07D0 e 0x07D1 também aceitam escrita (0x06). O
+// novo baud rate vale logo depois do eco, que ainda sai no antigo. Um
+// registrador fora do mapa (0x0001 no anemômetro) dá exceção 02, ou nada com
+// 'mudo_fora_do_mapa', como os sensores que só ignoram o pedido.
+//
+// O tempo é o relógio virtual do HAL nativo (µs). Cada byte ocupa 10 bits na
+// linha (8N1); o sensor só detecta o fim do quadro após 3,5 caracteres de
+// silêncio e responde depois da sua latência. Quadros enviados num baud rate
+// diferente do sensor chegam corrompidos: o sensor não reconhece nem o
+// próprio ID e fica calado, o caso comum. Com 'prob_lixo_baud' o sensor
+// endereçado ainda reage ao quadro truncado e o mestre recebe bytes sem
+// quadro válido (o lixo que a descoberta usa para abandonar o baud rate).
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+enum class SimModelo : uint8_t {
+  ANEMOMETRO_FSJT,   // SN-3000-FSJT-N01
+  BIRUTA_FXJT        // SN-3000-FXJT-N01
+};
+
+struct SimSensor {
+  uint8_t id = 1;
+  SimModelo modelo = SimModelo::ANEMOMETRO_FSJT;
+  uint32_t baud = 4800;
+  uint32_t latencia_us = 8000;     // Tempo de resposta do sensor (turnaround)
+  bool presente = true;            // false = desconectado do barramento
+  bool vento_automatico = true;    // Valores evoluem sozinhos a cada leitura
+  bool mudo_fora_do_mapa = false;  // Registrador fora do mapa: silêncio em vez da exceção 02
+  uint16_t valor_principal = 0;    // Registrador 0x0000
+  uint16_t valor_secundario = 0;   // Registrador 0x0001 (biruta)
+};
+
+struct SimConfig {
+  uint32_t latencia_extra_us = 0;  // Atraso somado a todas as respostas
+  uint32_t jitter_us = 0;          // Variação aleatória da latência (0..jitter)
+  float prob_perda = 0.0f;         // Probabilidade de uma resposta não chegar
+  float prob_erro_crc = 0.0f;      // Probabilidade de um byte corrompido na resposta
+  uint32_t baud_max_linha = 0;     // Acima deste baud rate a linha degrada (0 = sem limite)
+  float prob_erro_acima = 0.2f;    // Corrupção somada acima de baud_max_linha
+  float prob_lixo_baud = 0.0f;     // Quadro em outro baud rate que volta como lixo
+  uint32_t semente = 1;
+};
+
+struct SimEstatisticas {
+  uint32_t quadros_recebidos = 0;  // Quadros completos vistos pelos sensores
+  uint32_t respostas = 0;
+  uint32_t excecoes = 0;
+  uint32_t perdidas = 0;
+  uint32_t corrompidas = 0;
+  uint32_t ignorados_baud = 0;     // Quadros em baud rate diferente do sensor
+  uint32_t lixo_baud = 0;          // Desses, os que voltaram como lixo
+  uint32_t ignorados_crc = 0;
+  uint32_t escritas = 0;           // Escritas aceitas (0x06 em 0x07D0/0x07D1)
+  uint64_t bytes_linha = 0;        // Bytes transmitidos (mestre + sensores)
+};
+
+// Tempo de um caractere (10 bits) em µs
+inline uint32_t simTempoCaractere(uint32_t baud) {
+  return (uint32_t)(10000000ULL / baud);
+}
+
+class BarramentoSimulado {
+public:
+  void configurar(const SimConfig& config);
+  const SimConfig& config() const { return config_; }
+
+  SimSensor& adicionarSensor(uint8_t id, SimModelo modelo, uint32_t baud = 4800,
+                             uint32_t latencia_us = 8000);
+  SimSensor* sensor(uint8_t id);
+  void limparSensores();
+
+  // Lado do mestre: bytes enviados a partir de 'inicio_us' no baud rate dado.
+  // Retorna o instante em que o último bit sai da linha.
+  uint64_t transmitir(const uint8_t* dados, size_t len, uint32_t baud, uint64_t inicio_us);
+  int disponivel(uint64_t agora_us);
+  int ler(uint64_t agora_us);
+  void descartar(uint64_t agora_us);
+
+  // Próximo instante em que algo acontece na linha (UINT64_MAX se nada)
+  uint64_t proximoEvento() const;
+
+  const SimEstatisticas& estatisticas() const { return stats_; }
+  void zerarEstatisticas() { stats_ = SimEstatisticas(); }
+
+private:
+  void processar(uint64_t agora_us);
+  void atenderQuadro(const std::vector<uint8_t>& quadro, uint32_t baud, uint64_t fim_us);
+  void emitirLixo(const SimSensor& s, uint32_t baud, uint64_t fim_us);
+  bool lerRegistrador(SimSensor& s, uint16_t reg, uint16_t& valor);
+  void evoluirVento(SimSensor& s);
+  float sortear();
+
+  SimConfig config_;
+  std::vector<SimSensor> sensores_;
+  std::mt19937 rng_{1};
+
+  // Quadro do mestre ainda em formação (fim detectado por silêncio de 3,5 char)
+  std::vector<uint8_t> quadro_mestre_;
+  uint32_t baud_quadro_ = 0;
+  uint64_t fim_quadro_us_ = 0;
+
+  struct ByteLinha {
+    uint64_t chegada_us;
+    uint8_t valor;
+  };
+  std::deque<ByteLinha> rx_;
+  SimEstatisticas stats_;
+};
+
+// Um barramento por UART de sensores do HAL nativo (HAL_MAX_BARRAMENTOS)
+#define SIM_MAX_BARRAMENTOS 2
+BarramentoSimulado& simBarramento(uint8_t barramento = 0);
+
+// Relógio virtual do HAL nativo
+uint64_t simAgoraUs();
+void simAvancarUs(uint64_t us);
+
+// Porta do escravo (segunda UART): o SCADA simulado envia requisições e lê as
+// respostas do firmware. Sem timing de linha: os bytes ficam disponíveis na hora.
+void simScadaEnviar(const uint8_t* dados, size_t len);
+size_t simScadaReceber(uint8_t* destino, size_t max);
+
+// NVS simulada: blobs em memória; com um arquivo, sobrevivem entre execuções
+// (boot a quente com o cache de descoberta)
+void simNvsArquivo(const char* caminho);
+
+// Flash de dados simulada (NOR, setores de HAL_FLASH_SETOR), em memória ou
+// num arquivo. Apagar e gravar avançam o relógio virtual com tempos típicos
+// de uma flash SPI: 45 ms por setor, 0,4 ms por página de 256 bytes.
+struct SimFlashEstatisticas {
+  uint32_t apagamentos = 0;
+  uint32_t maior_desgaste = 0;     // Apagamentos do setor mais apagado
+  uint32_t menor_desgaste = 0;
+  uint64_t bytes_gravados = 0;
+  uint64_t bytes_lidos = 0;
+  uint32_t leituras = 0;
+};
+void simFlashConfigurar(uint32_t tamanho, const char* arquivo = nullptr);
+// Queda de energia: grava só mais 'bytes' bytes (a gravação em curso fica
+// pela metade) e falha todas as operações até simFlashReligar()
+void simFlashCortarApos(uint32_t bytes);
+void simFlashReligar();
+const SimFlashEstatisticas& simFlashEstatisticas();
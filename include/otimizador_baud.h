@@ -0,0 +1,141 @@
+#pragma once
+
+// Otimizador de baud rate de um barramento (comando 'optimize')
+//
+// Os transmissores saem de fábrica a 4800 bps, e isso limita a taxa de
+// leitura. O 0x07D1 aceita até 115200. O otimizador sobe o barramento um
+// degrau por vez (BAUD_POR_CODIGO, crescente):
+//   1. mede a qualidade do enlace no baud rate atual (leituras de 0x0000);
+//   2. escreve 0x07D1 (função 0x06) em um dispositivo por vez e confirma
+//      lendo o 0x07D1 de volta no novo baud rate;
+//   3. mede o enlace no novo baud rate com todos os dispositivos;
+//   4. com falhas acima de 'erro_maximo', volta cada dispositivo ao degrau
+//      anterior e para. Sem falhas, tenta o próximo degrau.
+// Um dispositivo que não confirma interrompe o degrau, e os já movidos
+// voltam. Se ele ainda responde no baud rate antigo com o código novo, o
+// sensor só troca ao religar; o código antigo é reescrito.
+//
+// Segurança: o firmware continua só de leitura por padrão. A escrita só
+// existe com ESCRITA_BAUD_RATE no build (modbus_rtu.h) e só roda com
+// 'aplicar'. Sem isso o otimizador faz um ensaio: mede o enlace atual e
+// lista as escritas que faria, sem escrever nada. No build nativo a
+// escrita é habilitada e roda contra os sensores simulados.
+//
+// Roda em passos (passo()), cada um com uma única leitura de medida ou a
+// troca de um dispositivo, para o console intercalar a amostragem. Entre
+// iniciar() e o último passo o barramento é do otimizador. cancelar() volta
+// os dispositivos já movidos no degrau em andamento, também em passos.
+
+#include <stdint.h>
+#include "hal.h"
+#include "metricas_modbus.h"
+#include "modbus_rtu.h"
+#include "tipos.h"
+
+#define OTIMIZADOR_MAX_DISPOSITIVOS 16
+#define OTIMIZADOR_MAX_PASSOS 96
+
+struct ConfigOtimizador {
+  uint32_t baud_maximo = 115200;
+  uint16_t leituras_por_dispositivo = 20;   // Por medida de enlace
+  float erro_maximo = 1.0f;                 // % de leituras com falha
+  uint32_t turnaround_us = 20000;
+  uint8_t tentativas_confirmacao = 3;
+  bool aplicar = false;                     // false = ensaio, sem escrita
+};
+
+struct MedidaEnlace {
+  uint32_t baud;
+  uint16_t leituras;
+  uint16_t falhas;
+  uint32_t p95_us;
+  float leituras_s;
+  bool aprovado;
+
+  float erroPct() const { return leituras ? 100.0f * falhas / leituras : 100.0f; }
+};
+
+enum AcaoOtimizador : uint8_t {
+  OTM_ENSAIO,         // Escrita que seria feita (ensaio)
+  OTM_CONFIRMADO,     // Escrita e leitura de volta no novo baud rate
+  OTM_SEM_RESPOSTA,   // Não confirmou no novo nem no antigo
+  OTM_SO_AO_RELIGAR,  // Aceitou o código, mas segue no baud rate antigo
+  OTM_RECUSADO,       // Exceção ou eco diferente; segue no antigo
+  OTM_RETORNO,        // Voltou ao baud rate anterior
+  OTM_RETORNO_FALHOU
+};
+
+enum EtapaOtimizador : uint8_t {
+  OTM_MEDINDO_ATUAL,   // Enlace no baud rate de partida
+  OTM_TROCANDO,        // Um dispositivo por passo para o próximo degrau
+  OTM_MEDINDO_NOVO,    // Enlace no degrau novo, todos já movidos
+  OTM_VOLTANDO,        // Degrau reprovado ou cancelado: um retorno por passo
+  OTM_FIM
+};
+
+struct PassoOtimizador {
+  AcaoOtimizador acao;
+  uint8_t id;
+  uint32_t de;
+  uint32_t para;
+  uint8_t resultado;    // Da escrita (MB_SUCESSO ou código de erro)
+};
+
+class OtimizadorBaud {
+public:
+  void configurar(const ConfigOtimizador& config) { config_ = config; }
+  void limparDispositivos() { num_ids_ = 0; }
+  bool adicionarDispositivo(uint8_t id);
+
+  // Sobe o barramento até onde o enlace aguenta, um passo por chamada;
+  // passo() retorna false no fim, com o barramento em baudFinal()
+  void iniciar(uint8_t barramento);
+  bool passo();
+  void cancelar();
+  // iniciar() e passo() até o fim; retorna o baud rate final
+  uint32_t executar(uint8_t barramento);
+
+  EtapaOtimizador etapa() const { return etapa_; }
+  uint32_t baudFinal() const { return baud_final_; }
+
+  uint8_t numMedidas() const { return num_medidas_; }
+  const MedidaEnlace& medida(uint8_t i) const { return medidas_[i]; }
+  uint8_t numPassos() const { return num_passos_; }
+  const PassoOtimizador& passo(uint8_t i) const { return passos_[i]; }
+  bool mudou() const { return baud_final_ != baud_inicial_; }
+  bool consistente() const { return consistente_; }   // false: algum dispositivo ficou fora do baud rate final
+
+private:
+  void iniciarMedida(uint32_t baud);
+  bool medir();
+  bool proximoDegrau();
+  bool iniciarRetorno();
+  bool concluir();
+  bool lerCodigo(uint8_t id, uint32_t baud, uint16_t& codigo);
+  bool trocar(uint8_t id, uint32_t de, uint32_t para);
+  void voltar(uint8_t id, uint32_t de, uint32_t para);
+  void registrarPasso(AcaoOtimizador acao, uint8_t id, uint32_t de, uint32_t para, uint8_t resultado);
+
+  ConfigOtimizador config_;
+  uint8_t barramento_ = 0;
+  uint8_t ids_[OTIMIZADOR_MAX_DISPOSITIVOS];
+  uint8_t num_ids_ = 0;
+
+  MedidaEnlace medidas_[NUM_CODIGOS_BAUD];
+  uint8_t num_medidas_ = 0;
+  PassoOtimizador passos_[OTIMIZADOR_MAX_PASSOS];
+  uint8_t num_passos_ = 0;
+  HistogramaLatencia latencia_;
+  uint32_t baud_inicial_ = 0;
+  uint32_t baud_final_ = 0;
+  bool consistente_ = true;
+
+  EtapaOtimizador etapa_ = OTM_FIM;
+  bool escrever_ = false;
+  uint8_t codigo_ = 0;         // Próximo código de BAUD_POR_CODIGO a tentar
+  uint32_t para_ = 0;          // Degrau em andamento
+  uint8_t movidos_ = 0;        // Dispositivos já no degrau
+  uint8_t voltados_ = 0;
+  uint16_t leitura_ = 0;       // Leituras feitas da medida em andamento
+  uint32_t tempo_medida_us_ = 0;
+};
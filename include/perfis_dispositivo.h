@@ -0,0 +1,169 @@
+#pragma once
+
+// Perfis de dispositivo: o mapa de registradores de cada modelo em tempo de compilação
+//
+// Cada registrador é um tipo: endereço, campo de destino (ponteiro para
+// membro de SensorData, DeviceInfo...), faixa do manual em valor bruto e
+// divisor de escala. O decodificador sai do tipo do campo, sem tabela nem
+// switch em tempo de execução:
+//   - float: bruto / Divisor (velocidade × 10 -> m/s);
+//   - enum: 0..Maximo, e Maximo + 1 (o "inválido" do enum) fora da faixa;
+//   - inteiro: o valor bruto.
+// BlocoRegistradores junta os registradores lidos numa só transação
+// (função, início e quantidade calculados pelo compilador) e decodifica a
+// resposta inteira com uma expansão do pacote de registradores, também
+// quando o bloco é só uma parte de uma leitura maior (planejador.h).
+//
+// Um transmissor novo (umidade, pressão...) é um perfil novo: o campo em
+// SensorData e um BlocoRegistradores com os registradores do manual. Não
+// depende do HAL: o firmware e o coletor do host (tools/coletor) usam os
+// mesmos perfis.
+
+#include <stdint.h>
+#include <type_traits>
+#include "modbus_codec.h"
+#include "tipos.h"
+
+template <typename T>
+struct MembroRegistrador;
+
+template <typename Classe, typename Tipo>
+struct MembroRegistrador<Tipo Classe::*> {
+  using Destino = Classe;
+  using Valor = Tipo;
+};
+
+template <uint16_t Endereco, auto Campo, uint16_t Minimo, uint16_t Maximo, uint16_t Divisor = 1>
+struct Registrador {
+  using Destino = typename MembroRegistrador<decltype(Campo)>::Destino;
+  using Valor = typename MembroRegistrador<decltype(Campo)>::Valor;
+  static_assert(Minimo <= Maximo && Divisor > 0, "faixa ou divisor inválido");
+  static_assert(Divisor == 1 || std::is_floating_point<Valor>::value, "só campos float têm escala");
+
+  static constexpr uint16_t endereco = Endereco;
+  static constexpr uint16_t minimo = Minimo;
+  static constexpr uint16_t maximo = Maximo;
+  static constexpr uint16_t divisor = Divisor;
+
+  static constexpr bool naFaixa(uint16_t bruto) { return bruto >= Minimo && bruto <= Maximo; }
+
+  static constexpr Valor converter(uint16_t bruto) {
+    if constexpr (std::is_floating_point<Valor>::value) {
+      return (Valor)bruto / (Valor)Divisor;
+    } else if constexpr (std::is_enum<Valor>::value) {
+      return naFaixa(bruto) ? (Valor)bruto : (Valor)(Maximo + 1);
+    } else {
+      return (Valor)bruto;
+    }
+  }
+
+  static void decodificar(uint16_t bruto, Destino& destino) { destino.*Campo = converter(bruto); }
+};
+
+template <uint16_t Primeiro, uint16_t... Outros>
+constexpr uint16_t menorEndereco() {
+  uint16_t menor = Primeiro;
+  ((menor = Outros < menor ? Outros : menor), ...);
+  return menor;
+}
+
+template <uint16_t Primeiro, uint16_t... Outros>
+constexpr uint16_t maiorEndereco() {
+  uint16_t maior = Primeiro;
+  ((maior = Outros > maior ? Outros : maior), ...);
+  return maior;
+}
+
+// Registradores contíguos (ou quase) lidos numa única transação
+template <uint8_t Funcao, typename... Registradores>
+struct BlocoRegistradores {
+  static_assert(sizeof...(Registradores) > 0, "bloco sem registradores");
+
+  static constexpr uint8_t funcao = Funcao;
+  static constexpr uint16_t inicio = menorEndereco<Registradores::endereco...>();
+  static constexpr uint16_t quantidade = maiorEndereco<Registradores::endereco...>() - inicio + 1;
+  static_assert(quantidade <= MODBUS_MAX_REGISTRADORES, "bloco maior que uma leitura Modbus");
+
+  // Resposta validada (vista no buffer de recepção); registradores além da
+  // resposta ficam como estão
+  template <typename Destino>
+  static void decodificar(const RespostaModbus& resposta, Destino& destino) {
+    decodificar(resposta, 0, destino);
+  }
+
+  // Idem, com o bloco a partir do registrador 'deslocamento' da resposta
+  // (uma leitura do planejador que cobre mais de um bloco)
+  template <typename Destino>
+  static void decodificar(const RespostaModbus& resposta, uint16_t deslocamento, Destino& destino) {
+    (decodificarUm<Registradores>(resposta, deslocamento, destino), ...);
+  }
+
+  // Registradores já copiados, a partir de 'inicio'
+  template <typename Destino>
+  static void decodificar(const uint16_t* valores, Destino& destino) {
+    (Registradores::decodificar(valores[Registradores::endereco - inicio], destino), ...);
+  }
+
+private:
+  template <typename R, typename Destino>
+  static void decodificarUm(const RespostaModbus& resposta, uint16_t deslocamento, Destino& destino) {
+    uint16_t indice = deslocamento + (R::endereco - inicio);
+    if (indice < resposta.num_registradores) R::decodificar(resposta.registrador(indice), destino);
+  }
+};
+
+// Registrador com o valor principal de todos os modelos: a sonda da varredura lê só ele
+#define REGISTRADOR_PRINCIPAL 0x0000
+
+// Anemômetro SN-3000-FSJT-N01: velocidade × 10 em 0x0000 (0-70 m/s)
+struct PerfilAnemometro {
+  static constexpr const char* modelo = "SN-3000-FSJT-N01";
+  using Velocidade = Registrador<0x0000, &SensorData::wind_speed, 0, 700, 10>;
+  using Dados = BlocoRegistradores<MB_FC_READ_INPUT, Velocidade>;
+
+  // Valor principal acima da faixa: ANEMÔMETRO (velocidade alta) na varredura
+  static constexpr uint16_t LIMIAR_ALTA = Velocidade::maximo;
+};
+
+// Biruta SN-3000-FXJT-N01: direção 0-7 em 0x0000 e graus (0-360°) em 0x0001
+struct PerfilBiruta {
+  static constexpr const char* modelo = "SN-3000-FXJT-N01";
+  using Direcao = Registrador<0x0000, &SensorData::wind_direction_raw, DIRECAO_NORTE, DIRECAO_NOROESTE>;
+  using Cardinal = Registrador<0x0000, &SensorData::wind_direction_cardinal, DIRECAO_NORTE, DIRECAO_NOROESTE>;
+  using Graus = Registrador<0x0001, &SensorData::wind_direction_degrees, 0, 360>;
+  using Dados = BlocoRegistradores<MB_FC_READ_INPUT, Direcao, Cardinal, Graus>;
+
+  static constexpr uint16_t GRAUS_POR_SETOR = 45;
+};
+
+// Configuração comum aos dois modelos (holding registers 0x07D0-0x07D1)
+struct PerfilConfiguracao {
+  using Endereco = Registrador<0x07D0, &DeviceInfo::config_id, 1, 254>;
+  using CodigoBaud = Registrador<0x07D1, &DeviceInfo::config_baud, 0, NUM_CODIGOS_BAUD - 1>;
+  using Dados = BlocoRegistradores<MB_FC_READ_HOLDING, Endereco, CodigoBaud>;
+};
+
+static_assert(PerfilAnemometro::Dados::inicio == REGISTRADOR_PRINCIPAL &&
+              PerfilBiruta::Dados::inicio == REGISTRADOR_PRINCIPAL,
+              "a sonda da varredura lê o primeiro registrador de dados");
+static_assert(PerfilBiruta::Dados::quantidade == 2, "biruta: direção e graus numa leitura");
+static_assert(PerfilBiruta::Cardinal::converter(8) == DIRECAO_INVALIDA, "fora da faixa vira o inválido do enum");
+
+// Sonda de tipo: o registrador de graus (0x0001) só existe na biruta. Pelo
+// valor de 0x0000 um anemômetro com vento calmo (0-0,7 m/s) pareceria uma
+// biruta (0-7). O anemômetro pode recusar 0x0001 com exceção 02 ou só ficar
+// calado, então só a leitura bem-sucedida decide.
+using SondaTipo = PerfilBiruta::Graus;
+constexpr uint8_t FUNCAO_SONDA_TIPO = PerfilBiruta::Dados::funcao;
+
+// Tipo de quem respondeu 0x0000: biruta se 0x0001 foi lido; senão (exceção,
+// timeout ou lixo) anemômetro, de velocidade alta acima da faixa do manual
+constexpr TipoDispositivo classificarDispositivo(uint8_t resultado_sonda, uint16_t valor_principal) {
+  if (resultado_sonda == MB_SUCESSO) return TIPO_BIRUTA;
+  return valor_principal > PerfilAnemometro::LIMIAR_ALTA ? TIPO_ANEMOMETRO_ALTA : TIPO_ANEMOMETRO_BAIXA;
+}
+
+static_assert(classificarDispositivo(MB_EXC_ENDERECO_ILEGAL, 0) == TIPO_ANEMOMETRO_BAIXA,
+              "vento calmo continua anemômetro");
+static_assert(classificarDispositivo(MB_ERRO_TIMEOUT, 0) == TIPO_ANEMOMETRO_BAIXA,
+              "anemômetro calado em 0x0001 continua anemômetro");
@@ -0,0 +1,108 @@
+#pragma once
+
+// Planejador de leituras Modbus com agrupamento de faixas de registradores
+//
+// Cada dispositivo declara os blocos de perfil que precisa por ciclo
+// (perfis_dispositivo.h). compilar() ordena os pedidos e funde blocos
+// contíguos (ou separados por até 'lacuna_max' registradores) no menor número
+// de transações; executar() faz as leituras e decodifica direto do quadro
+// recebido para os campos de SensorData, sem buffer intermediário. Cada
+// bloco decodifica pela sua expansão do perfil (BlocoRegistradores::
+// decodificar, especializada pelo compilador): uma chamada por bloco, não
+// uma por registrador.
+// Ex.: anemômetro 0x0000 + bloco em 0x0002 -> uma leitura de 3 registradores.
+// Uma transação com lacuna recusada pelo escravo (endereço ilegal) é trocada
+// por faixas contíguas de blocos e só elas são relidas; as outras não mudam.
+// enfileirar() faz o mesmo pelo mestre assíncrono, sem bloquear.
+
+#include <stdint.h>
+#include "hal.h"
+#include "modbus_async.h"
+#include "perfis_dispositivo.h"
+#include "tipos.h"
+
+#define PLANO_MAX_BLOCOS 16
+#define PLANO_MAX_TRANSACOES 8
+
+// O bloco começa no registrador 'deslocamento' da resposta
+typedef void (*DecodificarBloco)(const RespostaModbus& resposta, uint16_t deslocamento, SensorData& destino);
+
+struct MapeamentoBloco {
+  uint8_t id;
+  uint8_t funcao;
+  uint16_t inicio;
+  uint16_t quantidade;
+  DecodificarBloco decodificar;
+
+  uint16_t fim() const { return inicio + quantidade - 1; }
+};
+
+// Chamado quando todas as transações enfileiradas do plano terminaram
+typedef void (*CallbackPlano)(uint8_t resultado, void* contexto);
+
+struct LeituraPlanejada {
+  uint8_t id;
+  uint8_t funcao;
+  uint16_t inicio;
+  uint16_t quantidade;
+  uint8_t primeiro;         // Índice do primeiro bloco coberto
+  uint8_t num_blocos;
+};
+
+class PlanoLeitura {
+public:
+  void limpar();
+  bool adicionar(const MapeamentoBloco& bloco);   // false se o plano estiver cheio
+
+  // Um bloco de perfil (PerfilBiruta::Dados...), decodificado pela expansão dele
+  template <typename Bloco>
+  bool adicionarBloco(uint8_t id) {
+    return adicionar({id, Bloco::funcao, Bloco::inicio, Bloco::quantidade, &Bloco::template decodificar<SensorData>});
+  }
+  // false se os blocos não cabem em PLANO_MAX_TRANSACOES (o excedente não é lido)
+  bool compilar(uint16_t lacuna_max = 2);
+
+  // Retorna MB_SUCESSO ou o código da primeira transação com falha
+  uint8_t executar(SensorData& destino, uint8_t barramento = 0);
+
+  // Versão assíncrona: enfileira as transações no mestre e decodifica em
+  // 'destino' à medida que as respostas chegam. false se a fila não comporta.
+  bool enfileirar(MestreModbusAsync& mestre, SensorData& destino,
+                  CallbackPlano callback = nullptr, void* contexto = nullptr);
+  bool pendente() const { return faltam_ > 0; }
+  // Tempo de barramento das transações da última execução enfileirada
+  uint32_t duracaoUs() const { return duracao_us_; }
+
+  uint8_t numTransacoes() const { return num_transacoes_; }
+  uint8_t numBlocos() const { return num_blocos_; }
+  const LeituraPlanejada& transacao(uint8_t i) const { return transacoes_[i]; }
+
+private:
+  void aplicar(const LeituraPlanejada& t, const RespostaModbus& resposta, SensorData& destino) const;
+  bool temLacuna(const LeituraPlanejada& t) const;
+  bool dividir(uint8_t i);
+  void enfileirarTransacao(uint8_t i);
+  bool relerLacunas();
+  static void aoConcluirTransacao(const RequisicaoModbus& requisicao, uint8_t resultado,
+                                  const RespostaModbus& resposta, void* contexto);
+
+  // Contexto de cada transação enfileirada (plano + índice)
+  struct ContextoTransacao {
+    PlanoLeitura* plano;
+    uint8_t indice;
+  };
+  ContextoTransacao contextos_[PLANO_MAX_TRANSACOES];
+  MestreModbusAsync* mestre_ = nullptr;
+  SensorData* destino_ = nullptr;
+  CallbackPlano callback_ = nullptr;
+  void* contexto_ = nullptr;
+  uint8_t faltam_ = 0;
+  uint8_t resultado_ = MB_SUCESSO;
+  uint32_t duracao_us_ = 0;
+
+  MapeamentoBloco blocos_[PLANO_MAX_BLOCOS];
+  uint8_t num_blocos_ = 0;
+  LeituraPlanejada transacoes_[PLANO_MAX_TRANSACOES];
+  bool reler_[PLANO_MAX_TRANSACOES] = {};   // Transações a (re)enfileirar após uma divisão
+  uint8_t num_transacoes_ = 0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+// Registro de dispositivos Modbus de todos os barramentos RS-485
+//
+// Tabela estática com uma partição por barramento do tamanho da faixa de
+// endereços (247): qualquer instalação que o protocolo permita cabe sem heap,
+// e a capacidade é verificada a cada inserção. Cada partição tem um único
+// escritor, a tarefa dona do barramento (varredura e leituras periódicas).
+//
+// A varredura em segundo plano refaz a partição (limpar() e adicionar())
+// enquanto outras tarefas a percorrem: cada partição é um seqlock, como o
+// MapaEscravo. limpar(), adicionar() e mudarBaud() marcam a versão como ímpar durante a
+// mudança; as outras tarefas leem por copiar(), que descarta cópias feitas
+// durante uma mudança e desiste em vez de esperar (o escritor pode estar
+// parado no mesmo núcleo). Os contadores das leituras não mudam a versão: a
+// cópia pode estar uma leitura atrás. dispositivo() é só da tarefa dona.
+//
+// lerProximo() lê em rodízio os dispositivos que o escalonador não lê (os
+// principais têm plano próprio): um por chamada, pelo mestre assíncrono do
+// barramento, com no máximo uma leitura do registro na fila de cada mestre.
+// Dispositivos num baud rate diferente do barramento ficam de fora: trocar o
+// baud rate a cada leitura reconfiguraria a UART. O rodízio também pula quem
+// está em espera após uma falha; um dispositivo FORA só entra na sua vez
+// quando a sonda de reconexão vence (saude_dispositivo.h).
+
+#include <stdint.h>
+#include <atomic>
+#include "hal.h"
+#include "modbus_async.h"
+#include "modbus_rtu.h"
+#include "saude_dispositivo.h"
+#include "tipos.h"
+
+#define REGISTRO_MAX_POR_BARRAMENTO MODBUS_ID_MAX
+
+struct Dispositivo {
+  DeviceInfo info;
+  bool principal = false;              // Lido pelo escalonador (anemômetro/biruta principais)
+  uint8_t resultado = MB_ERRO_TIMEOUT; // Última leitura
+  uint16_t valores[2] = {};            // 0x0000 e 0x0001 (biruta)
+  uint32_t leituras = 0;
+  uint32_t falhas = 0;
+  uint32_t ultima_leitura_ms = 0;
+  SaudeDispositivo saude;
+};
+
+// Chamado quando a leitura enfileirada por lerProximo() termina
+typedef void (*CallbackRegistro)(const Dispositivo& dispositivo, void* contexto);
+
+class RegistroDispositivos {
+public:
+  // Só a tarefa dona do barramento
+  void limpar(uint8_t barramento);
+  bool adicionar(const Dispositivo& dispositivo);   // false se a partição estiver cheia
+  // Os dispositivos em 'de' passam a 'para' (baud rate e código do 0x07D1)
+  void mudarBaud(uint8_t barramento, uint32_t de, uint32_t para);
+  Dispositivo& dispositivo(uint8_t barramento, uint16_t i) { return itens_[barramento][i]; }
+  const Dispositivo& dispositivo(uint8_t barramento, uint16_t i) const { return itens_[barramento][i]; }
+
+  // Qualquer tarefa. copiar(): false se 'i' está fora da partição ou se não
+  // obteve uma cópia consistente (a partição está sendo refeita)
+  uint16_t quantidade(uint8_t barramento) const { return quantidade_[barramento].load(std::memory_order_acquire); }
+  uint16_t total() const;
+  bool copiar(uint8_t barramento, uint16_t i, Dispositivo& destino) const;
+
+  // Enfileira a leitura do próximo dispositivo do barramento. false se não há
+  // o que ler, se a leitura anterior ainda não terminou ou se a fila está cheia.
+  bool lerProximo(uint8_t barramento, MestreModbusAsync& mestre,
+                  CallbackRegistro callback = nullptr, void* contexto = nullptr);
+  bool lendo(uint8_t barramento) const { return leituras_pendentes_[barramento].dispositivo != nullptr; }
+
+  uint32_t leituras(uint8_t barramento) const { return leituras_[barramento]; }
+
+  void configurarSaude(const ConfigSaude& config) { config_saude_ = config; }
+
+private:
+  static void aoLer(const RequisicaoModbus& requisicao, uint8_t resultado,
+                    const RespostaModbus& resposta, void* contexto);
+
+  // Leitura em andamento de cada barramento
+  struct LeituraPendente {
+    RegistroDispositivos* registro;
+    MestreModbusAsync* mestre;
+    Dispositivo* dispositivo;
+    CallbackRegistro callback;
+    void* contexto;
+  };
+
+  Dispositivo itens_[HAL_MAX_BARRAMENTOS][REGISTRO_MAX_POR_BARRAMENTO];
+  std::atomic<uint16_t> quantidade_[HAL_MAX_BARRAMENTOS] = {};
+  std::atomic<uint32_t> versao_[HAL_MAX_BARRAMENTOS] = {};   // Ímpar: partição mudando
+  uint16_t cursor_[HAL_MAX_BARRAMENTOS] = {};
+  uint32_t leituras_[HAL_MAX_BARRAMENTOS] = {};
+  LeituraPendente leituras_pendentes_[HAL_MAX_BARRAMENTOS] = {};
+  ConfigSaude config_saude_;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+// Relógio de amostragem por temporizador e medida de jitter por fonte
+//
+// O escalonador decide pelo relógio de amostragem, não pelo millis() do
+// momento em que a tarefa de aquisição roda. Um temporizador de hardware
+// (halTemporizadorIniciar) dispara a cada tick, avança o relógio e acorda a
+// aquisição: as liberações caem na grade do temporizador, e o instante
+// programado de cada uma é conhecido em µs mesmo com a tarefa atrasada por
+// um comando no console ou uma transação longa.
+//
+// JitterAmostragem compara, por fonte, o instante da captura (fim do quadro
+// Modbus ou leitura do sensor local) com o instante programado:
+//  - atraso: captura - programado (histograma logarítmico, p50/p95/p99);
+//  - intervalo entre capturas de períodos seguidos: média, desvio, mín, máx;
+//  - deriva: inclinação do atraso no tempo (regressão linear), em ppm.
+// As médias de 2/10 min e a rajada supõem leituras igualmente espaçadas: o
+// desvio do intervalo diz o quanto isso vale.
+
+#include <atomic>
+#include <stdint.h>
+#include "hal.h"
+#include "metricas_modbus.h"
+
+#define RELOGIO_TICK_US 1000   // Quantum do escalonador (ms)
+
+class RelogioAmostragem {
+public:
+  // Liga o temporizador; 'callback' deve chamar disparar(micros()). Sem
+  // temporizador o relógio segue o millis().
+  bool iniciar(uint32_t periodo_us, CallbackTemporizador callback, PassoTarefa acordar);
+  void disparar(uint32_t agora_us);   // Callback do temporizador (outra tarefa)
+
+  bool ativo() const { return ativo_.load(std::memory_order_acquire); }
+  uint32_t agoraMs() const;
+  // Instante programado de um ms do relógio, no domínio do micros()
+  uint32_t instanteUs(uint32_t ms) const { return inicio_us_ + (ms - inicio_ms_) * 1000u; }
+
+  // Atraso do callback em relação ao instante programado do tick. Escritos
+  // só pelo callback e lidos sem trava, apenas para exibição.
+  uint32_t disparos() const { return ticks_.load(std::memory_order_relaxed); }
+  uint32_t atrasoMaxUs() const { return atraso_max_us_; }
+  uint32_t atrasoMedioUs() const;
+  uint32_t periodoUs() const { return periodo_us_; }
+
+private:
+  std::atomic<bool> ativo_{false};
+  std::atomic<uint32_t> ticks_{0};
+  uint32_t periodo_us_ = RELOGIO_TICK_US;
+  uint32_t inicio_ms_ = 0;
+  uint32_t inicio_us_ = 0;
+  uint32_t atraso_max_us_ = 0;
+  uint64_t soma_atraso_us_ = 0;
+};
+
+class JitterAmostragem {
+public:
+  void registrar(uint32_t programado_us, uint32_t captura_us, uint32_t periodo_us);
+  void zerar();
+
+  const HistogramaLatencia& atraso() const { return atraso_; }
+  uint32_t intervalos() const { return intervalos_; }
+  float intervaloMedioUs() const;
+  float intervaloDesvioUs() const;
+  uint32_t intervaloMinUs() const { return intervalos_ ? intervalo_min_us_ : 0; }
+  uint32_t intervaloMaxUs() const { return intervalo_max_us_; }
+  uint32_t lacunas() const { return lacunas_; }   // Períodos sem captura entre duas capturas
+  float derivaPpm() const;                        // µs de atraso ganhos por segundo
+
+private:
+  void reiniciarSerie(uint32_t periodo_us);
+
+  HistogramaLatencia atraso_;
+  bool anterior_ = false;
+  uint32_t programado_anterior_us_ = 0;
+  uint32_t captura_anterior_us_ = 0;
+  uint32_t periodo_us_ = 0;
+
+  uint32_t intervalos_ = 0;
+  int64_t soma_desvio_us_ = 0;       // Intervalo - período
+  double soma_desvio_quad_ = 0;
+  uint32_t intervalo_min_us_ = UINT32_MAX;
+  uint32_t intervalo_max_us_ = 0;
+  uint32_t lacunas_ = 0;
+
+  // Regressão do atraso (µs) contra o tempo programado (s)
+  uint64_t decorrido_us_ = 0;
+  double n_ = 0, soma_t_ = 0, soma_a_ = 0, soma_tt_ = 0, soma_ta_ = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+// Saúde de cada dispositivo Modbus: retentativas limitadas, espera
+// exponencial e reconexão em segundo plano
+//
+//   OK --falha--> SUSPEITO --'falhas_fora' seguidas--> FORA
+//    ^               |                                   |
+//    +---resposta----+-------------sonda respondeu-------+
+//
+// Um transmissor desconectado não respondia e a leitura esperava o timeout
+// inteiro em todo período, tomando esse tempo dos sensores vivos do mesmo
+// barramento. Agora, depois de uma falha o dispositivo fica SUSPEITO e só é
+// lido de novo após uma espera que dobra a cada falha (espera_inicial_ms,
+// limitada a espera_max_ms). Com 'falhas_fora' falhas seguidas ele está
+// FORA: sai das leituras periódicas e passa a ser sondado a cada
+// 'intervalo_sonda_ms', no tempo livre do barramento. A primeira resposta o
+// devolve a OK, sem 'scan'.
+//
+// Uma exceção do escravo também conta como resposta: o dispositivo está na
+// linha. Cada transação sem resposta soma o tempo que segurou o barramento
+// (envio + espera até a desistência): é o tempo perdido com dispositivos
+// mortos, mostrado pelo comando 'saude'.
+//
+// Escrito só pela tarefa dona do barramento; as outras leem sem trava.
+
+#include <stdint.h>
+#include "modbus_codec.h"
+
+enum EstadoSaude : uint8_t {
+  SAUDE_OK,
+  SAUDE_SUSPEITO,   // Falhou há pouco: relido só depois da espera
+  SAUDE_FORA        // Fora das leituras; só a sonda de reconexão
+};
+
+struct ConfigSaude {
+  uint8_t falhas_fora = 4;               // Falhas seguidas até FORA
+  uint32_t espera_inicial_ms = 250;      // Após a primeira falha; dobra a cada falha
+  uint32_t espera_max_ms = 4000;
+  uint32_t intervalo_sonda_ms = 30000;   // Entre sondas de um dispositivo FORA
+};
+
+class SaudeDispositivo {
+public:
+  void reiniciar();   // OK, sem histórico (dispositivo recém-encontrado)
+
+  // Leitura periódica liberada? SUSPEITO só depois da espera; FORA nunca
+  bool podeLer(uint32_t agora_ms) const;
+  // FORA e com a sonda de reconexão vencida
+  bool sondaVencida(uint32_t agora_ms) const;
+  // Leitura pulada pela espera ou por estar FORA (período economizado)
+  void pular() { pulos_++; }
+
+  // Resultado de uma leitura ou sonda. 'duracao_us': tempo de barramento da
+  // transação. Retorna true se o estado mudou.
+  bool registrar(uint8_t resultado, uint32_t duracao_us, uint32_t agora_ms, const ConfigSaude& config);
+  bool mudou() const { return mudou_; }   // O último registrar() mudou o estado
+
+  EstadoSaude estado() const { return estado_; }
+  uint8_t falhasSeguidas() const { return falhas_seguidas_; }
+  uint32_t proximaMs() const { return proxima_ms_; }
+  uint32_t quedas() const { return quedas_; }           // Vezes em que ficou FORA
+  uint32_t reconexoes() const { return reconexoes_; }   // Voltas de FORA para OK
+  uint32_t sondas() const { return sondas_; }
+  uint32_t pulos() const { return pulos_; }
+  uint64_t tempoPerdidoUs() const { return tempo_perdido_us_; }
+  void zerarEstatisticas();
+
+private:
+  EstadoSaude estado_ = SAUDE_OK;
+  uint8_t falhas_seguidas_ = 0;
+  bool mudou_ = false;
+  uint32_t proxima_ms_ = 0;    // Próxima leitura (SUSPEITO) ou sonda (FORA)
+  uint32_t quedas_ = 0;
+  uint32_t reconexoes_ = 0;
+  uint32_t sondas_ = 0;
+  uint32_t pulos_ = 0;
+  uint64_t tempo_perdido_us_ = 0;
+};
+
+const char* nomeSaude(EstadoSaude estado);
@@ -0,0 +1,133 @@
+#pragma once
+
+// Estruturas de dados compartilhadas entre os módulos do firmware
+//
+// Registros de tamanho fixo, sem String: copiar uma amostra nunca aloca no
+// heap (o firmware roda por meses). Textos vêm de tabelas constexpr.
+
+#include <stdint.h>
+#include <type_traits>
+
+// Direção cardinal da biruta (valor bruto 0-7 do registrador 0x0000)
+enum DirecaoVento : uint8_t {
+  DIRECAO_NORTE,
+  DIRECAO_NORDESTE,
+  DIRECAO_LESTE,
+  DIRECAO_SUDESTE,
+  DIRECAO_SUL,
+  DIRECAO_SUDOESTE,
+  DIRECAO_OESTE,
+  DIRECAO_NOROESTE,
+  DIRECAO_INVALIDA
+};
+
+constexpr const char* NOMES_DIRECAO[] = {
+  "Norte", "Nordeste", "Leste", "Sudeste", "Sul", "Sudoeste", "Oeste", "Noroeste", "Inválido"
+};
+
+constexpr DirecaoVento direcaoDeBruto(uint16_t bruto) {
+  return bruto <= DIRECAO_NOROESTE ? (DirecaoVento)bruto : DIRECAO_INVALIDA;
+}
+
+constexpr const char* nomeDirecao(DirecaoVento direcao) {
+  return NOMES_DIRECAO[direcao <= DIRECAO_INVALIDA ? direcao : DIRECAO_INVALIDA];
+}
+
+// Tipo de dispositivo na varredura: biruta se lê 0x0001, senão anemômetro pelo
+// valor principal (0x0000) (classificarDispositivo, perfis_dispositivo.h)
+enum TipoDispositivo : uint8_t {
+  TIPO_DESCONHECIDO,
+  TIPO_BIRUTA,              // direção 0-7
+  TIPO_ANEMOMETRO_ALTA,     // valor > 700
+  TIPO_ANEMOMETRO_BAIXA
+};
+
+constexpr const char* NOMES_TIPO[] = {
+  "DESCONHECIDO", "BIRUTA (direção 0-7)", "ANEMÔMETRO (velocidade alta)", "ANEMÔMETRO (velocidade baixa)"
+};
+
+constexpr const char* nomeTipo(TipoDispositivo tipo) {
+  return NOMES_TIPO[tipo <= TIPO_ANEMOMETRO_BAIXA ? tipo : TIPO_DESCONHECIDO];
+}
+
+constexpr bool ehAnemometro(TipoDispositivo tipo) {
+  return tipo == TIPO_ANEMOMETRO_ALTA || tipo == TIPO_ANEMOMETRO_BAIXA;
+}
+
+// Código de baud rate do registrador 0x07D1 (manuais dos sensores)
+#define NUM_CODIGOS_BAUD 8
+constexpr const char* NOMES_CODIGO_BAUD[NUM_CODIGOS_BAUD] = {
+  "2400", "4800", "9600", "19200", "38400", "57600", "115200", "1200"
+};
+
+constexpr const char* nomeCodigoBaud(uint16_t codigo) {
+  return codigo < NUM_CODIGOS_BAUD ? NOMES_CODIGO_BAUD[codigo] : "Inválido";
+}
+
+constexpr uint32_t BAUD_POR_CODIGO[NUM_CODIGOS_BAUD] = {2400, 4800, 9600, 19200, 38400, 57600, 115200, 1200};
+
+// Código do baud rate para o 0x07D1 (NUM_CODIGOS_BAUD se não há)
+constexpr uint16_t codigoDoBaud(uint32_t baud) {
+  for (uint16_t c = 0; c < NUM_CODIGOS_BAUD; c++) {
+    if (BAUD_POR_CODIGO[c] == baud) return c;
+  }
+  return NUM_CODIGOS_BAUD;
+}
+
+// Estrutura para dados dos sensores
+struct SensorData {
+  uint32_t timestamp = 0;         // ms da captura (millis)
+  uint32_t timestamp_us = 0;      // Captura: fim do quadro Modbus ou leitura local (micros)
+  float wind_speed = 0.0f;
+  float temperature = 0.0f;
+  float uv_index = 0.0f;
+  float uv_noise = 0.0f;          // Desvio padrão do índice UV no período
+  uint16_t wind_direction_raw = 0;
+  uint16_t wind_direction_degrees = 0;
+  DirecaoVento wind_direction_cardinal = DIRECAO_INVALIDA;
+};
+
+// Estrutura para informações de dispositivo detectado
+struct DeviceInfo {
+  uint32_t baud_rate = 0;
+  uint16_t config_id = 0;
+  uint16_t config_baud = 0;
+  uint8_t id = 0;
+  uint8_t barramento = 0;         // Barramento RS-485 (HAL)
+  TipoDispositivo tipo = TIPO_DESCONHECIDO;
+  bool ativo = false;
+};
+
+// Estatísticas de vento das janelas deslizantes (EstatisticasVento)
+struct ResumoVento {
+  uint16_t media_2min_dms = 0;       // Velocidade × 10 (m/s)
+  uint16_t media_10min_dms = 0;
+  uint16_t rajada_dms = 0;           // Maior média de 3 s em 10 min
+  uint16_t calmaria_dms = 0;         // Menor média de 3 s em 10 min
+  uint16_t desvio_vento_dms = 0;     // Desvio padrão da velocidade em 10 min
+  uint16_t direcao_2min_graus = 0;   // Média vetorial
+  uint16_t direcao_10min_graus = 0;
+  uint16_t desvio_direcao_dg = 0;    // Desvio padrão da direção × 10 (graus)
+  uint16_t cobertura_s = 0;          // Segundos de histórico na janela de 10 min
+  bool vento_valido = false;
+  bool direcao_valida = false;
+};
+
+// Amostra publicada pela aquisição a cada leitura concluída, passada entre as
+// tarefas do pipeline. 'dados' traz o último valor de todos os campos.
+struct Amostra {
+  SensorData dados;
+  uint8_t fontes;                 // Fontes atualizadas nesta amostra (bit = índice no escalonador)
+  uint8_t resultado_anemometro;   // MB_SUCESSO ou código de erro da leitura
+  uint8_t resultado_biruta;
+  bool anemometro_conectado;
+  bool biruta_conectada;
+  uint32_t baud_rate;
+  uint32_t sequencia;             // Número sequencial da amostra (1, 2, ...)
+  ResumoVento vento;              // Preenchido pelo processamento
+};
+
+static_assert(std::is_trivially_copyable<SensorData>::value, "SensorData deve ser copiável sem alocação");
+static_assert(std::is_trivially_copyable<DeviceInfo>::value, "DeviceInfo deve ser copiável sem alocação");
+static_assert(std::is_trivially_copyable<ResumoVento>::value, "ResumoVento deve ser copiável sem alocação");
+static_assert(std::is_trivially_copyable<Amostra>::value, "Amostra deve ser copiável sem alocação");
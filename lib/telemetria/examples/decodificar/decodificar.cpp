@@ -0,0 +1,28 @@
+// Decodificador de telemetria no host: lê o fluxo binário da Serial (stdin)
+// e escreve uma linha CSV por amostra; estatísticas no stderr ao final.
+//
+// Compilação (na raiz do projeto):
+//   g++ -std=c++17 -O2 -Ilib/telemetria lib/telemetria/telemetria.cpp
+//       lib/telemetria/examples/decodificar/decodificar.cpp -o decodificar
+// stty -F /dev/ttyUSB0 115200 raw && ./decodificar < /dev/ttyUSB0
+#include <cstdio>
+#include "telemetria.h"
+
+int main() {
+  DecodificadorTelemetria decodificador;
+  RegistroTelemetria r;
+
+  printf("sequencia,timestamp_ms,vento_ms,direcao_graus,direcao_bruta,temperatura_c,uv,flags\n");
+  int c;
+  while ((c = getchar()) != EOF) {
+    if (!decodificador.alimentar((uint8_t)c, r)) continue;
+    printf("%u,%u,%.1f,%u,%u,%.2f,%.1f,0x%02X\n", (unsigned)r.sequencia, (unsigned)r.timestamp_ms,
+           r.vento_dms / 10.0, r.direcao_graus, r.direcao_bruta, r.temperatura_qc / 4.0,
+           r.uv_dec / 10.0, r.flags);
+    fflush(stdout);
+  }
+
+  fprintf(stderr, "%u quadros válidos, %u inválidos, %u perdidos\n", (unsigned)decodificador.validos(),
+          (unsigned)decodificador.invalidos(), (unsigned)decodificador.perdidos());
+  return 0;
+}
@@ -0,0 +1,278 @@
+#include "serie_temporal.h"
+#include <string.h>
+
+size_t varintEscrever(uint32_t valor, uint8_t* saida, size_t max) {
+  size_t n = 0;
+  do {
+    if (n >= max) return 0;
+    uint8_t byte = valor & 0x7F;
+    valor >>= 7;
+    saida[n++] = valor ? (uint8_t)(byte | 0x80) : byte;
+  } while (valor);
+  return n;
+}
+
+size_t varintLer(const uint8_t* entrada, size_t len, uint32_t& valor) {
+  valor = 0;
+  for (size_t n = 0; n < len && n < 5; n++) {
+    valor |= (uint32_t)(entrada[n] & 0x7F) << (7 * n);
+    if (!(entrada[n] & 0x80)) return n + 1;
+  }
+  return 0;
+}
+
+// Campos na ordem dos bits da máscara
+enum CampoSerie : uint8_t {
+  CAMPO_TIMESTAMP, CAMPO_SEQUENCIA, CAMPO_VENTO, CAMPO_DIRECAO,
+  CAMPO_BRUTA, CAMPO_TEMPERATURA, CAMPO_UV, CAMPO_FLAGS, NUM_CAMPOS
+};
+
+// --- Codificador ---
+
+void CodificadorSerie::iniciar(uint8_t* bloco, size_t capacidade) {
+  bloco_ = bloco;
+  capacidade_ = capacidade;
+  tamanho_ = SERIE_TAM_CABECALHO;
+  amostras_ = 0;
+  intervalo_ms_ = 0;
+  intervalo_seq_ = 0;
+}
+
+bool CodificadorSerie::adicionar(const RegistroTelemetria& r) {
+  if (capacidade_ < SERIE_TAM_MINIMO || amostras_ >= SERIE_MAX_AMOSTRAS) return false;
+  if (!amostras_) {
+    telemetriaEscreverCarga(r, &bloco_[4]);
+    anterior_ = r;
+    amostras_ = 1;
+    return true;
+  }
+
+  const RegistroTelemetria& a = anterior_;
+  uint32_t intervalo_ms = r.timestamp_ms - a.timestamp_ms;
+  uint32_t intervalo_seq = r.sequencia - a.sequencia;
+  int32_t residuos[NUM_CAMPOS] = {
+    (int32_t)(intervalo_ms - intervalo_ms_),
+    (int32_t)(intervalo_seq - intervalo_seq_),
+    (int32_t)r.vento_dms - a.vento_dms,
+    (int32_t)r.direcao_graus - a.direcao_graus,
+    (int32_t)r.direcao_bruta - a.direcao_bruta,
+    (int32_t)r.temperatura_qc - a.temperatura_qc,
+    (int32_t)r.uv_dec - a.uv_dec,
+    (int32_t)r.flags - a.flags,
+  };
+
+  uint8_t amostra[SERIE_MAX_AMOSTRA];
+  uint8_t mascara = 0;
+  size_t n = 1;
+  for (uint8_t c = 0; c < NUM_CAMPOS; c++) {
+    if (!residuos[c]) continue;
+    mascara |= (uint8_t)(1 << c);
+    n += varintEscrever(zigzagCodificar(residuos[c]), &amostra[n], sizeof(amostra) - n);
+  }
+  amostra[0] = mascara;
+  if (tamanho_ + n + 2 > capacidade_) return false;
+
+  memcpy(&bloco_[tamanho_], amostra, n);
+  tamanho_ += n;
+  amostras_++;
+  anterior_ = r;
+  intervalo_ms_ = intervalo_ms;
+  intervalo_seq_ = intervalo_seq;
+  return true;
+}
+
+size_t CodificadorSerie::finalizar() {
+  if (!amostras_) return 0;
+  bloco_[0] = SERIE_VERSAO;
+  bloco_[1] = amostras_;
+  size_t total = tamanho_ + 2;
+  bloco_[2] = (uint8_t)total;
+  bloco_[3] = (uint8_t)(total >> 8);
+  uint16_t crc = telemetriaCrc16(bloco_, tamanho_);
+  bloco_[tamanho_] = (uint8_t)crc;
+  bloco_[tamanho_ + 1] = (uint8_t)(crc >> 8);
+  return total;
+}
+
+// --- Decodificador ---
+
+bool serieInicioBloco(const uint8_t* bloco, size_t len, size_t& tamanho, RegistroTelemetria& primeira) {
+  if (len < SERIE_TAM_MINIMO || bloco[0] != SERIE_VERSAO || !bloco[1]) return false;
+  tamanho = (size_t)(bloco[2] | (bloco[3] << 8));
+  if (tamanho < SERIE_TAM_MINIMO || tamanho > len) return false;
+  return telemetriaLerCarga(&bloco[4], primeira);
+}
+
+bool DecodificadorSerie::abrir(const uint8_t* bloco, size_t len) {
+  amostras_ = 0;
+  if (!serieInicioBloco(bloco, len, tamanho_, anterior_)) return false;
+  uint16_t crc = (uint16_t)(bloco[tamanho_ - 2] | (bloco[tamanho_ - 1] << 8));
+  if (crc != telemetriaCrc16(bloco, tamanho_ - 2)) return false;
+  bloco_ = bloco;
+  tamanho_ -= 2;
+  pos_ = SERIE_TAM_CABECALHO;
+  amostras_ = bloco[1];
+  entregues_ = 0;
+  intervalo_ms_ = 0;
+  intervalo_seq_ = 0;
+  return true;
+}
+
+bool DecodificadorSerie::proxima(RegistroTelemetria& r) {
+  if (entregues_ >= amostras_) return false;
+  if (!entregues_) {
+    entregues_ = 1;
+    r = anterior_;
+    return true;
+  }
+  if (pos_ >= tamanho_) return false;
+
+  uint8_t mascara = bloco_[pos_++];
+  int32_t residuos[NUM_CAMPOS] = {};
+  for (uint8_t c = 0; c < NUM_CAMPOS; c++) {
+    if (!(mascara & (1 << c))) continue;
+    uint32_t valor;
+    size_t n = varintLer(&bloco_[pos_], tamanho_ - pos_, valor);
+    if (!n) return false;
+    pos_ += n;
+    residuos[c] = zigzagDecodificar(valor);
+  }
+
+  RegistroTelemetria& a = anterior_;
+  intervalo_ms_ += (uint32_t)residuos[CAMPO_TIMESTAMP];
+  intervalo_seq_ += (uint32_t)residuos[CAMPO_SEQUENCIA];
+  a.timestamp_ms += intervalo_ms_;
+  a.sequencia += intervalo_seq_;
+  a.vento_dms = (uint16_t)(a.vento_dms + residuos[CAMPO_VENTO]);
+  a.direcao_graus = (uint16_t)(a.direcao_graus + residuos[CAMPO_DIRECAO]);
+  a.direcao_bruta = (uint8_t)(a.direcao_bruta + residuos[CAMPO_BRUTA]);
+  a.temperatura_qc = (int16_t)(a.temperatura_qc + residuos[CAMPO_TEMPERATURA]);
+  a.uv_dec = (uint16_t)(a.uv_dec + residuos[CAMPO_UV]);
+  a.flags = (uint8_t)(a.flags + residuos[CAMPO_FLAGS]);
+  entregues_++;
+  r = a;
+  return true;
+}
+
+// --- Gorilla ---
+
+// Só para XOR diferente de zero
+static uint8_t zerosEsquerda(uint32_t v) { return (uint8_t)__builtin_clz(v); }
+static uint8_t zerosDireita(uint32_t v) { return (uint8_t)__builtin_ctz(v); }
+
+static uint32_t bitsDoFloat(float valor) {
+  uint32_t bits;
+  memcpy(&bits, &valor, sizeof(bits));
+  return bits;
+}
+
+void CodificadorGorilla::iniciar(uint8_t* saida, size_t capacidade) {
+  saida_ = saida;
+  capacidade_ = capacidade;
+  bits_ = 0;
+  valores_ = 0;
+  zeros_esquerda_ = 0xFF;
+}
+
+// MSB primeiro; quem chama já conferiu o espaço
+void CodificadorGorilla::escreverBits(uint32_t valor, uint8_t n) {
+  while (n) {
+    uint8_t livres = (uint8_t)(8 - bits_ % 8);
+    uint8_t k = n < livres ? n : livres;
+    uint8_t parte = (uint8_t)((valor >> (n - k)) & ((1u << k) - 1));
+    if (bits_ % 8 == 0) saida_[bits_ / 8] = 0;
+    saida_[bits_ / 8] |= (uint8_t)(parte << (livres - k));
+    bits_ += k;
+    n = (uint8_t)(n - k);
+  }
+}
+
+bool CodificadorGorilla::adicionar(float valor) {
+  uint32_t atual = bitsDoFloat(valor);
+  if (!valores_) {
+    if (bits_ + 32 > capacidade_ * 8) return false;
+    escreverBits(atual, 32);
+    anterior_ = atual;
+    valores_++;
+    return true;
+  }
+
+  uint32_t x = atual ^ anterior_;
+  if (!x) {
+    if (bits_ + 1 > capacidade_ * 8) return false;
+    escreverBits(0, 1);
+  } else {
+    uint8_t esquerda = zerosEsquerda(x);
+    uint8_t direita = zerosDireita(x);
+    if (zeros_esquerda_ != 0xFF && esquerda >= zeros_esquerda_ && direita >= zeros_direita_) {
+      // Cabe na janela do anterior: só os bits significativos
+      uint8_t significativos = (uint8_t)(32 - zeros_esquerda_ - zeros_direita_);
+      if (bits_ + 2 + significativos > capacidade_ * 8) return false;
+      escreverBits(0b10, 2);
+      escreverBits(x >> zeros_direita_, significativos);
+    } else {
+      uint8_t significativos = (uint8_t)(32 - esquerda - direita);
+      if (bits_ + 12 + significativos > capacidade_ * 8) return false;
+      escreverBits(0b11, 2);
+      escreverBits(esquerda, 5);
+      escreverBits((uint32_t)(significativos - 1), 5);
+      escreverBits(x >> direita, significativos);
+      zeros_esquerda_ = esquerda;
+      zeros_direita_ = direita;
+    }
+  }
+  anterior_ = atual;
+  valores_++;
+  return true;
+}
+
+void DecodificadorGorilla::abrir(const uint8_t* entrada, size_t len, uint32_t valores) {
+  entrada_ = entrada;
+  bits_total_ = len * 8;
+  bits_ = 0;
+  restantes_ = valores;
+  primeiro_ = true;
+}
+
+bool DecodificadorGorilla::lerBits(uint8_t n, uint32_t& valor) {
+  if (bits_ + n > bits_total_) return false;
+  valor = 0;
+  while (n) {
+    uint8_t disponiveis = (uint8_t)(8 - bits_ % 8);
+    uint8_t k = n < disponiveis ? n : disponiveis;
+    uint8_t parte = (uint8_t)((entrada_[bits_ / 8] >> (disponiveis - k)) & ((1u << k) - 1));
+    valor = (valor << k) | parte;
+    bits_ += k;
+    n = (uint8_t)(n - k);
+  }
+  return true;
+}
+
+bool DecodificadorGorilla::proximo(float& valor) {
+  if (!restantes_) return false;
+  uint32_t bits;
+  if (primeiro_) {
+    if (!lerBits(32, bits)) return false;
+    primeiro_ = false;
+  } else {
+    uint32_t controle;
+    if (!lerBits(1, controle)) return false;
+    bits = anterior_;
+    if (controle) {
+      if (!lerBits(1, controle)) return false;
+      if (controle) {
+        uint32_t esquerda, significativos;
+        if (!lerBits(5, esquerda) || !lerBits(5, significativos)) return false;
+        zeros_esquerda_ = (uint8_t)esquerda;
+        zeros_direita_ = (uint8_t)(32 - esquerda - (significativos + 1));
+      }
+      uint32_t x;
+      if (!lerBits((uint8_t)(32 - zeros_esquerda_ - zeros_direita_), x)) return false;
+      bits ^= x << zeros_direita_;
+    }
+  }
+  anterior_ = bits;
+  restantes_--;
+  memcpy(&valor, &bits, sizeof(valor));
+  return true;
+}
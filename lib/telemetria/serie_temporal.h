@@ -0,0 +1,137 @@
+#pragma once
+
+// Compressão de séries de amostras para o diário e o enlace
+//
+// Amostras seguidas quase não mudam: o vento anda em passos de 0,1 m/s, a
+// direção tem 8 posições e a temperatura varia devagar. Cada amostra vira o
+// resíduo em relação à anterior:
+//
+//   campo            previsão                      resíduo
+//   timestamp_ms     último + último intervalo     delta-of-delta
+//   sequencia        último + último intervalo     delta-of-delta
+//   demais campos    último valor                  delta
+//
+// Os resíduos vão em zig-zag varint (|r| < 64 cabe em 1 byte). Uma máscara
+// de 1 byte por amostra diz quais campos têm resíduo diferente de zero, e só
+// esses são escritos. Em regime, uma amostra custa 1-3 bytes contra 19 da
+// carga.
+//
+// Bloco (independente dos outros: acesso aleatório sem decodificar o resto):
+//
+//   0  versao u8 (SERIE_VERSAO)     1  amostras u8     2  tamanho u16 (bloco inteiro)
+//   4  carga[19] da primeira amostra (telemetriaEscreverCarga)
+//   23 demais amostras: máscara u8 + varints dos campos marcados
+//   fim: CRC16 do bloco (telemetriaCrc16)
+//
+// A primeira amostra de cada bloco vai inteira: um índice de blocos por tempo
+// ou sequência sai de serieInicioBloco() sem decodificar nada.
+//
+// Gorilla (XOR de floats, fluxo de bits) para séries em float, como
+// SensorData. Valores repetidos custam 1 bit; os demais gravam só os bits
+// significativos do XOR com o anterior.
+//
+// Sem dependências do Arduino: compila no firmware e no host.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetria.h"
+
+#define SERIE_VERSAO 1
+#define SERIE_TAM_CABECALHO (4 + TELEMETRIA_TAM_CARGA)
+#define SERIE_TAM_MINIMO (SERIE_TAM_CABECALHO + 2)           // Bloco com uma amostra
+#define SERIE_MAX_AMOSTRA (1 + 2 * 5 + 6 * 3)                // Máscara + pior caso dos varints
+#define SERIE_MAX_AMOSTRAS 255
+
+// Zig-zag: inteiros com sinal pequenos viram sem sinal pequenos (0, -1, 1, -2 ...)
+inline uint32_t zigzagCodificar(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t zigzagDecodificar(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Varint LEB128: 7 bits por byte. Retorna os bytes usados (0 se não coube)
+size_t varintEscrever(uint32_t valor, uint8_t* saida, size_t max);
+size_t varintLer(const uint8_t* entrada, size_t len, uint32_t& valor);
+
+class CodificadorSerie {
+public:
+  // O bloco é montado direto em 'bloco' (até 'capacidade' bytes)
+  void iniciar(uint8_t* bloco, size_t capacidade);
+
+  // false: bloco cheio (sem espaço ou SERIE_MAX_AMOSTRAS). Feche com
+  // finalizar() e adicione a amostra no próximo bloco.
+  bool adicionar(const RegistroTelemetria& registro);
+
+  // Cabeçalho e CRC; retorna o tamanho do bloco (0 se vazio)
+  size_t finalizar();
+
+  uint8_t amostras() const { return amostras_; }
+  size_t tamanho() const { return tamanho_ + 2; }   // Com o CRC
+
+private:
+  uint8_t* bloco_ = nullptr;
+  size_t capacidade_ = 0;
+  size_t tamanho_ = 0;
+  uint8_t amostras_ = 0;
+  RegistroTelemetria anterior_;
+  uint32_t intervalo_ms_ = 0;
+  uint32_t intervalo_seq_ = 0;
+};
+
+class DecodificadorSerie {
+public:
+  // false: tamanho, versão ou CRC inválidos
+  bool abrir(const uint8_t* bloco, size_t len);
+
+  // Amostras em ordem; false no fim do bloco ou com o bloco corrompido
+  bool proxima(RegistroTelemetria& registro);
+
+  uint8_t amostras() const { return amostras_; }
+
+private:
+  const uint8_t* bloco_ = nullptr;
+  size_t tamanho_ = 0;
+  size_t pos_ = 0;
+  uint8_t amostras_ = 0;
+  uint8_t entregues_ = 0;
+  RegistroTelemetria anterior_;
+  uint32_t intervalo_ms_ = 0;
+  uint32_t intervalo_seq_ = 0;
+};
+
+// Tamanho e primeira amostra do bloco, sem CRC nem decodificação (índice)
+bool serieInicioBloco(const uint8_t* bloco, size_t len, size_t& tamanho, RegistroTelemetria& primeira);
+
+class CodificadorGorilla {
+public:
+  void iniciar(uint8_t* saida, size_t capacidade);
+  bool adicionar(float valor);               // false: sem espaço
+  size_t bytes() const { return (bits_ + 7) / 8; }
+  uint32_t valores() const { return valores_; }
+
+private:
+  void escreverBits(uint32_t valor, uint8_t n);
+
+  uint8_t* saida_ = nullptr;
+  size_t capacidade_ = 0;
+  size_t bits_ = 0;
+  uint32_t valores_ = 0;
+  uint32_t anterior_ = 0;
+  uint8_t zeros_esquerda_ = 0xFF;            // Janela do XOR anterior (0xFF = nenhuma)
+  uint8_t zeros_direita_ = 0;
+};
+
+class DecodificadorGorilla {
+public:
+  void abrir(const uint8_t* entrada, size_t len, uint32_t valores);
+  bool proximo(float& valor);
+
+private:
+  bool lerBits(uint8_t n, uint32_t& valor);
+
+  const uint8_t* entrada_ = nullptr;
+  size_t bits_total_ = 0;
+  size_t bits_ = 0;
+  uint32_t restantes_ = 0;
+  bool primeiro_ = true;
+  uint32_t anterior_ = 0;
+  uint8_t zeros_esquerda_ = 0;
+  uint8_t zeros_direita_ = 0;
+};
@@ -0,0 +1,143 @@
+#include "telemetria.h"
+
+uint16_t telemetriaCrc16(const uint8_t* dados, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)dados[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t cobsCodificar(const uint8_t* entrada, size_t len, uint8_t* saida) {
+  size_t escrita = 1;
+  size_t pos_codigo = 0;
+  uint8_t codigo = 1;
+
+  for (size_t i = 0; i < len; i++) {
+    if (entrada[i] != 0) {
+      saida[escrita++] = entrada[i];
+      codigo++;
+    }
+    if (entrada[i] == 0 || codigo == 0xFF) {
+      saida[pos_codigo] = codigo;
+      pos_codigo = escrita++;
+      codigo = 1;
+    }
+  }
+  saida[pos_codigo] = codigo;
+  return escrita;
+}
+
+size_t cobsDecodificar(const uint8_t* entrada, size_t len, uint8_t* saida, size_t max_saida) {
+  size_t lidos = 0;
+  size_t escrita = 0;
+
+  while (lidos < len) {
+    uint8_t codigo = entrada[lidos++];
+    if (codigo == 0 || lidos + codigo - 1 > len) return 0;
+    for (uint8_t k = 1; k < codigo; k++) {
+      if (entrada[lidos] == 0 || escrita >= max_saida) return 0;
+      saida[escrita++] = entrada[lidos++];
+    }
+    // Zero implícito entre blocos, exceto após bloco cheio ou no fim
+    if (codigo != 0xFF && lidos < len) {
+      if (escrita >= max_saida) return 0;
+      saida[escrita++] = 0;
+    }
+  }
+  return escrita;
+}
+
+static void escreverU16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void escreverU32(uint8_t* p, uint32_t v) {
+  escreverU16(p, (uint16_t)v);
+  escreverU16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t lerU16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t lerU32(const uint8_t* p) {
+  return lerU16(p) | ((uint32_t)lerU16(p + 2) << 16);
+}
+
+void telemetriaEscreverCarga(const RegistroTelemetria& registro, uint8_t* carga) {
+  carga[0] = TELEMETRIA_VERSAO;
+  carga[1] = registro.flags;
+  escreverU32(&carga[2], registro.sequencia);
+  escreverU32(&carga[6], registro.timestamp_ms);
+  escreverU16(&carga[10], registro.vento_dms);
+  escreverU16(&carga[12], registro.direcao_graus);
+  carga[14] = registro.direcao_bruta;
+  escreverU16(&carga[15], (uint16_t)registro.temperatura_qc);
+  escreverU16(&carga[17], registro.uv_dec);
+}
+
+bool telemetriaLerCarga(const uint8_t* carga, RegistroTelemetria& registro) {
+  if (carga[0] != TELEMETRIA_VERSAO) return false;
+  registro.flags = carga[1];
+  registro.sequencia = lerU32(&carga[2]);
+  registro.timestamp_ms = lerU32(&carga[6]);
+  registro.vento_dms = lerU16(&carga[10]);
+  registro.direcao_graus = lerU16(&carga[12]);
+  registro.direcao_bruta = carga[14];
+  registro.temperatura_qc = (int16_t)lerU16(&carga[15]);
+  registro.uv_dec = lerU16(&carga[17]);
+  return true;
+}
+
+size_t telemetriaMontarQuadro(const RegistroTelemetria& registro, uint8_t* quadro) {
+  uint8_t dados[TELEMETRIA_TAM_REGISTRO];
+  telemetriaEscreverCarga(registro, dados);
+  escreverU16(&dados[TELEMETRIA_TAM_CARGA], telemetriaCrc16(dados, TELEMETRIA_TAM_CARGA));
+
+  quadro[0] = 0x00;
+  size_t n = cobsCodificar(dados, sizeof(dados), &quadro[1]);
+  quadro[1 + n] = 0x00;
+  return n + 2;
+}
+
+bool telemetriaLerRegistro(const uint8_t* dados, size_t len, RegistroTelemetria& registro) {
+  if (len != TELEMETRIA_TAM_REGISTRO) return false;
+  if (lerU16(&dados[TELEMETRIA_TAM_CARGA]) != telemetriaCrc16(dados, TELEMETRIA_TAM_CARGA)) return false;
+  return telemetriaLerCarga(dados, registro);
+}
+
+bool DecodificadorTelemetria::alimentar(uint8_t byte, RegistroTelemetria& registro) {
+  if (byte != 0x00) {
+    if (recebidos_ < sizeof(buffer_)) buffer_[recebidos_++] = byte;
+    else transbordou_ = true;
+    return false;
+  }
+
+  // Delimitador: fecha o quadro acumulado (vazio entre dois 0x00 é normal)
+  size_t recebidos = recebidos_;
+  bool transbordou = transbordou_;
+  recebidos_ = 0;
+  transbordou_ = false;
+  if (recebidos == 0) return false;
+
+  uint8_t dados[TELEMETRIA_TAM_REGISTRO];
+  size_t len = transbordou ? 0 : cobsDecodificar(buffer_, recebidos, dados, sizeof(dados));
+  if (!len || !telemetriaLerRegistro(dados, len, registro)) {
+    invalidos_++;
+    return false;
+  }
+
+  // Sequência menor ou igual: firmware reiniciou, recomeça a contagem
+  if (sincronizado_ && registro.sequencia > ultima_sequencia_) {
+    perdidos_ += registro.sequencia - ultima_sequencia_ - 1;
+  }
+  sincronizado_ = true;
+  ultima_sequencia_ = registro.sequencia;
+  validos_++;
+  return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+// Telemetria binária: registros de amostra de tamanho fixo, CRC e COBS
+//
+// Quadro na linha (24 bytes, contra ~400 do relatório em texto):
+//
+//   0x00 | COBS( carga[19] + CRC16[2] ) | 0x00
+//
+// COBS elimina os bytes 0x00 da carga, então 0x00 só aparece como
+// delimitador: o decodificador se ressincroniza no próximo 0x00 depois de
+// lixo (ex.: texto de um comando no meio do fluxo). O delimitador inicial
+// isola o quadro de qualquer texto escrito antes dele.
+//
+// Carga (little-endian):
+//   0  versao (TELEMETRIA_VERSAO)     1  flags (FLAG_TLM_*)
+//   2  sequencia u32                  6  timestamp_ms u32
+//   10 vento_dms u16 (m/s × 10)       12 direcao_graus u16
+//   14 direcao_bruta u8               15 temperatura_qc i16 (°C × 4)
+//   17 uv_dec u16 (índice × 10)
+//
+// A sequência é o número da amostra no firmware: saltos indicam quadros
+// perdidos na linha ou amostras descartadas no firmware.
+//
+// Sem dependências do Arduino: compila no firmware e no host (ver
+// examples/decodificar).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRIA_VERSAO 1
+#define TELEMETRIA_TAM_CARGA 19
+#define TELEMETRIA_TAM_REGISTRO (TELEMETRIA_TAM_CARGA + 2)      // carga + CRC
+#define TELEMETRIA_TAM_QUADRO (TELEMETRIA_TAM_REGISTRO + 3)     // + COBS + 2 delimitadores
+
+#define FLAG_TLM_ANEMOMETRO  0x01   // Anemômetro conectado
+#define FLAG_TLM_VENTO_OK    0x02   // Leitura de velocidade válida
+#define FLAG_TLM_BIRUTA      0x04   // Biruta conectada
+#define FLAG_TLM_DIRECAO_OK  0x08   // Leitura de direção válida
+#define FLAG_TLM_TEMP_OK     0x10   // MAX6675 respondeu
+
+struct RegistroTelemetria {
+  uint32_t sequencia = 0;
+  uint32_t timestamp_ms = 0;
+  uint16_t vento_dms = 0;
+  uint16_t direcao_graus = 0;
+  uint8_t direcao_bruta = 0;
+  int16_t temperatura_qc = 0;
+  uint16_t uv_dec = 0;
+  uint8_t flags = 0;
+};
+
+// CRC-16/CCITT-FALSE (poli 0x1021, início 0xFFFF)
+uint16_t telemetriaCrc16(const uint8_t* dados, size_t len);
+
+// COBS: 'saida' precisa de len + len/254 + 1 bytes. Decodificação retorna 0
+// se a entrada não for COBS válido ou não couber em 'max_saida'.
+size_t cobsCodificar(const uint8_t* entrada, size_t len, uint8_t* saida);
+size_t cobsDecodificar(const uint8_t* entrada, size_t len, uint8_t* saida, size_t max_saida);
+
+// Só a carga (TELEMETRIA_TAM_CARGA bytes, sem CRC): para quem guarda os
+// registros com o seu próprio enquadramento (ex.: diário na flash)
+void telemetriaEscreverCarga(const RegistroTelemetria& registro, uint8_t* carga);
+bool telemetriaLerCarga(const uint8_t* carga, RegistroTelemetria& registro);   // false se outra versão
+
+// Monta o quadro completo (TELEMETRIA_TAM_QUADRO bytes, com delimitadores)
+size_t telemetriaMontarQuadro(const RegistroTelemetria& registro, uint8_t* quadro);
+
+// Valida um registro já sem COBS (tamanho, versão, CRC) e extrai os campos
+bool telemetriaLerRegistro(const uint8_t* dados, size_t len, RegistroTelemetria& registro);
+
+// Decodificador de fluxo para o host: recebe byte a byte, entrega registros
+// válidos e conta quadros inválidos e saltos de sequência
+class DecodificadorTelemetria {
+public:
+  // true quando 'registro' recebeu um quadro válido
+  bool alimentar(uint8_t byte, RegistroTelemetria& registro);
+
+  uint32_t validos() const { return validos_; }
+  uint32_t invalidos() const { return invalidos_; }   // CRC, versão ou COBS inválidos
+  uint32_t perdidos() const { return perdidos_; }     // Sequências que não chegaram
+
+private:
+  uint8_t buffer_[TELEMETRIA_TAM_REGISTRO + 1];
+  size_t recebidos_ = 0;
+  bool transbordou_ = false;
+  bool sincronizado_ = false;    // Já viu um registro válido (base da sequência)
+  uint32_t ultima_sequencia_ = 0;
+  uint32_t validos_ = 0;
+  uint32_t invalidos_ = 0;
+  uint32_t perdidos_ = 0;
+};
@@ -0,0 +1,69 @@
+#include "cache_descoberta.h"
+#include "modbus_rtu.h"
+#include <string.h>
+
+bool CacheDescoberta::carregar() {
+  valido_ = false;
+  size_t lidos = halNvsLer(CACHE_CHAVE_NVS, &blob_, sizeof(blob_));
+  if (lidos < sizeof(CabecalhoCache)) return false;
+
+  const CabecalhoCache& c = blob_.cabecalho;
+  if (c.versao != CACHE_VERSAO || c.num_entradas > CACHE_MAX_ENTRADAS || lidos != tamanho(c.num_entradas)) {
+    return false;
+  }
+  uint16_t crc = modbusCrc16(reinterpret_cast<const uint8_t*>(blob_.entradas), lidos - sizeof(CabecalhoCache));
+  valido_ = crc == c.crc;
+  return valido_;
+}
+
+bool CacheDescoberta::salvar(const RegistroDispositivos& registro, uint8_t num_barramentos) {
+  // Monta por cima do cache carregado, anotando se alguma entrada mudou
+  bool mudou = !valido_;
+  uint16_t n = 0;
+  for (uint8_t b = 0; b < num_barramentos && b < HAL_MAX_BARRAMENTOS; b++) {
+    for (uint16_t i = 0; i < registro.quantidade(b); i++) {
+      Dispositivo d;
+      if (!registro.copiar(b, i, d)) {
+        // Partição sendo refeita por outra varredura, que pede a gravação ao terminar
+        valido_ = false;
+        return false;
+      }
+      const DeviceInfo& info = d.info;
+      EntradaCache e = {};
+      e.baud_rate = info.baud_rate;
+      e.config_id = info.config_id;
+      e.config_baud = info.config_baud;
+      e.barramento = info.barramento;
+      e.id = info.id;
+      e.tipo = info.tipo;
+      if (memcmp(&blob_.entradas[n], &e, sizeof(e)) != 0) mudou = true;
+      blob_.entradas[n++] = e;
+    }
+  }
+  if (n != blob_.cabecalho.num_entradas) mudou = true;
+  if (!mudou) return false;
+
+  blob_.cabecalho.versao = CACHE_VERSAO;
+  blob_.cabecalho.num_entradas = n;
+  blob_.cabecalho.crc = modbusCrc16(reinterpret_cast<const uint8_t*>(blob_.entradas), tamanho(n) - sizeof(CabecalhoCache));
+  blob_.cabecalho.reservado = 0;
+  valido_ = halNvsGravar(CACHE_CHAVE_NVS, &blob_, tamanho(n));
+  return valido_;
+}
+
+void CacheDescoberta::apagar() {
+  halNvsApagar(CACHE_CHAVE_NVS);
+  valido_ = false;
+}
+
+DeviceInfo CacheDescoberta::paraDeviceInfo(const EntradaCache& entrada) {
+  DeviceInfo info;
+  info.baud_rate = entrada.baud_rate;
+  info.config_id = entrada.config_id;
+  info.config_baud = entrada.config_baud;
+  info.id = entrada.id;
+  info.barramento = entrada.barramento;
+  info.tipo = entrada.tipo <= TIPO_ANEMOMETRO_BAIXA ? (TipoDispositivo)entrada.tipo : TIPO_DESCONHECIDO;
+  info.ativo = true;
+  return info;
+}
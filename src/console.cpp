@@ -0,0 +1,146 @@
+#include "console.h"
+#include <Arduino.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+bool LeitorLinha::alimentar(int byte) {
+  if (byte < 0) return false;
+  char c = (char)byte;
+
+  if (c == '\r' || c == '\n') {
+    bool descartada = descartando_;
+    descartando_ = false;
+    // Apara as pontas; CR+LF e linhas em branco não geram linha
+    uint8_t inicio = 0, fim = tamanho_;
+    tamanho_ = 0;
+    while (inicio < fim && buffer_[inicio] == ' ') inicio++;
+    while (fim > inicio && buffer_[fim - 1] == ' ') fim--;
+    if (descartada || inicio == fim) return false;
+    memcpy(linha_, &buffer_[inicio], fim - inicio);
+    linha_[fim - inicio] = '\0';
+    linhas_++;
+    return true;
+  }
+
+  if (descartando_) return false;
+  if (c == '\b' || c == 0x7F) {
+    if (tamanho_) tamanho_--;
+    return false;
+  }
+  if (c == '\t') c = ' ';
+  if ((unsigned char)c < ' ') return false;
+  if (tamanho_ >= CONSOLE_MAX_LINHA - 1) {
+    descartando_ = true;
+    descartadas_++;
+    tamanho_ = 0;
+    return false;
+  }
+  buffer_[tamanho_++] = (char)tolower((unsigned char)c);
+  return false;
+}
+
+const EntradaComando* procurarComando(const EntradaComando* tabela, size_t n, const char* linha,
+                                      const char** argumentos) {
+  size_t tamanho = strcspn(linha, " ");
+  const char* resto = linha + tamanho;
+  while (*resto == ' ') resto++;
+  for (size_t i = 0; i < n; i++) {
+    if (strlen(tabela[i].nome) == tamanho && !strncmp(tabela[i].nome, linha, tamanho)) {
+      *argumentos = resto;
+      return &tabela[i];
+    }
+  }
+  return nullptr;
+}
+
+bool TrabalhoConsole::iniciar(const char* nome, PassoTrabalho passo, bool usa_barramento) {
+  if (passo_) return false;
+  passo_ = passo;
+  nome_ = nome;
+  usa_barramento_ = usa_barramento;
+  cancelado_ = false;
+  fatias_ = 0;
+  ultima_fatia_us_ = 0;
+  maior_fatia_us_ = 0;
+  inicio_ms_ = millis();
+  return true;
+}
+
+bool TrabalhoConsole::fatia() {
+  if (!passo_) return false;
+  uint32_t inicio = micros();
+  bool continua = passo_();
+  ultima_fatia_us_ = micros() - inicio;
+  fatias_++;
+  if (ultima_fatia_us_ > maior_fatia_us_) maior_fatia_us_ = ultima_fatia_us_;
+  if (!continua) {
+    passo_ = nullptr;
+    cancelado_ = false;
+  }
+  return continua;
+}
+
+uint32_t TrabalhoConsole::decorridoMs() const {
+  return millis() - inicio_ms_;
+}
+
+int SaidaConsole::printf(const char* formato, ...) {
+  char texto[CONSOLE_SAIDA_MAX_ESCRITA];
+  va_list argumentos;
+  va_start(argumentos, formato);
+  int n = vsnprintf(texto, sizeof(texto), formato, argumentos);
+  va_end(argumentos);
+  if (n < 0) return 0;
+  if ((size_t)n >= sizeof(texto)) n = sizeof(texto) - 1;   // Cortado no tamanho máximo
+  return (int)escrever(texto, (size_t)n);
+}
+
+size_t SaidaConsole::print(const char* texto) {
+  return escrever(texto, strlen(texto));
+}
+
+size_t SaidaConsole::println(const char* texto) {
+  return print(texto) + print("\n");
+}
+
+size_t SaidaConsole::escrever(const char* dados, size_t n) {
+  if (direto_) return Serial.print(dados);
+  uint32_t ocupacao = escrita_ - leitura_.load(std::memory_order_acquire);
+  if (ocupacao + n > CONSOLE_SAIDA_BYTES) {
+    descartados_.fetch_add((uint32_t)n, std::memory_order_relaxed);
+    return 0;
+  }
+  for (size_t i = 0; i < n; i++) anel_[(escrita_ + i) & (CONSOLE_SAIDA_BYTES - 1)] = dados[i];
+  escrita_ += (uint32_t)n;
+  if (ocupacao + n > ocupacao_max_.load(std::memory_order_relaxed)) {
+    ocupacao_max_.store(ocupacao + (uint32_t)n, std::memory_order_relaxed);
+  }
+  return n;
+}
+
+void SaidaConsole::confirmar() {
+  confirmada_.store(escrita_, std::memory_order_release);
+}
+
+size_t SaidaConsole::escoar(size_t max) {
+  uint32_t leitura = leitura_.load(std::memory_order_relaxed);
+  uint32_t disponivel = confirmada_.load(std::memory_order_acquire) - leitura;
+  size_t n = disponivel < max ? disponivel : max;
+  // Em pedaços terminados em '\0', pelo mesmo caminho de texto da Serial
+  char pedaco[65];
+  size_t escritos = 0;
+  while (escritos < n) {
+    size_t k = 0;
+    while (k < sizeof(pedaco) - 1 && escritos + k < n) {
+      pedaco[k] = anel_[(leitura + escritos + k) & (CONSOLE_SAIDA_BYTES - 1)];
+      k++;
+    }
+    pedaco[k] = '\0';
+    Serial.print(pedaco);
+    escritos += k;
+  }
+  leitura_.store(leitura + (uint32_t)n, std::memory_order_release);
+  return n;
+}
@@ -0,0 +1,124 @@
+#include "descoberta.h"
+#include "hal.h"
+#include "metricas_modbus.h"
+#include "modbus_rtu.h"
+
+void Descoberta::iniciar(const ConfigDescoberta& config, CallbackDescoberta callback, void* contexto) {
+  config_ = config;
+  if (config_.id_inicial < 1) config_.id_inicial = 1;
+  if (config_.id_final > MODBUS_ID_MAX) config_.id_final = MODBUS_ID_MAX;
+  if (config_.num_baud_rates > DESCOBERTA_MAX_BAUDS) config_.num_baud_rates = DESCOBERTA_MAX_BAUDS;
+
+  callback_ = callback;
+  contexto_ = contexto;
+  encontrados_ = 0;
+  sondas_ = 0;
+  bauds_abandonados_ = 0;
+  duracao_ms_ = 0;
+  inicio_ms_ = millis();
+  indice_baud_ = 0;
+  ativa_ = config_.num_baud_rates > 0 && config_.id_inicial <= config_.id_final;
+  if (!ativa_) return;
+
+  id_atual_ = config_.id_inicial;
+  lixo_no_baud_ = 0;
+  encontrados_no_baud_ = 0;
+  halRs485Iniciar(config_.barramento, config_.baud_rates[0]);
+}
+
+void Descoberta::proximoBaud() {
+  if ((config_.baud_unico && encontrados_no_baud_ > 0) || ++indice_baud_ >= config_.num_baud_rates) {
+    ativa_ = false;
+    return;
+  }
+  id_atual_ = config_.id_inicial;
+  lixo_no_baud_ = 0;
+  encontrados_no_baud_ = 0;
+  halRs485Iniciar(config_.barramento, config_.baud_rates[indice_baud_]);
+}
+
+// Bytes na linha antes da sonda: resposta atrasada da sonda anterior ou
+// tráfego num baud rate diferente. Conta como lixo sem gastar uma sonda.
+bool Descoberta::linhaComLixo() {
+  if (halRs485Disponivel(config_.barramento) <= 0) return false;
+  halRs485Descartar(config_.barramento);
+  return true;
+}
+
+// A sonda lê 0x0000 com a função 0x03; quem a recusa com exceção é relido
+// com 0x04, a função dos manuais. Sem o valor, o tipo fica desconhecido.
+// O tipo vem da sonda de 0x0001 (perfis_dispositivo.h), que só a biruta
+// tem; a exceção ou o timeout do anemômetro não contam nas métricas.
+TipoDispositivo Descoberta::sondarTipo(uint8_t id, uint8_t codigo_sonda, uint16_t& valor) {
+  if (codigo_sonda != MB_SUCESSO) {
+    ResultadoLeitura r = modbusLerComTimeout(id, MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1, &valor,
+                                             config_.turnaround_us, config_.barramento);
+    if (r.codigo != MB_SUCESSO) {
+      valor = 0;
+      return TIPO_DESCONHECIDO;
+    }
+  }
+  uint16_t graus;
+  MetricasBarramento& metricas = metricasModbus(config_.barramento);
+  metricas.suspender(true);
+  ResultadoLeitura r = modbusLerComTimeout(id, FUNCAO_SONDA_TIPO, SondaTipo::endereco, 1, &graus,
+                                           config_.turnaround_us, config_.barramento);
+  metricas.suspender(false);
+  return classificarDispositivo(r.codigo, valor);
+}
+
+bool Descoberta::passo() {
+  if (!ativa_) return false;
+
+  uint32_t baud = config_.baud_rates[indice_baud_];
+  uint8_t id = (uint8_t)id_atual_;
+  uint16_t valor = 0;
+
+  if (linhaComLixo() && encontrados_no_baud_ == 0 && config_.limite_lixo &&
+      ++lixo_no_baud_ >= config_.limite_lixo) {
+    bauds_abandonados_++;
+    proximoBaud();
+    if (!ativa_) duracao_ms_ = millis() - inicio_ms_;
+    return ativa_;
+  }
+
+  // Sonda: 1 registrador em 0x0000 (FUNÇÃO 03 - APENAS LEITURA). Nas
+  // métricas só conta como sonda: IDs vazios não são falhas.
+  MetricasBarramento& metricas = metricasModbus(config_.barramento);
+  metricas.suspender(true);
+  ResultadoLeitura r = modbusLerComTimeout(id, MB_FC_READ_HOLDING, REGISTRADOR_PRINCIPAL, 1, &valor, config_.turnaround_us,
+                                           config_.barramento);
+  metricas.suspender(false);
+  sondas_++;
+
+  if (r.codigo == MB_SUCESSO || r.codigo < MB_ERRO_ID_INVALIDO) {
+    // Resposta válida (dados ou exceção): há um dispositivo neste ID
+    encontrados_++;
+    encontrados_no_baud_++;
+    if (callback_) {
+      TipoDispositivo tipo = sondarTipo(id, r.codigo, valor);
+      DispositivoEncontrado d = {config_.barramento, id, baud, valor, tipo, r.latencia_us};
+      callback_(d, contexto_);
+    }
+  } else if (r.bytes_recebidos > 0) {
+    // Bytes que não formam um quadro válido: dispositivo em outro baud rate ou ruído
+    lixo_no_baud_++;
+  }
+
+  if (config_.esperados && encontrados_ >= config_.esperados) {
+    ativa_ = false;
+  } else if (config_.limite_lixo && encontrados_no_baud_ == 0 && lixo_no_baud_ >= config_.limite_lixo) {
+    bauds_abandonados_++;
+    proximoBaud();
+  } else if (++id_atual_ > config_.id_final) {
+    proximoBaud();
+  }
+
+  if (!ativa_) duracao_ms_ = millis() - inicio_ms_;
+  return ativa_;
+}
+
+void Descoberta::executar() {
+  while (passo()) {
+  }
+}
@@ -0,0 +1,201 @@
+#include "diario_amostras.h"
+#include "modbus_rtu.h"
+#include <stddef.h>
+#include <string.h>
+
+static uint16_t crcCabecalho(const CabecalhoBloco& c) {
+  return modbusCrc16(reinterpret_cast<const uint8_t*>(&c), offsetof(CabecalhoBloco, crc));
+}
+
+bool DiarioAmostras::lerCabecalho(uint16_t fisico, CabecalhoBloco& c) const {
+  if (!halFlashLer(enderecoBloco(fisico), &c, sizeof(c))) return false;
+  return c.magica == DIARIO_MAGICA && c.versao == DIARIO_VERSAO && c.crc == crcCabecalho(c);
+}
+
+bool DiarioAmostras::slotLivre(uint16_t fisico, uint16_t slot) const {
+  uint8_t dados[DIARIO_TAM_REGISTRO];
+  if (!halFlashLer(enderecoRegistro(fisico, slot), dados, sizeof(dados))) return false;
+  for (uint8_t b : dados) {
+    if (b != 0xFF) return false;
+  }
+  return true;
+}
+
+bool DiarioAmostras::lerRegistro(uint16_t fisico, uint16_t slot, RegistroDiario& registro) const {
+  uint8_t dados[DIARIO_TAM_REGISTRO];
+  if (!halFlashLer(enderecoRegistro(fisico, slot), dados, sizeof(dados))) return false;
+  uint16_t crc = (uint16_t)(dados[DIARIO_TAM_REGISTRO - 2] | (dados[DIARIO_TAM_REGISTRO - 1] << 8));
+  if (crc != modbusCrc16(dados, DIARIO_TAM_REGISTRO - 2)) return false;
+  registro.tempo_s = (uint32_t)dados[0] | ((uint32_t)dados[1] << 8) | ((uint32_t)dados[2] << 16) |
+                     ((uint32_t)dados[3] << 24);
+  return telemetriaLerCarga(&dados[4], registro.amostra);
+}
+
+// Registros são gravados em ordem: os livres formam o fim do bloco
+uint16_t DiarioAmostras::primeiroLivre(uint16_t fisico) const {
+  uint16_t inicio = 0, fim = DIARIO_REGISTROS_POR_BLOCO;
+  while (inicio < fim) {
+    uint16_t meio = (uint16_t)((inicio + fim) / 2);
+    if (slotLivre(fisico, meio)) fim = meio;
+    else inicio = (uint16_t)(meio + 1);
+  }
+  return inicio;
+}
+
+bool DiarioAmostras::montar() {
+  uint32_t setores = halFlashTamanho() / HAL_FLASH_SETOR;
+  num_blocos_ = (uint16_t)(setores > 0xFFFF ? 0xFFFF : setores);
+  usados_ = 0;
+  vazio_ = true;
+  slot_ = DIARIO_REGISTROS_POR_BLOCO;
+  ultimo_tempo_s_ = 0;
+  montagem_ms_ = millis();
+  base_s_ = 0;
+  if (!num_blocos_) return false;
+
+  // Cabeçalhos: maior sequência = cabeça, menor = cauda
+  uint32_t maior = 0, menor = UINT32_MAX;
+  for (uint16_t b = 0; b < num_blocos_; b++) {
+    CabecalhoBloco c;
+    if (!lerCabecalho(b, c)) continue;
+    usados_++;
+    if (c.sequencia >= maior) {
+      maior = c.sequencia;
+      cabeca_ = b;
+      ultimo_tempo_s_ = c.tempo_inicial_s;
+    }
+    if (c.sequencia < menor) {
+      menor = c.sequencia;
+      cauda_ = b;
+      tempo_antigo_s_ = c.tempo_inicial_s;
+    }
+  }
+  if (!usados_) {
+    cabeca_ = (uint16_t)(num_blocos_ - 1);   // O primeiro bloco aberto será o 0
+    cauda_ = 0;
+    sequencia_ = 0;
+    return true;
+  }
+
+  vazio_ = false;
+  sequencia_ = maior;
+  slot_ = primeiroLivre(cabeca_);
+  // Último tempo gravado, passando por cima de um registro cortado
+  for (uint16_t s = slot_; s > 0; s--) {
+    RegistroDiario r;
+    if (lerRegistro(cabeca_, (uint16_t)(s - 1), r)) {
+      ultimo_tempo_s_ = r.tempo_s;
+      break;
+    }
+  }
+  base_s_ = ultimo_tempo_s_ + 1;
+  return true;
+}
+
+uint32_t DiarioAmostras::tempoAgora() const {
+  return base_s_ + (millis() - montagem_ms_) / 1000;
+}
+
+uint32_t DiarioAmostras::registros() const {
+  return vazio_ ? 0 : (uint32_t)(usados_ - 1) * DIARIO_REGISTROS_POR_BLOCO + slot_;
+}
+
+// Apaga o próximo setor do anel (o mais antigo, se cheio) e grava o cabeçalho
+bool DiarioAmostras::abrirBloco(uint32_t tempo_s) {
+  uint16_t proximo = vazio_ ? 0 : (uint16_t)((cabeca_ + 1) % num_blocos_);
+  bool descarta_cauda = !vazio_ && usados_ == num_blocos_;
+  if (!halFlashApagarSetor(enderecoBloco(proximo))) return false;
+
+  CabecalhoBloco c = {DIARIO_MAGICA, sequencia_ + 1, tempo_s, DIARIO_VERSAO, 0};
+  c.crc = crcCabecalho(c);
+  if (descarta_cauda) {
+    // O setor apagado era o mais antigo
+    cauda_ = (uint16_t)((cauda_ + 1) % num_blocos_);
+    usados_--;
+    CabecalhoBloco antigo;
+    if (lerCabecalho(cauda_, antigo)) tempo_antigo_s_ = antigo.tempo_inicial_s;
+  }
+  if (!halFlashGravar(enderecoBloco(proximo), &c, sizeof(c))) return false;
+
+  if (vazio_) {
+    cauda_ = proximo;
+    tempo_antigo_s_ = tempo_s;
+    vazio_ = false;
+  }
+  cabeca_ = proximo;
+  sequencia_++;
+  usados_++;
+  slot_ = 0;
+  return true;
+}
+
+bool DiarioAmostras::anexar(const RegistroTelemetria& amostra, uint32_t tempo_s) {
+  if (!num_blocos_) return false;
+  if (!vazio_ && tempo_s < ultimo_tempo_s_) tempo_s = ultimo_tempo_s_;   // Tempo nunca volta
+  if (slot_ >= DIARIO_REGISTROS_POR_BLOCO && !abrirBloco(tempo_s)) {
+    falhas_gravacao_++;
+    return false;
+  }
+
+  uint8_t dados[DIARIO_TAM_REGISTRO];
+  dados[0] = (uint8_t)tempo_s;
+  dados[1] = (uint8_t)(tempo_s >> 8);
+  dados[2] = (uint8_t)(tempo_s >> 16);
+  dados[3] = (uint8_t)(tempo_s >> 24);
+  telemetriaEscreverCarga(amostra, &dados[4]);
+  uint16_t crc = modbusCrc16(dados, DIARIO_TAM_REGISTRO - 2);
+  dados[DIARIO_TAM_REGISTRO - 2] = (uint8_t)crc;
+  dados[DIARIO_TAM_REGISTRO - 1] = (uint8_t)(crc >> 8);
+
+  // O slot é consumido mesmo se a gravação falhar: pode ter ficado pela metade
+  bool ok = halFlashGravar(enderecoRegistro(cabeca_, slot_++), dados, sizeof(dados));
+  if (!ok) {
+    falhas_gravacao_++;
+    return false;
+  }
+  ultimo_tempo_s_ = tempo_s;
+  return true;
+}
+
+uint32_t DiarioAmostras::consultar(uint32_t de_s, uint32_t ate_s, CallbackDiario callback, void* contexto) {
+  blocos_lidos_ = 0;
+  invalidos_ = 0;
+  if (vazio_ || de_s > ate_s) return 0;
+
+  // Índice esparso: último bloco que começa até 'de_s'
+  uint16_t inicio = 0;
+  int32_t baixo = 0, alto = (int32_t)usados_ - 1;
+  while (baixo <= alto) {
+    int32_t meio = (baixo + alto) / 2;
+    CabecalhoBloco c;
+    if (lerCabecalho(fisico((uint16_t)meio), c) && c.tempo_inicial_s <= de_s) {
+      inicio = (uint16_t)meio;
+      baixo = meio + 1;
+    } else {
+      alto = meio - 1;
+    }
+  }
+
+  uint32_t entregues = 0;
+  for (uint16_t l = inicio; l < usados_; l++) {
+    uint16_t b = fisico(l);
+    CabecalhoBloco c;
+    if (!lerCabecalho(b, c)) continue;
+    if (c.tempo_inicial_s > ate_s) break;
+    blocos_lidos_++;
+
+    uint16_t fim = b == cabeca_ ? slot_ : DIARIO_REGISTROS_POR_BLOCO;
+    for (uint16_t s = 0; s < fim; s++) {
+      RegistroDiario r;
+      if (!lerRegistro(b, s, r)) {
+        invalidos_++;
+        continue;
+      }
+      if (r.tempo_s < de_s) continue;
+      if (r.tempo_s > ate_s) return entregues;
+      entregues++;
+      if (callback && !callback(r, contexto)) return entregues;
+    }
+  }
+  return entregues;
+}
@@ -0,0 +1,158 @@
+#include "escalonador.h"
+#include <string.h>
+
+// Comparação de instantes com millis() dando a volta (49 dias)
+static bool jaPassou(uint32_t agora_ms, uint32_t instante_ms) {
+  return (int32_t)(agora_ms - instante_ms) >= 0;
+}
+
+int8_t Escalonador::adicionar(const char* nome, uint32_t periodo_ms, uint8_t prioridade,
+                              bool usa_barramento, IniciarFonte iniciar, void* contexto) {
+  if (num_fontes_ >= ESCALONADOR_MAX_FONTES) return -1;
+  FonteAmostragem& f = fontes_[num_fontes_];
+  f = FonteAmostragem();
+  f.nome = nome;
+  f.periodo_ms = periodo_ms ? periodo_ms : 1;
+  f.prioridade = prioridade;
+  f.usa_barramento = usa_barramento;
+  f.ativa = true;
+  f.iniciar = iniciar;
+  f.contexto = contexto;
+  return (int8_t)num_fontes_++;
+}
+
+void Escalonador::configurar(uint8_t fonte, uint32_t periodo_ms, uint8_t prioridade) {
+  if (fonte >= num_fontes_) return;
+  FonteAmostragem& f = fontes_[fonte];
+  f.periodo_ms = periodo_ms ? periodo_ms : 1;
+  f.prioridade = prioridade;
+  // Recomeça no próximo passo com o novo período
+  f.agendada = false;
+  f.pendente = false;
+}
+
+void Escalonador::ativar(uint8_t fonte, bool ativa) {
+  if (fonte >= num_fontes_) return;
+  FonteAmostragem& f = fontes_[fonte];
+  if (f.ativa == ativa) return;
+  f.ativa = ativa;
+  f.agendada = false;
+  f.pendente = false;
+}
+
+void Escalonador::zerarEstatisticas(uint32_t agora_ms) {
+  for (uint8_t i = 0; i < num_fontes_; i++) {
+    FonteAmostragem& f = fontes_[i];
+    f.inicio_estatisticas_ms = agora_ms;
+    f.execucoes = 0;
+    f.prazos_perdidos = 0;
+    f.atraso_max_ms = 0;
+  }
+}
+
+void Escalonador::liberar(FonteAmostragem& f, uint32_t agora_ms) {
+  if (!f.agendada) {
+    f.agendada = true;
+    f.inicio_estatisticas_ms = agora_ms;
+    f.liberacao_ms = agora_ms;
+  } else {
+    // Períodos inteiros sem liberação (ex.: comando longo no console) são prazos perdidos
+    uint32_t pulados = (agora_ms - f.prazo_ms) / f.periodo_ms;
+    f.prazos_perdidos += pulados;
+    f.liberacao_ms = f.prazo_ms + pulados * f.periodo_ms;
+  }
+  f.prazo_ms = f.liberacao_ms + f.periodo_ms;
+  f.pendente = true;
+}
+
+void Escalonador::registrarConclusao(FonteAmostragem& f, uint32_t agora_ms) {
+  f.em_andamento = false;
+  f.execucoes++;
+  uint32_t atraso = agora_ms - f.liberacao_ms;
+  if (atraso > f.atraso_max_ms) f.atraso_max_ms = atraso;
+  if (agora_ms != f.prazo_ms && jaPassou(agora_ms, f.prazo_ms)) f.prazos_perdidos++;
+}
+
+void Escalonador::passo(uint32_t agora_ms, bool barramento_livre) {
+  for (uint8_t i = 0; i < num_fontes_; i++) {
+    FonteAmostragem& f = fontes_[i];
+    if (!f.ativa) continue;
+    if (f.pendente && jaPassou(agora_ms, f.prazo_ms)) {
+      f.prazos_perdidos++;   // Período acabou sem a leitura começar
+      f.pendente = false;
+    }
+    if (!f.pendente && !f.em_andamento && (!f.agendada || jaPassou(agora_ms, f.prazo_ms))) {
+      liberar(f, agora_ms);
+    }
+  }
+
+  // Despacho EDF: menor prazo primeiro, prioridade como desempate
+  bool tentou[ESCALONADOR_MAX_FONTES] = {};
+  for (;;) {
+    int8_t escolhida = -1;
+    for (uint8_t i = 0; i < num_fontes_; i++) {
+      const FonteAmostragem& f = fontes_[i];
+      if (!f.ativa || !f.pendente || tentou[i]) continue;
+      if (f.usa_barramento && !barramento_livre) continue;
+      if (escolhida < 0) {
+        escolhida = (int8_t)i;
+        continue;
+      }
+      const FonteAmostragem& e = fontes_[escolhida];
+      int32_t diferenca = (int32_t)(f.prazo_ms - e.prazo_ms);
+      if (diferenca < 0 || (diferenca == 0 && f.prioridade < e.prioridade)) escolhida = (int8_t)i;
+    }
+    if (escolhida < 0) break;
+
+    FonteAmostragem& f = fontes_[escolhida];
+    tentou[escolhida] = true;
+    InicioFonte r = f.iniciar((uint8_t)escolhida, f.contexto);
+    if (r == FONTE_OCUPADA) continue;
+
+    f.pendente = false;
+    if (r == FONTE_CONCLUIDA) {
+      registrarConclusao(f, agora_ms);
+    } else {
+      f.em_andamento = true;
+      if (f.usa_barramento) barramento_livre = false;
+    }
+  }
+}
+
+void Escalonador::concluir(uint8_t fonte, uint32_t agora_ms) {
+  if (fonte >= num_fontes_ || !fontes_[fonte].em_andamento) return;
+  registrarConclusao(fontes_[fonte], agora_ms);
+}
+
+bool Escalonador::ocioso() const {
+  for (uint8_t i = 0; i < num_fontes_; i++) {
+    if (fontes_[i].em_andamento) return false;
+  }
+  return true;
+}
+
+bool Escalonador::barramentoDisputado(uint8_t fonte) const {
+  if (fonte >= num_fontes_) return false;
+  for (uint8_t i = 0; i < num_fontes_; i++) {
+    const FonteAmostragem& f = fontes_[i];
+    if (i == fonte || !f.ativa || !f.usa_barramento) continue;
+    if (f.pendente && f.prioridade < fontes_[fonte].prioridade) return true;
+  }
+  return false;
+}
+
+int8_t Escalonador::procurar(const char* nome) const {
+  for (uint8_t i = 0; i < num_fontes_; i++) {
+    if (!strcmp(fontes_[i].nome, nome)) return (int8_t)i;
+  }
+  return -1;
+}
+
+float Escalonador::taxaAlcancada(uint8_t fonte, uint32_t agora_ms) const {
+  if (fonte >= num_fontes_) return 0.0f;
+  const FonteAmostragem& f = fontes_[fonte];
+  // Janela de pelo menos um período: logo após a ativação a taxa não dispara
+  uint32_t janela = agora_ms - f.inicio_estatisticas_ms;
+  if (janela < f.periodo_ms) janela = f.periodo_ms;
+  return janela ? f.execucoes * 1000.0f / janela : 0.0f;
+}
@@ -0,0 +1,315 @@
+// HAL do ESP32: Serial2/Serial1 + MAX485, MAX6675 e ADC por DMA
+#include "hal.h"
+#include <MAX6675.h>
+#include <Preferences.h>
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "driver/uart.h"
+#include "driver/adc.h"
+#include "esp_adc_cal.h"
+#include <algorithm>
+
+static MAX6675 thermocouple(MAX6675_CLK_PIN, MAX6675_CS_PIN, MAX6675_DO_PIN);
+
+// Uma UART e um MAX485 por barramento de sensores
+struct PortaRs485 {
+  HardwareSerial& serial;
+  uart_port_t uart;
+  uint8_t rx;
+  uint8_t tx;
+  uint8_t de_re;
+  uint32_t baud;
+};
+
+static PortaRs485 portas[HAL_MAX_BARRAMENTOS] = {
+  {Serial2, UART_NUM_2, RS485_RX_PIN, RS485_TX_PIN, RS485_DE_RE_PIN, 0},
+  {Serial1, UART_NUM_1, ESCRAVO_RX_PIN, ESCRAVO_TX_PIN, ESCRAVO_DE_RE_PIN, 0},   // Sem o escravo
+};
+
+void halIniciar() {
+  // Configurar pino DE/RE
+  pinMode(RS485_DE_RE_PIN, OUTPUT);
+  digitalWrite(RS485_DE_RE_PIN, LOW);
+
+  // Configurar sensor UV
+  pinMode(UV_SENSOR_PIN, INPUT);
+}
+
+void halRs485Iniciar(uint8_t barramento, uint32_t baud) {
+  PortaRs485& p = portas[barramento];
+  pinMode(p.de_re, OUTPUT);
+  digitalWrite(p.de_re, LOW);
+  p.serial.begin(baud, SERIAL_8N1, p.rx, p.tx);
+  p.baud = baud;
+}
+
+uint32_t halRs485Baud(uint8_t barramento) {
+  return portas[barramento].baud;
+}
+
+void halRs485Direcao(uint8_t barramento, bool transmitir) {
+  digitalWrite(portas[barramento].de_re, transmitir ? HIGH : LOW);
+}
+
+size_t halRs485Escrever(uint8_t barramento, const uint8_t* dados, size_t len) {
+  return portas[barramento].serial.write(dados, len);
+}
+
+void halRs485AguardarEnvio(uint8_t barramento) {
+  portas[barramento].serial.flush();
+}
+
+bool halRs485EnvioConcluido(uint8_t barramento) {
+  // Timeout zero: só consulta se o FIFO e o registrador de deslocamento esvaziaram
+  return uart_wait_tx_done(portas[barramento].uart, 0) == ESP_OK;
+}
+
+int halRs485Disponivel(uint8_t barramento) {
+  return portas[barramento].serial.available();
+}
+
+int halRs485Ler(uint8_t barramento) {
+  return portas[barramento].serial.read();
+}
+
+void halRs485Descartar(uint8_t barramento) {
+  HardwareSerial& serial = portas[barramento].serial;
+  while (serial.available()) serial.read();
+}
+
+static uint32_t baud_escravo = 0;
+
+void halEscravoIniciar(uint32_t baud) {
+  pinMode(ESCRAVO_DE_RE_PIN, OUTPUT);
+  digitalWrite(ESCRAVO_DE_RE_PIN, LOW);
+  Serial1.begin(baud, SERIAL_8N1, ESCRAVO_RX_PIN, ESCRAVO_TX_PIN);
+  baud_escravo = baud;
+}
+
+uint32_t halEscravoBaud() {
+  return baud_escravo;
+}
+
+void halEscravoDirecao(bool transmitir) {
+  digitalWrite(ESCRAVO_DE_RE_PIN, transmitir ? HIGH : LOW);
+}
+
+size_t halEscravoEscrever(const uint8_t* dados, size_t len) {
+  return Serial1.write(dados, len);
+}
+
+bool halEscravoEnvioConcluido() {
+  return uart_wait_tx_done(UART_NUM_1, 0) == ESP_OK;
+}
+
+int halEscravoDisponivel() {
+  return Serial1.available();
+}
+
+int halEscravoLer() {
+  return Serial1.read();
+}
+
+float halLerTemperatura() {
+  return thermocouple.readCelsius();
+}
+
+// ADC1 canal 4 = GPIO32 (UV_SENSOR_PIN). No ESP32 o modo contínuo usa o
+// I2S0 com DMA; cada amostra ocupa 2 bytes (formato tipo 1).
+#define ADC_CANAL_UV ADC1_CHANNEL_4
+#define ADC_BUFFER_DRIVER 4096         // ~100 ms a 20 kHz
+#define ADC_BYTES_POR_INTERRUPCAO 512
+
+static esp_adc_cal_characteristics_t calibracao_adc;
+static esp_adc_cal_value_t origem_calibracao = ESP_ADC_CAL_VAL_DEFAULT_VREF;
+static uint32_t estouros_adc = 0;
+
+bool halAdcIniciar(uint32_t taxa_hz) {
+  origem_calibracao = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                               1100, &calibracao_adc);
+
+  adc_digi_init_config_t driver = {};
+  driver.max_store_buf_size = ADC_BUFFER_DRIVER;
+  driver.conv_num_each_intr = ADC_BYTES_POR_INTERRUPCAO;
+  driver.adc1_chan_mask = BIT(ADC_CANAL_UV);
+  if (adc_digi_initialize(&driver) != ESP_OK) return false;
+
+  adc_digi_pattern_config_t padrao = {};
+  padrao.atten = ADC_ATTEN_DB_11;
+  padrao.channel = ADC_CANAL_UV;
+  padrao.unit = 0;                     // ADC1
+  padrao.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+  adc_digi_configuration_t controlador = {};
+  controlador.conv_limit_en = true;    // Obrigatório no ESP32
+  controlador.conv_limit_num = 250;
+  controlador.pattern_num = 1;
+  controlador.adc_pattern = &padrao;
+  controlador.sample_freq_hz = taxa_hz;
+  controlador.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  controlador.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&controlador) != ESP_OK) return false;
+  return adc_digi_start() == ESP_OK;
+}
+
+size_t halAdcLer(uint16_t* codigos, size_t max) {
+  uint8_t bruto[ADC_BYTES_POR_INTERRUPCAO];
+  size_t n = 0;
+  while (max - n >= sizeof(bruto) / SOC_ADC_DIGI_RESULT_BYTES) {
+    uint32_t lidos = 0;
+    esp_err_t r = adc_digi_read_bytes(bruto, sizeof(bruto), &lidos, 0);
+    if (r == ESP_ERR_INVALID_STATE) estouros_adc++;   // Driver descartou dados; os lidos valem
+    else if (r != ESP_OK) break;
+    if (!lidos) break;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= lidos; i += SOC_ADC_DIGI_RESULT_BYTES) {
+      const adc_digi_output_data_t* p = (const adc_digi_output_data_t*)&bruto[i];
+      if (p->type1.channel == ADC_CANAL_UV) codigos[n++] = p->type1.data;
+    }
+  }
+  return n;
+}
+
+uint32_t halAdcEstouros() {
+  return estouros_adc;
+}
+
+// Curva do eFuse é por código inteiro; interpola para o valor sobreamostrado
+float halAdcMilivolts(float codigo) {
+  if (codigo <= 0.0f) return (float)esp_adc_cal_raw_to_voltage(0, &calibracao_adc);
+  if (codigo >= 4095.0f) return (float)esp_adc_cal_raw_to_voltage(4095, &calibracao_adc);
+  uint32_t base = (uint32_t)codigo;
+  float v0 = (float)esp_adc_cal_raw_to_voltage(base, &calibracao_adc);
+  float v1 = (float)esp_adc_cal_raw_to_voltage(base + 1, &calibracao_adc);
+  return v0 + (v1 - v0) * (codigo - (float)base);
+}
+
+const char* halAdcCalibracao() {
+  switch (origem_calibracao) {
+    case ESP_ADC_CAL_VAL_EFUSE_TP:   return "eFuse (dois pontos)";
+    case ESP_ADC_CAL_VAL_EFUSE_VREF: return "eFuse (Vref)";
+    default:                         return "Vref padrão (1100 mV)";
+  }
+}
+
+// NVS: namespace próprio na partição padrão, aberto na primeira chamada
+static Preferences nvs;
+static bool nvs_aberta = false;
+
+static bool abrirNvs() {
+  if (!nvs_aberta) nvs_aberta = nvs.begin("estacao", false);
+  return nvs_aberta;
+}
+
+size_t halNvsLer(const char* chave, void* dados, size_t max) {
+  if (!abrirNvs() || !nvs.isKey(chave)) return 0;
+  return nvs.getBytes(chave, dados, max);
+}
+
+bool halNvsGravar(const char* chave, const void* dados, size_t len) {
+  return abrirNvs() && nvs.putBytes(chave, dados, len) == len;
+}
+
+void halNvsApagar(const char* chave) {
+  if (abrirNvs()) nvs.remove(chave);
+}
+
+// Flash de dados: partição "amostras" de particoes.csv
+static const esp_partition_t* particao_amostras = nullptr;
+
+static const esp_partition_t* particaoAmostras() {
+  if (!particao_amostras) {
+    particao_amostras = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "amostras");
+  }
+  return particao_amostras;
+}
+
+uint32_t halFlashTamanho() {
+  const esp_partition_t* p = particaoAmostras();
+  return p ? p->size : 0;
+}
+
+bool halFlashLer(uint32_t endereco, void* dados, size_t len) {
+  const esp_partition_t* p = particaoAmostras();
+  return p && esp_partition_read(p, endereco, dados, len) == ESP_OK;
+}
+
+bool halFlashGravar(uint32_t endereco, const void* dados, size_t len) {
+  const esp_partition_t* p = particaoAmostras();
+  return p && esp_partition_write(p, endereco, dados, len) == ESP_OK;
+}
+
+bool halFlashApagarSetor(uint32_t endereco) {
+  const esp_partition_t* p = particaoAmostras();
+  return p && esp_partition_erase_range(p, endereco, HAL_FLASH_SETOR) == ESP_OK;
+}
+
+struct Tarefa {
+  PassoTarefa passo;
+  TickType_t intervalo;
+  TaskHandle_t handle;
+};
+
+static Tarefa tarefas[HAL_MAX_TAREFAS];
+static uint8_t num_tarefas = 0;
+
+static void executarTarefa(void* parametro) {
+  const Tarefa* tarefa = static_cast<const Tarefa*>(parametro);
+  for (;;) {
+    tarefa->passo();
+    // Dorme o intervalo ou até o temporizador de amostragem acordar a tarefa
+    ulTaskNotifyTake(pdTRUE, tarefa->intervalo);
+  }
+}
+
+bool halCriarTarefa(const char* nome, PassoTarefa passo, uint8_t nucleo,
+                    uint8_t prioridade, uint32_t intervalo_ms) {
+  if (num_tarefas >= HAL_MAX_TAREFAS) return false;
+  Tarefa& tarefa = tarefas[num_tarefas];
+  tarefa.passo = passo;
+  tarefa.intervalo = std::max<TickType_t>(1, pdMS_TO_TICKS(intervalo_ms));
+  // Pilha de 8 KB: printf com float nas tarefas de processamento e saída
+  if (xTaskCreatePinnedToCore(executarTarefa, nome, 8192, &tarefa, prioridade,
+                              &tarefa.handle, nucleo) != pdPASS) {
+    return false;
+  }
+  num_tarefas++;
+  return true;
+}
+
+void halExecutarTarefas() {
+  // O loopTask do Arduino não tem mais trabalho: tudo roda nas tarefas
+  vTaskDelay(pdMS_TO_TICKS(1000));
+}
+
+static esp_timer_handle_t temporizador = nullptr;
+static CallbackTemporizador callback_temporizador = nullptr;
+static TaskHandle_t tarefa_acordada = nullptr;
+
+static void aoDispararTemporizador(void* argumento) {
+  (void)argumento;
+  callback_temporizador();
+  if (tarefa_acordada) xTaskNotifyGive(tarefa_acordada);
+}
+
+bool halTemporizadorIniciar(uint32_t periodo_us, CallbackTemporizador callback, PassoTarefa acordar) {
+  if (temporizador || !callback) return false;
+  callback_temporizador = callback;
+  for (uint8_t i = 0; i < num_tarefas; i++) {
+    if (tarefas[i].passo == acordar) tarefa_acordada = tarefas[i].handle;
+  }
+  esp_timer_create_args_t args = {};
+  args.callback = aoDispararTemporizador;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "amostragem";
+  if (esp_timer_create(&args, &temporizador) != ESP_OK) return false;
+  if (esp_timer_start_periodic(temporizador, periodo_us) != ESP_OK) {
+    esp_timer_delete(temporizador);
+    temporizador = nullptr;
+    return false;
+  }
+  return true;
+}
+
+uint32_t halCiclos() {
+  return ESP.getCycleCount();
+}
@@ -0,0 +1,163 @@
+#include "estatisticas_vento.h"
+#include <math.h>
+
+#define ESCALA_COMPONENTE 10000
+
+void EstatisticasVento::Janela::somar(const Balde& b) {
+  soma_dms += b.soma_dms;
+  soma_quadrados += b.soma_quadrados;
+  soma_cos += b.soma_cos;
+  soma_sen += b.soma_sen;
+  leituras_vento += b.leituras_vento;
+  leituras_direcao += b.leituras_direcao;
+}
+
+void EstatisticasVento::Janela::subtrair(const Balde& b) {
+  soma_dms -= b.soma_dms;
+  soma_quadrados -= b.soma_quadrados;
+  soma_cos -= b.soma_cos;
+  soma_sen -= b.soma_sen;
+  leituras_vento -= b.leituras_vento;
+  leituras_direcao -= b.leituras_direcao;
+}
+
+void EstatisticasVento::adicionarVelocidade(uint32_t agora_ms, uint16_t vento_dms) {
+  avancar(agora_ms);
+  Balde leitura = {};
+  leitura.soma_dms = vento_dms;
+  leitura.soma_quadrados = (uint32_t)vento_dms * vento_dms;
+  leitura.leituras_vento = 1;
+
+  Balde& b = balde(segundo_);
+  if (b.leituras_vento == UINT16_MAX) return;
+  b.soma_dms += leitura.soma_dms;
+  b.soma_quadrados += leitura.soma_quadrados;
+  b.leituras_vento++;
+  curta_.somar(leitura);
+  longa_.somar(leitura);
+}
+
+void EstatisticasVento::adicionarDirecao(uint32_t agora_ms, uint16_t graus) {
+  avancar(agora_ms);
+  float radianos = (graus % 360) * (float)M_PI / 180.0f;
+  Balde leitura = {};
+  leitura.soma_cos = (int32_t)lroundf(cosf(radianos) * ESCALA_COMPONENTE);
+  leitura.soma_sen = (int32_t)lroundf(sinf(radianos) * ESCALA_COMPONENTE);
+  leitura.leituras_direcao = 1;
+
+  Balde& b = balde(segundo_);
+  if (b.leituras_direcao == UINT16_MAX) return;
+  b.soma_cos += leitura.soma_cos;
+  b.soma_sen += leitura.soma_sen;
+  b.leituras_direcao++;
+  curta_.somar(leitura);
+  longa_.somar(leitura);
+}
+
+// Fecha os segundos passados desde a última chamada. Leituras com timestamp
+// anterior ao segundo corrente (atrasadas na fila) entram no segundo corrente.
+void EstatisticasVento::avancar(uint32_t agora_ms) {
+  if (!iniciado_) {
+    iniciado_ = true;
+    inicio_segundo_ms_ = agora_ms;
+    return;
+  }
+  if ((int32_t)(agora_ms - inicio_segundo_ms_) < 0) return;
+
+  uint32_t passados = (agora_ms - inicio_segundo_ms_) / 1000;
+  if (passados > VENTO_JANELA_LONGA_S) {
+    // Lacuna maior que a janela: nada do histórico continua valendo
+    zerar();
+    iniciado_ = true;
+    inicio_segundo_ms_ = agora_ms;
+    return;
+  }
+  inicio_segundo_ms_ += passados * 1000;
+  while (passados--) fecharSegundo();
+}
+
+void EstatisticasVento::fecharSegundo() {
+  // Média de 3 s terminando neste segundo, candidata a rajada/calmaria
+  uint32_t soma = 0;
+  uint32_t leituras = 0;
+  for (uint32_t k = 0; k < VENTO_JANELA_RAJADA_S && k <= segundo_; k++) {
+    const Balde& b = balde(segundo_ - k);
+    soma += b.soma_dms;
+    leituras += b.leituras_vento;
+  }
+  if (leituras) {
+    uint16_t media_3s = (uint16_t)((soma + leituras / 2) / leituras);
+    rajada_.inserir(segundo_, media_3s);
+    calmaria_.inserir(segundo_, media_3s);
+  }
+
+  segundo_++;
+  rajada_.expirar(segundo_, VENTO_JANELA_LONGA_S);
+  calmaria_.expirar(segundo_, VENTO_JANELA_LONGA_S);
+
+  // O balde do novo segundo guardava o segundo que sai da janela longa; o de
+  // 2 minutos atrás sai da curta
+  Balde& novo = balde(segundo_);
+  longa_.subtrair(novo);
+  if (segundo_ >= VENTO_JANELA_CURTA_S) curta_.subtrair(balde(segundo_ - VENTO_JANELA_CURTA_S));
+  novo = Balde();
+  if (segundos_preenchidos_ < VENTO_JANELA_LONGA_S) segundos_preenchidos_++;
+}
+
+// Direção média vetorial em graus (0-359)
+static uint16_t direcaoMedia(int64_t soma_sen, int64_t soma_cos) {
+  float graus = atan2f((float)soma_sen, (float)soma_cos) * 180.0f / (float)M_PI;
+  if (graus < 0) graus += 360.0f;
+  return (uint16_t)(lroundf(graus) % 360);
+}
+
+ResumoVento EstatisticasVento::resumo(uint32_t agora_ms) {
+  avancar(agora_ms);
+  ResumoVento r;
+  r.cobertura_s = (uint16_t)segundos_preenchidos_;
+
+  if (longa_.leituras_vento) {
+    r.vento_valido = true;
+    uint64_t n = longa_.leituras_vento;
+    r.media_10min_dms = (uint16_t)((longa_.soma_dms + n / 2) / n);
+    if (curta_.leituras_vento) {
+      r.media_2min_dms = (uint16_t)((curta_.soma_dms + curta_.leituras_vento / 2) / curta_.leituras_vento);
+    }
+    if (n > 1) {
+      // Somas inteiras exatas: n·Σx² − (Σx)² nunca fica negativo
+      uint64_t dispersao = n * longa_.soma_quadrados - longa_.soma_dms * longa_.soma_dms;
+      r.desvio_vento_dms = (uint16_t)lroundf(sqrtf((float)dispersao / (float)(n * (n - 1))));
+    }
+    if (!rajada_.vazio()) {
+      r.rajada_dms = rajada_.valor();
+      r.calmaria_dms = calmaria_.valor();
+    }
+  }
+
+  if (longa_.leituras_direcao) {
+    r.direcao_valida = true;
+    r.direcao_10min_graus = direcaoMedia(longa_.soma_sen, longa_.soma_cos);
+    if (curta_.leituras_direcao) {
+      r.direcao_2min_graus = direcaoMedia(curta_.soma_sen, curta_.soma_cos);
+    }
+    // Yamartino: desvio da direção numa passada, a partir do vetor médio
+    float escala = (float)longa_.leituras_direcao * ESCALA_COMPONENTE;
+    float sen = (float)longa_.soma_sen / escala;
+    float cos = (float)longa_.soma_cos / escala;
+    float epsilon = sqrtf(fmaxf(0.0f, 1.0f - (sen * sen + cos * cos)));
+    float desvio = asinf(fminf(epsilon, 1.0f)) * (1.0f + 0.1547f * epsilon * epsilon * epsilon);
+    r.desvio_direcao_dg = (uint16_t)lroundf(desvio * 1800.0f / (float)M_PI);
+  }
+  return r;
+}
+
+void EstatisticasVento::zerar() {
+  for (Balde& b : baldes_) b = Balde();
+  curta_ = Janela();
+  longa_ = Janela();
+  rajada_.zerar();
+  calmaria_.zerar();
+  iniciado_ = false;
+  segundo_ = 0;
+  segundos_preenchidos_ = 0;
+}
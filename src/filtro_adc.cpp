@@ -0,0 +1,79 @@
+#include "filtro_adc.h"
+#include <math.h>
+
+void FiltroAdc::configurar(uint16_t decimacao, float alfa) {
+  if (decimacao < 1) decimacao = 1;
+  if (decimacao > FILTRO_CIC_DECIMACAO_MAX) decimacao = FILTRO_CIC_DECIMACAO_MAX;
+  *this = FiltroAdc();
+  decimacao_ = decimacao;
+  alfa_ = alfa > 0.0f && alfa <= 1.0f ? alfa : 1.0f;
+  escala_cic_ = 1.0f / ((float)decimacao * decimacao * decimacao);
+}
+
+void FiltroAdc::processar(const uint16_t* codigos, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    // Integradores na taxa de entrada
+    uint32_t x = codigos[i];
+    integradores_[0] += x;
+    integradores_[1] += integradores_[0];
+    integradores_[2] += integradores_[1];
+    if (++contador_ < decimacao_) continue;
+    contador_ = 0;
+
+    // Pentes na taxa decimada (atraso diferencial 1)
+    uint32_t y = integradores_[2];
+    for (uint8_t k = 0; k < FILTRO_CIC_ORDEM; k++) {
+      uint32_t anterior = atrasos_pente_[k];
+      atrasos_pente_[k] = y;
+      y -= anterior;
+    }
+    decimada((float)(int32_t)y * escala_cic_);
+  }
+  entradas_ += (uint32_t)n;
+}
+
+// As primeiras ORDEM saídas do CIC ainda estão enchendo os pentes
+void FiltroAdc::decimada(float valor) {
+  if (ocupacao_mediana_ < FILTRO_CIC_ORDEM + FILTRO_MEDIANA) {
+    if (++ocupacao_mediana_ <= FILTRO_CIC_ORDEM) return;
+  }
+  janela_mediana_[posicao_mediana_] = valor;
+  posicao_mediana_ = (uint8_t)((posicao_mediana_ + 1) % FILTRO_MEDIANA);
+  float m = mediana();
+
+  if (!iir_iniciado_) {
+    iir_ = m;
+    iir_iniciado_ = true;
+  } else {
+    iir_ += alfa_ * (m - iir_);
+  }
+
+  n_++;
+  float delta = m - media_;
+  media_ += delta / n_;
+  m2_ += delta * (m - media_);
+}
+
+float FiltroAdc::mediana() const {
+  uint8_t n = ocupacao_mediana_ - FILTRO_CIC_ORDEM;
+  float v[FILTRO_MEDIANA];
+  // Inserção: no máximo 5 elementos
+  for (uint8_t i = 0; i < n; i++) {
+    float x = janela_mediana_[i];
+    uint8_t j = i;
+    for (; j > 0 && v[j - 1] > x; j--) v[j] = v[j - 1];
+    v[j] = x;
+  }
+  return v[n / 2];
+}
+
+bool FiltroAdc::retirar(SaidaFiltro& saida) {
+  if (!n_) return false;
+  saida.codigo = iir_;
+  saida.ruido = n_ > 1 ? sqrtf(m2_ / (n_ - 1)) : 0.0f;
+  saida.amostras = n_;
+  n_ = 0;
+  media_ = 0.0f;
+  m2_ = 0.0f;
+  return true;
+}
@@ -0,0 +1,139 @@
+#include "gerador_carga.h"
+#include "perfis_dispositivo.h"
+
+bool GeradorCarga::adicionarAlvo(uint8_t id, TipoDispositivo tipo) {
+  if (num_alvos_ >= CARGA_MAX_ALVOS) return false;
+  alvos_[num_alvos_++] = {id, tipo};
+  return true;
+}
+
+// Alvos em rodízio; a cada volta completa troca o formato da leitura
+bool GeradorCarga::enfileirar(MestreModbusAsync& mestre) {
+  const Alvo& alvo = alvos_[sequencia_ % num_alvos_];
+  Pendente& pendente = pendentes_[proximo_pendente_];
+  RequisicaoModbus requisicao = {alvo.id, MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1, aoConcluir, &pendente};
+  switch ((sequencia_ / num_alvos_) % 3) {
+    case 1:
+      if (alvo.tipo == TIPO_BIRUTA) requisicao.quantidade = PerfilBiruta::Dados::quantidade;
+      break;
+    case 2:
+      requisicao.funcao = MB_FC_READ_HOLDING;
+      requisicao.registrador = PerfilConfiguracao::Dados::inicio;
+      requisicao.quantidade = PerfilConfiguracao::Dados::quantidade;
+      break;
+  }
+
+  pendente = {this, (uint32_t)micros()};
+  if (!mestre.enfileirar(requisicao)) return false;
+  proximo_pendente_ = (uint8_t)((proximo_pendente_ + 1) % (FILA_MODBUS_MAX + 1));
+  sequencia_++;
+  return true;
+}
+
+void GeradorCarga::aoConcluir(const RequisicaoModbus& requisicao, uint8_t resultado,
+                              const RespostaModbus& resposta, void* contexto) {
+  (void)resposta;
+  Pendente& pendente = *static_cast<Pendente*>(contexto);
+  GeradorCarga& gerador = *pendente.gerador;
+  gerador.concluidas_++;
+  if (resultado != MB_SUCESSO) return;
+  gerador.sucessos_++;
+  gerador.registradores_ += requisicao.quantidade;
+  gerador.latencia_.registrar(micros() - pendente.enfileirada_us);
+}
+
+void GeradorCarga::abrirDegrau(uint32_t taxa) {
+  DegrauCarga& degrau = degraus_[num_degraus_++];
+  degrau = DegrauCarga();
+  degrau.taxa_pedida = taxa;
+  latencia_.zerar();
+  sucessos_ = 0;
+  concluidas_ = 0;
+  registradores_ = 0;
+
+  duracao_us_ = config_.duracao_degrau_ms * 1000UL;
+  intervalo_us_ = taxa ? 1000000UL / taxa : 0;
+  marcado_us_ = 0;
+  inicio_us_ = micros();
+}
+
+void GeradorCarga::fecharDegrau(DegrauCarga& degrau) {
+  float segundos = (micros() - inicio_us_) / 1000000.0f;
+  degrau.sucessos = sucessos_;
+  degrau.vazao = sucessos_ / segundos;
+  degrau.registradores_s = registradores_ / segundos;
+  degrau.p50_us = latencia_.percentil(50);
+  degrau.p95_us = latencia_.percentil(95);
+  degrau.p99_us = latencia_.percentil(99);
+  degrau.maximo_us = latencia_.maximo();
+}
+
+bool GeradorCarga::passouDoJoelho(const DegrauCarga& degrau) const {
+  if (degrau.descartadas || degrau.sucessoPct() < config_.sucesso_minimo) return true;
+  if (degrau.vazao < config_.fracao_vazao * degrau.taxa_pedida) return true;
+  return num_degraus_ > 1 && degrau.p95_us > config_.fator_latencia * degraus_[0].p95_us;
+}
+
+void GeradorCarga::iniciar(MestreModbusAsync& mestre) {
+  mestre_ = &mestre;
+  num_degraus_ = 0;
+  joelho_ = -1;
+  sequencia_ = 0;
+  ativo_ = num_alvos_ > 0;
+  if (ativo_) abrirDegrau(config_.taxa_inicial ? config_.taxa_inicial : 1);
+}
+
+bool GeradorCarga::passo() {
+  if (!ativo_) return false;
+  DegrauCarga& degrau = degraus_[num_degraus_ - 1];
+  mestre_->processar();
+
+  uint32_t decorrido = micros() - inicio_us_;
+  if (decorrido < duracao_us_) {
+    if (degrau.taxa_pedida) {
+      // Malha aberta: envios atrasados saem em seguida, não são adiados
+      while (marcado_us_ < duracao_us_ && decorrido >= marcado_us_) {
+        if (enfileirar(*mestre_)) degrau.enviadas++;
+        else degrau.descartadas++;
+        marcado_us_ += intervalo_us_;
+      }
+    } else if (mestre_->ocioso() && enfileirar(*mestre_)) {
+      degrau.enviadas++;
+    }
+    return true;
+  }
+  if (!mestre_->ocioso()) return true;   // As que ainda estão na linha contam no degrau
+
+  fecharDegrau(degrau);
+  if (!degrau.taxa_pedida) {
+    ativo_ = false;   // O degrau sem ritmo é o último
+    return false;
+  }
+  if (passouDoJoelho(degrau)) {
+    degrau.joelho = true;
+    joelho_ = (int8_t)(num_degraus_ - 1);
+    abrirDegrau(0);
+  } else if (num_degraus_ >= CARGA_MAX_DEGRAUS - 1) {
+    abrirDegrau(0);
+  } else {
+    uint32_t taxa = degrau.taxa_pedida;
+    abrirDegrau(taxa * 3 / 2 > taxa ? taxa * 3 / 2 : taxa + 1);
+  }
+  return true;
+}
+
+uint8_t GeradorCarga::executar(MestreModbusAsync& mestre) {
+  iniciar(mestre);
+  while (passo()) yield();
+  return num_degraus_;
+}
+
+float GeradorCarga::vazaoSustentavel() const {
+  float maior = 0.0f;
+  for (uint8_t i = 0; i < num_degraus_; i++) {
+    const DegrauCarga& d = degraus_[i];
+    if (d.joelho) break;
+    if (d.taxa_pedida && d.vazao > maior) maior = d.vazao;
+  }
+  return maior;
+}
@@ -0,0 +1,148 @@
+#include "log_async.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+LogAssincrono log_sistema;
+
+uint8_t LogAssincrono::copiarTexto(RegistroLog& registro, const char* texto) {
+  if (!texto) texto = "(null)";
+  // O último byte fica reservado para o '\0' dos textos que não couberam
+  uint8_t inicio = registro.uso_texto;
+  if (inicio >= LOG_MAX_TEXTO - 1) {
+    registro.texto[LOG_MAX_TEXTO - 1] = '\0';
+    return LOG_MAX_TEXTO - 1;
+  }
+  size_t livre = LOG_MAX_TEXTO - 1 - inicio;
+  size_t tamanho = strnlen(texto, livre);
+  memcpy(&registro.texto[inicio], texto, tamanho);
+  registro.texto[inicio + tamanho] = '\0';
+  registro.uso_texto = (uint8_t)(inicio + tamanho + 1);
+  return inicio;
+}
+
+// Mantém o valor do tipo original para as conversões sem sinal (%x de -1 é FFFFFFFF)
+static unsigned long long semSinal(const RegistroLog& registro, uint8_t i) {
+  if (registro.tipos[i] == LOG_ARG_REAL) return (unsigned long long)registro.valores[i].real;
+  uint64_t valor = registro.valores[i].natural;
+  uint8_t bytes = registro.bytes[i];
+  if (registro.tipos[i] == LOG_ARG_INTEIRO && bytes < 8) valor &= (1ULL << (bytes * 8)) - 1;
+  return valor;
+}
+
+static long long comSinal(const RegistroLog& registro, uint8_t i) {
+  if (registro.tipos[i] == LOG_ARG_REAL) return (long long)registro.valores[i].real;
+  return registro.valores[i].inteiro;
+}
+
+// Formata cada especificação do printf com o seu argumento, trocando o
+// modificador de tamanho pelo do valor guardado (64 bits ou double)
+size_t formatarRegistroLog(const RegistroLog& registro, char* destino, size_t tamanho) {
+  if (!tamanho) return 0;
+  int n = snprintf(destino, tamanho, "[%s] ", registro.tag);
+  size_t usado = n < 0 ? 0 : ((size_t)n < tamanho ? (size_t)n : tamanho - 1);
+  uint8_t argumento = 0;
+
+  const char* p = registro.formato;
+  while (*p && usado < tamanho - 1) {
+    if (*p != '%') {
+      destino[usado++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      destino[usado++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // %[flags][largura][.precisão][tamanho]conversão
+    const char* inicio = p++;
+    while (*p && strchr("-+ #0", *p)) p++;
+    while (isdigit((unsigned char)*p)) p++;
+    if (*p == '.') {
+      p++;
+      while (isdigit((unsigned char)*p)) p++;
+    }
+    size_t base = (size_t)(p - inicio);
+    while (*p && strchr("hlLqjzt", *p)) p++;
+    char conversao = *p;
+    if (!conversao) break;
+    p++;
+
+    char especificacao[16];
+    if (base > sizeof(especificacao) - 4) base = sizeof(especificacao) - 4;
+    memcpy(especificacao, inicio, base);
+    char* fim = especificacao + base;
+    char* saida = destino + usado;
+    size_t livre = tamanho - usado;
+
+    if (argumento >= registro.num_argumentos) {
+      n = snprintf(saida, livre, "%.*s", (int)(p - inicio), inicio);   // Sem argumento: o texto da especificação
+    } else {
+      uint8_t i = argumento++;
+      switch (conversao) {
+        case 'd':
+        case 'i':
+          strcpy(fim, "lld");
+          n = snprintf(saida, livre, especificacao, comSinal(registro, i));
+          break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+          fim[0] = 'l';
+          fim[1] = 'l';
+          fim[2] = conversao;
+          fim[3] = '\0';
+          n = snprintf(saida, livre, especificacao, semSinal(registro, i));
+          break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+          fim[0] = conversao;
+          fim[1] = '\0';
+          n = snprintf(saida, livre, especificacao,
+                       registro.tipos[i] == LOG_ARG_REAL ? registro.valores[i].real : (double)comSinal(registro, i));
+          break;
+        case 'c':
+          strcpy(fim, "c");
+          n = snprintf(saida, livre, especificacao, (int)comSinal(registro, i));
+          break;
+        case 's':
+          strcpy(fim, "s");
+          n = snprintf(saida, livre, especificacao,
+                       registro.tipos[i] == LOG_ARG_TEXTO ? &registro.texto[registro.valores[i].texto] : "?");
+          break;
+        case 'p':
+          strcpy(fim, "p");
+          n = snprintf(saida, livre, especificacao, registro.valores[i].ponteiro);
+          break;
+        default:
+          n = snprintf(saida, livre, "%.*s", (int)(p - inicio), inicio);
+          break;
+      }
+    }
+    if (n > 0) usado += (size_t)n < livre ? (size_t)n : livre - 1;
+  }
+  destino[usado] = '\0';
+  return usado;
+}
+
+bool LogAssincrono::formatarProxima(char* destino, size_t tamanho) {
+  RegistroLog registro;
+  if (!fila_.retirar(registro)) return false;
+  formatarRegistroLog(registro, destino, tamanho);
+  return true;
+}
+
+bool LogAssincrono::suprimirProxima() {
+  RegistroLog registro;
+  if (!fila_.retirar(registro)) return false;
+  suprimidas_++;
+  return true;
+}
@@ -1,525 +1,845 @@
 #include <Arduino.h>
-#include <ModbusMaster.h>
-#include <MAX6675.h>
+#include "hal.h"
+#include "modbus_rtu.h"
+#include "descoberta.h"
+#include "modbus_async.h"
+#include "planejador.h"
+#include "fila_spsc.h"
+#include "telemetria.h"
+#include "modbus_escravo.h"
+#include "escalonador.h"
+#include "estatisticas_vento.h"
+#include "filtro_adc.h"
+#include "registro_dispositivos.h"
+#include "cache_descoberta.h"
+#include "metricas_modbus.h"
+#include "gerador_carga.h"
+#include "diario_amostras.h"
+#include "otimizador_baud.h"
+#include "relogio_amostragem.h"
+#include "console.h"
+#include "log_async.h"
+#include "perfis_dispositivo.h"
+#include "saude_dispositivo.h"
+#include "tipos.h"
 
-// Configurações de Hardware
-#define RS485_DE_RE_PIN 4      // Pino DE/RE do MAX485
-#define MAX6675_CS_PIN 19      // CS do MAX6675
-#define MAX6675_CLK_PIN 23     // CLK do MAX6675
-#define MAX6675_DO_PIN 18      // DO do MAX6675
-#define UV_SENSOR_PIN 32       // Pino analógico do sensor UV
-
-// Configurações Modbus - IDs para teste
-uint8_t possible_ids[] = {1, 2, 3, 4, 5}; // IDs para testar
-const int num_ids = sizeof(possible_ids) / sizeof(possible_ids[0]);
-
-// Baud rates para teste (do mais provável para menos provável)
-uint32_t baud_rates[] = {4800, 9600, 2400, 19200, 38400, 57600, 115200, 1200};
-const int num_baud_rates = sizeof(baud_rates) / sizeof(baud_rates[0]);
-
-// Objetos Modbus
-ModbusMaster nodeAnemometro;
-ModbusMaster nodeBiruta;
-MAX6675 thermocouple(MAX6675_CLK_PIN, MAX6675_CS_PIN, MAX6675_DO_PIN);
+// Configurações Modbus - IDs 1-5 e baud rates do mais provável para o menos provável
+ConfigDescoberta config_descoberta;
 
 // Variáveis globais
-uint32_t current_baud_rate = 4800;
+uint8_t num_barramentos = BARRAMENTOS_RS485;   // Barramento 0 = sensores principais
+uint32_t current_baud_rate = 4800;             // Baud rate do barramento 0
 uint8_t anemometro_id = 0;
 uint8_t biruta_id = 0;
 bool anemometro_connected = false;
 bool biruta_connected = false;
 
-// Modo Simulador
-bool modo_simulador = false;
-uint8_t simulador_id = 1; // ID padrão para simulação
-String tipo_simulacao = "ANEMOMETRO"; // "ANEMOMETRO" ou "BIRUTA"
-uint16_t valor_simulado_principal = 0;
-uint16_t valor_simulado_secundario = 0;
-
-// Estrutura para dados dos sensores
-struct SensorData {
-  float wind_speed = 0.0;
-  int wind_direction_raw = 0;
-  int wind_direction_degrees = 0;
-  String wind_direction_cardinal = "N/A";
-  float temperature = 0.0;
-  float uv_index = 0.0;
-  unsigned long timestamp = 0;
-};
+// Modo escravo: o SCADA lê a última amostra pela segunda UART (0x04)
+#define ESCRAVO_BAUD 9600
+bool modo_escravo = true;
+uint8_t escravo_id = 1;
+MapaEscravo mapa_escravo;
+EscravoModbus escravo;
+
+// Agregados publicados no mapa do escravo (tarefa de processamento)
+uint64_t soma_vento_dms = 0;   // Em 32 bits estourava após semanas de vento forte
+uint32_t leituras_vento = 0;
+uint16_t vento_maximo_dms = 0;
+uint16_t falhas_anemometro = 0;
+uint16_t falhas_biruta = 0;
+
+// Médias de 2/10 min, rajada e direção vetorial (tarefa de processamento)
+EstatisticasVento estatisticas_vento;
 
 SensorData dados;
 
-// Estrutura para informações de dispositivo detectado
-struct DeviceInfo {
-  uint8_t id;
-  uint32_t baud_rate;
-  String tipo;
-  uint16_t config_id;
-  uint16_t config_baud;
-  bool ativo;
+// Planos de leitura por sensor (registradores agrupados em transações)
+PlanoLeitura plano_anemometro;
+PlanoLeitura plano_biruta;
+
+// Mestre Modbus assíncrono de cada barramento. O do barramento 0 é da
+// tarefa de aquisição; os outros, da tarefa do seu barramento.
+MestreModbusAsync mestres[HAL_MAX_BARRAMENTOS];
+
+// Escalonador por prazo: cada fonte com período e prioridade próprios
+// (comando 'periodo'). Rajadas pedem o anemômetro a 4 Hz; o MAX6675 converte
+// em ~220 ms. O período de 'uv' é a taxa de saída do filtro; 'adc' só esvazia
+// o buffer do DMA para dentro do filtro.
+#define PERIODO_ANEMOMETRO_MS 250
+#define PERIODO_BIRUTA_MS 1000
+#define PERIODO_TEMPERATURA_MS 250
+#define PERIODO_UV_MS 1000
+#define PERIODO_ADC_MS 20
+#define PERIODO_DISPOSITIVOS_MS 100   // Um dispositivo do registro por período
+#define PERIODO_RECONEXAO_MS 1000     // Procura sondas de reconexão vencidas
+Escalonador escalonador;
+int8_t fonte_anemometro = -1;
+int8_t fonte_biruta = -1;
+int8_t fonte_temperatura = -1;
+int8_t fonte_uv = -1;
+int8_t fonte_adc = -1;
+int8_t fonte_dispositivos = -1;
+int8_t fonte_reconexao = -1;
+
+// Saúde dos sensores principais (os demais ficam no registro): depois de
+// falhas seguidas o sensor sai das leituras periódicas e a fonte 'reconexao'
+// o sonda no tempo livre do barramento até ele responder ('saude')
+ConfigSaude config_saude;
+SaudeDispositivo saude_anemometro;
+SaudeDispositivo saude_biruta;
+uint32_t inicio_saude_ms = 0;
+
+// Relógio do escalonador: esp_timer a cada 1 ms, que também acorda a
+// aquisição. Jitter de cada fonte: captura contra o instante programado
+// (comando 'jitter').
+RelogioAmostragem relogio;
+JitterAmostragem jitter_fontes[ESCALONADOR_MAX_FONTES];
+
+// UV: ADC contínuo por DMA -> CIC ÷64 -> mediana -> IIR (filtro_adc.h)
+#define ADC_TAXA_HZ 20000
+#define ADC_DECIMACAO 64          // 312,5 Hz na saída do CIC
+#define ADC_ALFA_IIR 0.05f        // Constante de tempo ~64 ms
+#define UV_MV_POR_INDICE 220.0f   // 0-3300 mV -> índice 0-15
+FiltroAdc filtro_uv;
+
+uint32_t amostras_publicadas = 0;
+uint8_t resultado_anemometro = MB_ERRO_TIMEOUT;   // Última leitura de cada sensor
+uint8_t resultado_biruta = MB_ERRO_TIMEOUT;
+
+// Linhas do log escritas por passo da tarefa de saída
+#define LOG_LINHAS_POR_PASSO 4
+
+// Buffer de transmissão do driver da UART do console, além do FIFO de 128
+// bytes: o relatório cabe inteiro sem prender a tarefa de saída
+#define SERIAL_BUFFER_TX 2048
+
+// Relatório em texto com a amostra mais recente (binário: todas as amostras)
+#define INTERVALO_RELATORIO_MS 3000
+
+// Diário na flash: uma amostra por período (~14 dias no anel de 2 MB)
+DiarioAmostras diario;
+#define DIARIO_PERIODO_MS 1000
+
+// Pipeline: aquisição (núcleo 1) -> processamento -> saída (núcleo 0)
+// A aquisição nunca espera pelas outras tarefas: com a fila cheia a amostra é
+// descartada e contada (ver 'status').
+struct ComandoConsole {
+  char texto[CONSOLE_MAX_LINHA];
+  uint32_t recebido_us;      // Fim da linha no console (ida e volta do comando)
 };
+FilaSpsc<Amostra, 8> fila_amostras;         // aquisição -> processamento
+FilaSpsc<Amostra, 8> fila_saida;            // processamento -> saída
+FilaSpsc<ComandoConsole, 4> fila_comandos;  // console (saída) -> aquisição
 
-DeviceInfo dispositivos_detectados[10];
-int num_dispositivos = 0;
+// Console: a saída monta as linhas sem bloquear; scan, diag e stress rodam
+// na aquisição em fatias, entre as liberações do escalonador ('cancelar'
+// interrompe). O texto dos comandos vai para saida_console e a tarefa de
+// saída o leva à Serial: a aquisição nunca espera a UART. 'console' mostra a
+// ida e volta dos comandos e o maior tempo em que a aquisição ficou presa
+// num comando ou numa fatia.
+LeitorLinha leitor_console;
+SaidaConsole saida_console;
+TrabalhoConsole trabalho;
+std::atomic<bool> trabalho_em_andamento{false};
+HistogramaLatencia ida_volta_comandos;      // Linha recebida -> comando concluído
+uint32_t maior_bloqueio_us = 0;
+const char* nome_maior_bloqueio = "";
 
-// Mapeamento de direções do vento
-String getWindDirection(int direction) {
-  switch(direction) {
-    case 0: return "Norte";
-    case 1: return "Nordeste";
-    case 2: return "Leste";
-    case 3: return "Sudeste";
-    case 4: return "Sul";
-    case 5: return "Sudoeste";
-    case 6: return "Oeste";
-    case 7: return "Noroeste";
-    default: return "Inválido";
-  }
-}
+// Formato das amostras na Serial ('saida texto' / 'saida binario')
+enum ModoSaida : uint8_t {
+  SAIDA_TEXTO,     // Relatório legível com alertas
+  SAIDA_BINARIA    // Quadros COBS de tamanho fixo (lib/telemetria)
+};
+std::atomic<ModoSaida> modo_saida{SAIDA_TEXTO};
 
-// Função para controle DE/RE do RS485
-void preTransmission() {
-  digitalWrite(RS485_DE_RE_PIN, HIGH);
-}
+// Todos os dispositivos encontrados, por barramento. Os barramentos extras
+// são varridos pelas suas próprias tarefas quando o 'scan' é pedido com elas
+// já rodando.
+RegistroDispositivos registro;
+Descoberta descobertas[HAL_MAX_BARRAMENTOS];
+std::atomic<bool> varredura_pedida[HAL_MAX_BARRAMENTOS];
+bool tarefas_iniciadas = false;
+
+// Tabela de dispositivos da última varredura, guardada na NVS para o boot a
+// quente. As varreduras em segundo plano pedem a gravação à aquisição.
+CacheDescoberta cache_dispositivos;
+std::atomic<bool> gravar_cache{false};
+
+// Boot até a primeira leitura válida de um sensor Modbus (0 = ainda não houve)
+std::atomic<uint32_t> primeira_amostra_ms{0};
+
+// Acima disso o relatório periódico só resume os barramentos
+#define MONITOR_MAX_DISPOSITIVOS 16
 
-void postTransmission() {
-  digitalWrite(RS485_DE_RE_PIN, LOW);
+// Escala Beaufort: limite superior (m/s) e descrição de cada grau
+struct GrauBeaufort {
+  float limite;
+  const char* descricao;
+};
+
+constexpr GrauBeaufort ESCALA_BEAUFORT[] = {
+  {0.3f, "Calmaria"}, {1.6f, "Aragem"}, {3.4f, "Brisa leve"}, {5.5f, "Brisa fraca"},
+  {8.0f, "Brisa moderada"}, {10.8f, "Brisa fresca"}, {13.9f, "Brisa forte"},
+  {17.2f, "Vento moderado"}, {20.8f, "Vento fresco"}, {24.5f, "Vento forte"},
+  {28.5f, "Temporal"}, {32.7f, "Tempestade"}, {INFINITY, "Furacão"}
+};
+
+// Leituras dos comandos ('diag', 'config', 'analise') pelo mestre do
+// barramento 0, como as do escalonador: a fatia enfileira a leitura e
+// retorna; o trabalho só volta a rodar com o mestre ocioso, quando o callback
+// já copiou a resposta. Com o sensor mudo, a espera de 100 ms
+// (MODBUS_TURNAROUND_COMANDOS_US) ocupa o barramento, não a aquisição.
+#define CONSOLE_MAX_REGISTRADORES 4
+
+struct LeituraConsole {
+  bool pedida;
+  bool pronta;
+  uint8_t resultado;
+  uint32_t duracao_us;           // Tempo de barramento da transação
+  uint8_t quadro[3 + 2 * CONSOLE_MAX_REGISTRADORES];
+  RespostaModbus resposta;       // Vista sobre 'quadro'
+};
+LeituraConsole leitura_console;
+
+void aoLerConsole(const RequisicaoModbus& /*requisicao*/, uint8_t resultado, const RespostaModbus& resposta,
+                  void* /*contexto*/) {
+  LeituraConsole& l = leitura_console;
+  l.resultado = resultado;
+  l.duracao_us = mestres[0].duracaoUs();
+  l.resposta = RespostaModbus();
+  if (resultado == MB_SUCESSO && resposta.num_registradores <= CONSOLE_MAX_REGISTRADORES) {
+    memcpy(l.quadro, resposta.quadro, 3 + 2 * resposta.num_registradores);
+    l.resposta.quadro = l.quadro;
+    l.resposta.num_registradores = resposta.num_registradores;
+  }
+  l.pedida = false;
+  l.pronta = true;
 }
 
-// Função para testar comunicação com um dispositivo (APENAS LEITURA)
-bool testModbusConnection(ModbusMaster& node, uint8_t device_id, uint16_t reg_address, uint32_t baud_rate) {
-  Serial2.begin(baud_rate, SERIAL_8N1, 16, 17); // RX=16, TX=17
-  delay(100); // Aguardar estabilização
-  
-  // Configurar callbacks
-  node.preTransmission(preTransmission);
-  node.postTransmission(postTransmission);
-  node.begin(device_id, Serial2);
-  
-  // Tentar ler um registrador (FUNÇÃO 03 - APENAS LEITURA)
-  uint8_t result = node.readHoldingRegisters(reg_address, 1);
-  
-  if (result == node.ku8MBSuccess) {
-    Serial.printf("✅ Dispositivo ID %d respondeu em %d bps\n", device_id, baud_rate);
+// true quando a leitura terminou (resultado em leitura_console); false
+// enquanto ela está na fila do mestre ou não coube lá
+bool lerPeloMestre(uint8_t id, uint8_t funcao, uint16_t registrador, uint16_t quantidade) {
+  LeituraConsole& l = leitura_console;
+  if (l.pronta) {
+    l.pronta = false;
     return true;
   }
-  
+  if (!l.pedida) {
+    RequisicaoModbus requisicao = {id, funcao, registrador, quantidade, aoLerConsole, nullptr,
+                                   MODBUS_TURNAROUND_COMANDOS_US};
+    l.pedida = mestres[0].enfileirar(requisicao);
+  }
   return false;
 }
 
-// Função SEGURA para diagnóstico completo baseado nos manuais
-bool diagnosticoCompleto(ModbusMaster& node, uint8_t device_id, DeviceInfo& info) {
-  Serial.printf("\n� DIAGNÓSTICO COMPLETO - ID %d\n", device_id);
-  Serial.println("==========================================");
-  
-  bool sucesso = true;
-  
-  // 1. TESTE DE COMUNICAÇÃO BÁSICA
-  Serial.println("📡 1. Teste de Comunicação:");
-  // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
-  uint8_t result = node.readInputRegisters(0x0000, 1);
-  if (result == node.ku8MBSuccess) {
-    uint16_t valor_principal = node.getResponseBuffer(0);
-    Serial.printf("  ✅ Comunicação OK - Valor: %d\n", valor_principal);
-  } else {
-    Serial.printf("  ❌ Falha na comunicação: %02X\n", result);
-    sucesso = false;
-  }
-  
-  // 2. LEITURA DE REGISTRADORES DE CONFIGURAÇÃO (baseado nos manuais)
-  Serial.println("\n⚙️  2. Configuração do Dispositivo:");
-  
-  // Registrador 0x07D0 - Device Address (ID)
-  result = node.readHoldingRegisters(0x07D0, 1);
-  if (result == node.ku8MBSuccess) {
-    uint16_t device_addr = node.getResponseBuffer(0);
-    Serial.printf("  📍 Endereço configurado: %d\n", device_addr);
-    info.config_id = device_addr;
-  } else {
-    Serial.printf("  ⚠️  Erro lendo endereço: %02X\n", result);
-  }
-  
-  // Registrador 0x07D1 - Baud Rate
-  result = node.readHoldingRegisters(0x07D1, 1);
-  if (result == node.ku8MBSuccess) {
-    uint16_t baud_code = node.getResponseBuffer(0);
-    String baud_names[] = {"2400", "4800", "9600", "19200", "38400", "57600", "115200", "1200"};
-    String baud_str = (baud_code <= 7) ? baud_names[baud_code] : "Inválido";
-    Serial.printf("  🔗 Baud Rate: %s bps (código %d)\n", baud_str.c_str(), baud_code);
-    info.config_baud = baud_code;
-  } else {
-    Serial.printf("  ⚠️  Erro lendo baud rate: %02X\n", result);
-  }
-  
-  // 3. TESTE DE MÚLTIPLOS REGISTRADORES (verificar consistência)
-  Serial.println("\n📊 3. Teste de Consistência de Dados:");
-  
-  // Ler registrador 0x0000 (dado principal) múltiplas vezes
-  int leituras_validas = 0;
+template <typename Bloco>
+bool lerBlocoPeloMestre(uint8_t id) {
+  static_assert(Bloco::quantidade <= CONSOLE_MAX_REGISTRADORES, "bloco maior que a leitura do console");
+  return lerPeloMestre(id, Bloco::funcao, Bloco::inicio, Bloco::quantidade);
+}
+
+// Diagnóstico completo baseado nos manuais ('diag'), em fatias: uma leitura
+// por fatia, com o barramento de volta ao escalonador entre as leituras
+enum EtapaDiagnostico : uint8_t {
+  DIAG_COMUNICACAO,
+  DIAG_ENDERECO,
+  DIAG_BAUD,
+  DIAG_CONSISTENCIA,
+  DIAG_SECUNDARIO,
+  DIAG_RESPOSTA
+};
+
+struct EstadoDiagnostico {
+  uint8_t ids[2];                // Sensores principais conectados
+  uint8_t num_ids;
+  uint8_t atual;
+  EtapaDiagnostico etapa;
+  uint8_t leituras;              // Consistência: feitas, válidas e valores
+  uint8_t validas;
   uint16_t valores[5];
+  uint32_t proxima_ms;           // Consistência: 100 ms entre leituras
+};
+EstadoDiagnostico diagnostico;
+
+// Uma etapa do diagnóstico do dispositivo (na consistência, uma das 5
+// leituras); false quando o dispositivo terminou. Cada etapa pede a sua
+// leitura ao mestre e só escreve quando ela terminou.
+bool etapaDiagnostico(uint8_t device_id) {
+  EstadoDiagnostico& d = diagnostico;
+  LeituraConsole& l = leitura_console;
   
-  for (int i = 0; i < 5; i++) {
-    // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
-    result = node.readInputRegisters(0x0000, 1);
-    if (result == node.ku8MBSuccess) {
-      valores[i] = node.getResponseBuffer(0);
-      leituras_validas++;
+  switch (d.etapa) {
+    case DIAG_COMUNICACAO: {
+      // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
+      if (!lerPeloMestre(device_id, MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1)) return true;
+      saida_console.printf("\n� DIAGNÓSTICO COMPLETO - ID %d\n", device_id);
+      saida_console.println("==========================================");
+      
+      // 1. TESTE DE COMUNICAÇÃO BÁSICA
+      saida_console.println("📡 1. Teste de Comunicação:");
+      if (l.resultado == MB_SUCESSO) {
+        saida_console.printf("  ✅ Comunicação OK - Valor: %d\n", l.resposta.registrador(0));
+      } else {
+        saida_console.printf("  ❌ Falha na comunicação: %02X\n", l.resultado);
+      }
+      d.etapa = DIAG_ENDERECO;
+      return true;
     }
-    delay(100);
-  }
-  
-  Serial.printf("  📈 Leituras válidas: %d/5\n", leituras_validas);
-  if (leituras_validas >= 3) {
-    Serial.print("  📋 Valores: ");
-    for (int i = 0; i < 5; i++) {
-      if (i < leituras_validas) Serial.printf("%d ", valores[i]);
+      
+    case DIAG_ENDERECO: {
+      // 2. LEITURA DE REGISTRADORES DE CONFIGURAÇÃO (baseado nos manuais)
+      // Registrador 0x07D0 - Device Address (ID)
+      if (!lerPeloMestre(device_id, MB_FC_READ_HOLDING, PerfilConfiguracao::Endereco::endereco, 1)) return true;
+      saida_console.println("\n⚙️  2. Configuração do Dispositivo:");
+      if (l.resultado == MB_SUCESSO) {
+        saida_console.printf("  📍 Endereço configurado: %d\n", l.resposta.registrador(0));
+      } else {
+        saida_console.printf("  ⚠️  Erro lendo endereço: %02X\n", l.resultado);
+      }
+      d.etapa = DIAG_BAUD;
+      return true;
     }
-    Serial.println();
-    
-    // Verificar estabilidade dos dados
-    bool dados_estaveis = true;
-    for (int i = 1; i < leituras_validas; i++) {
-      if (abs(valores[i] - valores[0]) > 5) { // Tolerância de 5 unidades
-        dados_estaveis = false;
-        break;
+      
+    case DIAG_BAUD: {
+      // Registrador 0x07D1 - Baud Rate
+      if (!lerPeloMestre(device_id, MB_FC_READ_HOLDING, PerfilConfiguracao::CodigoBaud::endereco, 1)) return true;
+      if (l.resultado == MB_SUCESSO) {
+        uint16_t baud_code = l.resposta.registrador(0);
+        saida_console.printf("  🔗 Baud Rate: %s bps (código %d)\n", nomeCodigoBaud(baud_code), baud_code);
+      } else {
+        saida_console.printf("  ⚠️  Erro lendo baud rate: %02X\n", l.resultado);
       }
+      
+      // 3. TESTE DE MÚLTIPLOS REGISTRADORES (verificar consistência)
+      saida_console.println("\n📊 3. Teste de Consistência de Dados:");
+      d.leituras = 0;
+      d.validas = 0;
+      d.proxima_ms = millis();
+      d.etapa = DIAG_CONSISTENCIA;
+      return true;
     }
-    Serial.printf("  📊 Estabilidade: %s\n", dados_estaveis ? "ESTÁVEL" : "INSTÁVEL");
-  }
-  
-  // 4. TESTE DE REGISTRADORES SECUNDÁRIOS (se existirem)
-  Serial.println("\n🔍 4. Registradores Secundários:");
-  
-  // Para biruta: registrador 0x0001 (direção em graus - conforme manual)
-  // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
-  result = node.readInputRegisters(0x0001, 1);
-  if (result == node.ku8MBSuccess) {
-    uint16_t reg_secundario = node.getResponseBuffer(0);
-    Serial.printf("  📐 Registrador 0x0001: %d\n", reg_secundario);
-  } else {
-    Serial.printf("  ℹ️  Registrador 0x0001: não disponível\n");
-  }
-  
-  // 5. TESTE DE TEMPO DE RESPOSTA
-  Serial.println("\n⏱️  5. Performance de Comunicação:");
-  
-  unsigned long inicio = micros();
-  // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
-  result = node.readInputRegisters(0x0000, 1);
-  unsigned long tempo_resposta = micros() - inicio;
-  
-  if (result == node.ku8MBSuccess) {
-    Serial.printf("  ⚡ Tempo de resposta: %lu μs\n", tempo_resposta);
-    if (tempo_resposta < 50000) { // < 50ms
-      Serial.println("  ✅ Performance: EXCELENTE");
-    } else if (tempo_resposta < 100000) { // < 100ms
-      Serial.println("  ✅ Performance: BOA");
-    } else {
-      Serial.println("  ⚠️  Performance: LENTA");
+      
+    case DIAG_CONSISTENCIA: {
+      // Ler registrador 0x0000 (dado principal) múltiplas vezes
+      if (!l.pedida && !l.pronta && (int32_t)(millis() - d.proxima_ms) < 0) return true;
+      // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
+      if (!lerPeloMestre(device_id, MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1)) return true;
+      if (l.resultado == MB_SUCESSO) {
+        d.valores[d.validas++] = l.resposta.registrador(0);
+      }
+      d.proxima_ms = millis() + 100;
+      if (++d.leituras < 5) return true;
+      
+      saida_console.printf("  📈 Leituras válidas: %d/5\n", d.validas);
+      if (d.validas >= 3) {
+        saida_console.print("  📋 Valores: ");
+        for (int i = 0; i < d.validas; i++) {
+          saida_console.printf("%d ", d.valores[i]);
+        }
+        saida_console.println();
+        
+        // Verificar estabilidade dos dados
+        bool dados_estaveis = true;
+        for (int i = 1; i < d.validas; i++) {
+          if (abs(d.valores[i] - d.valores[0]) > 5) { // Tolerância de 5 unidades
+            dados_estaveis = false;
+            break;
+          }
+        }
+        saida_console.printf("  📊 Estabilidade: %s\n", dados_estaveis ? "ESTÁVEL" : "INSTÁVEL");
+      }
+      d.etapa = DIAG_SECUNDARIO;
+      return true;
+    }
+      
+    case DIAG_SECUNDARIO: {
+      // 4. TESTE DE REGISTRADORES SECUNDÁRIOS (se existirem)
+      // Para biruta: registrador 0x0001 (direção em graus - conforme manual)
+      // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
+      constexpr uint16_t REG_GRAUS = PerfilBiruta::Graus::endereco;
+      if (!lerPeloMestre(device_id, MB_FC_READ_INPUT, REG_GRAUS, 1)) return true;
+      saida_console.println("\n🔍 4. Registradores Secundários:");
+      if (l.resultado == MB_SUCESSO) {
+        saida_console.printf("  📐 Registrador 0x%04X: %d\n", REG_GRAUS, l.resposta.registrador(0));
+      } else {
+        saida_console.printf("  ℹ️  Registrador 0x%04X: não disponível\n", REG_GRAUS);
+      }
+      d.etapa = DIAG_RESPOSTA;
+      return true;
+    }
+      
+    case DIAG_RESPOSTA: {
+      // 5. TESTE DE TEMPO DE RESPOSTA: tempo de barramento medido pelo mestre
+      // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
+      if (!lerPeloMestre(device_id, MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1)) return true;
+      saida_console.println("\n⏱️  5. Performance de Comunicação:");
+      
+      unsigned long tempo_resposta = l.duracao_us;
+      if (l.resultado == MB_SUCESSO) {
+        saida_console.printf("  ⚡ Tempo de resposta: %lu μs\n", tempo_resposta);
+        if (tempo_resposta < 50000) { // < 50ms
+          saida_console.println("  ✅ Performance: EXCELENTE");
+        } else if (tempo_resposta < 100000) { // < 100ms
+          saida_console.println("  ✅ Performance: BOA");
+        } else {
+          saida_console.println("  ⚠️  Performance: LENTA");
+        }
+      }
+      
+      saida_console.println("==========================================");
+      return false;
     }
   }
-  
-  Serial.println("==========================================");
-  return sucesso;
+  return false;
 }
 
-// Função SEGURA para teste de stress (múltiplas leituras rápidas)
-void testeStress(ModbusMaster& node, uint8_t device_id, int num_testes = 20) {
-  Serial.printf("\n🏃 TESTE DE STRESS - %d leituras rápidas\n", num_testes);
-  
-  int sucessos = 0;
-  int falhas = 0;
-  unsigned long tempo_total = 0;
-  
-  for (int i = 0; i < num_testes; i++) {
-    unsigned long inicio = millis();
-    // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
-    uint8_t result = node.readInputRegisters(0x0000, 1);
-    unsigned long duracao = millis() - inicio;
-    
-    tempo_total += duracao;
-    
-    if (result == node.ku8MBSuccess) {
-      sucessos++;
-      Serial.printf("  ✅ %d: %dms\n", i+1, (int)duracao);
-    } else {
-      falhas++;
-      Serial.printf("  ❌ %d: ERRO %02X\n", i+1, result);
-    }
-    
-    delay(50); // 50ms entre leituras
-  }
-  
-  float taxa_sucesso = (float)sucessos / num_testes * 100;
-  float tempo_medio = (float)tempo_total / num_testes;
-  
-  Serial.printf("\n📊 RESULTADO DO TESTE:\n");
-  Serial.printf("  Sucessos: %d/%d (%.1f%%)\n", sucessos, num_testes, taxa_sucesso);
-  Serial.printf("  Falhas: %d\n", falhas);
-  Serial.printf("  Tempo médio: %.1fms\n", tempo_medio);
-  
-  if (taxa_sucesso >= 95) {
-    Serial.println("  🏆 QUALIDADE: EXCELENTE");
-  } else if (taxa_sucesso >= 80) {
-    Serial.println("  ✅ QUALIDADE: BOA");
-  } else {
-    Serial.println("  ⚠️  QUALIDADE: PROBLEMÁTICA");
+// Fatia do 'diag': uma etapa do dispositivo atual, depois o próximo
+bool passoDiagnostico() {
+  EstadoDiagnostico& d = diagnostico;
+  if (trabalho.cancelado()) {
+    saida_console.println("🛑 Diagnóstico cancelado");
+    return false;
   }
+  if (etapaDiagnostico(d.ids[d.atual])) return true;
+  d.etapa = DIAG_COMUNICACAO;
+  return ++d.atual < d.num_ids;
 }
 
 // Função SEGURA para análise de dados conforme manuais EXATOS
-void analiseDados(uint8_t device_id, uint16_t valor_principal, uint16_t valor_secundario = 0) {
-  Serial.printf("\n🔬 ANÁLISE DE DADOS - ID %d\n", device_id);
+// 'biruta': tipo sondado na descoberta, não adivinhado pelos valores
+void analiseDados(uint8_t device_id, bool biruta, uint16_t valor_principal, uint16_t valor_secundario = 0) {
+  saida_console.printf("\n🔬 ANÁLISE DE DADOS - ID %d\n", device_id);
   
-  // Análise baseada EXCLUSIVAMENTE nos manuais
-  if (valor_principal <= 7 && valor_secundario > 0 && valor_secundario <= 360) {
+  // Análise baseada EXCLUSIVAMENTE nos manuais (perfis_dispositivo.h)
+  using Direcao = PerfilBiruta::Direcao;
+  using Velocidade = PerfilAnemometro::Velocidade;
+  if (biruta) {
     // BIRUTA: Manual confirma 0x0000 (0-7) e 0x0001 (0-360°)
-    Serial.println("  🧭 TIPO: Sensor de Direção (Biruta)");
-    Serial.printf("  📐 Direção bruta (0-7): %d\n", valor_principal);
-    
-    String direcoes[] = {"Norte (0°)", "Nordeste (45°)", "Leste (90°)", "Sudeste (135°)",
-                        "Sul (180°)", "Sudoeste (225°)", "Oeste (270°)", "Noroeste (315°)"};
-    
-    if (valor_principal < 8) {
-      Serial.printf("  🧭 Direção: %s\n", direcoes[valor_principal].c_str());
-    }
-    
-    Serial.printf("  📐 Direção em graus: %d°\n", valor_secundario);
-    
-    // Verificações conforme manual da biruta
-    if (valor_principal > 7) {
-      Serial.println("  ⚠️  ALERTA: Valor fora da faixa do manual (0-7)");
-    }
-    if (valor_secundario > 360) {
-      Serial.println("  ⚠️  ALERTA: Graus fora da faixa do manual (0-360°)");
-    }
+    saida_console.println("  🧭 TIPO: Sensor de Direção (Biruta)");
+    saida_console.printf("  📐 Direção bruta (%d-%d): %d\n", Direcao::minimo, Direcao::maximo, valor_principal);
+    saida_console.printf("  🧭 Direção: %s (%d°)\n", nomeDirecao(PerfilBiruta::Cardinal::converter(valor_principal)),
+                         valor_principal * PerfilBiruta::GRAUS_POR_SETOR);
+    saida_console.printf("  📐 Direção em graus: %d°\n", valor_secundario);
     
   } else {
     // ANEMÔMETRO: Manual confirma apenas 0x0000 (valor × 10 = m/s)
-    Serial.println("  💨 TIPO: Sensor de Velocidade (Anemômetro)");
+    saida_console.println("  💨 TIPO: Sensor de Velocidade (Anemômetro)");
     
-    float velocidade = valor_principal / 10.0; // Conforme manual: "valor × 10 = m/s real"
-    Serial.printf("  💨 Velocidade: %.1f m/s\n", velocidade);
+    float velocidade = Velocidade::converter(valor_principal); // Conforme manual: "valor × 10 = m/s real"
+    saida_console.printf("  💨 Velocidade: %.1f m/s\n", velocidade);
     
     // Conversões úteis
     float kmh = velocidade * 3.6;
     float mph = velocidade * 2.237;
-    Serial.printf("  🏃 Em km/h: %.1f\n", kmh);
-    Serial.printf("  🏃 Em mph: %.1f\n", mph);
+    saida_console.printf("  🏃 Em km/h: %.1f\n", kmh);
+    saida_console.printf("  🏃 Em mph: %.1f\n", mph);
     
     // Escala Beaufort
-    int beaufort;
-    String descricao;
+    int beaufort = 0;
+    while (velocidade >= ESCALA_BEAUFORT[beaufort].limite) beaufort++;
     
-    if (velocidade < 0.3) { beaufort = 0; descricao = "Calmaria"; }
-    else if (velocidade < 1.6) { beaufort = 1; descricao = "Aragem"; }
-    else if (velocidade < 3.4) { beaufort = 2; descricao = "Brisa leve"; }
-    else if (velocidade < 5.5) { beaufort = 3; descricao = "Brisa fraca"; }
-    else if (velocidade < 8.0) { beaufort = 4; descricao = "Brisa moderada"; }
-    else if (velocidade < 10.8) { beaufort = 5; descricao = "Brisa fresca"; }
-    else if (velocidade < 13.9) { beaufort = 6; descricao = "Brisa forte"; }
-    else if (velocidade < 17.2) { beaufort = 7; descricao = "Vento moderado"; }
-    else if (velocidade < 20.8) { beaufort = 8; descricao = "Vento fresco"; }
-    else if (velocidade < 24.5) { beaufort = 9; descricao = "Vento forte"; }
-    else if (velocidade < 28.5) { beaufort = 10; descricao = "Temporal"; }
-    else if (velocidade < 32.7) { beaufort = 11; descricao = "Tempestade"; }
-    else { beaufort = 12; descricao = "Furacão"; }
-    
-    Serial.printf("  🌪️  Beaufort: %d (%s)\n", beaufort, descricao.c_str());
+    saida_console.printf("  🌪️  Beaufort: %d (%s)\n", beaufort, ESCALA_BEAUFORT[beaufort].descricao);
     
     // Verificações conforme manual do anemômetro (0-70 m/s)
-    if (velocidade > 70) {
-      Serial.println("  ⚠️  ALERTA: Velocidade acima do limite do manual (70 m/s)");
+    if (!Velocidade::naFaixa(valor_principal)) {
+      saida_console.printf("  ⚠️  ALERTA: Velocidade acima do limite do manual (%.0f m/s)\n",
+                           Velocidade::converter(Velocidade::maximo));
     }
     if (valor_principal == 0) {
-      Serial.println("  ℹ️  INFO: Vento calmo (≤0.2 m/s conforme manual)");
+      saida_console.println("  ℹ️  INFO: Vento calmo (≤0.2 m/s conforme manual)");
+    }
+  }
+}
+
+// Monta os planos de leitura dos sensores principais
+void configurarPlanos() {
+  plano_anemometro.limpar();
+  if (anemometro_connected) {
+    plano_anemometro.adicionarBloco<PerfilAnemometro::Dados>(anemometro_id);
+  }
+  if (!plano_anemometro.compilar()) LOG_ERRO("plano", "❌ Plano do anemômetro não cabe em %d transações", PLANO_MAX_TRANSACOES);
+
+  plano_biruta.limpar();
+  if (biruta_connected) {
+    plano_biruta.adicionarBloco<PerfilBiruta::Dados>(biruta_id);
+  }
+  if (!plano_biruta.compilar()) LOG_ERRO("plano", "❌ Plano da biruta não cabe em %d transações", PLANO_MAX_TRANSACOES);
+
+  escalonador.ativar(fonte_anemometro, anemometro_connected);
+  escalonador.ativar(fonte_biruta, biruta_connected);
+  escalonador.ativar(fonte_reconexao, anemometro_connected || biruta_connected);
+  saude_anemometro.reiniciar();
+  saude_biruta.reiniciar();
+
+  // Demais dispositivos do barramento 0: leitura em rodízio no tempo livre
+  bool ha_outros = false;
+  for (uint16_t i = 0; i < registro.quantidade(0); i++) {
+    if (!registro.dispositivo(0, i).principal) ha_outros = true;
+  }
+  escalonador.ativar(fonte_dispositivos, ha_outros);
+}
+
+// Coloca o dispositivo no registro; os primeiros anemômetro e biruta do
+// barramento 0 viram os sensores principais
+void adicionarAoRegistro(const DeviceInfo& device, uint16_t valor_principal) {
+  // Pronto antes de entrar: as outras tarefas podem copiá-lo logo em seguida
+  Dispositivo novo;
+  novo.info = device;
+  novo.valores[0] = valor_principal;
+  bool anemometro = device.barramento == 0 && !anemometro_connected && ehAnemometro(device.tipo);
+  bool biruta = device.barramento == 0 && !biruta_connected && device.tipo == TIPO_BIRUTA;
+  novo.principal = anemometro || biruta;
+  if (!registro.adicionar(novo)) return;
+
+  if (anemometro) {
+    anemometro_id = device.id;
+    anemometro_connected = true;
+    current_baud_rate = device.baud_rate;
+    saida_console.printf("  🎯 Configurado como ANEMÔMETRO principal\n");
+  }
+
+  if (biruta) {
+    biruta_id = device.id;
+    biruta_connected = true;
+    if (!anemometro_connected) current_baud_rate = device.baud_rate;
+    saida_console.printf("  🎯 Configurado como BIRUTA principal\n");
+  }
+}
+
+// Registra cada dispositivo assim que responde na varredura. 'contexto' não
+// nulo: varredura em segundo plano na tarefa do barramento, que não escreve
+// no console (saida_console tem um só produtor, a aquisição).
+void registrarDispositivo(const DispositivoEncontrado& encontrado, void* contexto) {
+  bool relatar = contexto == nullptr;
+  uint8_t barramento = encontrado.barramento;
+  if (relatar) {
+    saida_console.printf("✅ Dispositivo ID %d respondeu em %d bps no barramento %d (%lu μs)\n",
+                         encontrado.id, encontrado.baud_rate, barramento, (unsigned long)encontrado.latencia_us);
+  }
+
+  if (registro.quantidade(barramento) >= REGISTRO_MAX_POR_BARRAMENTO) {
+    if (relatar) {
+      saida_console.printf("  ⚠️  Registro cheio (%d dispositivos no barramento %d), ID %d ignorado\n",
+                           REGISTRO_MAX_POR_BARRAMENTO, barramento, encontrado.id);
     }
+    return;
+  }
+
+  DeviceInfo device;
+  device.id = encontrado.id;
+  device.barramento = barramento;
+  device.baud_rate = encontrado.baud_rate;
+  device.ativo = true;
+
+  // Registradores 0x07D0 (endereço) e 0x07D1 (baud rate) numa única leitura
+  using Configuracao = PerfilConfiguracao::Dados;
+  uint16_t config[Configuracao::quantidade];
+  ResultadoLeitura r = modbusLerComTimeout(encontrado.id, Configuracao::funcao, Configuracao::inicio,
+                                           Configuracao::quantidade, config, config_descoberta.turnaround_us,
+                                           barramento);
+  if (r.codigo == MB_SUCESSO) Configuracao::decodificar(config, device);
+
+  // Tipo sondado pela descoberta: 0x0001 só existe na biruta
+  uint16_t valor_principal = encontrado.valor_principal;
+  device.tipo = encontrado.tipo;
+  if (relatar) saida_console.printf("  📊 Valor principal: %d -> Tipo: %s\n", valor_principal, nomeTipo(device.tipo));
+  adicionarAoRegistro(device, valor_principal);
+}
+
+// Volta ao baud rate do barramento depois da varredura: o dos sensores
+// principais no barramento 0, o do primeiro dispositivo encontrado nos outros
+void restaurarBaud(uint8_t barramento) {
+  uint32_t baud = config_descoberta.baud_rates[0];
+  if (registro.quantidade(barramento)) baud = registro.dispositivo(barramento, 0).info.baud_rate;
+  if (barramento == 0) {
+    if (anemometro_connected || biruta_connected) baud = current_baud_rate;
+    current_baud_rate = baud;
   }
+  halRs485Iniciar(barramento, baud);
+}
+
+// Configuração da varredura de um barramento
+ConfigDescoberta configDescoberta(uint8_t barramento) {
+  ConfigDescoberta config = config_descoberta;
+  config.barramento = barramento;
+  return config;
+}
+
+// Fim da varredura de um barramento: resumo e baud rate de volta
+void concluirVarredura(uint8_t barramento) {
+  Descoberta& descoberta = descobertas[barramento];
+  saida_console.printf("⏱️  Barramento %d: %lu ms, %lu sondas, %d baud rates abandonados por lixo\n", barramento,
+                       (unsigned long)descoberta.duracaoMs(), (unsigned long)descoberta.sondas(),
+                       descoberta.baudsAbandonados());
+  restaurarBaud(barramento);
+}
+
+// Varredura bloqueante de um barramento, com o seu mestre ocioso
+void varrerBarramento(uint8_t barramento) {
+  registro.limpar(barramento);
+  Descoberta& descoberta = descobertas[barramento];
+  descoberta.iniciar(configDescoberta(barramento), registrarDispositivo);
+  descoberta.executar();
+  concluirVarredura(barramento);
 }
 
-// Detecção automática e SEGURA de dispositivos
+// Início de uma detecção: os sensores principais só voltam quando a
+// varredura do barramento 0 os encontrar de novo
+void iniciarDeteccao() {
+  saida_console.println("🔍 Iniciando detecção SEGURA de dispositivos...");
+  saida_console.println("(Apenas operações de LEITURA - sem risco aos equipamentos)");
+  saida_console.printf("IDs %d-%d, %d baud rates, %d barramento(s)\n", config_descoberta.id_inicial,
+                       config_descoberta.id_final, config_descoberta.num_baud_rates, num_barramentos);
+
+  anemometro_connected = false;
+  biruta_connected = false;
+}
+
+// Barramento extra com a tarefa rodando: a varredura fica com ela
+void pedirVarredura(uint8_t barramento) {
+  varredura_pedida[barramento] = true;
+  saida_console.printf("🔄 Barramento %d: varredura em segundo plano (ver 'info')\n", barramento);
+}
+
+// Detecção automática e SEGURA de dispositivos. O barramento 0 é varrido na
+// hora; os extras também, antes das tarefas existirem, e depois pelas suas tarefas.
 bool detectarDispositivos() {
-  Serial.println("🔍 Iniciando detecção SEGURA de dispositivos...");
-  Serial.println("(Apenas operações de LEITURA - sem risco aos equipamentos)");
-  
-  num_dispositivos = 0;
-  
-  for (int b = 0; b < num_baud_rates; b++) {
-    uint32_t baud = baud_rates[b];
-    Serial.printf("\n🔍 Testando baud rate: %d bps\n", baud);
-    
-    for (int i = 0; i < num_ids; i++) {
-      uint8_t test_id = possible_ids[i];
-      
-      // Testar com nodeAnemometro
-      if (testModbusConnection(nodeAnemometro, test_id, 0x0000, baud)) {
-        DeviceInfo device;
-        device.id = test_id;
-        device.baud_rate = baud;
-        device.ativo = true;
-        
-        // Ler configuração e fazer diagnóstico completo
-        diagnosticoCompleto(nodeAnemometro, test_id, device);
-        
-        // Tentar determinar o tipo baseado nos dados e análise detalhada
-        // CORRIGIDO: usar readInputRegisters para dados (conforme manual)
-        uint8_t result = nodeAnemometro.readInputRegisters(0x0000, 1);
-        if (result == nodeAnemometro.ku8MBSuccess) {
-          uint16_t valor_principal = nodeAnemometro.getResponseBuffer(0);
-          
-          // Tentar ler segundo registrador para biruta
-          uint16_t valor_secundario = 0;
-          uint8_t result2 = nodeAnemometro.readInputRegisters(0x0001, 1);
-          if (result2 == nodeAnemometro.ku8MBSuccess) {
-            valor_secundario = nodeAnemometro.getResponseBuffer(0);
-          }
-          
-          // Análise detalhada dos dados
-          analiseDados(test_id, valor_principal, valor_secundario);
-          
-          // Heurística melhorada para determinar tipo
-          if (valor_principal <= 7) {
-            device.tipo = "BIRUTA (direção 0-7)";
-          } else if (valor_principal > 700) {
-            device.tipo = "ANEMÔMETRO (velocidade alta)";
-          } else {
-            device.tipo = "ANEMÔMETRO (velocidade baixa)";
-          }
-          
-          Serial.printf("  📊 Valor principal: %d -> Tipo: %s\n", valor_principal, device.tipo.c_str());
-        } else {
-          device.tipo = "DESCONHECIDO";
-        }
-        
-        dispositivos_detectados[num_dispositivos] = device;
-        num_dispositivos++;
-        
-        // Configurar como dispositivos principais se for o primeiro encontrado
-        if (!anemometro_connected && device.tipo.startsWith("ANEMÔ")) {
-          anemometro_id = test_id;
-          anemometro_connected = true;
-          current_baud_rate = baud;
-          Serial.printf("  🎯 Configurado como ANEMÔMETRO principal\n");
-        }
-        
-        if (!biruta_connected && device.tipo.startsWith("BIRUTA")) {
-          biruta_id = test_id;
-          biruta_connected = true;
-          if (!anemometro_connected) current_baud_rate = baud;
-          Serial.printf("  🎯 Configurado como BIRUTA principal\n");
-        }
-      }
-      
-      delay(200); // Pequena pausa entre testes
+  iniciarDeteccao();
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    if (b == 0 || !tarefas_iniciadas) {
+      varrerBarramento(b);
+    } else {
+      pedirVarredura(b);
     }
   }
-  
-  return (num_dispositivos > 0);
+
+  configurarPlanos();
+  return registro.total() > 0;
 }
 
-// Leitura SEGURA do anemômetro
-// Leitura SEGURA do anemômetro conforme manual EXATO
-bool lerAnemometro() {
-  if (!anemometro_connected) return false;
-  
-  Serial.printf("💨 Lendo anemômetro ID %d...\n", anemometro_id);
-  
-  nodeAnemometro.begin(anemometro_id, Serial2);
-  
-  // Manual do anemômetro especifica INPUT REGISTER 0x0000
-  uint8_t result = nodeAnemometro.readInputRegisters(0x0000, 1);
-  
-  if (result == nodeAnemometro.ku8MBSuccess) {
-    uint16_t raw_value = nodeAnemometro.getResponseBuffer(0);
-    dados.wind_speed = raw_value / 10.0; // Manual: "valor × 10 = m/s real"
-    
+// Grava a tabela na NVS se ela mudou desde a última gravação
+void salvarCache() {
+  if (cache_dispositivos.salvar(registro, num_barramentos)) {
+    saida_console.printf("💾 Cache de descoberta gravado: %u dispositivos\n", (unsigned)cache_dispositivos.quantidade());
+  }
+}
+
+// Boot a quente: confere cada dispositivo do cache com uma única leitura e
+// procura de novo, em todos os baud rates, só os IDs que não responderam.
+// false sem cache ou se nenhum dispositivo foi encontrado (varredura completa).
+bool restaurarDoCache() {
+  if (!cache_dispositivos.carregar() || !cache_dispositivos.quantidade()) return false;
+  uint32_t inicio = millis();
+  saida_console.printf("💾 Cache de descoberta: %u dispositivos, conferindo...\n", (unsigned)cache_dispositivos.quantidade());
+
+  anemometro_connected = false;
+  biruta_connected = false;
+  for (uint8_t b = 0; b < num_barramentos; b++) registro.limpar(b);
+
+  static uint16_t ausentes[CACHE_MAX_ENTRADAS];
+  uint16_t num_ausentes = 0;
+  for (uint16_t i = 0; i < cache_dispositivos.quantidade(); i++) {
+    const EntradaCache& e = cache_dispositivos.entrada(i);
+    if (e.barramento >= num_barramentos) continue;   // Barramento fora de uso neste build
+    if (halRs485Baud(e.barramento) != e.baud_rate) halRs485Iniciar(e.barramento, e.baud_rate);
+
+    // A mesma sonda da varredura (0x0000, função 03)
+    uint16_t valor = 0;
+    ResultadoLeitura r = modbusLerComTimeout(e.id, MB_FC_READ_HOLDING, REGISTRADOR_PRINCIPAL, 1, &valor,
+                                             config_descoberta.turnaround_us, e.barramento);
+    if (r.codigo == MB_SUCESSO || r.codigo < MB_ERRO_ID_INVALIDO) {
+      saida_console.printf("✅ ID %d confirmado em %lu bps no barramento %d\n", e.id, (unsigned long)e.baud_rate, e.barramento);
+      adicionarAoRegistro(CacheDescoberta::paraDeviceInfo(e), r.codigo == MB_SUCESSO ? valor : 0);
+    } else {
+      ausentes[num_ausentes++] = i;
+    }
+  }
+
+  // Varredura dirigida: cada ausente no seu barramento, em todos os baud rates
+  for (uint16_t k = 0; k < num_ausentes; k++) {
+    const EntradaCache& e = cache_dispositivos.entrada(ausentes[k]);
+    saida_console.printf("🔍 ID %d não respondeu em %lu bps, procurando nos outros baud rates...\n",
+                         e.id, (unsigned long)e.baud_rate);
+    ConfigDescoberta config = configDescoberta(e.barramento);
+    config.id_inicial = e.id;
+    config.id_final = e.id;
+    config.esperados = 1;
+    Descoberta descoberta;
+    descoberta.iniciar(config, registrarDispositivo);
+    descoberta.executar();
+    if (!descoberta.encontrados()) saida_console.printf("  ⚠️  ID %d ausente\n", e.id);
+  }
+
+  for (uint8_t b = 0; b < num_barramentos; b++) restaurarBaud(b);
+  configurarPlanos();
+  saida_console.printf("⏱️  Cache conferido em %lu ms: %u de %u dispositivos, %u procurados de novo\n",
+                       (unsigned long)(millis() - inicio), (unsigned)registro.total(),
+                       (unsigned)cache_dispositivos.quantidade(), (unsigned)num_ausentes);
+  return registro.total() > 0;
+}
+
+// Mudança de estado vinda de registrar(): só o log, que não bloqueia
+void avisarSaude(const char* nome, uint8_t id, const SaudeDispositivo& saude) {
+  switch (saude.estado()) {
+    case SAUDE_FORA:
+      LOG_AVISO(nome, "⚠️  ID %d sem resposta após %u tentativas: fora das leituras, sonda a cada %lu s", id,
+                saude.falhasSeguidas(), (unsigned long)(config_saude.intervalo_sonda_ms / 1000));
+      break;
+    case SAUDE_SUSPEITO:
+      LOG_DEPURACAO(nome, "ID %d falhou: nova tentativa em %lu ms", id,
+                    (unsigned long)(saude.proximaMs() - millis()));
+      break;
+    case SAUDE_OK:
+      LOG_INFO(nome, "✅ ID %d respondeu de novo (%lu reconexões)", id, (unsigned long)saude.reconexoes());
+      break;
+  }
+}
+
+// Resultado de uma leitura na saúde do dispositivo; avisa quando ele cai ou volta
+void registrarSaude(const char* nome, uint8_t id, SaudeDispositivo& saude, uint8_t resultado, uint32_t duracao_us) {
+  if (!saude.registrar(resultado, duracao_us, millis(), config_saude)) return;
+  avisarSaude(nome, id, saude);
+}
+
+// Confere uma leitura do anemômetro já concluída: avisa acima da faixa do
+// manual (0-70 m/s) e registra a falha; true se o sensor respondeu
+bool validarAnemometro(uint8_t result, const SensorData& leitura) {
+  if (result == MB_SUCESSO) {
     // Validação conforme manual (0-70 m/s)
-    if (dados.wind_speed > 70.0) {
-      Serial.printf("⚠️  Velocidade acima do limite do manual (70 m/s): %.1f\n", dados.wind_speed);
+    constexpr float VENTO_MAXIMO = PerfilAnemometro::Velocidade::converter(PerfilAnemometro::Velocidade::maximo);
+    if (leitura.wind_speed > VENTO_MAXIMO) {
+      LOG_AVISO("anemometro", "⚠️  Velocidade acima do limite do manual (%.0f m/s): %.1f", VENTO_MAXIMO,
+                leitura.wind_speed);
     }
     
     return true;
   } else {
-    Serial.printf("❌ Erro ao ler anemômetro: %02X\n", result);
+    LOG_ERRO("anemometro", "❌ Erro ao ler anemômetro: %02X", result);
     return false;
   }
 }
 
-// Leitura SEGURA da biruta conforme manual EXATO
-bool lerBiruta() {
-  if (!biruta_connected) return false;
-  
-  // Manual da biruta especifica INPUT REGISTERS, não holding
-  Serial.printf("🧭 Lendo biruta ID %d...\n", biruta_id);
-  
-  nodeBiruta.begin(biruta_id, Serial2);
-  
-  // Ler registro 0x0000 (direção 0-7)
-  uint8_t result1 = nodeBiruta.readInputRegisters(0x0000, 1);
-  if (result1 != nodeBiruta.ku8MBSuccess) {
-    Serial.printf("❌ Erro ao ler registro 0x0000: %02X\n", result1);
+bool lerAnemometro() {
+  if (!anemometro_connected) return false;
+  if (!saude_anemometro.podeLer(millis())) {
+    saude_anemometro.pular();   // Em espera ou fora: nem ocupa o barramento
     return false;
   }
-  dados.wind_direction_raw = nodeBiruta.getResponseBuffer(0);
   
-  // Ler registro 0x0001 (direção em graus 0-360°)
-  uint8_t result2 = nodeBiruta.readInputRegisters(0x0001, 1);
-  if (result2 != nodeBiruta.ku8MBSuccess) {
-    Serial.printf("❌ Erro ao ler registro 0x0001: %02X\n", result2);
+  LOG_DEPURACAO("anemometro", "💨 Lendo anemômetro ID %d...", anemometro_id);
+  
+  // Manual do anemômetro especifica INPUT REGISTER 0x0000
+  uint32_t inicio = micros();
+  uint8_t resultado = plano_anemometro.executar(dados);
+  registrarSaude("anemometro", anemometro_id, saude_anemometro, resultado, micros() - inicio);
+  return validarAnemometro(resultado, dados);
+}
+
+// Confere uma leitura da biruta já concluída: avisa fora das faixas do manual
+// (direção 0-7, graus 0-360) e registra a falha; true se o sensor respondeu
+bool validarBiruta(uint8_t result, const SensorData& leitura) {
+  if (result != MB_SUCESSO) {
+    LOG_ERRO("biruta", "❌ Erro ao ler registros 0x0000-0x0001: %02X", result);
     return false;
   }
-  dados.wind_direction_degrees = nodeBiruta.getResponseBuffer(0);
   
-  // Validações conforme manual
-  if (dados.wind_direction_raw > 7) {
-    Serial.printf("⚠️  Direção bruta fora da faixa (0-7): %d\n", dados.wind_direction_raw);
+  // Validações conforme manual; a direção cardinal já vem do perfil
+  using Direcao = PerfilBiruta::Direcao;
+  using Graus = PerfilBiruta::Graus;
+  if (!Direcao::naFaixa(leitura.wind_direction_raw)) {
+    LOG_AVISO("biruta", "⚠️  Direção bruta fora da faixa (%d-%d): %d", Direcao::minimo, Direcao::maximo,
+              leitura.wind_direction_raw);
   }
   
-  if (dados.wind_direction_degrees > 360) {
-    Serial.printf("⚠️  Direção em graus fora da faixa (0-360): %d\n", dados.wind_direction_degrees);
+  if (!Graus::naFaixa(leitura.wind_direction_degrees)) {
+    LOG_AVISO("biruta", "⚠️  Direção em graus fora da faixa (%d-%d): %d", Graus::minimo, Graus::maximo,
+              leitura.wind_direction_degrees);
   }
-  
-  dados.wind_direction_cardinal = getWindDirection(dados.wind_direction_raw);
   return true;
 }
 
-// Leitura de temperatura
-void lerTemperatura() {
-  dados.temperature = thermocouple.readCelsius();
-  if (isnan(dados.temperature)) {
-    Serial.println("⚠️  Erro ao ler temperatura MAX6675");
-    dados.temperature = -999;
+bool lerBiruta() {
+  if (!biruta_connected) return false;
+  if (!saude_biruta.podeLer(millis())) {
+    saude_biruta.pular();
+    return false;
   }
+  
+  // Manual da biruta especifica INPUT REGISTERS, não holding
+  LOG_DEPURACAO("biruta", "🧭 Lendo biruta ID %d...", biruta_id);
+  
+  // Registros 0x0000 (direção 0-7) e 0x0001 (graus 0-360°) numa única transação
+  uint32_t inicio = micros();
+  uint8_t resultado = plano_biruta.executar(dados);
+  registrarSaude("biruta", biruta_id, saude_biruta, resultado, micros() - inicio);
+  return validarBiruta(resultado, dados);
 }
 
-// Leitura do sensor UV
+// Leitura de temperatura (NAN em caso de erro, tratado no processamento)
+void lerTemperatura() {
+  dados.temperature = halLerTemperatura();
+}
+
+// Leitura do sensor UV: resultado filtrado do período, calibrado em mV.
+// Sem amostras novas (ADC parado) mantém o último valor.
 void lerUV() {
-  int uv_raw = analogRead(UV_SENSOR_PIN);
-  dados.uv_index = map(uv_raw, 0, 4095, 0, 15); // Mapear para índice UV 0-15
+  SaidaFiltro saida;
+  if (!filtro_uv.retirar(saida)) return;
+  float mv = halAdcMilivolts(saida.codigo);
+  float mv_por_codigo = halAdcMilivolts(saida.codigo + 1.0f) - mv;
+  dados.uv_index = mv / UV_MV_POR_INDICE;
+  dados.uv_noise = saida.ruido * mv_por_codigo / UV_MV_POR_INDICE;
+}
+
+// Esvazia o buffer do DMA no filtro (só somas inteiras por amostra)
+void drenarAdc() {
+  uint16_t codigos[256];
+  size_t n;
+  while ((n = halAdcLer(codigos, 256)) > 0) {
+    filtro_uv.processar(codigos, n);
+  }
+}
+
+// Resumo de um barramento: dispositivos, baud rate e leituras do mestre.
+// 'saida': a Serial no relatório da tarefa de saída, saida_console nos comandos.
+template <typename Saida>
+void mostrarBarramento(Saida& saida, uint8_t barramento) {
+  const MestreModbusAsync& mestre = mestres[barramento];
+  saida.printf("🔌 Barramento %d: %u dispositivos, %lu bps, %lu transações, %lu timeouts%s\n", barramento,
+               (unsigned)registro.quantidade(barramento), (unsigned long)halRs485Baud(barramento),
+               (unsigned long)mestre.transacoes(), (unsigned long)mestre.timeouts(),
+               descobertas[barramento].ativa() ? " (varredura em andamento)" : "");
 }
 
-// Função SEGURA para mostrar dispositivos detectados
-void mostrarDispositivosDetectados() {
-  Serial.println("\n📋 RELATÓRIO DE DISPOSITIVOS DETECTADOS");
-  Serial.println("==========================================");
+// Função SEGURA para mostrar dispositivos detectados (uma linha por dispositivo)
+template <typename Saida>
+void mostrarDispositivosDetectados(Saida& saida) {
+  saida.println("\n📋 RELATÓRIO DE DISPOSITIVOS DETECTADOS");
+  saida.println("==========================================");
   
-  if (num_dispositivos == 0) {
-    Serial.println("❌ Nenhum dispositivo encontrado!");
+  if (registro.total() == 0) {
+    saida.println("❌ Nenhum dispositivo encontrado!");
     return;
   }
   
-  for (int i = 0; i < num_dispositivos; i++) {
-    DeviceInfo& dev = dispositivos_detectados[i];
-    Serial.printf("\n🏷️  DISPOSITIVO %d:\n", i + 1);
-    Serial.printf("   ID: %d\n", dev.id);
-    Serial.printf("   Baud Rate: %d bps\n", dev.baud_rate);
-    Serial.printf("   Tipo: %s\n", dev.tipo.c_str());
-    Serial.printf("   Config ID: %d\n", dev.config_id);
-    Serial.printf("   Config Baud: %d\n", dev.config_baud);
-    Serial.printf("   Status: %s\n", dev.ativo ? "ATIVO" : "INATIVO");
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    mostrarBarramento(saida, b);
+    for (uint16_t i = 0; i < registro.quantidade(b); i++) {
+      Dispositivo d;   // Tarefa de saída: cópia, a partição pode estar sendo refeita
+      if (!registro.copiar(b, i, d)) continue;
+      const DeviceInfo& dev = d.info;
+      saida.printf("  🏷️  ID %3d | %6lu bps | %-30s | config ID %d, baud %s | ", dev.id,
+                   (unsigned long)dev.baud_rate, nomeTipo(dev.tipo), dev.config_id, nomeCodigoBaud(dev.config_baud));
+      if (d.principal) {
+        saida.println("principal");
+      } else {
+        saida.printf("%lu leituras, %lu falhas, 0x0000 = %u, %s\n", (unsigned long)d.leituras,
+                     (unsigned long)d.falhas, d.valores[0], nomeSaude(d.saude.estado()));
+      }
+    }
   }
   
-  Serial.println("==========================================");
+  saida.println("==========================================");
 }
 
 // Função SEGURA para monitoramento contínuo
@@ -529,233 +849,604 @@ void monitorarContinuo() {
   
   // Mostrar relatório a cada 30 segundos
   if (agora - ultimo_relatorio > 30000) {
-    mostrarDispositivosDetectados();
+    if (registro.total() <= MONITOR_MAX_DISPOSITIVOS) {
+      mostrarDispositivosDetectados(Serial);
+    } else {
+      for (uint8_t b = 0; b < num_barramentos; b++) mostrarBarramento(Serial, b);
+    }
     ultimo_relatorio = agora;
   }
 }
 
-void setup() {
-  Serial.begin(115200);
-  Serial.println("🌪️  === SISTEMA DE MONITORAMENTO METEOROLÓGICO SEGURO ===");
-  Serial.println("✅ Apenas operações de LEITURA - sem risco aos equipamentos");
-  Serial.println("Iniciando...");
-  
-  // Configurar pino DE/RE
-  pinMode(RS485_DE_RE_PIN, OUTPUT);
-  digitalWrite(RS485_DE_RE_PIN, LOW);
-  
-  // Configurar sensor UV
-  pinMode(UV_SENSOR_PIN, INPUT);
-  
-  // Detectar dispositivos automaticamente (SEGURO)
-  if (detectarDispositivos()) {
-    Serial.println("✅ Sistema inicializado com sucesso!");
-    
-    // Mostrar relatório inicial
-    mostrarDispositivosDetectados();
-    
-    // Configurar comunicação com baud rate detectado
-    if (anemometro_connected || biruta_connected) {
-      Serial2.begin(current_baud_rate, SERIAL_8N1, 16, 17);
-      
-      if (anemometro_connected) {
-        nodeAnemometro.begin(anemometro_id, Serial2);
-        Serial.printf("🎯 Anemômetro configurado: ID %d, %d bps\n", anemometro_id, current_baud_rate);
-      }
-      
-      if (biruta_connected) {
-        nodeBiruta.begin(biruta_id, Serial2);
-        Serial.printf("🎯 Biruta configurada: ID %d, %d bps\n", biruta_id, current_baud_rate);
-      }
-    }
-    
+// Entrega a amostra ao processamento sem esperar por ele. 'fontes' marca as
+// leituras que acabaram de ser atualizadas (bit = índice da fonte); o carimbo
+// de tempo é o da captura, não o da publicação.
+void publicarAmostra(uint8_t fontes, uint32_t captura_us) {
+  Amostra amostra;
+  amostra.dados = dados;
+  amostra.dados.timestamp_us = captura_us;
+  amostra.dados.timestamp = millis() - (micros() - captura_us) / 1000;
+  amostra.fontes = fontes;
+  amostra.resultado_anemometro = resultado_anemometro;
+  amostra.resultado_biruta = resultado_biruta;
+  // Sensor fora (sem resposta, só sondado) conta como desconectado
+  amostra.anemometro_conectado = anemometro_connected && saude_anemometro.estado() != SAUDE_FORA;
+  amostra.biruta_conectada = biruta_connected && saude_biruta.estado() != SAUDE_FORA;
+  amostra.baud_rate = current_baud_rate;
+  amostra.sequencia = ++amostras_publicadas;
+  fila_amostras.inserir(amostra);  // Cheia: descarta e conta, nunca bloqueia
+}
+
+bool atualizou(const Amostra& amostra, int8_t fonte) {
+  return fonte >= 0 && (amostra.fontes & (1u << fonte));
+}
+
+// Marca o boot até a primeira leitura válida do vento
+void marcarPrimeiraAmostra(uint8_t resultado) {
+  if (resultado == MB_SUCESSO && !primeira_amostra_ms) primeira_amostra_ms = millis();
+}
+
+// Atraso da captura em relação à liberação do período atual da fonte
+void registrarCaptura(int8_t fonte, uint32_t captura_us) {
+  if (fonte < 0) return;
+  const FonteAmostragem& f = escalonador.fonte(fonte);
+  jitter_fontes[fonte].registrar(relogio.instanteUs(f.liberacao_ms), captura_us, f.periodo_ms * 1000);
+}
+
+// Fontes do escalonador. Rodam na tarefa de aquisição, por isso não escrevem
+// na Serial (o log só enfileira): as leituras Modbus vão para a fila do
+// mestre e terminam no callback; os sensores locais são lidos na hora.
+void aoLerAnemometro(uint8_t resultado, void* contexto) {
+  (void)contexto;
+  uint32_t captura_us = mestres[0].capturaUs();
+  resultado_anemometro = resultado;
+  registrarSaude("anemometro", anemometro_id, saude_anemometro, resultado, plano_anemometro.duracaoUs());
+  marcarPrimeiraAmostra(resultado);
+  if (resultado == MB_SUCESSO) registrarCaptura(fonte_anemometro, captura_us);
+  else LOG_DEPURACAO("anemometro", "Leitura periódica falhou: %02X", resultado);
+  escalonador.concluir(fonte_anemometro, relogio.agoraMs());
+  publicarAmostra(1u << fonte_anemometro, captura_us);
+}
+
+// Sensor em espera após uma falha ou fora: o período passa sem ocupar o
+// barramento e sem amostra nova
+InicioFonte pularLeitura(SaudeDispositivo& saude) {
+  saude.pular();
+  return FONTE_CONCLUIDA;
+}
+
+InicioFonte iniciarAnemometro(uint8_t fonte, void* contexto) {
+  (void)fonte;
+  (void)contexto;
+  // Manual do anemômetro especifica INPUT REGISTER 0x0000
+  if (!plano_anemometro.numTransacoes()) return FONTE_CONCLUIDA;
+  if (!saude_anemometro.podeLer(millis())) return pularLeitura(saude_anemometro);
+  return plano_anemometro.enfileirar(mestres[0], dados, aoLerAnemometro) ? FONTE_INICIADA : FONTE_OCUPADA;
+}
+
+void aoLerBiruta(uint8_t resultado, void* contexto) {
+  (void)contexto;
+  uint32_t captura_us = mestres[0].capturaUs();
+  resultado_biruta = resultado;
+  registrarSaude("biruta", biruta_id, saude_biruta, resultado, plano_biruta.duracaoUs());
+  marcarPrimeiraAmostra(resultado);
+  if (resultado == MB_SUCESSO) registrarCaptura(fonte_biruta, captura_us);
+  else LOG_DEPURACAO("biruta", "Leitura periódica falhou: %02X", resultado);
+  escalonador.concluir(fonte_biruta, relogio.agoraMs());
+  publicarAmostra(1u << fonte_biruta, captura_us);
+}
+
+InicioFonte iniciarBiruta(uint8_t fonte, void* contexto) {
+  (void)fonte;
+  (void)contexto;
+  // Registros 0x0000 (direção 0-7) e 0x0001 (graus 0-360°) numa única transação
+  if (!plano_biruta.numTransacoes()) return FONTE_CONCLUIDA;
+  if (!saude_biruta.podeLer(millis())) return pularLeitura(saude_biruta);
+  return plano_biruta.enfileirar(mestres[0], dados, aoLerBiruta) ? FONTE_INICIADA : FONTE_OCUPADA;
+}
+
+void aoLerDispositivo(const Dispositivo& dispositivo, void* contexto) {
+  (void)contexto;
+  if (dispositivo.saude.mudou()) avisarSaude("dispositivos", dispositivo.info.id, dispositivo.saude);
+  registrarCaptura(fonte_dispositivos, mestres[0].capturaUs());
+  escalonador.concluir(fonte_dispositivos, relogio.agoraMs());
+}
+
+InicioFonte iniciarDispositivos(uint8_t fonte, void* contexto) {
+  (void)fonte;
+  (void)contexto;
+  // Próximo dispositivo do registro no barramento 0 (os principais ficam de fora)
+  return registro.lerProximo(0, mestres[0], aoLerDispositivo) ? FONTE_INICIADA : FONTE_CONCLUIDA;
+}
+
+// Sonda de um sensor principal fora: o próprio plano de leitura. Com
+// resposta, as leituras periódicas voltam no próximo período.
+void aoSondarPrincipal(uint8_t resultado, void* contexto) {
+  if (contexto == &saude_anemometro) {
+    registrarSaude("anemometro", anemometro_id, saude_anemometro, resultado, plano_anemometro.duracaoUs());
   } else {
-    Serial.println("❌ ERRO: Falha na inicialização. Verifique as conexões.");
-    Serial.println("Verificar:");
-    Serial.println("  • Conexões físicas (A/B do RS485)");
-    Serial.println("  • Alimentação dos sensores");
-    Serial.println("  • Terminação de 120Ω nas extremidades");
+    registrarSaude("biruta", biruta_id, saude_biruta, resultado, plano_biruta.duracaoUs());
   }
-  
-  Serial.println("===========================================");
-  Serial.println("📋 Comandos disponíveis via Serial:");
-  Serial.println("- 'scan' - Nova detecção de dispositivos");
-  Serial.println("- 'info' - Mostrar dispositivos detectados");
-  Serial.println("- 'status' - Status atual do sistema");
-  Serial.println("- 'diag' - Diagnóstico completo dos sensores");
-  Serial.println("- 'config' - Ler configuração (0x07D0/0x07D1)");
-  Serial.println("- 'stress' - Teste de stress de comunicação");
-  Serial.println("- 'analise' - Análise detalhada dos dados atuais");
-  Serial.println("===========================================");
+  escalonador.concluir(fonte_reconexao, relogio.agoraMs());
 }
 
-void loop() {
-  dados.timestamp = millis();
-  
-  // Verificar comandos via Serial (APENAS COMANDOS SEGUROS)
-  if (Serial.available()) {
-    String comando = Serial.readString();
-    comando.trim();
-    comando.toLowerCase();
-    
-    if (comando == "scan") {
-      Serial.println("🔄 Iniciando nova detecção...");
-      detectarDispositivos();
-      mostrarDispositivosDetectados();
-      
-    } else if (comando == "info") {
-      mostrarDispositivosDetectados();
-      
-    } else if (comando == "status") {
-      Serial.println("\n📊 STATUS DO SISTEMA:");
-      Serial.printf("  Anemômetro: %s (ID %d)\n", anemometro_connected ? "CONECTADO" : "DESCONECTADO", anemometro_id);
-      Serial.printf("  Biruta: %s (ID %d)\n", biruta_connected ? "CONECTADO" : "DESCONECTADO", biruta_id);
-      Serial.printf("  Baud Rate: %d bps\n", current_baud_rate);
-      Serial.printf("  Dispositivos detectados: %d\n", num_dispositivos);
-      Serial.printf("  Uptime: %lu ms\n", millis());
-      
-    } else if (comando == "config") {
-      Serial.println("⚙️  Lendo configuração dos sensores...");
-      
-      if (anemometro_connected) {
-        Serial.printf("🎯 Configuração do anemômetro (ID %d):\n", anemometro_id);
-        
-        // Registrador 0x07D0 - Device Address (ID) - HOLDING REGISTER
-        uint8_t result1 = nodeAnemometro.readHoldingRegisters(0x07D0, 1);
-        if (result1 == nodeAnemometro.ku8MBSuccess) {
-          uint16_t device_addr = nodeAnemometro.getResponseBuffer(0);
-          Serial.printf("  📍 Endereço configurado (0x07D0): %d\n", device_addr);
-        } else {
-          Serial.printf("  ❌ Erro lendo 0x07D0: %02X\n", result1);
-        }
-        
-        // Registrador 0x07D1 - Baud Rate - HOLDING REGISTER
-        uint8_t result2 = nodeAnemometro.readHoldingRegisters(0x07D1, 1);
-        if (result2 == nodeAnemometro.ku8MBSuccess) {
-          uint16_t baud_code = nodeAnemometro.getResponseBuffer(0);
-          String baud_names[] = {"2400", "4800", "9600", "19200", "38400", "57600", "115200", "1200"};
-          String baud_str = (baud_code <= 7) ? baud_names[baud_code] : "Inválido";
-          Serial.printf("  🔗 Baud Rate configurado (0x07D1): %s bps (código %d)\n", baud_str.c_str(), baud_code);
-        } else {
-          Serial.printf("  ❌ Erro lendo 0x07D1: %02X\n", result2);
-        }
-      }
-      
-      if (biruta_connected) {
-        Serial.printf("🎯 Configuração da biruta (ID %d):\n", biruta_id);
-        
-        // Biruta também pode ter registradores de configuração
-        uint8_t result1 = nodeBiruta.readHoldingRegisters(0x07D0, 1);
-        if (result1 == nodeBiruta.ku8MBSuccess) {
-          uint16_t device_addr = nodeBiruta.getResponseBuffer(0);
-          Serial.printf("  📍 Endereço configurado (0x07D0): %d\n", device_addr);
-        } else {
-          Serial.printf("  ❌ Erro lendo 0x07D0: %02X\n", result1);
-        }
-        
-        uint8_t result2 = nodeBiruta.readHoldingRegisters(0x07D1, 1);
-        if (result2 == nodeBiruta.ku8MBSuccess) {
-          uint16_t baud_code = nodeBiruta.getResponseBuffer(0);
-          String baud_names[] = {"2400", "4800", "9600", "19200", "38400", "57600", "115200", "1200"};
-          String baud_str = (baud_code <= 7) ? baud_names[baud_code] : "Inválido";
-          Serial.printf("  🔗 Baud Rate configurado (0x07D1): %s bps (código %d)\n", baud_str.c_str(), baud_code);
-        } else {
-          Serial.printf("  ❌ Erro lendo 0x07D1: %02X\n", result2);
-        }
-      }
-      
-      if (!anemometro_connected && !biruta_connected) {
-        Serial.println("❌ Nenhum sensor conectado para ler configuração!");
-      }
-      
-    } else if (comando == "diag") {
-      Serial.println("🔬 Iniciando diagnóstico completo...");
-      
-      if (anemometro_connected) {
-        DeviceInfo temp_info;
-        diagnosticoCompleto(nodeAnemometro, anemometro_id, temp_info);
-      }
-      
-      if (biruta_connected) {
-        DeviceInfo temp_info;
-        diagnosticoCompleto(nodeBiruta, biruta_id, temp_info);
-      }
-      
-      if (!anemometro_connected && !biruta_connected) {
-        Serial.println("❌ Nenhum sensor conectado para diagnóstico!");
-      }
-      
-    } else if (comando == "stress") {
-      Serial.println("🏃 Iniciando teste de stress...");
-      
-      if (anemometro_connected) {
-        Serial.printf("🎯 Testando anemômetro (ID %d):\n", anemometro_id);
-        testeStress(nodeAnemometro, anemometro_id);
-      }
-      
-      if (biruta_connected) {
-        Serial.printf("🎯 Testando biruta (ID %d):\n", biruta_id);
-        testeStress(nodeBiruta, biruta_id);
+InicioFonte iniciarReconexao(uint8_t fonte, void* contexto) {
+  (void)contexto;
+  uint32_t agora = millis();
+  bool anemometro = anemometro_connected && saude_anemometro.sondaVencida(agora);
+  bool biruta = !anemometro && biruta_connected && saude_biruta.sondaVencida(agora);
+  if (!anemometro && !biruta) return FONTE_CONCLUIDA;
+  // Só no tempo livre: com leitura de sensor vivo esperando, fica para o próximo passo
+  if (escalonador.barramentoDisputado(fonte)) return FONTE_OCUPADA;
+  PlanoLeitura& plano = anemometro ? plano_anemometro : plano_biruta;
+  void* saude = anemometro ? &saude_anemometro : &saude_biruta;
+  return plano.enfileirar(mestres[0], dados, aoSondarPrincipal, saude) ? FONTE_INICIADA : FONTE_OCUPADA;
+}
+
+InicioFonte iniciarTemperatura(uint8_t fonte, void* contexto) {
+  (void)contexto;
+  lerTemperatura();
+  uint32_t captura_us = micros();
+  registrarCaptura((int8_t)fonte, captura_us);
+  publicarAmostra(1u << fonte, captura_us);
+  return FONTE_CONCLUIDA;
+}
+
+InicioFonte iniciarAdc(uint8_t fonte, void* contexto) {
+  (void)contexto;
+  drenarAdc();
+  registrarCaptura((int8_t)fonte, micros());
+  return FONTE_CONCLUIDA;
+}
+
+InicioFonte iniciarUV(uint8_t fonte, void* contexto) {
+  (void)contexto;
+  lerUV();
+  uint32_t captura_us = micros();
+  registrarCaptura((int8_t)fonte, captura_us);
+  publicarAmostra(1u << fonte, captura_us);
+  return FONTE_CONCLUIDA;
+}
+
+// Registra as fontes com período e prioridade padrão (0 = mais urgente)
+void configurarFontes() {
+  fonte_anemometro = escalonador.adicionar("anemometro", PERIODO_ANEMOMETRO_MS, 0, true, iniciarAnemometro);
+  fonte_biruta = escalonador.adicionar("biruta", PERIODO_BIRUTA_MS, 1, true, iniciarBiruta);
+  fonte_temperatura = escalonador.adicionar("temperatura", PERIODO_TEMPERATURA_MS, 2, false, iniciarTemperatura);
+  fonte_uv = escalonador.adicionar("uv", PERIODO_UV_MS, 3, false, iniciarUV);
+  fonte_adc = escalonador.adicionar("adc", PERIODO_ADC_MS, 4, false, iniciarAdc);
+  fonte_dispositivos = escalonador.adicionar("dispositivos", PERIODO_DISPOSITIVOS_MS, 5, true, iniciarDispositivos);
+  fonte_reconexao = escalonador.adicionar("reconexao", PERIODO_RECONEXAO_MS, 5, true, iniciarReconexao);
+}
+
+// Períodos configurados e taxas alcançadas de cada fonte
+void mostrarAgenda() {
+  uint32_t agora = relogio.agoraMs();
+  for (uint8_t i = 0; i < escalonador.numFontes(); i++) {
+    const FonteAmostragem& f = escalonador.fonte(i);
+    saida_console.printf("  %-12s %6lu ms (%.2f Hz, prio %d) -> %.2f Hz, %lu prazos perdidos, atraso máx %lu ms%s\n",
+                         f.nome, (unsigned long)f.periodo_ms, 1000.0f / f.periodo_ms, f.prioridade,
+                         escalonador.taxaAlcancada(i, agora), (unsigned long)f.prazos_perdidos,
+                         (unsigned long)f.atraso_max_ms, f.ativa ? "" : " [inativa]");
+  }
+}
+
+// Atraso de cada captura em relação ao instante programado, espaçamento
+// real entre capturas de períodos seguidos e deriva do atraso no tempo
+void mostrarJitter(bool zerar) {
+  if (relogio.ativo()) {
+    saida_console.printf("  Relógio: tick de %lu µs, %lu disparos, atraso do disparo médio %lu µs, máx %lu µs\n",
+                         (unsigned long)relogio.periodoUs(), (unsigned long)relogio.disparos(),
+                         (unsigned long)relogio.atrasoMedioUs(), (unsigned long)relogio.atrasoMaxUs());
+  } else {
+    saida_console.println("  Relógio: sem temporizador, liberações pelo millis()");
+  }
+  saida_console.println("  fonte         capturas  atraso p50/p95/p99/máx (µs)    intervalo médio ± σ (µs)  mín-máx (µs)          lacunas  deriva");
+  for (uint8_t i = 0; i < escalonador.numFontes(); i++) {
+    const FonteAmostragem& f = escalonador.fonte(i);
+    JitterAmostragem& j = jitter_fontes[i];
+    const HistogramaLatencia& a = j.atraso();
+    saida_console.printf("  %-12s %9lu  %6lu/%6lu/%6lu/%6lu    %10.0f ± %-8.0f    %8lu-%-8lu  %9lu  %+.2f ppm%s\n", f.nome,
+                         (unsigned long)a.total(), (unsigned long)a.percentil(50), (unsigned long)a.percentil(95),
+                         (unsigned long)a.percentil(99), (unsigned long)a.maximo(), j.intervaloMedioUs(),
+                         j.intervaloDesvioUs(), (unsigned long)j.intervaloMinUs(), (unsigned long)j.intervaloMaxUs(),
+                         (unsigned long)j.lacunas(), j.derivaPpm(), f.ativa ? "" : " [inativa]");
+    if (zerar) j.zerar();
+  }
+}
+
+// Ocupação e descartes das filas entre as tarefas
+void mostrarFilas() {
+  saida_console.printf("  Fila de amostras: %u/%u (máx %u), %u descartadas\n",
+                       (unsigned)fila_amostras.ocupacao(), (unsigned)fila_amostras.capacidade(),
+                       (unsigned)fila_amostras.ocupacaoMaxima(), (unsigned)fila_amostras.descartes());
+  saida_console.printf("  Fila de saída: %u/%u (máx %u), %u descartadas\n",
+                       (unsigned)fila_saida.ocupacao(), (unsigned)fila_saida.capacidade(),
+                       (unsigned)fila_saida.ocupacaoMaxima(), (unsigned)fila_saida.descartes());
+  saida_console.printf("  Comandos descartados: %u\n", (unsigned)fila_comandos.descartes());
+}
+
+// Uma linha de métricas: contadores e, se houver histograma, percentis em μs
+void mostrarContadores(const char* nome, const ContadoresModbus& c, const HistogramaLatencia* h) {
+  saida_console.printf("  %-12s %7lu trans, %5lu timeouts, %4lu CRC, %4lu exceções, %4lu outros, %4lu retentativas",
+                       nome, (unsigned long)c.transacoes, (unsigned long)c.timeouts, (unsigned long)c.erros_crc,
+                       (unsigned long)c.excecoes, (unsigned long)c.outros_erros, (unsigned long)c.retentativas);
+  if (h && h->total()) {
+    saida_console.printf(" | p50 %lu p95 %lu p99 %lu máx %lu μs", (unsigned long)h->percentil(50),
+                         (unsigned long)h->percentil(95), (unsigned long)h->percentil(99), (unsigned long)h->maximo());
+  }
+  saida_console.println();
+}
+
+void jsonContadores(const ContadoresModbus& c, const HistogramaLatencia* h) {
+  saida_console.printf("\"transacoes\":%lu,\"sucessos\":%lu,\"timeouts\":%lu,\"erros_crc\":%lu,\"excecoes\":%lu,"
+                       "\"outros_erros\":%lu,\"retentativas\":%lu",
+                       (unsigned long)c.transacoes, (unsigned long)c.sucessos, (unsigned long)c.timeouts,
+                       (unsigned long)c.erros_crc, (unsigned long)c.excecoes, (unsigned long)c.outros_erros,
+                       (unsigned long)c.retentativas);
+  if (h) {
+    saida_console.printf(",\"p50_us\":%lu,\"p95_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu,\"media_us\":%lu",
+                         (unsigned long)h->percentil(50), (unsigned long)h->percentil(95),
+                         (unsigned long)h->percentil(99), (unsigned long)h->maximo(), (unsigned long)h->media());
+  }
+}
+
+// Teste de carga do barramento 0 ('stress'): uma rampa até o joelho para
+// cada baud rate em uso, com os dispositivos daquele baud rate como alvos.
+// Cada fatia avança a rampa sem bloquear; a tabela sai no fim de cada baud rate.
+struct EstadoCarga {
+  uint32_t bauds[DESCOBERTA_MAX_BAUDS];
+  uint8_t num_bauds;
+  uint8_t atual;
+  uint32_t duracao_degrau_ms;
+};
+EstadoCarga carga;
+GeradorCarga gerador_carga;
+
+// Alvos e baud rate do baud rate atual da carga, e a rampa começa
+void iniciarCargaBaud() {
+  uint32_t baud = carga.bauds[carga.atual];
+  gerador_carga.limparAlvos();
+  for (uint16_t i = 0; i < registro.quantidade(0); i++) {
+    const DeviceInfo& info = registro.dispositivo(0, i).info;
+    if (info.baud_rate == baud) gerador_carga.adicionarAlvo(info.id, info.tipo);
+  }
+  halRs485Iniciar(0, baud);
+  saida_console.printf("\n🏃 TESTE DE CARGA - %lu bps, %d dispositivos, %lu ms por degrau\n",
+                       (unsigned long)baud, gerador_carga.numAlvos(), (unsigned long)carga.duracao_degrau_ms);
+  saida_console.println("  taxa req/s  leituras/s  regs/s  sucesso  descartes   p50 μs   p95 μs   p99 μs   máx μs");
+  gerador_carga.iniciar(mestres[0]);
+}
+
+// Degraus da rampa que acabou e o joelho
+void mostrarCarga() {
+  const GeradorCarga& gerador = gerador_carga;
+  for (uint8_t i = 0; i < gerador.numDegraus(); i++) {
+    const DegrauCarga& d = gerador.degrau(i);
+    char taxa[12];
+    if (d.taxa_pedida) snprintf(taxa, sizeof(taxa), "%lu", (unsigned long)d.taxa_pedida);
+    else snprintf(taxa, sizeof(taxa), "sem ritmo");
+    saida_console.printf("  %10s  %10.1f  %6.1f  %6.1f%%  %9lu  %7lu  %7lu  %7lu  %7lu%s\n", taxa, d.vazao,
+                         d.registradores_s, d.sucessoPct(), (unsigned long)d.descartadas, (unsigned long)d.p50_us,
+                         (unsigned long)d.p95_us, (unsigned long)d.p99_us, (unsigned long)d.maximo_us,
+                         d.joelho ? "  <- joelho" : "");
+  }
+  const DegrauCarga& maxima = gerador.degrau(gerador.numDegraus() - 1);
+  if (gerador.joelho() >= 0) {
+    saida_console.printf("  📊 Joelho em %lu req/s: sustenta %.1f leituras/s, máximo sem ritmo %.1f leituras/s\n",
+                         (unsigned long)gerador.degrau(gerador.joelho()).taxa_pedida, gerador.vazaoSustentavel(),
+                         maxima.vazao);
+  } else {
+    saida_console.printf("  📊 Sem joelho até %lu req/s; máximo sem ritmo %.1f leituras/s\n",
+                         (unsigned long)gerador.degrau(gerador.numDegraus() - 2).taxa_pedida, maxima.vazao);
+  }
+}
+
+// Fatia do 'stress'. Cancelado, espera a fila do mestre esvaziar antes de
+// voltar ao baud rate dos sensores.
+bool passoCarga() {
+  MestreModbusAsync& mestre = mestres[0];
+  if (trabalho.cancelado()) {
+    mestre.processar();
+    if (!mestre.ocioso()) return true;
+    saida_console.println("🛑 Teste de carga cancelado");
+    restaurarBaud(0);
+    return false;
+  }
+  if (gerador_carga.passo()) return true;
+
+  mostrarCarga();
+  if (++carga.atual < carga.num_bauds) {
+    iniciarCargaBaud();
+    return true;
+  }
+  restaurarBaud(0);
+  return false;
+}
+
+// Baud rates em uso no barramento 0; false se não há dispositivos
+bool iniciarCarga(uint32_t duracao_degrau_ms) {
+  carga.num_bauds = 0;
+  carga.atual = 0;
+  carga.duracao_degrau_ms = duracao_degrau_ms;
+  for (uint16_t i = 0; i < registro.quantidade(0); i++) {
+    uint32_t baud = registro.dispositivo(0, i).info.baud_rate;
+    bool novo = true;
+    for (uint8_t k = 0; k < carga.num_bauds; k++) novo = novo && carga.bauds[k] != baud;
+    if (novo && carga.num_bauds < DESCOBERTA_MAX_BAUDS) carga.bauds[carga.num_bauds++] = baud;
+  }
+  if (!carga.num_bauds) return false;
+
+  ConfigCarga config;
+  config.duracao_degrau_ms = duracao_degrau_ms;
+  gerador_carga.configurar(config);
+  iniciarCargaBaud();
+  return true;
+}
+
+OtimizadorBaud otimizador;
+bool otimizacao_aplicar = false;
+
+// Sobe o baud rate dos dispositivos do barramento 0 que estão no baud rate
+// atual. Sem 'aplicar' (ou sem ESCRITA_BAUD_RATE no build) é só um ensaio.
+// false se não há dispositivo no baud rate atual.
+bool iniciarOtimizacao(bool aplicar) {
+  ConfigOtimizador config;
+  config.turnaround_us = config_descoberta.turnaround_us;
+#ifdef ESCRITA_BAUD_RATE
+  config.aplicar = aplicar;
+#else
+  if (aplicar) saida_console.println("🔒 Escrita desabilitada neste build (sem ESCRITA_BAUD_RATE): só ensaio");
+#endif
+  otimizador.configurar(config);
+
+  otimizador.limparDispositivos();
+  for (uint16_t i = 0; i < registro.quantidade(0); i++) {
+    const DeviceInfo& info = registro.dispositivo(0, i).info;
+    if (info.baud_rate == current_baud_rate) otimizador.adicionarDispositivo(info.id);
+  }
+  halRs485Iniciar(0, current_baud_rate);
+  saida_console.printf("\n🚀 OTIMIZADOR DE BAUD RATE - barramento 0, %lu bps, %s\n", (unsigned long)current_baud_rate,
+                       config.aplicar ? "APLICANDO (escreve 0x07D1)" : "ensaio (nenhuma escrita)");
+  otimizador.iniciar(0);
+  return otimizador.etapa() != OTM_FIM;
+}
+
+// Medidas, escritas e o baud rate final de um 'optimize' que terminou
+void concluirOtimizacao(bool aplicar) {
+  uint32_t final = otimizador.baudFinal();
+  saida_console.println("     baud  leituras  falhas   erro %   p95 μs  leituras/s");
+  for (uint8_t i = 0; i < otimizador.numMedidas(); i++) {
+    const MedidaEnlace& m = otimizador.medida(i);
+    saida_console.printf("  %7lu  %8u  %6u  %6.1f%%  %7lu  %10.1f%s\n", (unsigned long)m.baud, m.leituras, m.falhas,
+                         m.erroPct(), (unsigned long)m.p95_us, m.leituras_s, m.aprovado ? "" : "  <- reprovado");
+  }
+  for (uint8_t i = 0; i < otimizador.numPassos(); i++) {
+    const PassoOtimizador& p = otimizador.passo(i);
+    switch (p.acao) {
+      case OTM_ENSAIO:
+        saida_console.printf("  🔍 ID %d: escreveria 0x07D1 = %d (%lu -> %lu bps)\n", p.id, codigoDoBaud(p.para),
+                             (unsigned long)p.de, (unsigned long)p.para);
+        break;
+      case OTM_CONFIRMADO:
+        saida_console.printf("  ✅ ID %d: %lu -> %lu bps confirmado\n", p.id, (unsigned long)p.de, (unsigned long)p.para);
+        break;
+      case OTM_SEM_RESPOSTA:
+        saida_console.printf("  ❌ ID %d: sem resposta em %lu e %lu bps após a escrita (%02X)\n", p.id,
+                             (unsigned long)p.de, (unsigned long)p.para, p.resultado);
+        break;
+      case OTM_SO_AO_RELIGAR:
+        saida_console.printf("  ⚠️  ID %d: aceitou %lu bps só para o próximo boot; código antigo reescrito\n", p.id,
+                             (unsigned long)p.para);
+        break;
+      case OTM_RECUSADO:
+        saida_console.printf("  ❌ ID %d: recusou %lu bps (%02X)\n", p.id, (unsigned long)p.para, p.resultado);
+        break;
+      case OTM_RETORNO:
+        saida_console.printf("  ↩️  ID %d: de volta a %lu bps\n", p.id, (unsigned long)p.para);
+        break;
+      case OTM_RETORNO_FALHOU:
+        saida_console.printf("  ❌ ID %d: não voltou a %lu bps\n", p.id, (unsigned long)p.para);
+        break;
+    }
+  }
+
+  if (otimizador.mudou()) {
+    registro.mudarBaud(0, current_baud_rate, final);
+    saida_console.printf("✅ Barramento 0: %lu -> %lu bps\n", (unsigned long)current_baud_rate, (unsigned long)final);
+    current_baud_rate = final;
+    salvarCache();
+  } else if (aplicar) {
+    saida_console.printf("ℹ️  Barramento 0 mantido em %lu bps\n", (unsigned long)final);
+  }
+  if (!otimizador.consistente()) {
+    saida_console.println("⚠️  Algum dispositivo pode ter ficado em outro baud rate: rode 'scan'");
+  }
+  halRs485Iniciar(0, current_baud_rate);
+}
+
+// Fatia do 'optimize': uma leitura de medida ou a troca de um dispositivo.
+// Cancelado no meio de um degrau, os já movidos voltam antes do fim.
+bool passoOtimizacao() {
+  if (trabalho.cancelado()) otimizador.cancelar();
+  if (otimizador.passo()) return true;
+  if (trabalho.cancelado()) saida_console.println("🛑 Otimização cancelada: barramento no último degrau aprovado");
+  concluirOtimizacao(otimizacao_aplicar);
+  return false;
+}
+
+// Métricas de cada barramento: texto ou uma linha JSON por barramento.
+// 'zerar' começa uma nova janela depois de mostrar.
+void mostrarMetricas(bool json, bool zerar) {
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    MetricasBarramento& m = metricasModbus(b);
+    if (json) {
+      saida_console.printf("{\"barramento\":%d,\"janela_ms\":%lu,\"bytes_enviados\":%llu,\"bytes_recebidos\":%llu,"
+                           "\"utilizacao\":%.4f,\"ocupacao\":%.4f,\"sondas\":%lu,",
+                           b, (unsigned long)m.janelaMs(), (unsigned long long)m.bytesEnviados(),
+                           (unsigned long long)m.bytesRecebidos(), m.utilizacao(), m.ocupacao(), (unsigned long)m.sondas());
+      jsonContadores(m.contadores(), nullptr);
+      saida_console.print(",\"dispositivos\":[");
+      for (uint8_t i = 0; i < m.numDispositivos(); i++) {
+        const MetricasDispositivo& d = m.dispositivo(i);
+        saida_console.printf("%s{\"id\":%d,", i ? "," : "", d.id);
+        jsonContadores(d.contadores, &d.latencia);
+        saida_console.print("}");
       }
-      
-      if (!anemometro_connected && !biruta_connected) {
-        Serial.println("❌ Nenhum sensor conectado para teste!");
+      saida_console.print("],\"outros\":{");
+      jsonContadores(m.outros().contadores, &m.outros().latencia);
+      saida_console.print("},\"funcoes\":[");
+      for (uint8_t i = 0; i < m.numFuncoes(); i++) {
+        const MetricasFuncao& f = m.funcao(i);
+        saida_console.printf("%s{\"funcao\":%d,", i ? "," : "", f.funcao);
+        jsonContadores(f.contadores, &f.latencia);
+        saida_console.print("}");
       }
-      
-    } else if (comando == "analise") {
-      Serial.println("🔬 Análise detalhada dos dados atuais...");
-      
-      if (anemometro_connected) {
-        // CORRIGIDO: usar readInputRegisters conforme manual
-        uint8_t result = nodeAnemometro.readInputRegisters(0x0000, 1);
-        if (result == nodeAnemometro.ku8MBSuccess) {
-          uint16_t valor = nodeAnemometro.getResponseBuffer(0);
-          analiseDados(anemometro_id, valor);
-        }
+      saida_console.println("]}");
+    } else {
+      saida_console.printf("🔌 Barramento %d (%lu bps), janela de %lu ms: %llu bytes enviados, %llu recebidos, "
+                           "linha %.1f%%, ocupado %.1f%%, %lu sondas de varredura\n",
+                           b, (unsigned long)halRs485Baud(b), (unsigned long)m.janelaMs(),
+                           (unsigned long long)m.bytesEnviados(), (unsigned long long)m.bytesRecebidos(),
+                           m.utilizacao() * 100.0f, m.ocupacao() * 100.0f, (unsigned long)m.sondas());
+      mostrarContadores("total", m.contadores(), nullptr);
+      char nome[16];
+      for (uint8_t i = 0; i < m.numDispositivos(); i++) {
+        const MetricasDispositivo& d = m.dispositivo(i);
+        snprintf(nome, sizeof(nome), "ID %d", d.id);
+        mostrarContadores(nome, d.contadores, &d.latencia);
       }
-      
-      if (biruta_connected) {
-        // CORRIGIDO: ler registros separadamente usando readInputRegisters
-        uint8_t result1 = nodeBiruta.readInputRegisters(0x0000, 1);
-        uint8_t result2 = nodeBiruta.readInputRegisters(0x0001, 1);
-        if (result1 == nodeBiruta.ku8MBSuccess && result2 == nodeBiruta.ku8MBSuccess) {
-          uint16_t valor1 = nodeBiruta.getResponseBuffer(0); // da primeira leitura
-          // Ler novamente para pegar o segundo valor
-          nodeBiruta.readInputRegisters(0x0001, 1);
-          uint16_t valor2 = nodeBiruta.getResponseBuffer(0);
-          analiseDados(biruta_id, valor1, valor2);
-        }
+      if (m.outros().contadores.transacoes) mostrarContadores("outros IDs", m.outros().contadores, &m.outros().latencia);
+      for (uint8_t i = 0; i < m.numFuncoes(); i++) {
+        const MetricasFuncao& f = m.funcao(i);
+        snprintf(nome, sizeof(nome), "função 0x%02X", f.funcao);
+        mostrarContadores(nome, f.contadores, &f.latencia);
       }
-      
-    } else {
-      Serial.println("❌ Comando não reconhecido.");
-      Serial.println("Comandos disponíveis: scan, info, status, config, diag, stress, analise");
     }
+    if (zerar) m.pedirZerar();
   }
-  
-  // Leitura SEGURA dos sensores
-  bool anemometro_ok = false;
-  bool biruta_ok = false;
-  
-  if (anemometro_connected) {
-    anemometro_ok = lerAnemometro();
+}
+
+// Estado de conexão e validade da amostra (FLAG_TLM_*)
+uint8_t flagsAmostra(const Amostra& amostra) {
+  uint8_t flags = 0;
+  if (amostra.anemometro_conectado) flags |= FLAG_TLM_ANEMOMETRO;
+  if (amostra.resultado_anemometro == MB_SUCESSO) flags |= FLAG_TLM_VENTO_OK;
+  if (amostra.biruta_conectada) flags |= FLAG_TLM_BIRUTA;
+  if (amostra.resultado_biruta == MB_SUCESSO) flags |= FLAG_TLM_DIRECAO_OK;
+  if (amostra.dados.temperature > -999) flags |= FLAG_TLM_TEMP_OK;
+  return flags;
+}
+
+// Alimenta as janelas com as leituras válidas e anexa o resumo à amostra
+void atualizarEstatisticasVento(Amostra& amostra) {
+  const SensorData& leitura = amostra.dados;
+  if (atualizou(amostra, fonte_anemometro) && amostra.resultado_anemometro == MB_SUCESSO) {
+    estatisticas_vento.adicionarVelocidade(leitura.timestamp, (uint16_t)lroundf(leitura.wind_speed * 10.0f));
   }
+  if (atualizou(amostra, fonte_biruta) && amostra.resultado_biruta == MB_SUCESSO) {
+    estatisticas_vento.adicionarDirecao(leitura.timestamp, leitura.wind_direction_degrees);
+  }
+  amostra.vento = estatisticas_vento.resumo(leitura.timestamp);
+}
+
+// Atualiza os agregados e publica a amostra no mapa do escravo
+void publicarMapaEscravo(const Amostra& amostra) {
+  const SensorData& leitura = amostra.dados;
+  uint16_t vento_dms = (uint16_t)lroundf(leitura.wind_speed * 10.0f);
   
-  if (biruta_connected) {
-    biruta_ok = lerBiruta();
+  if (atualizou(amostra, fonte_anemometro)) {
+    if (amostra.resultado_anemometro == MB_SUCESSO) {
+      soma_vento_dms += vento_dms;
+      leituras_vento++;
+      if (vento_dms > vento_maximo_dms) vento_maximo_dms = vento_dms;
+      falhas_anemometro = 0;
+    } else if (falhas_anemometro < 0xFFFF) {
+      falhas_anemometro++;
+    }
+  }
+  if (atualizou(amostra, fonte_biruta)) {
+    if (amostra.resultado_biruta == MB_SUCESSO) {
+      falhas_biruta = 0;
+    } else if (falhas_biruta < 0xFFFF) {
+      falhas_biruta++;
+    }
   }
   
-  // Leitura dos sensores locais
-  lerTemperatura();
-  lerUV();
+  uint16_t regs[ESCRAVO_NUM_REGISTROS];
+  regs[REG_ESC_VENTO_DMS] = vento_dms;
+  regs[REG_ESC_DIRECAO_GRAUS] = leitura.wind_direction_degrees;
+  regs[REG_ESC_DIRECAO_BRUTA] = leitura.wind_direction_raw;
+  regs[REG_ESC_TEMPERATURA_DC] = (uint16_t)(int16_t)lroundf(leitura.temperature * 10.0f);
+  regs[REG_ESC_UV_DEC] = (uint16_t)lroundf(leitura.uv_index * 10.0f);
+  regs[REG_ESC_FLAGS] = flagsAmostra(amostra);
+  regs[REG_ESC_TIMESTAMP_H] = (uint16_t)(leitura.timestamp >> 16);
+  regs[REG_ESC_TIMESTAMP_L] = (uint16_t)leitura.timestamp;
+  regs[REG_ESC_SEQUENCIA_H] = (uint16_t)(amostra.sequencia >> 16);
+  regs[REG_ESC_SEQUENCIA_L] = (uint16_t)amostra.sequencia;
+  regs[REG_ESC_VENTO_MEDIO_DMS] = leituras_vento ? (uint16_t)(soma_vento_dms / leituras_vento) : 0;
+  regs[REG_ESC_VENTO_MAXIMO_DMS] = vento_maximo_dms;
+  regs[REG_ESC_FALHAS_ANEMOMETRO] = falhas_anemometro;
+  regs[REG_ESC_FALHAS_BIRUTA] = falhas_biruta;
+  regs[REG_ESC_TIMEOUTS] = (uint16_t)mestres[0].timeouts();
+  regs[REG_ESC_DESCARTES] = (uint16_t)(fila_amostras.descartes() + fila_saida.descartes());
+  regs[REG_ESC_VENTO_2MIN_DMS] = amostra.vento.media_2min_dms;
+  regs[REG_ESC_VENTO_10MIN_DMS] = amostra.vento.media_10min_dms;
+  regs[REG_ESC_RAJADA_DMS] = amostra.vento.rajada_dms;
+  regs[REG_ESC_DIRECAO_2MIN_GRAUS] = amostra.vento.direcao_2min_graus;
+  regs[REG_ESC_DIRECAO_10MIN_GRAUS] = amostra.vento.direcao_10min_graus;
+  regs[REG_ESC_DESVIO_DIRECAO_DG] = amostra.vento.desvio_direcao_dg;
+  mapa_escravo.publicar(regs);
+}
+
+// Amostra no formato compacto da telemetria (também o do diário na flash)
+RegistroTelemetria registroTelemetria(const Amostra& amostra) {
+  const SensorData& leitura = amostra.dados;
+  RegistroTelemetria registro;
+  registro.sequencia = amostra.sequencia;
+  registro.timestamp_ms = leitura.timestamp;
+  registro.vento_dms = (uint16_t)lroundf(leitura.wind_speed * 10.0f);
+  registro.direcao_graus = leitura.wind_direction_degrees;
+  registro.direcao_bruta = (uint8_t)leitura.wind_direction_raw;
+  registro.uv_dec = (uint16_t)lroundf(leitura.uv_index * 10.0f);
+  registro.flags = flagsAmostra(amostra);
+  if (registro.flags & FLAG_TLM_TEMP_OK) {
+    registro.temperatura_qc = (int16_t)lroundf(leitura.temperature * 4.0f);
+  }
+  return registro;
+}
+
+// Amostra como quadro binário: ~24 bytes em vez de ~400 do relatório
+void enviarTelemetria(const Amostra& amostra) {
+  uint8_t quadro[TELEMETRIA_TAM_QUADRO];
+  Serial.write(quadro, telemetriaMontarQuadro(registroTelemetria(amostra), quadro));
+}
+
+// Contadores do escravo Modbus (porta do SCADA)
+void mostrarEscravo() {
+  if (!modo_escravo) {
+    saida_console.println("  Escravo Modbus: desativado");
+    return;
+  }
+  saida_console.printf("  Escravo Modbus: ID %d, %lu bps, %lu respostas, %lu exceções, %lu erros CRC, %lu cópias anteriores\n",
+                       escravo.id(), (unsigned long)halEscravoBaud(), (unsigned long)escravo.respostas(),
+                       (unsigned long)escravo.excecoes(), (unsigned long)escravo.errosCrc(),
+                       (unsigned long)escravo.copiasAntigas());
+}
+
+// Relatório de uma amostra já processada
+void exibirDados(const Amostra& amostra) {
+  const SensorData& leitura = amostra.dados;
+  bool anemometro_ok = amostra.resultado_anemometro == MB_SUCESSO;
+  bool biruta_ok = amostra.resultado_biruta == MB_SUCESSO;
   
   // Exibir dados
   Serial.println("\n📊 --- Dados dos Sensores ---");
-  Serial.printf("🕐 Timestamp: %lu ms\n", dados.timestamp);
+  Serial.printf("🕐 Timestamp: %lu ms\n", (unsigned long)leitura.timestamp);
   
-  if (anemometro_connected) {
+  if (amostra.anemometro_conectado) {
     if (anemometro_ok) {
-      Serial.printf("💨 Velocidade do vento: %.1f m/s\n", dados.wind_speed);
+      Serial.printf("💨 Velocidade do vento: %.1f m/s\n", leitura.wind_speed);
     } else {
       Serial.println("💨 Velocidade do vento: ❌ ERRO");
     }
@@ -763,9 +1454,9 @@ void loop() {
     Serial.println("💨 Velocidade do vento: ⚠️  NÃO DETECTADO");
   }
   
-  if (biruta_connected) {
+  if (amostra.biruta_conectada) {
     if (biruta_ok) {
-      Serial.printf("🧭 Direção do vento: %d° (%s)\n", dados.wind_direction_degrees, dados.wind_direction_cardinal.c_str());
+      Serial.printf("🧭 Direção do vento: %d° (%s)\n", leitura.wind_direction_degrees, nomeDirecao(leitura.wind_direction_cardinal));
     } else {
       Serial.println("🧭 Direção do vento: ❌ ERRO");
     }
@@ -773,18 +1464,797 @@ void loop() {
     Serial.println("🧭 Direção do vento: ⚠️  NÃO DETECTADO");
   }
   
-  Serial.printf("🌡️  Temperatura: %.1f°C\n", dados.temperature);
-  Serial.printf("☀️  Índice UV: %.1f\n", dados.uv_index);
-  Serial.printf("📡 Comunicação: %d bps\n", current_baud_rate);
+  const ResumoVento& vento = amostra.vento;
+  if (vento.vento_valido) {
+    Serial.printf("📈 Médias: 2 min %.1f m/s, 10 min %.1f m/s (σ %.1f), rajada %.1f m/s (%u s de histórico)\n",
+                  vento.media_2min_dms / 10.0f, vento.media_10min_dms / 10.0f,
+                  vento.desvio_vento_dms / 10.0f, vento.rajada_dms / 10.0f, vento.cobertura_s);
+  }
+  if (vento.direcao_valida) {
+    Serial.printf("🧭 Direção média: 2 min %u°, 10 min %u° (σ %.1f°)\n",
+                  vento.direcao_2min_graus, vento.direcao_10min_graus, vento.desvio_direcao_dg / 10.0f);
+  }
+  
+  Serial.printf("🌡️  Temperatura: %.1f°C\n", leitura.temperature);
+  Serial.printf("☀️  Índice UV: %.2f (ruído ±%.3f)\n", leitura.uv_index, leitura.uv_noise);
+  Serial.printf("📡 Comunicação: %d bps\n", amostra.baud_rate);
+  if (fila_amostras.descartes() || fila_saida.descartes()) {
+    Serial.printf("⏳ Amostras descartadas: %u na aquisição, %u na saída\n",
+                  (unsigned)fila_amostras.descartes(), (unsigned)fila_saida.descartes());
+  }
   Serial.println("-----------------------------");
   
   // Alertas de status
-  if (!anemometro_connected && !biruta_connected) {
+  if (!amostra.anemometro_conectado && !amostra.biruta_conectada) {
     Serial.println("🚨 ALERTA: Nenhum sensor Modbus conectado!");
   }
   
   // Monitoramento contínuo
   monitorarContinuo();
+}
+
+static bool imprimirRegistroDiario(const RegistroDiario& registro, void* contexto) {
+  (void)contexto;
+  const RegistroTelemetria& a = registro.amostra;
+  Serial.printf("%lu,%lu,%lu,%.1f,%u,%.2f,%.1f,0x%02X\n", (unsigned long)registro.tempo_s,
+                (unsigned long)a.sequencia, (unsigned long)a.timestamp_ms, a.vento_dms / 10.0f,
+                a.direcao_graus, a.temperatura_qc / 4.0f, a.uv_dec / 10.0f, a.flags);
+  return true;
+}
+
+// 'dump': estado do diário; 'dump <de> [ate]': registros da faixa em CSV
+void executarDump(const char* argumentos) {
+  if (!diario.montado()) {
+    Serial.println("❌ Diário indisponível (sem partição 'amostras')");
+    return;
+  }
+  char* fim;
+  unsigned long de = strtoul(argumentos, &fim, 10);
+  if (fim == argumentos) {
+    Serial.println("\n🗄️  --- Diário na flash ---");
+    Serial.printf("  Registros: %lu em %u/%u blocos de %u\n", (unsigned long)diario.registros(),
+                  diario.blocosUsados(), diario.numBlocos(), (unsigned)DIARIO_REGISTROS_POR_BLOCO);
+    Serial.printf("  Tempo: %lu .. %lu s (agora %lu s)\n", (unsigned long)diario.tempoMaisAntigo(),
+                  (unsigned long)diario.tempoMaisRecente(), (unsigned long)diario.tempoAgora());
+    Serial.printf("  Falhas de gravação: %lu\n", (unsigned long)diario.falhasGravacao());
+    Serial.println("  Uso: dump <de_s> [ate_s]");
+    return;
+  }
+  const char* resto = fim;
+  unsigned long ate = strtoul(resto, &fim, 10);
+  if (fim == resto) ate = UINT32_MAX;
+
+  Serial.println("tempo_s,seq,uptime_ms,vento_ms,direcao_graus,temp_c,uv,flags");
+  uint32_t n = diario.consultar((uint32_t)de, (uint32_t)ate, imprimirRegistroDiario, nullptr);
+  Serial.printf("🗄️  %lu registros (%u blocos lidos, %lu inválidos)\n", (unsigned long)n,
+                diario.blocosLidosNaConsulta(), (unsigned long)diario.invalidosNaConsulta());
+}
+
+// Comandos do console (APENAS COMANDOS SEGUROS)
+// Rodam na tarefa de aquisição, com o barramento livre, e escrevem em
+// saida_console. Os que leem os sensores (scan, diag, config, analise,
+// stress, optimize) viram trabalhos em fatias que só enfileiram no mestre:
+// nenhuma espera pela resposta de um sensor.
+void mostrarAjuda();
+
+// Fatia do 'scan': uma sonda do barramento 0. Cancelada, o registro fica com
+// o que já foi encontrado e o cache não é gravado.
+bool passoVarredura() {
+  Descoberta& descoberta = descobertas[0];
+  if (trabalho.cancelado()) {
+    descoberta.cancelar();
+    restaurarBaud(0);
+    configurarPlanos();
+    saida_console.println("🛑 Varredura cancelada: registro com o que já foi encontrado");
+    return false;
+  }
+  if (descoberta.passo()) return true;
   
-  delay(3000); // Aguardar 3 segundos
-}
\ No newline at end of file
+  concluirVarredura(0);
+  configurarPlanos();
+  salvarCache();
+  mostrarDispositivosDetectados(saida_console);
+  return false;
+}
+
+// 'scan [id_inicial id_final]': faixa opcional (até 247)
+void comandoScan(const char* argumentos) {
+  int id_inicial, id_final;
+  if (sscanf(argumentos, "%d %d", &id_inicial, &id_final) == 2 &&
+      id_inicial >= 1 && id_final >= id_inicial && id_final <= MODBUS_ID_MAX) {
+    config_descoberta.id_inicial = (uint8_t)id_inicial;
+    config_descoberta.id_final = (uint8_t)id_final;
+  }
+  saida_console.println("🔄 Iniciando nova detecção...");
+  iniciarDeteccao();
+  for (uint8_t b = 1; b < num_barramentos; b++) pedirVarredura(b);
+  registro.limpar(0);
+  descobertas[0].iniciar(configDescoberta(0), registrarDispositivo);
+  trabalho.iniciar("scan", passoVarredura, true);
+}
+
+// 'cache apagar': próximo boot faz a varredura completa
+void comandoCache(const char* argumentos) {
+  if (strcmp(argumentos, "apagar")) {
+    saida_console.println("❌ Uso: cache apagar");
+    return;
+  }
+  cache_dispositivos.apagar();
+  saida_console.println("💾 Cache de descoberta apagado");
+}
+
+void comandoInfo(const char* argumentos) {
+  (void)argumentos;
+  mostrarDispositivosDetectados(saida_console);
+}
+
+void comandoStatus(const char* argumentos) {
+  (void)argumentos;
+  saida_console.println("\n📊 STATUS DO SISTEMA:");
+  saida_console.printf("  Anemômetro: %s (ID %d, %s)\n", anemometro_connected ? "CONECTADO" : "DESCONECTADO", anemometro_id,
+                       nomeSaude(saude_anemometro.estado()));
+  saida_console.printf("  Biruta: %s (ID %d, %s)\n", biruta_connected ? "CONECTADO" : "DESCONECTADO", biruta_id,
+                       nomeSaude(saude_biruta.estado()));
+  saida_console.printf("  Baud Rate: %d bps\n", current_baud_rate);
+  saida_console.printf("  Dispositivos detectados: %u\n", (unsigned)registro.total());
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    saida_console.print("  ");
+    mostrarBarramento(saida_console, b);
+  }
+  saida_console.printf("  Uptime: %lu ms\n", millis());
+  if (primeira_amostra_ms) {
+    saida_console.printf("  Boot até a primeira amostra: %lu ms\n", (unsigned long)primeira_amostra_ms);
+  }
+  saida_console.printf("  Cache de descoberta: %s (%u dispositivos)\n",
+                       cache_dispositivos.valido() ? "gravado" : "vazio", (unsigned)cache_dispositivos.quantidade());
+  saida_console.printf("  Saída: %s\n", modo_saida == SAIDA_BINARIA ? "binária" : "texto");
+  mostrarFilas();
+  mostrarEscravo();
+  saida_console.printf("  Log: %lu linhas, %lu descartadas (fila cheia), %lu suprimidas (saída binária), nível %d\n",
+                       (unsigned long)log_sistema.emitidas(), (unsigned long)log_sistema.descartadas(),
+                       (unsigned long)log_sistema.suprimidas(), LOG_NIVEL);
+  saida_console.printf("  ADC UV: %lu amostras, %lu estouros do DMA, calibração %s\n",
+                       (unsigned long)filtro_uv.entradas(), (unsigned long)halAdcEstouros(), halAdcCalibracao());
+  mostrarAgenda();
+}
+
+// Uma linha de 'saude': estado, quedas e voltas, períodos sem leitura e
+// tempo de barramento gasto esperando respostas que não vieram
+void mostrarSaude(const char* nome, uint8_t barramento, uint8_t id, const SaudeDispositivo& s, uint32_t agora) {
+  saida_console.printf("  %-12s %d/%3d  %-8s %3u falhas seguidas %4lu quedas %4lu reconexões %5lu sondas %7lu pulos %9.1f ms perdidos",
+                       nome, barramento, id, nomeSaude(s.estado()), s.falhasSeguidas(), (unsigned long)s.quedas(),
+                       (unsigned long)s.reconexoes(), (unsigned long)s.sondas(), (unsigned long)s.pulos(),
+                       s.tempoPerdidoUs() / 1000.0);
+  int32_t falta_ms = (int32_t)(s.proximaMs() - agora);
+  if (falta_ms < 0) falta_ms = 0;   // Vencida, esperando o barramento livre
+  if (s.estado() == SAUDE_SUSPEITO) saida_console.printf(" (nova tentativa em %ld ms)", (long)falta_ms);
+  if (s.estado() == SAUDE_FORA) saida_console.printf(" (sonda em %ld s)", (long)(falta_ms / 1000));
+  saida_console.println();
+}
+
+// 'saude [zerar]': principais e os dispositivos do registro com alguma falha.
+// 'zerar' só mexe no barramento 0 (os outros são das suas tarefas).
+void comandoSaude(const char* argumentos) {
+  uint32_t agora = millis();
+  saida_console.printf("\n🩺 SAÚDE DOS DISPOSITIVOS (%u falhas seguidas até fora; espera %lu-%lu ms; sonda a cada %lu s):\n",
+                       config_saude.falhas_fora, (unsigned long)config_saude.espera_inicial_ms,
+                       (unsigned long)config_saude.espera_max_ms, (unsigned long)(config_saude.intervalo_sonda_ms / 1000));
+  uint64_t perdido_us = 0;
+  if (anemometro_connected) {
+    mostrarSaude("anemometro", 0, anemometro_id, saude_anemometro, agora);
+    perdido_us += saude_anemometro.tempoPerdidoUs();
+  }
+  if (biruta_connected) {
+    mostrarSaude("biruta", 0, biruta_id, saude_biruta, agora);
+    perdido_us += saude_biruta.tempoPerdidoUs();
+  }
+  uint16_t saudaveis = 0;
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    for (uint16_t i = 0; i < registro.quantidade(b); i++) {
+      Dispositivo d;   // Os barramentos extras são das suas tarefas
+      if (!registro.copiar(b, i, d) || d.principal) continue;
+      perdido_us += d.saude.tempoPerdidoUs();
+      if (d.saude.estado() == SAUDE_OK && !d.saude.quedas() && !d.saude.tempoPerdidoUs()) {
+        saudaveis++;
+      } else {
+        mostrarSaude(d.info.tipo == TIPO_BIRUTA ? "biruta" : "anemometro", b, d.info.id, d.saude, agora);
+      }
+    }
+  }
+  if (saudaveis) saida_console.printf("  + %u dispositivos do registro sem falhas\n", (unsigned)saudaveis);
+  uint32_t janela_ms = agora - inicio_saude_ms;
+  saida_console.printf("  Barramento perdido com dispositivos sem resposta: %.1f ms em %lu s (%.2f%%)\n", perdido_us / 1000.0,
+                       (unsigned long)(janela_ms / 1000), janela_ms ? perdido_us / (10.0 * janela_ms) : 0.0);
+
+  if (!strcmp(argumentos, "zerar")) {
+    saude_anemometro.zerarEstatisticas();
+    saude_biruta.zerarEstatisticas();
+    for (uint16_t i = 0; i < registro.quantidade(0); i++) registro.dispositivo(0, i).saude.zerarEstatisticas();
+    inicio_saude_ms = agora;
+    saida_console.println("  Estatísticas zeradas");
+  }
+}
+
+void comandoAgenda(const char* argumentos) {
+  (void)argumentos;
+  saida_console.println("\n⏱️  AGENDA DE AMOSTRAGEM:");
+  mostrarAgenda();
+}
+
+// 'jitter [zerar]'
+void comandoJitter(const char* argumentos) {
+  saida_console.println("\n⏱️  JITTER DA AMOSTRAGEM:");
+  mostrarJitter(!strcmp(argumentos, "zerar"));
+}
+
+// 'periodo <fonte> <ms> [prioridade]'
+void comandoPeriodo(const char* argumentos) {
+  char nome[16];
+  unsigned long periodo_ms;
+  int prioridade = -1;
+  int lidos = sscanf(argumentos, "%15s %lu %d", nome, &periodo_ms, &prioridade);
+  int8_t fonte = lidos >= 2 ? escalonador.procurar(nome) : -1;
+  if (fonte < 0 || periodo_ms < 10) {
+    saida_console.println("❌ Uso: periodo <anemometro|biruta|temperatura|uv|adc|dispositivos> <ms >= 10> [prioridade]");
+  } else {
+    uint8_t nova_prioridade = prioridade >= 0 ? (uint8_t)prioridade : escalonador.fonte(fonte).prioridade;
+    escalonador.configurar(fonte, periodo_ms, nova_prioridade);
+    saida_console.printf("⏱️  %s: %lu ms, prioridade %d\n", nome, periodo_ms, nova_prioridade);
+  }
+}
+
+// 'metrics [json] [zerar]'
+void comandoMetrics(const char* argumentos) {
+  bool json = strstr(argumentos, "json") != nullptr;
+  bool zerar = strstr(argumentos, "zerar") != nullptr;
+  if (!json) saida_console.println("\n📈 MÉTRICAS DO BARRAMENTO:");
+  mostrarMetricas(json, zerar);
+}
+
+// 'saida texto|binario'
+void comandoSaida(const char* argumentos) {
+  if (!strcmp(argumentos, "texto")) {
+    modo_saida = SAIDA_TEXTO;
+    saida_console.println("📝 Saída em texto");
+  } else if (!strcmp(argumentos, "binario")) {
+    // Confirmação antes do primeiro quadro; o decodificador descarta o texto
+    saida_console.println("📦 Saída binária (COBS + CRC, lib/telemetria)");
+    modo_saida = SAIDA_BINARIA;
+  } else {
+    saida_console.println("❌ Uso: saida texto|binario");
+  }
+}
+
+// Registradores 0x07D0 (endereço) e 0x07D1 (baud rate), já lidos numa única
+// leitura (leitura_console)
+void mostrarConfiguracao(const char* nome, uint8_t id) {
+  using Endereco = PerfilConfiguracao::Endereco;
+  using CodigoBaud = PerfilConfiguracao::CodigoBaud;
+  const LeituraConsole& l = leitura_console;
+  saida_console.printf("🎯 Configuração %s (ID %d):\n", nome, id);
+  if (l.resultado != MB_SUCESSO) {
+    saida_console.printf("  ❌ Erro lendo 0x%04X-0x%04X: %02X\n", Endereco::endereco, CodigoBaud::endereco,
+                         l.resultado);
+    return;
+  }
+  DeviceInfo config;
+  PerfilConfiguracao::Dados::decodificar(l.resposta, config);
+  saida_console.printf("  📍 Endereço configurado (0x%04X): %d\n", Endereco::endereco, config.config_id);
+  saida_console.printf("  🔗 Baud Rate configurado (0x%04X): %s bps (código %d)\n", CodigoBaud::endereco,
+                       nomeCodigoBaud(config.config_baud), config.config_baud);
+}
+
+// Sensores principais percorridos por 'config' e 'analise', um por fatia
+struct ConsultaSensores {
+  uint8_t ids[2];
+  bool biruta[2];
+  uint8_t num;
+  uint8_t atual;
+};
+ConsultaSensores consulta;
+
+// false se nenhum sensor principal está conectado
+bool iniciarConsulta() {
+  consulta = ConsultaSensores();
+  leitura_console = LeituraConsole();
+  if (anemometro_connected) {
+    consulta.ids[consulta.num] = anemometro_id;
+    consulta.biruta[consulta.num++] = false;
+  }
+  if (biruta_connected) {
+    consulta.ids[consulta.num] = biruta_id;
+    consulta.biruta[consulta.num++] = true;
+  }
+  return consulta.num > 0;
+}
+
+// Fatia do 'config': a configuração de um sensor
+bool passoConfig() {
+  if (trabalho.cancelado()) {
+    saida_console.println("🛑 Leitura de configuração cancelada");
+    return false;
+  }
+  uint8_t i = consulta.atual;
+  if (!lerBlocoPeloMestre<PerfilConfiguracao::Dados>(consulta.ids[i])) return true;
+  mostrarConfiguracao(consulta.biruta[i] ? "da biruta" : "do anemômetro", consulta.ids[i]);
+  return ++consulta.atual < consulta.num;
+}
+
+void comandoConfig(const char* argumentos) {
+  (void)argumentos;
+  saida_console.println("⚙️  Lendo configuração dos sensores...");
+  
+  if (!iniciarConsulta()) {
+    saida_console.println("❌ Nenhum sensor conectado para ler configuração!");
+    return;
+  }
+  // Como o 'diag': cada leitura entra na fila do mestre vazia
+  trabalho.iniciar("config", passoConfig, false);
+}
+
+void comandoDiag(const char* argumentos) {
+  (void)argumentos;
+  saida_console.println("🔬 Iniciando diagnóstico completo...");
+  
+  diagnostico = EstadoDiagnostico();
+  leitura_console = LeituraConsole();
+  if (anemometro_connected) diagnostico.ids[diagnostico.num_ids++] = anemometro_id;
+  if (biruta_connected) diagnostico.ids[diagnostico.num_ids++] = biruta_id;
+  
+  if (!diagnostico.num_ids) {
+    saida_console.println("❌ Nenhum sensor conectado para diagnóstico!");
+    return;
+  }
+  // Não é dono do barramento: cada leitura entra na fila do mestre vazia
+  trabalho.iniciar("diag", passoDiagnostico, false);
+}
+
+// 'stress [ms por degrau]'
+void comandoStress(const char* argumentos) {
+  unsigned long duracao_ms = 2000;
+  sscanf(argumentos, "%lu", &duracao_ms);
+  if (duracao_ms < 200) duracao_ms = 200;
+  if (!iniciarCarga(duracao_ms)) {
+    saida_console.println("❌ Nenhum dispositivo detectado para o teste de carga!");
+    return;
+  }
+  trabalho.iniciar("stress", passoCarga, true);
+}
+
+// 'optimize [aplicar]': dono do barramento, que muda de baud rate
+void comandoOptimize(const char* argumentos) {
+  otimizacao_aplicar = !strcmp(argumentos, "aplicar");
+  if (!iniciarOtimizacao(otimizacao_aplicar)) {
+    saida_console.println("❌ Nenhum dispositivo no baud rate atual para otimizar!");
+    return;
+  }
+  trabalho.iniciar("optimize", passoOtimizacao, true);
+}
+
+// Fatia do 'analise': a leitura e a análise de um sensor
+bool passoAnalise() {
+  if (trabalho.cancelado()) {
+    saida_console.println("🛑 Análise cancelada");
+    return false;
+  }
+  uint8_t i = consulta.atual;
+  const LeituraConsole& l = leitura_console;
+  if (!consulta.biruta[i]) {
+    // CORRIGIDO: usar readInputRegisters conforme manual
+    if (!lerPeloMestre(consulta.ids[i], MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1)) return true;
+    if (l.resultado == MB_SUCESSO) {
+      analiseDados(consulta.ids[i], false, l.resposta.registrador(0));
+    }
+  } else {
+    // 0x0000 e 0x0001 numa única leitura (bloco da biruta)
+    if (!lerBlocoPeloMestre<PerfilBiruta::Dados>(consulta.ids[i])) return true;
+    if (l.resultado == MB_SUCESSO) {
+      SensorData leitura;
+      PerfilBiruta::Dados::decodificar(l.resposta, leitura);
+      analiseDados(consulta.ids[i], true, leitura.wind_direction_raw, leitura.wind_direction_degrees);
+    }
+  }
+  return ++consulta.atual < consulta.num;
+}
+
+void comandoAnalise(const char* argumentos) {
+  (void)argumentos;
+  saida_console.println("🔬 Análise detalhada dos dados atuais...");
+  if (!iniciarConsulta()) return;
+  trabalho.iniciar("analise", passoAnalise, false);
+}
+
+// 'console [zerar]': linhas lidas, ida e volta dos comandos da aquisição
+// (da linha recebida ao fim do comando) e o maior tempo em que um comando
+// ou uma fatia segurou a aquisição
+void comandoConsole(const char* argumentos) {
+  const HistogramaLatencia& h = ida_volta_comandos;
+  saida_console.println("\n💬 CONSOLE:");
+  saida_console.printf("  Linhas: %lu (%lu descartadas com mais de %d caracteres)\n",
+                       (unsigned long)leitor_console.linhas(), (unsigned long)leitor_console.descartadas(),
+                       CONSOLE_MAX_LINHA - 1);
+  saida_console.printf("  Ida e volta: %lu comandos, p50 %lu μs, p95 %lu μs, máx %lu μs\n", (unsigned long)h.total(),
+                       (unsigned long)h.percentil(50), (unsigned long)h.percentil(95), (unsigned long)h.maximo());
+  saida_console.printf("  Maior bloqueio da aquisição: %lu μs (%s)\n", (unsigned long)maior_bloqueio_us,
+                       maior_bloqueio_us ? nome_maior_bloqueio : "-");
+  saida_console.printf("  Saída dos comandos: maior ocupação %lu/%lu bytes, %lu bytes descartados\n",
+                       (unsigned long)saida_console.ocupacaoMaxima(), (unsigned long)saida_console.capacidade(),
+                       (unsigned long)saida_console.descartados());
+  if (trabalho.ativo()) {
+    saida_console.printf("  Em andamento: '%s' há %lu ms, %lu fatias, a maior de %lu μs\n", trabalho.nome(),
+                         (unsigned long)trabalho.decorridoMs(), (unsigned long)trabalho.fatias(),
+                         (unsigned long)trabalho.maiorFatiaUs());
+  }
+  if (!strcmp(argumentos, "zerar")) {
+    ida_volta_comandos.zerar();
+    maior_bloqueio_us = 0;
+  }
+}
+
+void comandoCancelar(const char* argumentos) {
+  (void)argumentos;
+  if (!trabalho.ativo()) {
+    saida_console.println("ℹ️  Nenhum comando em andamento");
+    return;
+  }
+  trabalho.cancelar();
+  saida_console.printf("🛑 Cancelando '%s'...\n", trabalho.nome());
+}
+
+void comandoAjuda(const char* argumentos) {
+  (void)argumentos;
+  mostrarAjuda();
+}
+
+constexpr EntradaComando COMANDOS[] = {
+  {"scan", "scan [id_ini id_fim]", "Nova detecção de dispositivos (IDs até 247)", COMANDO_BARRAMENTO, comandoScan},
+  {"info", "info", "Mostrar dispositivos detectados", COMANDO_AQUISICAO, comandoInfo},
+  {"status", "status", "Status atual do sistema", COMANDO_AQUISICAO, comandoStatus},
+  {"diag", "diag", "Diagnóstico completo dos sensores", COMANDO_BARRAMENTO, comandoDiag},
+  {"config", "config", "Ler configuração (0x07D0/0x07D1)", COMANDO_BARRAMENTO, comandoConfig},
+  {"stress", "stress [ms]", "Teste de carga: rampa de taxa até o joelho, por baud rate", COMANDO_BARRAMENTO,
+   comandoStress},
+  {"analise", "analise", "Análise detalhada dos dados atuais", COMANDO_BARRAMENTO, comandoAnalise},
+  {"saida", "saida texto|binario", "Formato das amostras (binário: COBS + CRC)", COMANDO_AQUISICAO, comandoSaida},
+  {"agenda", "agenda", "Períodos, taxas alcançadas e prazos perdidos por fonte", COMANDO_AQUISICAO, comandoAgenda},
+  {"jitter", "jitter [zerar]", "Atraso da captura, espaçamento real e deriva por fonte", COMANDO_AQUISICAO,
+   comandoJitter},
+  {"periodo", "periodo <fonte> <ms> [prio]", "Ajusta o período de uma fonte", COMANDO_AQUISICAO, comandoPeriodo},
+  {"metrics", "metrics [json] [zerar]", "Latências (p50/p95/p99) e erros por dispositivo e função",
+   COMANDO_AQUISICAO, comandoMetrics},
+  {"optimize", "optimize [aplicar]", "Sobe o baud rate dos sensores (sem 'aplicar': só ensaio)", COMANDO_BARRAMENTO,
+   comandoOptimize},
+  {"cache", "cache apagar", "Apaga o cache de descoberta (próximo boot varre tudo)", COMANDO_AQUISICAO,
+   comandoCache},
+  {"dump", "dump [de] [ate]", "Diário na flash: estado ou registros da faixa (s) em CSV", COMANDO_SAIDA,
+   executarDump},
+  {"saude", "saude [zerar]", "Estado de cada dispositivo, reconexões e barramento perdido com os sem resposta",
+   COMANDO_AQUISICAO, comandoSaude},
+  {"console", "console [zerar]", "Ida e volta dos comandos e quanto seguraram a aquisição", COMANDO_AQUISICAO,
+   comandoConsole},
+  {"cancelar", "cancelar", "Interrompe o comando longo em andamento (scan, diag, stress...)", COMANDO_AQUISICAO, comandoCancelar},
+  {"ajuda", "ajuda", "Esta lista", COMANDO_SAIDA, comandoAjuda},
+};
+constexpr size_t NUM_COMANDOS = sizeof(COMANDOS) / sizeof(COMANDOS[0]);
+
+void mostrarAjuda() {
+  Serial.println("📋 Comandos disponíveis via Serial:");
+  for (size_t i = 0; i < NUM_COMANDOS; i++) {
+    Serial.printf("- '%s' - %s\n", COMANDOS[i].uso, COMANDOS[i].ajuda);
+  }
+}
+
+// Maior tempo em que a aquisição ficou presa num comando ou numa fatia
+void registrarBloqueio(const char* nome, uint32_t duracao_us) {
+  if (duracao_us <= maior_bloqueio_us) return;
+  maior_bloqueio_us = duracao_us;
+  nome_maior_bloqueio = nome;
+}
+
+// Comando da fila (a saída só enfileira nomes da tabela). Com um trabalho em
+// andamento, os que usam o barramento são recusados.
+void executarComando(const ComandoConsole& comando) {
+  const char* argumentos;
+  const EntradaComando* entrada = procurarComando(COMANDOS, NUM_COMANDOS, comando.texto, &argumentos);
+  if (!entrada) return;
+  
+  if (entrada->tarefa == COMANDO_BARRAMENTO && trabalho.ativo()) {
+    saida_console.printf("⏳ '%s' em andamento: aguarde ou use 'cancelar'\n", trabalho.nome());
+  } else {
+    uint32_t inicio = micros();
+    entrada->executar(argumentos);
+    registrarBloqueio(entrada->nome, micros() - inicio);
+  }
+  ida_volta_comandos.registrar(micros() - comando.recebido_us);
+  trabalho_em_andamento = trabalho.ativo();
+}
+
+// Uma fatia do trabalho em andamento; no fim, quanto ele durou e segurou
+void executarFatia() {
+  bool continua = trabalho.fatia();
+  registrarBloqueio(trabalho.nome(), trabalho.ultimaFatiaUs());
+  if (continua) return;
+  saida_console.printf("⏱️  '%s': %lu ms em %lu fatias, a maior de %lu μs\n", trabalho.nome(),
+                       (unsigned long)trabalho.decorridoMs(), (unsigned long)trabalho.fatias(),
+                       (unsigned long)trabalho.maiorFatiaUs());
+  trabalho_em_andamento = false;
+}
+
+// Callback do temporizador de amostragem (fora da aquisição: só avança o relógio)
+void aoDispararRelogio() {
+  relogio.disparar(micros());
+}
+
+// Tarefa de aquisição (núcleo 1): dona do barramento RS-485 0. Acordada pelo
+// temporizador a cada tick, além do intervalo de 1 ms.
+void passoAquisicao() {
+  MestreModbusAsync& mestre = mestres[0];
+  ComandoConsole comando;
+  if ((mestre.ocioso() || trabalho.ativo()) && fila_comandos.retirar(comando)) executarComando(comando);
+  
+  // Comando longo: uma fatia por passo. Sem ser dono do barramento ('diag'),
+  // espera a transação do escalonador terminar.
+  if (trabalho.usaBarramento() || (trabalho.ativo() && mestre.ocioso())) executarFatia();
+  
+  // Varredura em segundo plano terminou: a NVS só é escrita daqui
+  if (gravar_cache.exchange(false)) salvarCache();
+  
+  // Avançar transações Modbus sem bloquear
+  mestre.processar();
+  
+  // Inicia as leituras vencidas (EDF); as do barramento entram assim que a
+  // fila do mestre esvazia, coladas na transação em andamento. Com o scan ou
+  // o stress no barramento, só as fontes locais.
+  escalonador.passo(relogio.agoraMs(), mestre.pendentes() == 0 && !trabalho.usaBarramento());
+  
+  // O texto do comando ou da fatia deste passo fica inteiro para a saída
+  saida_console.confirmar();
+}
+
+// Tarefas dos barramentos extras (núcleo 1): cada uma é dona do seu
+// barramento e lê o registro em rodízio, sem esperar pelas outras, então a
+// vazão total cresce com o número de UARTs. A varredura pedida pelo 'scan'
+// roda aqui, uma sonda por passo, com o mestre ocioso.
+void passoBarramento(uint8_t barramento) {
+  MestreModbusAsync& mestre = mestres[barramento];
+  mestre.processar();
+  if (!mestre.ocioso()) return;
+
+  Descoberta& descoberta = descobertas[barramento];
+  if (varredura_pedida[barramento].exchange(false)) {
+    registro.limpar(barramento);
+    descoberta.iniciar(configDescoberta(barramento), registrarDispositivo, &descoberta);
+  }
+  if (descoberta.ativa()) {
+    if (!descoberta.passo()) {
+      restaurarBaud(barramento);
+      gravar_cache = true;
+    }
+    return;
+  }
+  registro.lerProximo(barramento, mestre);
+}
+
+void passoBarramento1() {
+  passoBarramento(1);
+}
+
+constexpr PassoTarefa PASSOS_BARRAMENTO[HAL_MAX_BARRAMENTOS] = {passoAquisicao, passoBarramento1};
+
+// Tarefa de processamento (núcleo 0): validação conforme manuais
+void passoProcessamento() {
+  Amostra amostra;
+  while (fila_amostras.retirar(amostra)) {
+    // Em modo binário os alertas vão nas flags do registro, sem texto na linha.
+    // Cada alerta só sai na amostra em que a leitura foi atualizada.
+    bool texto = modo_saida == SAIDA_TEXTO;
+    if (texto && atualizou(amostra, fonte_anemometro)) {
+      validarAnemometro(amostra.resultado_anemometro, amostra.dados);
+    }
+    if (amostra.biruta_conectada) {
+      if (texto && atualizou(amostra, fonte_biruta)) {
+        validarBiruta(amostra.resultado_biruta, amostra.dados);
+      }
+    }
+    if (isnan(amostra.dados.temperature)) {
+      if (texto && atualizou(amostra, fonte_temperatura)) LOG_AVISO("temperatura", "⚠️  Erro ao ler temperatura MAX6675");
+      amostra.dados.temperature = -999;
+    }
+    atualizarEstatisticasVento(amostra);
+    publicarMapaEscravo(amostra);
+    fila_saida.inserir(amostra);
+  }
+}
+
+// Linha completa do console: comandos da saída rodam aqui, os outros vão
+// para a aquisição pela fila
+void despacharLinha(const char* linha) {
+  const char* argumentos;
+  const EntradaComando* entrada = procurarComando(COMANDOS, NUM_COMANDOS, linha, &argumentos);
+  if (!entrada) {
+    Serial.println("❌ Comando não reconhecido.");
+    Serial.print("Comandos disponíveis:");
+    for (size_t i = 0; i < NUM_COMANDOS; i++) {
+      Serial.print(i ? ", " : " ");
+      Serial.print(COMANDOS[i].nome);
+    }
+    Serial.println();
+    return;
+  }
+  // O diário é da tarefa de saída: 'dump' roda aqui, sem passar pela aquisição
+  if (entrada->tarefa == COMANDO_SAIDA) {
+    entrada->executar(argumentos);
+    return;
+  }
+  ComandoConsole comando;
+  snprintf(comando.texto, sizeof(comando.texto), "%s", linha);
+  comando.recebido_us = micros();
+  if (!fila_comandos.inserir(comando)) Serial.println("⏳ Comando ignorado: fila cheia");
+}
+
+// Tarefa de saída (núcleo 0): relatório na Serial e leitura do console
+void passoSaida() {
+  // Só os bytes que já chegaram: nada de esperar o timeout do Stream
+  while (Serial.available()) {
+    if (leitor_console.alimentar(Serial.read())) despacharLinha(leitor_console.linha());
+  }
+  
+  // Respostas dos comandos: só o que cabe no buffer da UART, sem esperar por
+  // ela. Até a resposta sair inteira, o log e o relatório não intercalam.
+  saida_console.escoar(Serial.availableForWrite());
+  if (saida_console.pendentes()) return;
+  
+  // Log: formatado aqui, poucas linhas por passo, não em quem registrou.
+  // Saída binária: texto no meio dos quadros COBS quebraria o receptor.
+  if (modo_saida == SAIDA_BINARIA) {
+    while (log_sistema.suprimirProxima()) {
+    }
+  } else {
+    char linha[LOG_MAX_LINHA];
+    for (uint8_t i = 0; i < LOG_LINHAS_POR_PASSO && Serial.availableForWrite() >= LOG_MAX_LINHA &&
+                        log_sistema.formatarProxima(linha, sizeof(linha)); i++) {
+      Serial.println(linha);
+    }
+  }
+  
+  static bool primeira_informada = false;
+  if (!primeira_informada && primeira_amostra_ms && modo_saida == SAIDA_TEXTO) {
+    primeira_informada = true;
+    Serial.printf("⏱️  Primeira amostra %lu ms após o boot\n", (unsigned long)primeira_amostra_ms);
+  }
+  
+  // Binário: todas as amostras. Texto: a mais recente a cada INTERVALO_RELATORIO_MS
+  static Amostra ultima;
+  static bool ha_nova = false;
+  static unsigned long ultimo_relatorio = 0;
+  static unsigned long ultimo_diario = 0;
+  
+  Amostra amostra;
+  while (fila_saida.retirar(amostra)) {
+    if (diario.montado() && millis() - ultimo_diario >= DIARIO_PERIODO_MS) {
+      ultimo_diario = millis();
+      diario.anexar(registroTelemetria(amostra), diario.tempoAgora());
+    }
+    if (modo_saida == SAIDA_BINARIA) {
+      enviarTelemetria(amostra);
+    } else {
+      ultima = amostra;
+      ha_nova = true;
+    }
+  }
+  
+  // Durante um trabalho do console só o relatório em texto espera; fora dele,
+  // espera o buffer da UART esvaziar para sair sem prender a tarefa
+  if (ha_nova && !trabalho_em_andamento && millis() - ultimo_relatorio >= INTERVALO_RELATORIO_MS &&
+      Serial.availableForWrite() >= SERIAL_BUFFER_TX) {
+    ultimo_relatorio = millis();
+    ha_nova = false;
+    exibirDados(ultima);
+  }
+}
+
+// Tarefa do escravo (núcleo 0): responde ao SCADA a partir do mapa em memória
+void passoEscravo() {
+  escravo.processar();
+}
+
+void setup() {
+  Serial.setTxBufferSize(SERIAL_BUFFER_TX);
+  Serial.begin(115200);
+  Serial.println("🌪️  === SISTEMA DE MONITORAMENTO METEOROLÓGICO SEGURO ===");
+  Serial.println("✅ Apenas operações de LEITURA - sem risco aos equipamentos");
+  Serial.println("Iniciando...");
+  
+  // Configurar pino DE/RE e sensor UV
+  halIniciar();
+  if (num_barramentos < 1) num_barramentos = 1;
+  if (num_barramentos > HAL_MAX_BARRAMENTOS) num_barramentos = HAL_MAX_BARRAMENTOS;
+  if (num_barramentos > 1 && modo_escravo) {
+    // O barramento 1 usa a UART1 e o MAX485 da porta do escravo
+    modo_escravo = false;
+    Serial.println("⚠️  Barramento 1 na UART1: escravo Modbus desativado");
+  }
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    mestres[b].iniciar(config_descoberta.turnaround_us, b);
+  }
+  configurarFontes();
+  registro.configurarSaude(config_saude);
+  
+  if (diario.montar()) {
+    Serial.printf("🗄️  Diário: %lu registros, continua em %lu s\n", (unsigned long)diario.registros(),
+                  (unsigned long)diario.tempoAgora());
+  } else {
+    Serial.println("⚠️  Diário na flash indisponível");
+  }
+  
+  // Boot a quente pelo cache da NVS; sem cache (ou sem resposta), varredura completa
+  bool detectados = restaurarDoCache() || detectarDispositivos();
+  salvarCache();
+  if (detectados) {
+    Serial.println("✅ Sistema inicializado com sucesso!");
+    
+    // Mostrar relatório inicial
+    mostrarDispositivosDetectados(Serial);
+    
+    // Configurar comunicação com baud rate detectado
+    if (anemometro_connected || biruta_connected) {
+      halRs485Iniciar(0, current_baud_rate);
+      
+      if (anemometro_connected) {
+        Serial.printf("🎯 Anemômetro configurado: ID %d, %d bps\n", anemometro_id, current_baud_rate);
+      }
+      
+      if (biruta_connected) {
+        Serial.printf("🎯 Biruta configurada: ID %d, %d bps\n", biruta_id, current_baud_rate);
+      }
+    }
+    
+  } else {
+    Serial.println("❌ ERRO: Falha na inicialização. Verifique as conexões.");
+    Serial.println("Verificar:");
+    Serial.println("  • Conexões físicas (A/B do RS485)");
+    Serial.println("  • Alimentação dos sensores");
+    Serial.println("  • Terminação de 120Ω nas extremidades");
+  }
+  
+  Serial.println("===========================================");
+  mostrarAjuda();
+  Serial.println("===========================================");
+  
+  // ADC só agora: durante a varredura ninguém esvaziaria o buffer do DMA
+  filtro_uv.configurar(ADC_DECIMACAO, ADC_ALFA_IIR);
+  if (halAdcIniciar(ADC_TAXA_HZ)) {
+    Serial.printf("☀️  ADC UV contínuo: %lu Hz por DMA, calibração %s\n", (unsigned long)ADC_TAXA_HZ, halAdcCalibracao());
+  } else {
+    Serial.println("⚠️  ADC contínuo indisponível: índice UV não será atualizado");
+  }
+  
+  // Pipeline: a aquisição fica sozinha no núcleo 1 com prioridade maior, para
+  // que Serial e processamento nunca atrasem uma transação no barramento. Daqui
+  // em diante o texto dos comandos passa pelo anel e sai pela tarefa de saída.
+  saida_console.direto(false);
+  halCriarTarefa("aquisicao", passoAquisicao, NUCLEO_AQUISICAO, 3, 1);
+  halCriarTarefa("processamento", passoProcessamento, NUCLEO_PROCESSAMENTO, 2, 10);
+  halCriarTarefa("saida", passoSaida, NUCLEO_PROCESSAMENTO, 1, 20);
+  for (uint8_t b = 1; b < num_barramentos; b++) {
+    halCriarTarefa("barramento", PASSOS_BARRAMENTO[b], NUCLEO_AQUISICAO, 3, 1);
+  }
+  tarefas_iniciadas = true;
+  // Temporizador só depois da aquisição existir: é ela que ele acorda
+  if (relogio.iniciar(RELOGIO_TICK_US, aoDispararRelogio, passoAquisicao)) {
+    Serial.printf("⏱️  Relógio de amostragem: temporizador a cada %lu µs\n", (unsigned long)RELOGIO_TICK_US);
+  } else {
+    Serial.println("⚠️  Temporizador indisponível: escalonador segue o millis()");
+  }
+  if (modo_escravo) {
+    halEscravoIniciar(ESCRAVO_BAUD);
+    escravo.iniciar(escravo_id, &mapa_escravo);
+    halCriarTarefa("escravo", passoEscravo, NUCLEO_PROCESSAMENTO, 4, 1);
+    Serial.printf("🔌 Escravo Modbus: ID %d, %lu bps (input registers 0x0000-0x%04X)\n",
+                  escravo_id, (unsigned long)ESCRAVO_BAUD, ESCRAVO_NUM_REGISTROS - 1);
+  }
+}
+
+void loop() {
+  halExecutarTarefas();
+}
@@ -0,0 +1,140 @@
+#include "metricas_modbus.h"
+
+static MetricasBarramento metricas[HAL_MAX_BARRAMENTOS];
+
+MetricasBarramento& metricasModbus(uint8_t barramento) {
+  return metricas[barramento < HAL_MAX_BARRAMENTOS ? barramento : 0];
+}
+
+// Faixa 0: abaixo de 256 µs. Depois, 4 faixas por oitava pelos 2 bits
+// seguintes ao bit mais alto.
+uint8_t HistogramaLatencia::faixa(uint32_t us) {
+  if (us < (1UL << METRICAS_OITAVA_MIN)) return 0;
+  int oitava = 31 - __builtin_clz(us);
+  if (oitava >= METRICAS_OITAVA_MIN + METRICAS_OITAVAS) return METRICAS_FAIXAS - 1;
+  uint32_t sub = (us >> (oitava - 2)) & 3;
+  return (uint8_t)(1 + (oitava - METRICAS_OITAVA_MIN) * 4 + sub);
+}
+
+uint32_t HistogramaLatencia::limiteSuperior(uint8_t faixa) {
+  if (faixa == 0) return (1UL << METRICAS_OITAVA_MIN) - 1;
+  int oitava = METRICAS_OITAVA_MIN + (faixa - 1) / 4;
+  uint32_t sub = (faixa - 1) % 4;
+  return ((4 + sub + 1) << (oitava - 2)) - 1;
+}
+
+void HistogramaLatencia::registrar(uint32_t us) {
+  contagens_[faixa(us)]++;
+  total_++;
+  soma_ += us;
+  if (us > maximo_) maximo_ = us;
+}
+
+void HistogramaLatencia::zerar() {
+  *this = HistogramaLatencia();
+}
+
+uint32_t HistogramaLatencia::percentil(float p) const {
+  if (!total_) return 0;
+  uint32_t alvo = (uint32_t)(p / 100.0f * total_ + 0.5f);
+  if (alvo < 1) alvo = 1;
+  uint32_t acumulado = 0;
+  for (uint8_t i = 0; i < METRICAS_FAIXAS; i++) {
+    acumulado += contagens_[i];
+    if (acumulado >= alvo) {
+      uint32_t limite = limiteSuperior(i);
+      return limite < maximo_ ? limite : maximo_;
+    }
+  }
+  return maximo_;
+}
+
+void ContadoresModbus::contar(uint8_t resultado) {
+  transacoes++;
+  if (resultado == MB_SUCESSO) sucessos++;
+  else if (resultado == MB_ERRO_TIMEOUT) timeouts++;
+  else if (resultado == MB_ERRO_CRC) erros_crc++;
+  else if (resultado < MB_ERRO_ID_INVALIDO) excecoes++;
+  else outros_erros++;
+}
+
+void MetricasBarramento::zerarAgora() {
+  for (uint8_t i = 0; i < num_dispositivos_; i++) slot_por_id_[dispositivos_[i].id] = 0;
+  for (uint8_t i = 0; i < num_dispositivos_; i++) dispositivos_[i] = MetricasDispositivo();
+  outros_ = MetricasDispositivo();
+  for (uint8_t i = 0; i < num_funcoes_; i++) funcoes_[i] = MetricasFuncao();
+  num_dispositivos_ = 0;
+  num_funcoes_ = 0;
+  total_ = ContadoresModbus();
+  bytes_enviados_ = 0;
+  bytes_recebidos_ = 0;
+  linha_us_ = 0;
+  ocupado_us_ = 0;
+  sondas_ = 0;
+  inicio_ms_ = millis();
+}
+
+MetricasDispositivo& MetricasBarramento::slotDispositivo(uint8_t id) {
+  if (id == 0 || id > MODBUS_ID_MAX) return outros_;
+  uint8_t slot = slot_por_id_[id];
+  if (slot) return dispositivos_[slot - 1];
+  if (num_dispositivos_ >= METRICAS_MAX_DISPOSITIVOS) return outros_;
+  MetricasDispositivo& d = dispositivos_[num_dispositivos_++];
+  d.id = id;
+  slot_por_id_[id] = num_dispositivos_;
+  return d;
+}
+
+MetricasFuncao* MetricasBarramento::slotFuncao(uint8_t funcao) {
+  for (uint8_t i = 0; i < num_funcoes_; i++) {
+    if (funcoes_[i].funcao == funcao) return &funcoes_[i];
+  }
+  if (num_funcoes_ >= MAX_FUNCOES) return nullptr;
+  MetricasFuncao& f = funcoes_[num_funcoes_++];
+  f.funcao = funcao;
+  return &f;
+}
+
+void MetricasBarramento::registrar(uint8_t id, uint8_t funcao, uint8_t resultado, uint32_t duracao_us,
+                                   uint16_t bytes_recebidos, uint32_t baud) {
+  if (zerar_pedido_.exchange(false)) zerarAgora();
+
+  uint32_t t_char = modbusTempoCaractereUs(baud);
+  bytes_enviados_ += MODBUS_TAM_REQUISICAO;
+  bytes_recebidos_ += bytes_recebidos;
+  linha_us_ += (uint64_t)(MODBUS_TAM_REQUISICAO + bytes_recebidos) * t_char;
+  ocupado_us_ += (uint64_t)MODBUS_TAM_REQUISICAO * t_char + duracao_us;
+  if (suspensa_) {
+    sondas_++;
+    return;
+  }
+
+  total_.contar(resultado);
+  MetricasDispositivo& d = slotDispositivo(id);
+  d.contadores.contar(resultado);
+  MetricasFuncao* f = slotFuncao(funcao);
+  if (f) f->contadores.contar(resultado);
+
+  // Timeout não tem latência: só a espera configurada
+  if (resultado == MB_ERRO_TIMEOUT) return;
+  d.latencia.registrar(duracao_us);
+  if (f) f->latencia.registrar(duracao_us);
+}
+
+void MetricasBarramento::registrarRetentativa(uint8_t id, uint8_t funcao) {
+  if (suspensa_) return;
+  total_.retentativas++;
+  slotDispositivo(id).contadores.retentativas++;
+  MetricasFuncao* f = slotFuncao(funcao);
+  if (f) f->contadores.retentativas++;
+}
+
+float MetricasBarramento::utilizacao() const {
+  uint32_t janela = janelaMs();
+  return janela ? (float)((double)linha_us_ / (janela * 1000.0)) : 0.0f;
+}
+
+float MetricasBarramento::ocupacao() const {
+  uint32_t janela = janelaMs();
+  return janela ? (float)((double)ocupado_us_ / (janela * 1000.0)) : 0.0f;
+}
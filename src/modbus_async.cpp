@@ -0,0 +1,102 @@
+#include "modbus_async.h"
+#include "hal.h"
+#include "metricas_modbus.h"
+
+void MestreModbusAsync::iniciar(uint32_t turnaround_us, uint8_t barramento) {
+  turnaround_us_ = turnaround_us;
+  barramento_ = barramento;
+  inicio_fila_ = 0;
+  pendentes_ = 0;
+  estado_ = MESTRE_OCIOSO;
+  fim_quadro_us_ = micros();
+}
+
+bool MestreModbusAsync::enfileirar(const RequisicaoModbus& requisicao) {
+  if (pendentes_ >= FILA_MODBUS_MAX) return false;
+  fila_[(inicio_fila_ + pendentes_) % FILA_MODBUS_MAX] = requisicao;
+  pendentes_++;
+  return true;
+}
+
+void MestreModbusAsync::transmitir() {
+  atual_ = fila_[inicio_fila_];
+  inicio_fila_ = (inicio_fila_ + 1) % FILA_MODBUS_MAX;
+  pendentes_--;
+
+  uint8_t quadro[MODBUS_TAM_REQUISICAO];
+  modbusMontarLeitura(quadro, atual_.id, atual_.funcao, atual_.registrador, atual_.quantidade);
+
+  recebidos_ = 0;
+  esperados_ = 5;
+  vista_ = RespostaModbus();
+  halRs485Descartar(barramento_);
+  halRs485Direcao(barramento_, true);    // preTransmission
+  halRs485Escrever(barramento_, quadro, sizeof(quadro));
+  marca_us_ = micros();
+  inicio_us_ = marca_us_;
+  estado_ = MESTRE_TRANSMITINDO;
+}
+
+void MestreModbusAsync::concluir(uint8_t resultado) {
+  resultado_ = resultado;
+  transacoes_++;
+  if (resultado == MB_ERRO_TIMEOUT) timeouts_++;
+  fim_quadro_us_ = micros();
+  uint32_t fim = recebidos_ ? marca_us_ : fim_quadro_us_;   // Último byte ou desistência
+  captura_us_ = fim;
+  metricasModbus(barramento_).registrar(atual_.id, atual_.funcao, resultado, fim - fim_envio_us_,
+                                        recebidos_, halRs485Baud(barramento_));
+  estado_ = MESTRE_CONCLUIDO;
+}
+
+void MestreModbusAsync::processar() {
+  uint32_t baud = halRs485Baud(barramento_);
+  uint32_t t35 = modbusT35Us(baud);
+  uint32_t t_char = modbusTempoCaractereUs(baud);
+  uint32_t agora = micros();
+
+  switch (estado_) {
+    case MESTRE_OCIOSO:
+      // Respeita o silêncio de 3,5 caracteres entre quadros
+      if (pendentes_ && agora - fim_quadro_us_ >= t35) transmitir();
+      break;
+
+    case MESTRE_TRANSMITINDO:
+      if (halRs485EnvioConcluido(barramento_)) {
+        halRs485Direcao(barramento_, false);   // postTransmission
+        marca_us_ = agora;
+        fim_envio_us_ = agora;
+        estado_ = MESTRE_TURNAROUND;
+      }
+      break;
+
+    case MESTRE_TURNAROUND:
+    case MESTRE_RECEBENDO:
+      while (halRs485Disponivel(barramento_) && recebidos_ < esperados_) {
+        resposta_[recebidos_++] = (uint8_t)halRs485Ler(barramento_);
+        size_t tamanho = modbusTamanhoResposta(resposta_, recebidos_);
+        if (tamanho) esperados_ = (uint16_t)tamanho;
+        marca_us_ = agora;
+        estado_ = MESTRE_RECEBENDO;
+      }
+
+      if (recebidos_ >= esperados_) {
+        concluir(modbusValidarResposta(resposta_, recebidos_, atual_.id, atual_.funcao, vista_));
+      } else if (estado_ == MESTRE_TURNAROUND) {
+        uint32_t turnaround = atual_.turnaround_us ? atual_.turnaround_us : turnaround_us_;
+        if (agora - marca_us_ > t_char + t35 + turnaround) concluir(MB_ERRO_TIMEOUT);
+      } else if (agora - marca_us_ > t_char + t35) {
+        // Silêncio no meio do quadro: resposta truncada
+        concluir(MB_ERRO_CRC);
+      }
+      break;
+
+    case MESTRE_CONCLUIDO:
+      break;
+  }
+
+  if (estado_ == MESTRE_CONCLUIDO) {
+    estado_ = MESTRE_OCIOSO;
+    if (atual_.callback) atual_.callback(atual_, resultado_, vista_, atual_.contexto);
+  }
+}
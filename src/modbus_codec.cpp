@@ -0,0 +1,82 @@
+#include "modbus_codec.h"
+
+// Tabela do CRC-16/MODBUS (polinômio refletido 0xA001), gerada pelo compilador
+struct TabelaCrc16 {
+  uint16_t valores[256];
+};
+
+static constexpr TabelaCrc16 gerarTabelaCrc16() {
+  TabelaCrc16 tabela = {};
+  for (uint16_t i = 0; i < 256; i++) {
+    uint16_t crc = i;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+    tabela.valores[i] = crc;
+  }
+  return tabela;
+}
+
+static constexpr TabelaCrc16 TABELA_CRC16 = gerarTabelaCrc16();
+static_assert(TABELA_CRC16.valores[1] == 0xC0C1 && TABELA_CRC16.valores[255] == 0x4040,
+              "tabela CRC16/MODBUS incorreta");
+
+uint16_t modbusCrc16(const uint8_t* dados, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc = (crc >> 8) ^ TABELA_CRC16.valores[(crc ^ dados[i]) & 0xFF];
+  }
+  return crc;
+}
+
+bool modbusCrcValido(const uint8_t* quadro, size_t len) {
+  if (len < 4) return false;
+  uint16_t crc = modbusCrc16(quadro, len - 2);
+  return quadro[len - 2] == (crc & 0xFF) && quadro[len - 1] == (crc >> 8);
+}
+
+size_t modbusMontarLeitura(uint8_t* quadro, uint8_t id, uint8_t funcao,
+                           uint16_t registrador, uint16_t quantidade) {
+  quadro[0] = id;
+  quadro[1] = funcao;
+  quadro[2] = registrador >> 8;
+  quadro[3] = registrador & 0xFF;
+  quadro[4] = quantidade >> 8;
+  quadro[5] = quantidade & 0xFF;
+  uint16_t crc = modbusCrc16(quadro, 6);
+  quadro[6] = crc & 0xFF;
+  quadro[7] = crc >> 8;
+  return MODBUS_TAM_REQUISICAO;
+}
+
+size_t modbusTamanhoResposta(const uint8_t* resposta, size_t recebidos) {
+  if (recebidos < 3) return 0;
+  return (resposta[1] & 0x80) ? 5 : 5 + (size_t)resposta[2];
+}
+
+uint8_t modbusValidarResposta(const uint8_t* resposta, size_t len, uint8_t id, uint8_t funcao,
+                              RespostaModbus& vista) {
+  size_t esperados = modbusTamanhoResposta(resposta, len);
+  if (esperados == 0 || len < esperados) {
+    return len == 0 ? MB_ERRO_TIMEOUT : MB_ERRO_CRC;
+  }
+  if (!modbusCrcValido(resposta, esperados)) return MB_ERRO_CRC;
+  if (resposta[0] != id) return MB_ERRO_ID_INVALIDO;
+  if ((resposta[1] & 0x7F) != funcao) return MB_ERRO_FUNCAO;
+  if (resposta[1] & 0x80) return resposta[2];
+
+  vista.quadro = resposta;
+  vista.num_registradores = resposta[2] / 2;
+  return MB_SUCESSO;
+}
+
+uint8_t modbusDecodificarResposta(const uint8_t* resposta, size_t len, uint8_t id, uint8_t funcao,
+                                  uint16_t quantidade, uint16_t* destino) {
+  RespostaModbus vista;
+  uint8_t codigo = modbusValidarResposta(resposta, len, id, funcao, vista);
+  if (codigo != MB_SUCESSO) return codigo;
+  for (uint16_t i = 0; i < quantidade && i < vista.num_registradores; i++) {
+    destino[i] = vista.registrador(i);
+  }
+  return MB_SUCESSO;
+}
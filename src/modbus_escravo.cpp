@@ -0,0 +1,133 @@
+#include "modbus_escravo.h"
+#include <string.h>
+
+// Tentativas de cópia antes de desistir e usar a cópia anterior
+static const uint8_t TENTATIVAS_COPIA = 3;
+
+void MapaEscravo::publicar(const uint16_t* registros) {
+  uint32_t versao = versao_.load(std::memory_order_relaxed);
+  versao_.store(versao + 1, std::memory_order_relaxed);   // Ímpar: escrita em andamento
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(registros_, registros, sizeof(registros_));
+  versao_.store(versao + 2, std::memory_order_release);
+}
+
+bool MapaEscravo::copiar(uint16_t* destino) const {
+  uint16_t copia[ESCRAVO_NUM_REGISTROS];
+  for (uint8_t i = 0; i < TENTATIVAS_COPIA; i++) {
+    uint32_t antes = versao_.load(std::memory_order_acquire);
+    if (antes & 1) continue;
+    memcpy(copia, registros_, sizeof(copia));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (versao_.load(std::memory_order_relaxed) == antes) {
+      memcpy(destino, copia, sizeof(copia));
+      return true;
+    }
+  }
+  return false;
+}
+
+void EscravoModbus::iniciar(uint8_t id, const MapaEscravo* mapa) {
+  id_ = id;
+  mapa_ = mapa;
+  recebidos_ = 0;
+  transmitindo_ = false;
+  if (mapa_) mapa_->copiar(copia_);
+}
+
+void EscravoModbus::processar() {
+  if (transmitindo_) {
+    if (!halEscravoEnvioConcluido()) return;
+    halEscravoDirecao(false);
+    transmitindo_ = false;
+  }
+
+  uint32_t agora = micros();
+  uint32_t t35 = modbusT35Us(halEscravoBaud());
+
+  // Silêncio de 3,5 caracteres encerra o quadro (função desconhecida ou lixo)
+  if (recebidos_ && !halEscravoDisponivel() && agora - ultimo_byte_us_ > t35) {
+    atender();
+    return;
+  }
+
+  while (halEscravoDisponivel()) {
+    uint8_t byte = (uint8_t)halEscravoLer();
+    if (recebidos_ < sizeof(quadro_)) quadro_[recebidos_++] = byte;
+    ultimo_byte_us_ = agora;
+
+    // Leituras têm tamanho fixo: responde sem esperar o silêncio de fim de quadro
+    if (recebidos_ == MODBUS_TAM_REQUISICAO &&
+        (quadro_[1] == MB_FC_READ_INPUT || quadro_[1] == MB_FC_READ_HOLDING)) {
+      atender();
+      return;
+    }
+  }
+}
+
+void EscravoModbus::atender() {
+  uint16_t len = recebidos_;
+  recebidos_ = 0;
+  if (len < 4) return;
+  if (!modbusCrcValido(quadro_, len)) {
+    erros_crc_++;
+    return;
+  }
+  if (quadro_[0] != id_) return;   // Outro escravo ou broadcast (leitura não tem broadcast)
+
+  uint8_t funcao = quadro_[1];
+  if (funcao != MB_FC_READ_INPUT || len != MODBUS_TAM_REQUISICAO) {
+    responderExcecao(funcao, MB_EXC_FUNCAO_ILEGAL);
+    return;
+  }
+
+  uint16_t registrador = (uint16_t)((quadro_[2] << 8) | quadro_[3]);
+  uint16_t quantidade = (uint16_t)((quadro_[4] << 8) | quadro_[5]);
+  if (quantidade < 1 || quantidade > MODBUS_MAX_REGISTRADORES) {
+    responderExcecao(funcao, MB_EXC_VALOR_ILEGAL);
+    return;
+  }
+  if ((uint32_t)registrador + quantidade > ESCRAVO_NUM_REGISTROS) {
+    responderExcecao(funcao, MB_EXC_ENDERECO_ILEGAL);
+    return;
+  }
+
+  uint16_t atual[ESCRAVO_NUM_REGISTROS];
+  if (mapa_ && mapa_->copiar(atual)) {
+    memcpy(copia_, atual, sizeof(copia_));
+  } else {
+    copias_antigas_++;
+  }
+
+  uint8_t resposta[5 + 2 * ESCRAVO_NUM_REGISTROS];
+  resposta[0] = id_;
+  resposta[1] = funcao;
+  resposta[2] = (uint8_t)(quantidade * 2);
+  for (uint16_t i = 0; i < quantidade; i++) {
+    uint16_t valor = copia_[registrador + i];
+    resposta[3 + i * 2] = valor >> 8;
+    resposta[4 + i * 2] = valor & 0xFF;
+  }
+  size_t tamanho = 3 + quantidade * 2;
+  uint16_t crc = modbusCrc16(resposta, tamanho);
+  resposta[tamanho++] = crc & 0xFF;
+  resposta[tamanho++] = crc >> 8;
+
+  responder(resposta, tamanho);
+  respostas_++;
+}
+
+void EscravoModbus::responderExcecao(uint8_t funcao, uint8_t codigo) {
+  uint8_t resposta[5] = {id_, (uint8_t)(funcao | 0x80), codigo};
+  uint16_t crc = modbusCrc16(resposta, 3);
+  resposta[3] = crc & 0xFF;
+  resposta[4] = crc >> 8;
+  responder(resposta, sizeof(resposta));
+  excecoes_++;
+}
+
+void EscravoModbus::responder(const uint8_t* quadro, size_t len) {
+  halEscravoDirecao(true);
+  halEscravoEscrever(quadro, len);
+  transmitindo_ = true;
+}
@@ -0,0 +1,97 @@
+#include "modbus_rtu.h"
+#include "hal.h"
+#include "metricas_modbus.h"
+#include <string.h>
+
+// Envia 'quadro' e recebe a resposta em 'buffer'. O tamanho esperado vem
+// dos primeiros bytes: leituras trazem a contagem, a escrita (0x06) é um eco
+// de 8 bytes e exceções têm 5.
+static ResultadoLeitura trocarQuadro(const uint8_t* quadro, uint8_t funcao, uint32_t turnaround_us,
+                                     uint8_t* buffer, uint8_t barramento) {
+  ResultadoLeitura r = {MB_ERRO_TIMEOUT, 0, 0};
+
+  halRs485Descartar(barramento);
+  halRs485Direcao(barramento, true);
+  halRs485Escrever(barramento, quadro, MODBUS_TAM_REQUISICAO);
+  halRs485AguardarEnvio(barramento);
+  halRs485Direcao(barramento, false);
+
+  uint32_t baud = halRs485Baud(barramento);
+  uint32_t t35 = modbusT35Us(baud);
+  uint32_t t_char = modbusTempoCaractereUs(baud);
+
+  size_t esperados = 5;
+  uint32_t inicio = micros();
+  uint32_t ultimo = inicio;
+  uint32_t limite = t_char + t35 + turnaround_us; // Até o primeiro byte
+
+  while (r.bytes_recebidos < esperados) {
+    if (halRs485Disponivel(barramento)) {
+      buffer[r.bytes_recebidos++] = (uint8_t)halRs485Ler(barramento);
+      ultimo = micros();
+      limite = t_char + t35; // Entre caracteres: silêncio encerra o quadro
+      size_t tamanho = modbusTamanhoResposta(buffer, r.bytes_recebidos);
+      if (tamanho && funcao == MB_FC_WRITE_SINGLE && !(buffer[1] & 0x80)) tamanho = MODBUS_TAM_REQUISICAO;
+      if (tamanho) esperados = tamanho;
+      continue;
+    }
+    if (micros() - ultimo > limite) break;
+    yield();
+  }
+  r.latencia_us = ultimo - inicio;
+  return r;
+}
+
+ResultadoLeitura modbusLerQuadro(uint8_t id, uint8_t funcao, uint16_t registrador,
+                                 uint16_t quantidade, uint32_t turnaround_us,
+                                 uint8_t* buffer, RespostaModbus& vista, uint8_t barramento) {
+  uint8_t quadro[MODBUS_TAM_REQUISICAO];
+  modbusMontarLeitura(quadro, id, funcao, registrador, quantidade);
+  uint32_t inicio = micros();
+  ResultadoLeitura r = trocarQuadro(quadro, funcao, turnaround_us, buffer, barramento);
+
+  if (r.bytes_recebidos) r.codigo = modbusValidarResposta(buffer, r.bytes_recebidos, id, funcao, vista);
+  uint32_t duracao = r.bytes_recebidos ? r.latencia_us : micros() - inicio;   // Timeout: a espera inteira
+  metricasModbus(barramento).registrar(id, funcao, r.codigo, duracao, r.bytes_recebidos, halRs485Baud(barramento));
+  return r;
+}
+
+#ifdef ESCRITA_BAUD_RATE
+ResultadoLeitura modbusEscreverCodigoBaud(uint8_t id, uint16_t codigo, uint32_t turnaround_us, uint8_t barramento) {
+  // Mesmo formato da requisição de leitura: id, função, registrador, valor, CRC
+  uint8_t quadro[MODBUS_TAM_REQUISICAO];
+  modbusMontarLeitura(quadro, id, MB_FC_WRITE_SINGLE, PerfilConfiguracao::CodigoBaud::endereco, codigo);
+  uint32_t inicio = micros();
+  uint8_t buffer[MODBUS_TAM_REQUISICAO];
+  ResultadoLeitura r = trocarQuadro(quadro, MB_FC_WRITE_SINGLE, turnaround_us, buffer, barramento);
+
+  if (r.bytes_recebidos) {
+    size_t esperados = (r.bytes_recebidos >= 2 && (buffer[1] & 0x80)) ? 5 : MODBUS_TAM_REQUISICAO;
+    if (r.bytes_recebidos < esperados || !modbusCrcValido(buffer, esperados)) r.codigo = MB_ERRO_CRC;
+    else if (buffer[0] != id) r.codigo = MB_ERRO_ID_INVALIDO;
+    else if ((buffer[1] & 0x7F) != MB_FC_WRITE_SINGLE) r.codigo = MB_ERRO_FUNCAO;
+    else if (buffer[1] & 0x80) r.codigo = buffer[2];
+    else if (memcmp(buffer, quadro, MODBUS_TAM_REQUISICAO) != 0) r.codigo = MB_ERRO_FUNCAO;   // Eco diferente
+    else r.codigo = MB_SUCESSO;
+  }
+  uint32_t duracao = r.bytes_recebidos ? r.latencia_us : micros() - inicio;
+  metricasModbus(barramento).registrar(id, MB_FC_WRITE_SINGLE, r.codigo, duracao, r.bytes_recebidos,
+                                       halRs485Baud(barramento));
+  return r;
+}
+#endif
+
+ResultadoLeitura modbusLerComTimeout(uint8_t id, uint8_t funcao, uint16_t registrador,
+                                     uint16_t quantidade, uint16_t* destino,
+                                     uint32_t turnaround_us, uint8_t barramento) {
+  uint8_t buffer[MODBUS_TAM_MAX_RESPOSTA];
+  RespostaModbus vista;
+  ResultadoLeitura r = modbusLerQuadro(id, funcao, registrador, quantidade, turnaround_us, buffer, vista,
+                                       barramento);
+  if (r.codigo == MB_SUCESSO) {
+    for (uint16_t i = 0; i < quantidade && i < vista.num_registradores; i++) {
+      destino[i] = vista.registrador(i);
+    }
+  }
+  return r;
+}
@@ -0,0 +1,56 @@
+// Substituição global de operator new/delete com contagem (build nativo)
+#include "alocacoes.h"
+
+#include <cstdlib>
+#include <new>
+
+static ContagemAlocacoes contagem;
+static int suspensa = 0;
+
+ContagemAlocacoes simAlocacoes() {
+  return contagem;
+}
+
+ForaDaContagem::ForaDaContagem() {
+  suspensa++;
+}
+
+ForaDaContagem::~ForaDaContagem() {
+  suspensa--;
+}
+
+static void* alocar(std::size_t tamanho) {
+  if (!suspensa) {
+    contagem.alocacoes++;
+    contagem.bytes += tamanho;
+  }
+  void* p = std::malloc(tamanho ? tamanho : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new(std::size_t tamanho) { return alocar(tamanho); }
+void* operator new[](std::size_t tamanho) { return alocar(tamanho); }
+
+void* operator new(std::size_t tamanho, const std::nothrow_t&) noexcept {
+  try {
+    return alocar(tamanho);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t tamanho, const std::nothrow_t&) noexcept {
+  try {
+    return alocar(tamanho);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,853 @@
+// Benchmarks no host (env:native_bench)
+//
+// Mede as rotinas do firmware sobre o barramento simulado e reporta:
+//  - ciclos de CPU e tempo de parede no host (custo de processamento)
+//  - tempo simulado no barramento (quanto a rotina levaria no ESP32)
+//
+// Uso: program [--iteracoes N] [--baud B] [--perda P] [--erro-crc P] [--latencia US]
+//              [--traco ARQUIVO (quadros gravados com 'saida binario', para a compressão)]
+#include <Arduino.h>
+#include "descoberta.h"
+#include "diario_amostras.h"
+#include "hal.h"
+#include "modbus_rtu.h"
+#include "modbus_escravo.h"
+#include "otimizador_baud.h"
+#include "perfis_dispositivo.h"
+#include "escalonador.h"
+#include "estatisticas_vento.h"
+#include "filtro_adc.h"
+#include "gerador_carga.h"
+#include "metricas_modbus.h"
+#include "registro_dispositivos.h"
+#include "relogio_amostragem.h"
+#include "rs485_sim.h"
+#include "serie_temporal.h"
+#include "alocacoes.h"
+#include "console.h"
+#include "log_async.h"
+#include "tipos.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Rotinas do firmware (src/main.cpp)
+extern ConfigDescoberta config_descoberta;
+extern Descoberta descobertas[HAL_MAX_BARRAMENTOS];
+bool detectarDispositivos();
+bool restaurarDoCache();
+void salvarCache();
+bool lerAnemometro();
+bool lerBiruta();
+void setup();
+void loop();
+extern uint32_t amostras_publicadas;
+extern Escalonador escalonador;
+extern RelogioAmostragem relogio;
+extern JitterAmostragem jitter_fontes[ESCALONADOR_MAX_FONTES];
+extern EscravoModbus escravo;
+extern DiarioAmostras diario;
+extern TrabalhoConsole trabalho;
+extern HistogramaLatencia ida_volta_comandos;
+extern uint32_t maior_bloqueio_us;
+extern const char* nome_maior_bloqueio;
+
+struct Medida {
+  const char* nome;
+  uint32_t execucoes;
+  uint64_t ciclos;
+  double parede_us;
+  uint64_t simulado_us;
+};
+
+template <typename F>
+static Medida medir(const char* nome, uint32_t execucoes, F&& rotina) {
+  Medida m = {nome, execucoes, 0, 0.0, 0};
+  uint64_t sim_inicio = simAgoraUs();
+  auto parede_inicio = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < execucoes; i++) {
+    uint32_t c0 = halCiclos();
+    rotina();
+    m.ciclos += (uint32_t)(halCiclos() - c0);
+  }
+  m.parede_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - parede_inicio).count();
+  m.simulado_us = simAgoraUs() - sim_inicio;
+  return m;
+}
+
+static void acumular(Medida& total, const Medida& m) {
+  total.execucoes += m.execucoes;
+  total.ciclos += m.ciclos;
+  total.parede_us += m.parede_us;
+  total.simulado_us += m.simulado_us;
+}
+
+static void imprimir(const Medida& m) {
+  double n = m.execucoes ? (double)m.execucoes : 1.0;
+  printf("%-34s %6u %14.0f %12.2f %14.3f\n", m.nome, m.execucoes,
+         (double)m.ciclos / n, m.parede_us / n, (double)m.simulado_us / n / 1000.0);
+}
+
+// Referência: o caminho de CPU de uma leitura no ModbusMaster (begin() a
+// cada leitura, ADU próprio, CRC bit a bit na ida e na volta, cópia para o
+// buffer de resposta e getResponseBuffer() por registrador)
+class ModbusMasterReferencia {
+public:
+  void begin(uint8_t id) {
+    id_ = id;
+    memset(resposta_, 0, sizeof(resposta_));
+    tamanho_adu_ = 0;
+  }
+
+  uint8_t lerInput(uint16_t registrador, uint16_t quantidade, const uint8_t* linha, size_t len) {
+    uint8_t adu[256] = {id_, MB_FC_READ_INPUT, (uint8_t)(registrador >> 8), (uint8_t)registrador,
+                        (uint8_t)(quantidade >> 8), (uint8_t)quantidade};
+    uint16_t crc = crcBitABit(adu, 6);
+    adu[6] = crc & 0xFF;
+    adu[7] = crc >> 8;
+    escrito_ = adu[7];
+
+    // Recepção byte a byte no mesmo ADU, validando o cabeçalho após 5 bytes
+    tamanho_adu_ = 0;
+    size_t esperados = 5;
+    for (size_t i = 0; i < len && tamanho_adu_ < esperados; i++) {
+      adu[tamanho_adu_++] = linha[i];
+      if (tamanho_adu_ == 5) {
+        if (adu[0] != id_) return MB_ERRO_ID_INVALIDO;
+        if ((adu[1] & 0x7F) != MB_FC_READ_INPUT) return MB_ERRO_FUNCAO;
+        if (adu[1] & 0x80) return adu[2];
+        esperados = 5 + adu[2];
+      }
+    }
+    crc = crcBitABit(adu, tamanho_adu_ - 2);
+    if (adu[tamanho_adu_ - 2] != (crc & 0xFF) || adu[tamanho_adu_ - 1] != (crc >> 8)) return MB_ERRO_CRC;
+    for (uint8_t i = 0; i < adu[2] / 2; i++) {
+      resposta_[i] = (uint16_t)((adu[3 + 2 * i] << 8) | adu[4 + 2 * i]);
+    }
+    return MB_SUCESSO;
+  }
+
+  uint16_t getResponseBuffer(uint8_t i) const { return resposta_[i]; }
+  uint8_t escrito() const { return escrito_; }
+
+  static uint16_t crcBitABit(const uint8_t* dados, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+      crc ^= dados[i];
+      for (int b = 0; b < 8; b++) {
+        crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+      }
+    }
+    return crc;
+  }
+
+private:
+  uint8_t id_ = 0;
+  uint16_t resposta_[64];
+  uint8_t tamanho_adu_ = 0;
+  uint8_t escrito_ = 0;
+};
+
+// Codec próprio x ModbusMaster: CRC e quadros por segundo só na CPU (sem barramento)
+static void compararCodec(uint32_t iteracoes) {
+  static uint8_t bloco[256];
+  for (size_t i = 0; i < sizeof(bloco); i++) bloco[i] = (uint8_t)(i * 31 + 7);
+  volatile uint16_t sumidouro = 0;
+  uint32_t n_crc = iteracoes * 200;
+  Medida tabela = medir("CRC16 tabela (256 B)", n_crc, [&sumidouro] { sumidouro = sumidouro + modbusCrc16(bloco, sizeof(bloco)); });
+  Medida bit = medir("CRC16 bit a bit (256 B)", n_crc, [&sumidouro] {
+    sumidouro = sumidouro + ModbusMasterReferencia::crcBitABit(bloco, sizeof(bloco));
+  });
+  imprimir(tabela);
+  imprimir(bit);
+  if (modbusCrc16(bloco, sizeof(bloco)) != ModbusMasterReferencia::crcBitABit(bloco, sizeof(bloco))) {
+    printf("❌ CRC da tabela difere do bit a bit\n");
+  }
+
+  // Resposta da biruta (direção bruta + graus), como chega na linha
+  uint8_t resposta[9] = {2, MB_FC_READ_INPUT, 4, 0x00, 0x03, 0x00, 0x87};
+  uint16_t crc = modbusCrc16(resposta, 7);
+  resposta[7] = crc & 0xFF;
+  resposta[8] = crc >> 8;
+
+  uint32_t n_quadros = iteracoes * 2000;
+  static ModbusMasterReferencia referencia;
+  Medida mm = medir("quadro ModbusMaster (ref.)", n_quadros, [&sumidouro, &resposta] {
+    referencia.begin(2);
+    if (referencia.lerInput(0, 2, resposta, sizeof(resposta)) == MB_SUCESSO) {
+      SensorData leitura;
+      leitura.wind_direction_raw = referencia.getResponseBuffer(0);
+      leitura.wind_direction_degrees = referencia.getResponseBuffer(1);
+      sumidouro = sumidouro + leitura.wind_direction_degrees + referencia.escrito();
+    }
+  });
+  Medida proprio = medir("quadro codec próprio", n_quadros, [&sumidouro, &resposta] {
+    uint8_t requisicao[MODBUS_TAM_REQUISICAO];
+    modbusMontarLeitura(requisicao, 2, MB_FC_READ_INPUT, 0, 2);
+    RespostaModbus vista;
+    if (modbusValidarResposta(resposta, sizeof(resposta), 2, MB_FC_READ_INPUT, vista) == MB_SUCESSO) {
+      SensorData leitura;
+      PerfilBiruta::Dados::decodificar(vista, leitura);   // Direção bruta, cardinal e graus
+      sumidouro = sumidouro + leitura.wind_direction_degrees + leitura.wind_direction_cardinal + requisicao[7];
+    }
+  });
+  imprimir(mm);
+  imprimir(proprio);
+  printf("codec: CRC %.1fx mais rápido; %.0f quadros/s (ModbusMaster %.0f), %.1fx\n",
+         bit.parede_us / tabela.parede_us, n_quadros / proprio.parede_us * 1e6,
+         n_quadros / mm.parede_us * 1e6, mm.parede_us / proprio.parede_us);
+}
+
+// Vazão do registro: 'barramentos' × 'por_barramento' transmissores lidos em
+// rodízio, um mestre assíncrono por barramento, durante 'segundos' simulados.
+// Retorna leituras concluídas por segundo (todas as UARTs somadas).
+static float vazaoBarramentos(uint8_t barramentos, uint8_t por_barramento, uint32_t baud,
+                              uint32_t latencia_us, uint32_t segundos, uint32_t& falhas) {
+  static RegistroDispositivos registro_bench;
+  static MestreModbusAsync mestres_bench[HAL_MAX_BARRAMENTOS];
+  uint32_t leituras_antes[HAL_MAX_BARRAMENTOS];
+  for (uint8_t b = 0; b < barramentos; b++) {
+    BarramentoSimulado& bus = simBarramento(b);
+    bus.limparSensores();
+    registro_bench.limpar(b);
+    halRs485Iniciar(b, baud);
+    mestres_bench[b].iniciar(20000, b);
+    for (uint8_t i = 0; i < por_barramento; i++) {
+      bool biruta = i % 2;
+      bus.adicionarSensor((uint8_t)(i + 1), biruta ? SimModelo::BIRUTA_FXJT : SimModelo::ANEMOMETRO_FSJT,
+                          baud, latencia_us);
+      Dispositivo d;
+      d.info.id = (uint8_t)(i + 1);
+      d.info.barramento = b;
+      d.info.baud_rate = baud;
+      d.info.tipo = biruta ? TIPO_BIRUTA : TIPO_ANEMOMETRO_BAIXA;
+      registro_bench.adicionar(d);
+    }
+    leituras_antes[b] = registro_bench.leituras(b);
+  }
+
+  // Os passos das tarefas de cada barramento, em rodízio como no HAL nativo
+  uint64_t fim_us = simAgoraUs() + (uint64_t)segundos * 1000000ULL;
+  while (simAgoraUs() < fim_us) {
+    for (uint8_t b = 0; b < barramentos; b++) {
+      mestres_bench[b].processar();
+      if (mestres_bench[b].ocioso()) registro_bench.lerProximo(b, mestres_bench[b]);
+    }
+    yield();
+  }
+
+  uint32_t leituras = 0;
+  falhas = 0;
+  for (uint8_t b = 0; b < barramentos; b++) {
+    leituras += registro_bench.leituras(b) - leituras_antes[b];
+    for (uint16_t i = 0; i < registro_bench.quantidade(b); i++) falhas += registro_bench.dispositivo(b, i).falhas;
+    simBarramento(b).limparSensores();
+  }
+  return (float)leituras / segundos;
+}
+
+// Gerador de carga no barramento 1: anemômetro e biruta em cada baud rate,
+// rampa de 500 ms por degrau até o joelho
+static void cargaPorBaud(uint32_t latencia_us) {
+  static const uint32_t BAUDS[] = {4800, 9600, 19200, 38400, 115200};
+  static GeradorCarga gerador;
+  static MestreModbusAsync mestre;
+  ConfigCarga config;
+  config.duracao_degrau_ms = 500;
+  gerador.configurar(config);
+
+  printf("%-8s %10s %12s %12s %10s %10s\n", "carga bps", "joelho/s", "sustenta/s", "sem ritmo/s",
+         "p99 us", "sucesso %");
+  BarramentoSimulado& bus = simBarramento(1);
+  for (uint32_t baud : BAUDS) {
+    bus.limparSensores();
+    bus.adicionarSensor(1, SimModelo::ANEMOMETRO_FSJT, baud, latencia_us);
+    bus.adicionarSensor(2, SimModelo::BIRUTA_FXJT, baud, latencia_us);
+    halRs485Iniciar(1, baud);
+    mestre.iniciar(20000, 1);
+    gerador.limparAlvos();
+    gerador.adicionarAlvo(1, TIPO_ANEMOMETRO_BAIXA);
+    gerador.adicionarAlvo(2, TIPO_BIRUTA);
+    gerador.executar(mestre);
+
+    const DegrauCarga& maxima = gerador.degrau(gerador.numDegraus() - 1);
+    uint32_t joelho = gerador.joelho() >= 0 ? gerador.degrau(gerador.joelho()).taxa_pedida : 0;
+    printf("%-8u %10u %12.1f %12.1f %10u %10.1f\n", baud, joelho, gerador.vazaoSustentavel(), maxima.vazao,
+           maxima.p99_us, maxima.sucessoPct());
+  }
+  bus.limparSensores();
+}
+
+// Otimizador de baud rate no barramento 1: linha boa e linha limitada a
+// 38400 bps (respostas corrompidas acima), a partir de 4800
+static void otimizadorBaud(uint32_t latencia_us) {
+  static const uint32_t LIMITES[] = {0, 38400};
+  static OtimizadorBaud otimizador;
+  BarramentoSimulado& bus = simBarramento(1);
+  SimConfig original = bus.config();
+  for (uint32_t limite : LIMITES) {
+    SimConfig config = original;
+    config.baud_max_linha = limite;
+    bus.configurar(config);
+    bus.limparSensores();
+    bus.adicionarSensor(1, SimModelo::ANEMOMETRO_FSJT, 4800, latencia_us);
+    bus.adicionarSensor(2, SimModelo::BIRUTA_FXJT, 4800, latencia_us);
+    halRs485Iniciar(1, 4800);
+    ConfigOtimizador c;
+    c.aplicar = true;
+    otimizador.configurar(c);
+    otimizador.limparDispositivos();
+    otimizador.adicionarDispositivo(1);
+    otimizador.adicionarDispositivo(2);
+    uint64_t inicio_us = simAgoraUs();
+    uint32_t final = otimizador.executar(1);
+
+    uint8_t retornos = 0;
+    for (uint8_t i = 0; i < otimizador.numPassos(); i++) retornos += otimizador.passo(i).acao == OTM_RETORNO;
+    const MedidaEnlace& antes = otimizador.medida(0);
+    const MedidaEnlace* depois = &antes;
+    for (uint8_t i = 0; i < otimizador.numMedidas(); i++) {
+      if (otimizador.medida(i).baud == final) depois = &otimizador.medida(i);
+    }
+    bool sensores_ok = bus.sensor(1)->baud == final && bus.sensor(2)->baud == final;
+    printf("otimizador (linha %s): 4800 -> %u bps em %.1f s, %.1f -> %.1f leituras/s, %u retornos, sensores %s\n",
+           limite ? "até 38400" : "boa", final, (simAgoraUs() - inicio_us) / 1e6, antes.leituras_s,
+           depois->leituras_s, retornos, sensores_ok ? "no baud final" : "DIVERGENTES");
+  }
+  bus.configurar(original);
+  bus.limparSensores();
+}
+
+static RegistroTelemetria amostraDiario(uint32_t i) {
+  RegistroTelemetria r = {};
+  r.sequencia = i;
+  r.timestamp_ms = i * 1000;
+  r.vento_dms = (uint16_t)(i % 250);
+  r.direcao_graus = (uint16_t)(i % 360);
+  r.temperatura_qc = (int16_t)(80 + i % 40);
+  r.flags = FLAG_TLM_VENTO_OK | FLAG_TLM_TEMP_OK;
+  return r;
+}
+
+static bool contarRegistro(const RegistroDiario& registro, void* contexto) {
+  uint32_t* ultimo = static_cast<uint32_t*>(contexto);
+  if (registro.amostra.sequencia != registro.tempo_s) return false;   // Conteúdo trocado
+  *ultimo = registro.tempo_s;
+  return true;
+}
+
+// Sonda de tipo no barramento 1: anemômetros com vento calmo (0x0000 na
+// faixa da biruta) que recusam 0x0001 com exceção 02 ou ficam calados, e uma
+// biruta. Todos precisam sair com o tipo certo.
+static TipoDispositivo tipos_sondados[4];
+
+static void aoSondar(const DispositivoEncontrado& d, void* /*contexto*/) {
+  if (d.id < 4) tipos_sondados[d.id] = d.tipo;
+}
+
+static void sondaTipo(uint32_t baud, uint32_t latencia_us) {
+  BarramentoSimulado& bus = simBarramento(1);
+  bus.limparSensores();
+  bus.adicionarSensor(1, SimModelo::ANEMOMETRO_FSJT, baud, latencia_us);
+  bus.adicionarSensor(2, SimModelo::ANEMOMETRO_FSJT, baud, latencia_us).mudo_fora_do_mapa = true;
+  bus.adicionarSensor(3, SimModelo::BIRUTA_FXJT, baud, latencia_us);
+  for (uint8_t id = 1; id <= 3; id++) {
+    SimSensor* s = bus.sensor(id);
+    s->vento_automatico = false;
+    s->valor_principal = 2;   // Anemômetro: 0,2 m/s; biruta: Leste
+  }
+  halRs485Iniciar(1, baud);
+
+  ConfigDescoberta config;
+  config.barramento = 1;
+  config.baud_rates[0] = baud;
+  config.num_baud_rates = 1;
+  config.id_final = 3;
+  static Descoberta descoberta;
+  for (TipoDispositivo& t : tipos_sondados) t = TIPO_DESCONHECIDO;
+  descoberta.iniciar(config, aoSondar);
+  descoberta.executar();
+  printf("sonda de tipo: anemômetro calmo com exceção 02 -> %s, calado em 0x0001 -> %s, biruta -> %s\n",
+         nomeTipo(tipos_sondados[1]), nomeTipo(tipos_sondados[2]), nomeTipo(tipos_sondados[3]));
+  if (tipos_sondados[1] != TIPO_ANEMOMETRO_BAIXA || tipos_sondados[2] != TIPO_ANEMOMETRO_BAIXA ||
+      tipos_sondados[3] != TIPO_BIRUTA) {
+    printf("❌ Sonda de tipo classificou errado\n");
+  }
+  bus.limparSensores();
+}
+
+// Diário na flash simulada (1 MB): anexos a 1 Hz até dar uma volta e meia no
+// anel, consulta de 60 s, desgaste e quedas de energia no meio da gravação
+static void diarioNaFlash() {
+  simFlashConfigurar(1024 * 1024);
+  static DiarioAmostras diario;
+  diario.montar();
+  uint32_t capacidade = (uint32_t)diario.numBlocos() * DIARIO_REGISTROS_POR_BLOCO;
+  uint32_t tempo_s = 0;
+  uint32_t falhas = 0;
+  Medida anexo = medir("diario anexar (volta e meia)", capacidade * 3 / 2, [&tempo_s, &falhas] {
+    if (!diario.anexar(amostraDiario(tempo_s), tempo_s)) falhas++;
+    tempo_s++;
+  });
+  imprimir(anexo);
+  const SimFlashEstatisticas& st = simFlashEstatisticas();
+  printf("diario: %u registros em %u blocos, tempo %u..%u s, %.0f anexos/s sustentados, %u falhas\n",
+         diario.registros(), diario.blocosUsados(), diario.tempoMaisAntigo(), diario.tempoMaisRecente(),
+         anexo.execucoes / (anexo.simulado_us / 1e6), falhas);
+  printf("diario: %u apagamentos, desgaste por setor %u..%u, %.2f B gravados por B de carga\n", st.apagamentos,
+         st.menor_desgaste, st.maior_desgaste,
+         (double)st.bytes_gravados / ((double)anexo.execucoes * TELEMETRIA_TAM_CARGA));
+
+  uint32_t de = diario.tempoMaisAntigo() + (diario.tempoMaisRecente() - diario.tempoMaisAntigo()) / 2;
+  uint32_t entregues = 0, ultimo = 0;
+  imprimir(medir("diario consultar (60 s)", 100, [de, &entregues, &ultimo] {
+    entregues = diario.consultar(de, de + 59, contarRegistro, &ultimo);
+  }));
+  printf("diario: consulta de 60 s -> %u registros (último %u), %u blocos lidos\n", entregues, ultimo,
+         diario.blocosLidosNaConsulta());
+
+  // Queda no meio de um registro e no meio do cabeçalho de um bloco novo
+  uint32_t cortes[] = {DIARIO_TAM_REGISTRO / 2, DIARIO_TAM_CABECALHO / 2};
+  for (uint32_t corte : cortes) {
+    // Registro: cabeça com espaço. Cabeçalho: cabeça cheia, o anexo abre um bloco
+    bool abre_bloco = corte == DIARIO_TAM_CABECALHO / 2;
+    while ((diario.registros() % DIARIO_REGISTROS_POR_BLOCO == 0) != abre_bloco) {
+      diario.anexar(amostraDiario(tempo_s), tempo_s);
+      tempo_s++;
+    }
+    uint32_t antes = diario.tempoMaisRecente();
+    simFlashCortarApos(corte);
+    bool gravou = diario.anexar(amostraDiario(tempo_s), tempo_s);
+    simFlashReligar();
+    static DiarioAmostras religado;
+    religado.montar();
+    uint32_t continua = religado.tempoAgora();
+    uint32_t depois = 0;
+    for (uint32_t i = 0; i < 10; i++) religado.anexar(amostraDiario(continua + i), continua + i);
+    uint32_t total = religado.consultar(antes, UINT32_MAX, contarRegistro, &depois);
+    printf("diario: queda após %u B (%s): último íntegro %u, reinício em %u, %u lidos até %u, %u inválidos\n",
+           corte, gravou ? "gravou" : "cortado", antes, continua, total, depois, religado.invalidosNaConsulta());
+    diario = religado;
+    tempo_s = continua + 10;
+  }
+  simFlashConfigurar(1024 * 1024);   // Flash limpa para o setup()
+}
+
+static bool mesmoRegistro(const RegistroTelemetria& a, const RegistroTelemetria& b) {
+  return a.sequencia == b.sequencia && a.timestamp_ms == b.timestamp_ms && a.vento_dms == b.vento_dms &&
+         a.direcao_graus == b.direcao_graus && a.direcao_bruta == b.direcao_bruta &&
+         a.temperatura_qc == b.temperatura_qc && a.uv_dec == b.uv_dec && a.flags == b.flags;
+}
+
+static std::vector<RegistroTelemetria> decodificarQuadros(const std::string& fluxo) {
+  std::vector<RegistroTelemetria> serie;
+  DecodificadorTelemetria decodificador;
+  RegistroTelemetria r;
+  for (char c : fluxo) {
+    if (decodificador.alimentar((uint8_t)c, r)) serie.push_back(r);
+  }
+  return serie;
+}
+
+static bool adicionarRegistroDiario(const RegistroDiario& registro, void* contexto) {
+  static_cast<std::vector<RegistroTelemetria>*>(contexto)->push_back(registro.amostra);
+  return true;
+}
+
+// Compressão de uma série gravada: razão, MB/s (de carga de 19 B) na ida e na
+// volta, conferência campo a campo, e Gorilla nos mesmos valores em float
+static void compressaoSerie(const char* nome, const std::vector<RegistroTelemetria>& serie) {
+  if (serie.size() < 2) return;
+  const size_t TAM_BLOCO = 512;
+  std::vector<uint8_t> blocos(serie.size() * SERIE_MAX_AMOSTRA + TAM_BLOCO);
+  std::vector<size_t> inicios;
+  CodificadorSerie codificador;
+  size_t total = 0;
+  auto codificar = [&] {
+    inicios.clear();
+    total = 0;
+    codificador.iniciar(&blocos[0], TAM_BLOCO);
+    for (const RegistroTelemetria& r : serie) {
+      if (codificador.adicionar(r)) continue;
+      inicios.push_back(total);
+      total += codificador.finalizar();
+      codificador.iniciar(&blocos[total], TAM_BLOCO);
+      codificador.adicionar(r);
+    }
+    inicios.push_back(total);
+    total += codificador.finalizar();
+  };
+  std::vector<RegistroTelemetria> decodificada(serie.size());
+  size_t n_decodificadas = 0;
+  auto decodificar = [&] {
+    DecodificadorSerie decodificador;
+    n_decodificadas = 0;
+    for (size_t inicio : inicios) {
+      if (!decodificador.abrir(&blocos[inicio], total - inicio)) break;
+      while (n_decodificadas < decodificada.size() && decodificador.proxima(decodificada[n_decodificadas])) {
+        n_decodificadas++;
+      }
+    }
+  };
+
+  uint32_t repeticoes = (uint32_t)std::max<size_t>(1, 2000000 / serie.size());
+  auto cronometrar = [repeticoes](auto&& rotina) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < repeticoes; i++) rotina();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  };
+  double t_codificar = cronometrar(codificar);
+  double t_decodificar = cronometrar(decodificar);
+  size_t divergentes = serie.size() - n_decodificadas;
+  for (size_t i = 0; i < n_decodificadas; i++) {
+    if (!mesmoRegistro(serie[i], decodificada[i])) divergentes++;
+  }
+
+  double carga_mb = (double)serie.size() * TELEMETRIA_TAM_CARGA * repeticoes / 1e6;
+  double por_amostra = (double)total / serie.size();
+  printf("serie %-8s %7zu amostras, %4zu blocos: %.2f B/amostra (%.1fx sobre %u B), cod %.0f MB/s, "
+         "dec %.0f MB/s, %zu divergentes\n", nome, serie.size(), inicios.size(), por_amostra,
+         TELEMETRIA_TAM_CARGA / por_amostra, TELEMETRIA_TAM_CARGA, carga_mb / t_codificar, carga_mb / t_decodificar,
+         divergentes);
+
+  // Os mesmos valores como floats do SensorData (vento, temperatura, UV)
+  std::vector<uint8_t> saida(serie.size() * 6 + 16);
+  size_t bytes_gorilla = 0;
+  uint32_t erros_gorilla = 0;
+  for (int coluna = 0; coluna < 3; coluna++) {
+    auto valor = [coluna](const RegistroTelemetria& r) {
+      return coluna == 0 ? r.vento_dms / 10.0f : coluna == 1 ? r.temperatura_qc / 4.0f : r.uv_dec / 10.0f;
+    };
+    CodificadorGorilla gorilla;
+    gorilla.iniciar(saida.data(), saida.size());
+    for (const RegistroTelemetria& r : serie) gorilla.adicionar(valor(r));
+    bytes_gorilla += gorilla.bytes();
+    DecodificadorGorilla volta;
+    volta.abrir(saida.data(), gorilla.bytes(), gorilla.valores());
+    float v;
+    for (const RegistroTelemetria& r : serie) {
+      if (!volta.proximo(v) || v != valor(r)) erros_gorilla++;
+    }
+  }
+  printf("serie %-8s floats (vento, temp, UV): gorilla %.2f B/amostra contra 12 B, %u divergentes\n", nome,
+         (double)bytes_gorilla / serie.size(), erros_gorilla);
+}
+
+int main(int argc, char** argv) {
+  uint32_t iteracoes = 50;
+  uint32_t baud = 4800;
+  uint32_t latencia_us = 8000;
+  const char* traco = nullptr;
+  SimConfig config;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--iteracoes")) iteracoes = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--baud")) baud = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--perda")) config.prob_perda = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--erro-crc")) config.prob_erro_crc = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--latencia")) latencia_us = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--traco")) traco = argv[i + 1];
+  }
+
+  BarramentoSimulado& bus = simBarramento();
+  for (uint8_t b = 0; b < HAL_MAX_BARRAMENTOS; b++) simBarramento(b).configurar(config);
+  Serial.silenciar(true);
+  halIniciar();
+
+  printf("Barramento simulado: %u bps, latência %u us, perda %.3f, erro CRC %.3f\n",
+         baud, latencia_us, config.prob_perda, config.prob_erro_crc);
+  printf("%-34s %6s %14s %12s %14s\n", "rotina", "n", "ciclos/op", "host us/op", "barramento ms/op");
+
+  compararCodec(iteracoes);
+
+  // Vários barramentos: cada UART lê os seus transmissores em paralelo
+  uint32_t falhas_um = 0, falhas_dois = 0;
+  float vazao_um = vazaoBarramentos(1, 12, baud, latencia_us, 10, falhas_um);
+  float vazao_dois = vazaoBarramentos(2, 12, baud, latencia_us, 10, falhas_dois);
+  printf("registro: 1 x 12 transmissores %.1f leituras/s, 2 x 12 %.1f leituras/s (%.2fx), %u falhas; %zu B\n",
+         vazao_um, vazao_dois, vazao_dois / vazao_um, falhas_um + falhas_dois, sizeof(RegistroDispositivos));
+  cargaPorBaud(latencia_us);
+  otimizadorBaud(latencia_us);
+  sondaTipo(baud, latencia_us);
+  diarioNaFlash();
+
+  // Barramento vazio: pior caso da varredura
+  imprimir(medir("detectarDispositivos (vazio)", 1, [] { detectarDispositivos(); }));
+  config_descoberta.id_final = MODBUS_ID_MAX;
+  imprimir(medir("detectarDispositivos (vazio 1-247)", 1, [] { detectarDispositivos(); }));
+  config_descoberta.id_final = 5;
+
+  // Dois sensores no mesmo baud rate. Nos outros, o padrão do simulador é o
+  // sensor calado (não decodifica o próprio ID): a descoberta espera o
+  // timeout de cada sonda. Com prob_lixo_baud = 1 ele devolve lixo e o baud
+  // rate é abandonado cedo.
+  bus.adicionarSensor(1, SimModelo::ANEMOMETRO_FSJT, baud, latencia_us);
+  bus.adicionarSensor(2, SimModelo::BIRUTA_FXJT, baud, latencia_us);
+  static const char* const NOMES_VARREDURA[2][2] = {
+    {"detectarDispositivos (2 sensores)", "detectarDispositivos (2, 1-247)"},
+    {"detectarDispositivos (2, lixo)", "detectarDispositivos (lixo, 1-247)"}};
+  for (int lixo = 0; lixo < 2; lixo++) {
+    SimConfig config_lixo = config;
+    config_lixo.prob_lixo_baud = lixo ? 1.0f : 0.0f;
+    bus.configurar(config_lixo);
+    for (int faixa = 0; faixa < 2; faixa++) {
+      config_descoberta.id_final = faixa ? MODBUS_ID_MAX : 5;
+      imprimir(medir(NOMES_VARREDURA[lixo][faixa], 1, [] { detectarDispositivos(); }));
+      printf("  %u sondas, %u baud rates abandonados, %u dispositivos\n", descobertas[0].sondas(),
+             descobertas[0].baudsAbandonados(), descobertas[0].encontrados());
+    }
+  }
+  bus.configurar(config);
+  config_descoberta.id_final = 5;
+
+  // Boot a quente: uma leitura por entrada do cache, independente da faixa
+  salvarCache();
+  imprimir(medir("restaurarDoCache (2 sensores)", 1, [] { restaurarDoCache(); }));
+
+  halRs485Iniciar(0, baud);
+  imprimir(medir("lerAnemometro", iteracoes, [] { lerAnemometro(); }));
+  imprimir(medir("lerBiruta", iteracoes, [] { lerBiruta(); }));
+
+  // Filtro do UV: 1 s de ADC a 20 kHz (CIC + mediana + IIR) e ruído antes/depois
+  static FiltroAdc filtro;
+  filtro.configurar(64, 0.05f);
+  halAdcIniciar(20000);
+  static uint16_t codigos_adc[20000];
+  size_t n_adc = 0;
+  for (uint32_t i = 0; i < 10; i++) {
+    simAvancarUs(100000);
+    n_adc += halAdcLer(codigos_adc + n_adc, 20000 - n_adc);
+  }
+  double soma_bruta = 0, soma_quad_bruta = 0;
+  for (size_t i = 0; i < n_adc; i++) {
+    soma_bruta += codigos_adc[i];
+    soma_quad_bruta += (double)codigos_adc[i] * codigos_adc[i];
+  }
+  double media_bruta = soma_bruta / n_adc;
+  double desvio_bruto = sqrt(soma_quad_bruta / n_adc - media_bruta * media_bruta);
+  imprimir(medir("filtro UV (1 s de ADC a 20 kHz)", iteracoes, [n_adc] {
+    filtro.processar(codigos_adc, n_adc);
+  }));
+  SaidaFiltro saida_filtro;
+  filtro.retirar(saida_filtro);
+  printf("filtro UV: %zu amostras, bruto %.2f ± %.2f LSB -> filtrado %.2f ± %.3f LSB (%u saídas do CIC)\n",
+         n_adc, media_bruta, desvio_bruto, saida_filtro.codigo, saida_filtro.ruido, saida_filtro.amostras);
+
+  // Amostras publicadas pelo escalonador via mestre assíncrono; mede também o
+  // maior tempo que uma chamada de loop() segura a CPU (no barramento simulado)
+  setup();
+  uint64_t bloqueio_max_us = 0;
+  Serial.zerarEsperaTx();
+  ContagemAlocacoes alocacoes_antes = simAlocacoes();
+  imprimir(medir("loop() por amostra publicada", iteracoes, [&bloqueio_max_us] {
+    uint32_t alvo = amostras_publicadas + 1;
+    while (amostras_publicadas < alvo) {
+      uint64_t t0 = simAgoraUs();
+      loop();
+      bloqueio_max_us = std::max(bloqueio_max_us, simAgoraUs() - t0);
+      yield();
+    }
+  }));
+  ContagemAlocacoes alocacoes_depois = simAlocacoes();
+  printf("loop(): maior bloqueio %llu us (UART do console modelada: %llu us presos na Serial, a maior espera %llu us)\n",
+         (unsigned long long)bloqueio_max_us, (unsigned long long)Serial.esperaTxUs(),
+         (unsigned long long)Serial.maiorEsperaTxUs());
+
+  // Caminho da amostra sem heap: nenhuma alocação em regime permanente
+  uint64_t alocacoes = alocacoes_depois.alocacoes - alocacoes_antes.alocacoes;
+  printf("loop(): %llu alocações (%llu bytes) em %u amostras\n", (unsigned long long)alocacoes,
+         (unsigned long long)(alocacoes_depois.bytes - alocacoes_antes.bytes), iteracoes);
+  printf("Memória por amostra: SensorData %zu B, Amostra %zu B, DeviceInfo %zu B\n",
+         sizeof(SensorData), sizeof(Amostra), sizeof(DeviceInfo));
+
+  // Estatísticas de vento: custo por leitura a 20 Hz, sem varrer o histórico
+  static EstatisticasVento estatisticas;
+  uint32_t instante_ms = 0;
+  imprimir(medir("estatisticas vento (leitura+resumo)", iteracoes * 1000, [&instante_ms] {
+    instante_ms += 50;
+    estatisticas.adicionarVelocidade(instante_ms, (uint16_t)(50 + instante_ms / 50 % 37));
+    estatisticas.adicionarDirecao(instante_ms, (uint16_t)(instante_ms / 50 % 8 * 45));
+    estatisticas.resumo(instante_ms);
+  }));
+  printf("EstatisticasVento: %zu B\n", sizeof(EstatisticasVento));
+
+  // Métricas: custo por transação registrada (16 IDs, latências variadas)
+  static MetricasBarramento metricas_bancada;
+  uint32_t n_transacao = 0;
+  imprimir(medir("metricas registrar", iteracoes * 1000, [&n_transacao, baud] {
+    n_transacao++;
+    uint8_t resultado = n_transacao % 50 ? MB_SUCESSO : MB_ERRO_TIMEOUT;
+    metricas_bancada.registrar((uint8_t)(1 + n_transacao % 16), MB_FC_READ_INPUT, resultado,
+                               20000 + n_transacao % 7919, 7, baud);
+  }));
+  printf("MetricasBarramento: %zu B\n", sizeof(MetricasBarramento));
+
+  // Log no caminho quente. Antes: a linha formatada na hora (o que o
+  // Serial.printf faz antes de entregar à UART); depois: só os argumentos na
+  // fila, formatados pela tarefa de saída. DEPURACAO está fora deste build.
+  char linha_log[LOG_MAX_LINHA];
+  volatile float velocidade_log = 71.5f;
+  imprimir(medir("printf síncrono (só formatação)", iteracoes * 1000, [&linha_log, &velocidade_log] {
+    snprintf(linha_log, sizeof(linha_log), "⚠️  Velocidade acima do limite do manual (70 m/s): %.1f\n",
+             velocidade_log);
+  }));
+  while (log_sistema.formatarProxima(linha_log, sizeof(linha_log))) {
+  }
+  Medida enfileirar = {"LOG_AVISO (enfileirar)", 0, 0, 0.0, 0};
+  Medida formatar = {"log formatar (tarefa de saída)", 0, 0, 0.0, 0};
+  for (uint32_t rodada = 0; rodada < iteracoes * 30; rodada++) {
+    acumular(enfileirar, medir("", LOG_CAPACIDADE, [&velocidade_log] {
+      LOG_AVISO("bancada", "⚠️  Velocidade acima do limite do manual (70 m/s): %.1f", velocidade_log);
+    }));
+    acumular(formatar, medir("", LOG_CAPACIDADE, [&linha_log] {
+      log_sistema.formatarProxima(linha_log, sizeof(linha_log));
+    }));
+  }
+  imprimir(enfileirar);
+  imprimir(formatar);
+  imprimir(medir("LOG_DEPURACAO (desligado)", iteracoes * 1000, [&velocidade_log] {
+    LOG_DEPURACAO("bancada", "⚠️  Velocidade acima do limite do manual (70 m/s): %.1f", velocidade_log);
+  }));
+  uint32_t descartes_antes = log_sistema.descartadas();
+  for (uint32_t i = 0; i < 2 * LOG_CAPACIDADE; i++) LOG_AVISO("bancada", "linha %u", i);
+  printf("log: %zu B por linha na fila, %u descartadas de %u sem esvaziar; UART a 115200 bps com o FIFO "
+         "cheio: %zu B = %.0f us parado no printf\n",
+         sizeof(RegistroLog), log_sistema.descartadas() - descartes_antes, 2 * LOG_CAPACIDADE, strlen(linha_log),
+         strlen(linha_log) * 10 * 1e6 / 115200);
+  while (log_sistema.formatarProxima(linha_log, sizeof(linha_log))) {
+  }
+
+  // Agenda: taxa alcançada e prazos perdidos por fonte em 60 s simulados
+  escalonador.zerarEstatisticas(relogio.agoraMs());
+  for (JitterAmostragem& j : jitter_fontes) j.zerar();
+  metricasModbus(0).pedirZerar();
+  uint32_t fim_agenda = millis() + 60000;
+  while (millis() < fim_agenda) {
+    loop();
+    yield();
+  }
+  printf("%-14s %10s %10s %10s %10s %12s\n", "fonte", "periodo ms", "alvo Hz", "obtido Hz", "perdidos", "atraso max ms");
+  for (uint8_t i = 0; i < escalonador.numFontes(); i++) {
+    const FonteAmostragem& f = escalonador.fonte(i);
+    if (!f.ativa) continue;
+    printf("%-14s %10u %10.3f %10.3f %10u %12u\n", f.nome, f.periodo_ms, 1000.0f / f.periodo_ms,
+           escalonador.taxaAlcancada(i, relogio.agoraMs()), f.prazos_perdidos, f.atraso_max_ms);
+  }
+  // Jitter: captura (fim do quadro) contra o instante programado pelo temporizador
+  printf("relogio: %u disparos, atraso do disparo médio %u us, máx %u us\n", relogio.disparos(),
+         relogio.atrasoMedioUs(), relogio.atrasoMaxUs());
+  for (uint8_t i = 0; i < escalonador.numFontes(); i++) {
+    const JitterAmostragem& j = jitter_fontes[i];
+    if (!escalonador.fonte(i).ativa) continue;
+    printf("jitter %-12s atraso p50 %u p99 %u máx %u us, intervalo %.0f ± %.0f us [%u, %u], %u lacunas, deriva %+.2f ppm\n",
+           escalonador.fonte(i).nome, j.atraso().percentil(50), j.atraso().percentil(99), j.atraso().maximo(),
+           j.intervaloMedioUs(), j.intervaloDesvioUs(), j.intervaloMinUs(), j.intervaloMaxUs(), j.lacunas(),
+           j.derivaPpm());
+  }
+  // Latência medida pelo próprio mestre nos mesmos 60 s
+  const MetricasBarramento& metricas = metricasModbus(0);
+  for (uint8_t i = 0; i < metricas.numDispositivos(); i++) {
+    const MetricasDispositivo& d = metricas.dispositivo(i);
+    printf("metricas ID %u: %u transações, %u timeouts, p50 %u p95 %u p99 %u máx %u us\n", d.id,
+           d.contadores.transacoes, d.contadores.timeouts, d.latencia.percentil(50), d.latencia.percentil(95),
+           d.latencia.percentil(99), d.latencia.maximo());
+  }
+  printf("metricas barramento 0: linha %.1f%%, ocupado %.1f%%\n", metricas.utilizacao() * 100.0f,
+         metricas.ocupacao() * 100.0f);
+
+  // Console: comandos de uma vez ('status', 'metrics', 'saude'). Maior tempo
+  // em que a aquisição ficou presa num deles, com a UART modelada.
+  maior_bloqueio_us = 0;
+  Serial.zerarEsperaTx();
+  Serial.injetar("status\nmetrics\nsaude\n");
+  uint32_t fim_comandos = millis() + 2000;
+  while (millis() < fim_comandos) {
+    loop();
+    yield();
+  }
+  printf("console status+metrics+saude: aquisição presa no máximo %u us ('%s'), Serial %llu us presa no total\n",
+         maior_bloqueio_us, maior_bloqueio_us ? nome_maior_bloqueio : "-", (unsigned long long)Serial.esperaTxUs());
+
+  // Console: 'diag' em fatias com a amostragem rodando. Ida e volta do
+  // comando, maior fatia e o que ele custou ao anemômetro em 5 s simulados.
+  escalonador.zerarEstatisticas(relogio.agoraMs());
+  for (JitterAmostragem& j : jitter_fontes) j.zerar();
+  Serial.injetar("diag\n");
+  uint32_t fim_diag = millis() + 5000;
+  while (millis() < fim_diag) {
+    loop();
+    yield();
+  }
+  int8_t anemometro = escalonador.procurar("anemometro");
+  const JitterAmostragem& jitter_diag = jitter_fontes[anemometro];
+  printf("console diag: %s, %u fatias, maior fatia %u us, ida e volta máx %u us; anemometro %u perdidos, "
+         "intervalo %.0f ± %.0f us [%u, %u]\n",
+         trabalho.ativo() ? "em andamento" : "concluído", trabalho.fatias(), trabalho.maiorFatiaUs(),
+         ida_volta_comandos.maximo(), escalonador.fonte(anemometro).prazos_perdidos, jitter_diag.intervaloMedioUs(),
+         jitter_diag.intervaloDesvioUs(), jitter_diag.intervaloMinUs(), jitter_diag.intervaloMaxUs());
+
+  // O mesmo 'diag' com a biruta muda: cada leitura dela espera os 100 ms de
+  // MODBUS_TURNAROUND_COMANDOS_US no barramento antes do timeout
+  SimSensor* biruta_sim = simBarramento(0).sensor(2);
+  if (biruta_sim) biruta_sim->presente = false;
+  escalonador.zerarEstatisticas(relogio.agoraMs());
+  for (JitterAmostragem& j : jitter_fontes) j.zerar();
+  maior_bloqueio_us = 0;
+  Serial.injetar("diag\n");
+  fim_diag = millis() + 8000;
+  while (millis() < fim_diag) {
+    loop();
+    yield();
+  }
+  if (biruta_sim) biruta_sim->presente = true;
+  printf("console diag (biruta muda): %s, %u fatias, maior fatia %u us, aquisição presa no máximo %u us; anemometro "
+         "%u perdidos, atraso máx %u us, intervalo %.0f ± %.0f us [%u, %u]\n",
+         trabalho.ativo() ? "em andamento" : "concluído", trabalho.fatias(), trabalho.maiorFatiaUs(),
+         maior_bloqueio_us, escalonador.fonte(anemometro).prazos_perdidos, jitter_diag.atraso().maximo(),
+         jitter_diag.intervaloMedioUs(), jitter_diag.intervaloDesvioUs(), jitter_diag.intervaloMinUs(),
+         jitter_diag.intervaloMaxUs());
+
+  // Escravo: requisição do SCADA respondida do mapa em memória
+  uint32_t respostas_invalidas = 0;
+  imprimir(medir("escravo 0x04 (mapa completo)", iteracoes * 100, [&respostas_invalidas] {
+    uint8_t requisicao[MODBUS_TAM_REQUISICAO];
+    modbusMontarLeitura(requisicao, escravo.id(), MB_FC_READ_INPUT, 0, ESCRAVO_NUM_REGISTROS);
+    simScadaEnviar(requisicao, sizeof(requisicao));
+    escravo.processar();
+    uint8_t resposta[5 + 2 * ESCRAVO_NUM_REGISTROS];
+    size_t n = simScadaReceber(resposta, sizeof(resposta));
+    if (n != sizeof(resposta) || !modbusCrcValido(resposta, n)) respostas_invalidas++;
+  }));
+  printf("escravo: %u respostas inválidas\n", respostas_invalidas);
+
+  // Compressão: 10 min de quadros da 'saida binario' (todas as amostras) e o
+  // diário a 1 Hz; com --traco, também uma gravação real
+  std::string fluxo;
+  Serial.capturar(&fluxo);
+  Serial.injetar("saida binario\n");
+  uint32_t fim_traco = millis() + 600000;
+  while (millis() < fim_traco) {
+    loop();
+    yield();
+  }
+  Serial.capturar(nullptr);
+  compressaoSerie("enlace", decodificarQuadros(fluxo));
+  std::vector<RegistroTelemetria> serie_diario;
+  diario.consultar(0, UINT32_MAX, adicionarRegistroDiario, &serie_diario);
+  compressaoSerie("diario", serie_diario);
+  if (traco) {
+    FILE* arquivo = fopen(traco, "rb");
+    std::string gravado;
+    char buf[4096];
+    size_t n;
+    while (arquivo && (n = fread(buf, 1, sizeof(buf), arquivo)) > 0) gravado.append(buf, n);
+    if (arquivo) fclose(arquivo);
+    compressaoSerie("gravado", decodificarQuadros(gravado));
+  }
+
+  const SimEstatisticas& st = bus.estatisticas();
+  printf("\nQuadros: %u recebidos, %u respostas, %u exceções, %u perdidas, %u corrompidas, %u baud errado\n",
+         st.quadros_recebidos, st.respostas, st.excecoes, st.perdidas, st.corrompidas, st.ignorados_baud);
+  return alocacoes == 0 ? 0 : 1;
+}
@@ -0,0 +1,569 @@
+// HAL nativo (Linux): núcleo Arduino mínimo, relógio virtual e barramento simulado
+#include "hal.h"
+#include "rs485_sim.h"
+#include "alocacoes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <map>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+HardwareSerial Serial;
+
+// --- Relógio virtual ---
+
+// Passo máximo de yield() quando não há nada agendado na linha
+static const uint64_t QUANTUM_YIELD_US = 100;
+
+static uint64_t agora_us = 0;
+
+// Temporizador de amostragem: próximo disparo no relógio virtual (0 = parado)
+static uint64_t proximo_disparo_us = 0;
+static uint32_t periodo_temporizador_us = 0;
+static CallbackTemporizador callback_temporizador = nullptr;
+
+uint64_t simAgoraUs() {
+  return agora_us;
+}
+
+void simAvancarUs(uint64_t us) {
+  agora_us += us;
+}
+
+unsigned long millis() {
+  return (unsigned long)(agora_us / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)agora_us;
+}
+
+void delay(uint32_t ms) {
+  agora_us += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+  agora_us += us;
+}
+
+static_assert(SIM_MAX_BARRAMENTOS == HAL_MAX_BARRAMENTOS, "um barramento simulado por UART");
+
+// Laços de espera chamam yield(): avança até o próximo evento dos barramentos
+void yield() {
+  uint64_t alvo = agora_us + QUANTUM_YIELD_US;
+  for (uint8_t b = 0; b < HAL_MAX_BARRAMENTOS; b++) {
+    alvo = std::min(alvo, simBarramento(b).proximoEvento());
+  }
+  if (proximo_disparo_us) alvo = std::min(alvo, proximo_disparo_us);
+  agora_us = std::max(alvo, agora_us + 1);
+}
+
+// --- GPIO ---
+
+static uint8_t pino_de_re = LOW;
+static uint8_t pino_de_re_escravo = LOW;
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin == RS485_DE_RE_PIN) pino_de_re = val;
+  if (pin == ESCRAVO_DE_RE_PIN) pino_de_re_escravo = val;
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin == RS485_DE_RE_PIN) return pino_de_re;
+  if (pin == ESCRAVO_DE_RE_PIN) return pino_de_re_escravo;
+  return LOW;
+}
+
+// --- Console ---
+
+// Tempo de linha dos bytes escritos: a escrita volta assim que o que sobrou
+// cabe no FIFO e no buffer de transmissão; antes disso o relógio avança
+void HardwareSerial::transmitir(size_t len) {
+  uint64_t agora_ns = agora_us * 1000;
+  uint64_t byte_ns = 10000000000ULL / baud_;   // 8N1
+  fim_tx_ns_ = std::max(fim_tx_ns_, agora_ns) + len * byte_ns;
+  uint64_t cabe_ns = (SERIAL_FIFO_TX + buffer_tx_) * byte_ns;
+  if (fim_tx_ns_ > agora_ns + cabe_ns) {
+    uint64_t espera_us = (fim_tx_ns_ - cabe_ns - agora_ns + 999) / 1000;
+    agora_us += espera_us;
+    espera_tx_us_ += espera_us;
+    maior_espera_tx_us_ = std::max(maior_espera_tx_us_, espera_us);
+  }
+}
+
+int HardwareSerial::availableForWrite() {
+  uint64_t agora_ns = agora_us * 1000;
+  uint64_t byte_ns = 10000000000ULL / baud_;
+  uint64_t ocupados = fim_tx_ns_ > agora_ns ? (fim_tx_ns_ - agora_ns + byte_ns - 1) / byte_ns : 0;
+  uint64_t capacidade = SERIAL_FIFO_TX + buffer_tx_;
+  return ocupados >= capacidade ? 0 : (int)(capacidade - ocupados);
+}
+
+int HardwareSerial::printf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  va_list copia;
+  va_copy(copia, args);
+  int n = vsnprintf(nullptr, 0, fmt, copia);
+  va_end(copia);
+  if (n > 0) transmitir((size_t)n);
+  if (!mudo_) n = vprintf(fmt, args);
+  va_end(args);
+  return n;
+}
+
+size_t HardwareSerial::print(const char* s) {
+  size_t n = strlen(s);
+  transmitir(n);
+  if (mudo_) return n;
+  return fputs(s, stdout) >= 0 ? n : 0;
+}
+
+size_t HardwareSerial::println(const char* s) {
+  return print(s) + print("\n");
+}
+
+size_t HardwareSerial::write(const uint8_t* dados, size_t len) {
+  transmitir(len);
+  if (captura_) {
+    captura_->append(reinterpret_cast<const char*>(dados), len);
+    return len;
+  }
+  if (mudo_) return len;
+  return fwrite(dados, 1, len, stdout);
+}
+
+void HardwareSerial::lerStdin() {
+  ForaDaContagem fora;  // Buffer de recepção da UART
+  struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+  while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+    char buf[256];
+    ssize_t n = ::read(STDIN_FILENO, buf, sizeof(buf));
+    if (n <= 0) break;
+    entrada_.append(buf, (size_t)n);
+  }
+}
+
+int HardwareSerial::available() {
+  lerStdin();
+  return (int)entrada_.size();
+}
+
+int HardwareSerial::read() {
+  if (!available()) return -1;
+  int c = (unsigned char)entrada_[0];
+  entrada_.erase(0, 1);
+  return c;
+}
+
+String HardwareSerial::readString() {
+  lerStdin();
+  String s(entrada_);
+  entrada_.clear();
+  return s;
+}
+
+void HardwareSerial::injetar(const char* texto) {
+  entrada_ += texto;
+}
+
+// --- HAL ---
+
+// Estado de linha de cada barramento (baud rate e fim da transmissão em curso)
+struct PortaSimulada {
+  uint8_t de_re;
+  uint32_t baud;
+  uint64_t fim_tx_us;
+};
+
+static PortaSimulada portas[HAL_MAX_BARRAMENTOS] = {
+  {RS485_DE_RE_PIN, 4800, 0},
+  {ESCRAVO_DE_RE_PIN, 4800, 0},
+};
+
+void halIniciar() {
+  pinMode(RS485_DE_RE_PIN, OUTPUT);
+  digitalWrite(RS485_DE_RE_PIN, LOW);
+  pinMode(UV_SENSOR_PIN, INPUT);
+}
+
+void halRs485Iniciar(uint8_t barramento, uint32_t baud) {
+  portas[barramento].baud = baud;
+}
+
+uint32_t halRs485Baud(uint8_t barramento) {
+  return portas[barramento].baud;
+}
+
+void halRs485Direcao(uint8_t barramento, bool transmitir) {
+  digitalWrite(portas[barramento].de_re, transmitir ? HIGH : LOW);
+}
+
+size_t halRs485Escrever(uint8_t barramento, const uint8_t* dados, size_t len) {
+  ForaDaContagem fora;  // Barramento simulado = hardware
+  PortaSimulada& p = portas[barramento];
+  p.fim_tx_us = simBarramento(barramento).transmitir(dados, len, p.baud, std::max(agora_us, p.fim_tx_us));
+  return len;
+}
+
+void halRs485AguardarEnvio(uint8_t barramento) {
+  if (portas[barramento].fim_tx_us > agora_us) agora_us = portas[barramento].fim_tx_us;
+}
+
+bool halRs485EnvioConcluido(uint8_t barramento) {
+  return agora_us >= portas[barramento].fim_tx_us;
+}
+
+int halRs485Disponivel(uint8_t barramento) {
+  ForaDaContagem fora;
+  return simBarramento(barramento).disponivel(agora_us);
+}
+
+int halRs485Ler(uint8_t barramento) {
+  ForaDaContagem fora;
+  return simBarramento(barramento).ler(agora_us);
+}
+
+void halRs485Descartar(uint8_t barramento) {
+  ForaDaContagem fora;
+  simBarramento(barramento).descartar(agora_us);
+}
+
+// Porta do escravo: filas entre o SCADA simulado e o firmware
+static std::deque<uint8_t> escravo_rx;
+static std::deque<uint8_t> escravo_tx;
+static uint32_t baud_escravo = 9600;
+
+void simScadaEnviar(const uint8_t* dados, size_t len) {
+  ForaDaContagem fora;
+  escravo_rx.insert(escravo_rx.end(), dados, dados + len);
+}
+
+size_t simScadaReceber(uint8_t* destino, size_t max) {
+  size_t n = 0;
+  while (n < max && !escravo_tx.empty()) {
+    destino[n++] = escravo_tx.front();
+    escravo_tx.pop_front();
+  }
+  return n;
+}
+
+void halEscravoIniciar(uint32_t baud) {
+  baud_escravo = baud;
+}
+
+uint32_t halEscravoBaud() {
+  return baud_escravo;
+}
+
+void halEscravoDirecao(bool transmitir) {
+  (void)transmitir;
+}
+
+size_t halEscravoEscrever(const uint8_t* dados, size_t len) {
+  ForaDaContagem fora;
+  escravo_tx.insert(escravo_tx.end(), dados, dados + len);
+  return len;
+}
+
+bool halEscravoEnvioConcluido() {
+  return true;
+}
+
+int halEscravoDisponivel() {
+  return (int)escravo_rx.size();
+}
+
+int halEscravoLer() {
+  if (escravo_rx.empty()) return -1;
+  int c = escravo_rx.front();
+  escravo_rx.pop_front();
+  return c;
+}
+
+float halLerTemperatura() {
+  // Variação lenta em torno de 25 °C, resolução de 0,25 °C como o MAX6675
+  float t = 25.0f + 2.0f * sinf((float)(agora_us / 1000000ULL) / 600.0f);
+  return floorf(t * 4.0f) / 4.0f;
+}
+
+// ADC contínuo simulado: amostras geradas pelo tempo virtual decorrido desde a
+// última leitura, como o DMA faria. Índice UV ~5 com ruído de ±8 LSB e um
+// pico isolado a cada ~1000 amostras; o que passa do buffer do "driver" é
+// descartado e conta um estouro.
+#define ADC_SIM_BUFFER 2048
+static uint32_t taxa_adc_hz = 0;
+static uint64_t ultima_leitura_adc_us = 0;
+static uint64_t resto_adc = 0;          // Fração de amostra em (us · Hz)
+static uint32_t estouros_adc = 0;
+static uint32_t pendentes_adc = 0;
+static uint32_t ruido_adc = 12345;
+
+bool halAdcIniciar(uint32_t taxa_hz) {
+  taxa_adc_hz = taxa_hz;
+  ultima_leitura_adc_us = agora_us;
+  resto_adc = 0;
+  pendentes_adc = 0;
+  return taxa_hz > 0;
+}
+
+size_t halAdcLer(uint16_t* codigos, size_t max) {
+  if (!taxa_adc_hz) return 0;
+  uint64_t produto = (agora_us - ultima_leitura_adc_us) * taxa_adc_hz + resto_adc;
+  ultima_leitura_adc_us = agora_us;
+  resto_adc = produto % 1000000;
+  uint64_t novas = produto / 1000000 + pendentes_adc;
+  if (novas > ADC_SIM_BUFFER) {
+    estouros_adc++;
+    novas = ADC_SIM_BUFFER;
+  }
+  size_t n = (size_t)std::min<uint64_t>(novas, max);
+  pendentes_adc = (uint32_t)(novas - n);
+  for (size_t i = 0; i < n; i++) {
+    ruido_adc = ruido_adc * 1103515245u + 12345u;
+    int codigo = 1365 + (int)((ruido_adc >> 16) % 17) - 8;
+    if ((ruido_adc >> 8) % 1000 == 0) codigo += 600;
+    codigos[i] = (uint16_t)codigo;
+  }
+  return n;
+}
+
+uint32_t halAdcEstouros() {
+  return estouros_adc;
+}
+
+// Sem eFuse: curva linear ideal, 0-4095 -> 0-3300 mV
+float halAdcMilivolts(float codigo) {
+  return codigo * 3300.0f / 4095.0f;
+}
+
+const char* halAdcCalibracao() {
+  return "linear (simulado)";
+}
+
+// NVS simulada: arquivo com [tamanho da chave][chave][tamanho][dados] por blob
+static std::map<std::string, std::vector<uint8_t>> nvs;
+static std::string arquivo_nvs;
+
+static void gravarArquivoNvs() {
+  if (arquivo_nvs.empty()) return;
+  FILE* f = fopen(arquivo_nvs.c_str(), "wb");
+  if (!f) return;
+  for (const auto& item : nvs) {
+    uint8_t tamanho_chave = (uint8_t)item.first.size();
+    uint32_t tamanho = (uint32_t)item.second.size();
+    fwrite(&tamanho_chave, 1, 1, f);
+    fwrite(item.first.data(), 1, tamanho_chave, f);
+    fwrite(&tamanho, sizeof(tamanho), 1, f);
+    fwrite(item.second.data(), 1, tamanho, f);
+  }
+  fclose(f);
+}
+
+void simNvsArquivo(const char* caminho) {
+  ForaDaContagem fora;
+  arquivo_nvs = caminho;
+  nvs.clear();
+  FILE* f = fopen(caminho, "rb");
+  if (!f) return;
+  uint8_t tamanho_chave;
+  while (fread(&tamanho_chave, 1, 1, f) == 1) {
+    std::string chave(tamanho_chave, '\0');
+    uint32_t tamanho = 0;
+    if (fread(&chave[0], 1, tamanho_chave, f) != tamanho_chave || fread(&tamanho, sizeof(tamanho), 1, f) != 1) break;
+    std::vector<uint8_t> dados(tamanho);
+    if (fread(dados.data(), 1, tamanho, f) != tamanho) break;
+    nvs[chave] = dados;
+  }
+  fclose(f);
+}
+
+size_t halNvsLer(const char* chave, void* dados, size_t max) {
+  ForaDaContagem fora;
+  auto item = nvs.find(chave);
+  if (item == nvs.end() || item->second.size() > max) return 0;
+  memcpy(dados, item->second.data(), item->second.size());
+  return item->second.size();
+}
+
+bool halNvsGravar(const char* chave, const void* dados, size_t len) {
+  ForaDaContagem fora;  // Flash
+  const uint8_t* bytes = static_cast<const uint8_t*>(dados);
+  nvs[chave].assign(bytes, bytes + len);
+  gravarArquivoNvs();
+  return true;
+}
+
+void halNvsApagar(const char* chave) {
+  ForaDaContagem fora;
+  nvs.erase(chave);
+  gravarArquivoNvs();
+}
+
+// Flash de dados simulada: imagem em memória, espelhada no arquivo se houver
+static const uint32_t FLASH_PADRAO = 1024 * 1024;
+static const uint32_t FLASH_APAGAR_US = 45000;        // Apagamento de setor típico
+static const uint32_t FLASH_PAGINA = 256;
+static const uint32_t FLASH_PAGINA_MAX_US = 400;      // Programação de página inteira
+static std::vector<uint8_t> flash;
+static std::vector<uint32_t> desgaste_flash;          // Apagamentos por setor
+static FILE* arquivo_flash = nullptr;
+static SimFlashEstatisticas estatisticas_flash;
+static int64_t corte_flash = -1;                      // Bytes até a queda de energia (-1 = sem queda)
+static bool flash_cortada = false;
+
+void simFlashConfigurar(uint32_t tamanho, const char* arquivo) {
+  ForaDaContagem fora;
+  tamanho -= tamanho % HAL_FLASH_SETOR;
+  flash.assign(tamanho, 0xFF);
+  desgaste_flash.assign(tamanho / HAL_FLASH_SETOR, 0);
+  estatisticas_flash = SimFlashEstatisticas();
+  if (arquivo_flash) fclose(arquivo_flash);
+  arquivo_flash = nullptr;
+  if (!arquivo) return;
+
+  arquivo_flash = fopen(arquivo, "r+b");
+  if (arquivo_flash) {
+    if (fread(flash.data(), 1, tamanho, arquivo_flash) != tamanho) std::fill(flash.begin(), flash.end(), 0xFF);
+  } else {
+    arquivo_flash = fopen(arquivo, "w+b");
+  }
+  if (arquivo_flash) {
+    fseek(arquivo_flash, 0, SEEK_SET);
+    fwrite(flash.data(), 1, tamanho, arquivo_flash);
+    fflush(arquivo_flash);
+  }
+}
+
+static void garantirFlash() {
+  if (flash.empty()) simFlashConfigurar(FLASH_PADRAO);
+}
+
+static void espelharFlash(uint32_t endereco, size_t len) {
+  if (!arquivo_flash) return;
+  fseek(arquivo_flash, endereco, SEEK_SET);
+  fwrite(&flash[endereco], 1, len, arquivo_flash);
+  fflush(arquivo_flash);
+}
+
+void simFlashCortarApos(uint32_t bytes) {
+  corte_flash = bytes;
+}
+
+void simFlashReligar() {
+  corte_flash = -1;
+  flash_cortada = false;
+}
+
+const SimFlashEstatisticas& simFlashEstatisticas() {
+  if (!desgaste_flash.empty()) {
+    auto extremos = std::minmax_element(desgaste_flash.begin(), desgaste_flash.end());
+    estatisticas_flash.menor_desgaste = *extremos.first;
+    estatisticas_flash.maior_desgaste = *extremos.second;
+  }
+  return estatisticas_flash;
+}
+
+uint32_t halFlashTamanho() {
+  garantirFlash();
+  return (uint32_t)flash.size();
+}
+
+bool halFlashLer(uint32_t endereco, void* dados, size_t len) {
+  garantirFlash();
+  if (flash_cortada || (uint64_t)endereco + len > flash.size()) return false;
+  memcpy(dados, &flash[endereco], len);
+  estatisticas_flash.leituras++;
+  estatisticas_flash.bytes_lidos += len;
+  agora_us += 1 + len / 20;   // ~20 MB/s (SPI quad a 40 MHz)
+  return true;
+}
+
+bool halFlashGravar(uint32_t endereco, const void* dados, size_t len) {
+  garantirFlash();
+  if (flash_cortada || (uint64_t)endereco + len > flash.size()) return false;
+  size_t n = len;
+  if (corte_flash >= 0 && (int64_t)n > corte_flash) n = (size_t)corte_flash;
+
+  // NOR: só zera bits
+  const uint8_t* bytes = static_cast<const uint8_t*>(dados);
+  for (size_t i = 0; i < n; i++) flash[endereco + i] &= bytes[i];
+  espelharFlash(endereco, n);
+  estatisticas_flash.bytes_gravados += n;
+
+  // Primeiro byte ~30 µs, depois ~2,5 µs por byte, até a página inteira
+  for (uint32_t pagina = endereco / FLASH_PAGINA; n && pagina <= (endereco + n - 1) / FLASH_PAGINA; pagina++) {
+    uint32_t inicio = std::max(endereco, pagina * FLASH_PAGINA);
+    uint32_t fim = std::min((uint32_t)(endereco + n), (pagina + 1) * FLASH_PAGINA);
+    agora_us += std::min(FLASH_PAGINA_MAX_US, 30 + (fim - inicio - 1) * 5 / 2);
+  }
+
+  if (corte_flash >= 0) {
+    corte_flash -= (int64_t)n;
+    if (n < len || corte_flash == 0) flash_cortada = true;
+  }
+  return n == len;
+}
+
+bool halFlashApagarSetor(uint32_t endereco) {
+  garantirFlash();
+  if (flash_cortada || endereco % HAL_FLASH_SETOR || endereco >= flash.size()) return false;
+  std::fill(flash.begin() + endereco, flash.begin() + endereco + HAL_FLASH_SETOR, 0xFF);
+  espelharFlash(endereco, HAL_FLASH_SETOR);
+  desgaste_flash[endereco / HAL_FLASH_SETOR]++;
+  estatisticas_flash.apagamentos++;
+  agora_us += FLASH_APAGAR_US;
+  return true;
+}
+
+// Sem escalonador: os passos rodam em rodízio, um de cada por loop()
+static PassoTarefa passos[HAL_MAX_TAREFAS];
+static uint8_t num_passos = 0;
+
+bool halCriarTarefa(const char* nome, PassoTarefa passo, uint8_t nucleo,
+                    uint8_t prioridade, uint32_t intervalo_ms) {
+  (void)nome;
+  (void)nucleo;
+  (void)prioridade;
+  (void)intervalo_ms;
+  if (num_passos >= HAL_MAX_TAREFAS) return false;
+  passos[num_passos++] = passo;
+  return true;
+}
+
+void halExecutarTarefas() {
+  // Disparos vencidos primeiro, como o esp_timer: atrasado, recupera em rajada
+  while (proximo_disparo_us && agora_us >= proximo_disparo_us) {
+    proximo_disparo_us += periodo_temporizador_us;
+    callback_temporizador();
+  }
+  for (uint8_t i = 0; i < num_passos; i++) passos[i]();
+}
+
+bool halTemporizadorIniciar(uint32_t periodo_us, CallbackTemporizador callback, PassoTarefa acordar) {
+  (void)acordar;   // Os passos já rodam logo depois dos disparos
+  if (proximo_disparo_us || !callback || !periodo_us) return false;
+  periodo_temporizador_us = periodo_us;
+  callback_temporizador = callback;
+  proximo_disparo_us = agora_us + periodo_us;
+  return true;
+}
+
+uint32_t halCiclos() {
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__rdtsc();
+#else
+  return (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
@@ -0,0 +1,80 @@
+// Ponto de entrada do build nativo: roda setup()/loop() sobre o barramento simulado
+//
+// Uso: program [--segundos N (tempo simulado)] [--baud B] [--perda P] [--erro-crc P] [--latencia US]
+//              [--barramentos 1|2] [--extras N (transmissores a mais por barramento)]
+//              [--nvs ARQUIVO (NVS persistente: o segundo boot usa o cache de descoberta)]
+//              [--flash ARQUIVO (partição do diário persistente entre execuções)]
+//              [--baud-max B (acima de B a linha corrompe respostas: 'optimize' para antes)]
+//              [--desconectar ID:DE:ATE (sensor do barramento 0 fora da linha entre DE e ATE s)]
+//              [--fora-do-mapa excecao|mudo (registrador inexistente: exceção 02 ou silêncio)]
+//              [--lixo-baud P (quadro em outro baud rate volta como lixo; padrão 0: sensor calado)]
+// Comandos do console (scan, info, status...) são lidos de stdin.
+#include <Arduino.h>
+#include "descoberta.h"
+#include "modbus_rtu.h"
+#include "rs485_sim.h"
+
+void setup();
+void loop();
+extern uint8_t num_barramentos;
+extern ConfigDescoberta config_descoberta;
+
+int main(int argc, char** argv) {
+  long segundos = -1;
+  uint32_t baud = 4800;
+  uint32_t latencia_us = 8000;
+  int extras = 0;
+  SimConfig config;
+  int id_desconectado = 0;
+  long desconectar_de = 0, desconectar_ate = 0;
+  bool mudo_fora_do_mapa = false;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--segundos")) segundos = atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--baud")) baud = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--perda")) config.prob_perda = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--erro-crc")) config.prob_erro_crc = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--latencia")) latencia_us = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--barramentos")) num_barramentos = (uint8_t)atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--extras")) extras = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--nvs")) simNvsArquivo(argv[i + 1]);
+    else if (!strcmp(argv[i], "--flash")) simFlashConfigurar(1024 * 1024, argv[i + 1]);
+    else if (!strcmp(argv[i], "--baud-max")) config.baud_max_linha = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--lixo-baud")) config.prob_lixo_baud = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--desconectar")) {
+      sscanf(argv[i + 1], "%d:%ld:%ld", &id_desconectado, &desconectar_de, &desconectar_ate);
+    }
+    else if (!strcmp(argv[i], "--fora-do-mapa")) mudo_fora_do_mapa = !strcmp(argv[i + 1], "mudo");
+  }
+  if (extras < 0) extras = 0;
+  if (extras > MODBUS_ID_MAX - 2) extras = MODBUS_ID_MAX - 2;
+  if (num_barramentos > SIM_MAX_BARRAMENTOS) num_barramentos = SIM_MAX_BARRAMENTOS;
+
+  // Instalação padrão do README em cada barramento: anemômetro ID 1 e biruta
+  // ID 2, mais 'extras' transmissores alternados a partir do ID 3
+  for (uint8_t b = 0; b < num_barramentos; b++) {
+    BarramentoSimulado& bus = simBarramento(b);
+    bus.configurar(config);
+    bus.adicionarSensor(1, SimModelo::ANEMOMETRO_FSJT, baud, latencia_us).mudo_fora_do_mapa = mudo_fora_do_mapa;
+    bus.adicionarSensor(2, SimModelo::BIRUTA_FXJT, baud, latencia_us).mudo_fora_do_mapa = mudo_fora_do_mapa;
+    for (int i = 0; i < extras; i++) {
+      SimModelo modelo = i % 2 ? SimModelo::BIRUTA_FXJT : SimModelo::ANEMOMETRO_FSJT;
+      bus.adicionarSensor((uint8_t)(3 + i), modelo, baud, latencia_us).mudo_fora_do_mapa = mudo_fora_do_mapa;
+    }
+  }
+  if (2 + extras > config_descoberta.id_final) config_descoberta.id_final = (uint8_t)(2 + extras);
+
+  // Como no loopTask do Arduino: loop() repetido, yield() entre chamadas
+  setup();
+  SimSensor* desconectado = id_desconectado ? simBarramento(0).sensor((uint8_t)id_desconectado) : nullptr;
+  while (segundos < 0 || millis() < (unsigned long)segundos * 1000UL) {
+    if (desconectado) {
+      long s = (long)(millis() / 1000);
+      desconectado->presente = s < desconectar_de || s >= desconectar_ate;
+    }
+    loop();
+    yield();
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,277 @@
+// Barramento RS-485 simulado (ver include/native/rs485_sim.h)
+#include "rs485_sim.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Códigos de baud rate do registrador 0x07D1 (conforme manual)
+static const uint32_t BAUD_POR_CODIGO[] = {2400, 4800, 9600, 19200, 38400, 57600, 115200, 1200};
+
+static uint16_t crcModbus(const uint8_t* dados, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= dados[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+BarramentoSimulado& simBarramento(uint8_t barramento) {
+  static BarramentoSimulado barramentos[SIM_MAX_BARRAMENTOS];
+  return barramentos[barramento < SIM_MAX_BARRAMENTOS ? barramento : 0];
+}
+
+void BarramentoSimulado::configurar(const SimConfig& config) {
+  config_ = config;
+  rng_.seed(config.semente);
+}
+
+SimSensor& BarramentoSimulado::adicionarSensor(uint8_t id, SimModelo modelo, uint32_t baud,
+                                               uint32_t latencia_us) {
+  SimSensor s;
+  s.id = id;
+  s.modelo = modelo;
+  s.baud = baud;
+  s.latencia_us = latencia_us;
+  if (modelo == SimModelo::ANEMOMETRO_FSJT) {
+    s.valor_principal = 56; // 5.6 m/s
+  } else {
+    s.valor_principal = 2;  // Leste
+    s.valor_secundario = 90;
+  }
+  sensores_.push_back(s);
+  return sensores_.back();
+}
+
+SimSensor* BarramentoSimulado::sensor(uint8_t id) {
+  for (auto& s : sensores_) {
+    if (s.id == id) return &s;
+  }
+  return nullptr;
+}
+
+void BarramentoSimulado::limparSensores() {
+  sensores_.clear();
+  quadro_mestre_.clear();
+  rx_.clear();
+}
+
+float BarramentoSimulado::sortear() {
+  return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng_);
+}
+
+uint64_t BarramentoSimulado::transmitir(const uint8_t* dados, size_t len, uint32_t baud,
+                                        uint64_t inicio_us) {
+  processar(inicio_us);
+
+  // Mestre falando por cima de uma resposta: colisão, o restante se perde
+  while (!rx_.empty() && rx_.back().chegada_us > inicio_us) rx_.pop_back();
+
+  uint32_t t_char = simTempoCaractere(baud);
+  if (!quadro_mestre_.empty() && baud != baud_quadro_) {
+    quadro_mestre_.clear();
+  }
+  baud_quadro_ = baud;
+  quadro_mestre_.insert(quadro_mestre_.end(), dados, dados + len);
+  fim_quadro_us_ = std::max(inicio_us, fim_quadro_us_) + (uint64_t)len * t_char;
+  stats_.bytes_linha += len;
+  return fim_quadro_us_;
+}
+
+uint64_t BarramentoSimulado::proximoEvento() const {
+  uint64_t proximo = UINT64_MAX;
+  if (!quadro_mestre_.empty()) {
+    // Sensor detecta o fim do quadro após 3,5 caracteres de silêncio
+    proximo = fim_quadro_us_ + simTempoCaractere(baud_quadro_) * 7 / 2;
+  }
+  if (!rx_.empty()) proximo = std::min(proximo, rx_.front().chegada_us);
+  return proximo;
+}
+
+void BarramentoSimulado::processar(uint64_t agora_us) {
+  if (quadro_mestre_.empty()) return;
+  uint64_t fim_silencio = fim_quadro_us_ + simTempoCaractere(baud_quadro_) * 7 / 2;
+  if (agora_us < fim_silencio) return;
+
+  std::vector<uint8_t> quadro;
+  quadro.swap(quadro_mestre_);
+  atenderQuadro(quadro, baud_quadro_, fim_quadro_us_);
+}
+
+int BarramentoSimulado::disponivel(uint64_t agora_us) {
+  processar(agora_us);
+  int n = 0;
+  for (const auto& b : rx_) {
+    if (b.chegada_us > agora_us) break;
+    n++;
+  }
+  return n;
+}
+
+int BarramentoSimulado::ler(uint64_t agora_us) {
+  processar(agora_us);
+  if (rx_.empty() || rx_.front().chegada_us > agora_us) return -1;
+  uint8_t v = rx_.front().valor;
+  rx_.pop_front();
+  return v;
+}
+
+void BarramentoSimulado::descartar(uint64_t agora_us) {
+  processar(agora_us);
+  while (!rx_.empty() && rx_.front().chegada_us <= agora_us) rx_.pop_front();
+}
+
+void BarramentoSimulado::evoluirVento(SimSensor& s) {
+  if (!s.vento_automatico) return;
+
+  if (s.modelo == SimModelo::ANEMOMETRO_FSJT) {
+    // Passeio aleatório entre 0 e 25 m/s
+    int v = (int)s.valor_principal + (int)std::lround((sortear() - 0.5f) * 8.0f);
+    s.valor_principal = (uint16_t)std::min(250, std::max(0, v));
+  } else {
+    if (sortear() < 0.2f) {
+      int passo = sortear() < 0.5f ? 7 : 1;
+      s.valor_principal = (uint16_t)((s.valor_principal + passo) % 8);
+    }
+    s.valor_secundario = (uint16_t)(s.valor_principal * 45);
+  }
+}
+
+bool BarramentoSimulado::lerRegistrador(SimSensor& s, uint16_t reg, uint16_t& valor) {
+  switch (reg) {
+    case 0x0000:
+      valor = s.valor_principal;
+      return true;
+    case 0x0001:
+      if (s.modelo != SimModelo::BIRUTA_FXJT) return false;
+      valor = s.valor_secundario;
+      return true;
+    case 0x07D0:
+      valor = s.id;
+      return true;
+    case 0x07D1:
+      for (uint16_t c = 0; c < 8; c++) {
+        if (BAUD_POR_CODIGO[c] == s.baud) { valor = c; return true; }
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+// Resposta no baud rate do sensor lida no baud rate do mestre: uma resposta
+// curta (7 bytes) vira bytes sem CRC válido, mais ou menos na proporção
+// entre os dois baud rates
+void BarramentoSimulado::emitirLixo(const SimSensor& s, uint32_t baud, uint64_t fim_us) {
+  size_t n = std::min<size_t>(32, std::max<size_t>(1, 7ULL * baud / s.baud));
+  uint32_t t_char = simTempoCaractere(baud);
+  uint64_t chegada = fim_us + std::max<uint64_t>(s.latencia_us, t_char * 7 / 2);
+  for (size_t i = 0; i < n; i++) {
+    chegada += t_char;
+    // Erro de enquadramento no início lê como 0x00: nunca o ID de uma resposta
+    rx_.push_back({chegada, i ? (uint8_t)rng_() : (uint8_t)0x00});
+  }
+  stats_.lixo_baud++;
+  stats_.bytes_linha += n;
+}
+
+void BarramentoSimulado::atenderQuadro(const std::vector<uint8_t>& quadro, uint32_t baud,
+                                       uint64_t fim_us) {
+  if (quadro.size() < 4) return;
+  stats_.quadros_recebidos++;
+
+  SimSensor* alvo = nullptr;
+  for (auto& s : sensores_) {
+    if (s.presente && s.id == quadro[0]) { alvo = &s; break; }
+  }
+  if (!alvo) return;
+
+  if (alvo->baud != baud) {
+    stats_.ignorados_baud++;
+    if (sortear() < config_.prob_lixo_baud) emitirLixo(*alvo, baud, fim_us);
+    return;
+  }
+
+  uint16_t crc = crcModbus(quadro.data(), quadro.size() - 2);
+  if (quadro[quadro.size() - 2] != (crc & 0xFF) || quadro[quadro.size() - 1] != (crc >> 8)) {
+    stats_.ignorados_crc++;
+    return;
+  }
+
+  uint8_t funcao = quadro[1];
+  std::vector<uint8_t> resposta = {alvo->id, funcao};
+  uint8_t excecao = 0;
+
+  if ((funcao == 0x03 || funcao == 0x04) && quadro.size() == 8) {
+    uint16_t inicio = (uint16_t)((quadro[2] << 8) | quadro[3]);
+    uint16_t qtd = (uint16_t)((quadro[4] << 8) | quadro[5]);
+    if (qtd == 0 || qtd > 125) {
+      excecao = 0x03;
+    } else {
+      evoluirVento(*alvo);
+      resposta.push_back((uint8_t)(qtd * 2));
+      for (uint16_t i = 0; i < qtd && !excecao; i++) {
+        uint16_t v = 0;
+        if (!lerRegistrador(*alvo, (uint16_t)(inicio + i), v)) {
+          excecao = 0x02;
+        }
+        resposta.push_back((uint8_t)(v >> 8));
+        resposta.push_back((uint8_t)(v & 0xFF));
+      }
+    }
+  } else if (funcao == 0x06 && quadro.size() == 8) {
+    // Escrita de 0x07D0/0x07D1: eco da requisição, ainda no baud rate antigo
+    uint16_t reg = (uint16_t)((quadro[2] << 8) | quadro[3]);
+    uint16_t valor = (uint16_t)((quadro[4] << 8) | quadro[5]);
+    if (reg == 0x07D1 && valor < 8) {
+      alvo->baud = BAUD_POR_CODIGO[valor];
+      stats_.escritas++;
+    } else if (reg == 0x07D0 && valor >= 1 && valor <= 254) {
+      alvo->id = (uint8_t)valor;
+      stats_.escritas++;
+    } else {
+      excecao = reg == 0x07D0 || reg == 0x07D1 ? 0x03 : 0x02;
+    }
+    resposta.assign(quadro.begin(), quadro.end() - 2);
+  } else {
+    excecao = 0x01;
+  }
+
+  if (excecao == 0x02 && alvo->mudo_fora_do_mapa) return;
+  if (excecao) {
+    resposta = {alvo->id, (uint8_t)(funcao | 0x80), excecao};
+    stats_.excecoes++;
+  }
+
+  uint16_t crc_resp = crcModbus(resposta.data(), resposta.size());
+  resposta.push_back((uint8_t)(crc_resp & 0xFF));
+  resposta.push_back((uint8_t)(crc_resp >> 8));
+
+  if (sortear() < config_.prob_perda) {
+    stats_.perdidas++;
+    return;
+  }
+  // Cabo longo: acima do baud rate máximo a linha corrompe parte das respostas
+  float prob_erro_crc = config_.prob_erro_crc;
+  if (config_.baud_max_linha && baud > config_.baud_max_linha) prob_erro_crc += config_.prob_erro_acima;
+  if (sortear() < prob_erro_crc) {
+    size_t pos = (size_t)(sortear() * resposta.size()) % resposta.size();
+    resposta[pos] ^= (uint8_t)(1u << (rng_() % 8));
+    stats_.corrompidas++;
+  }
+
+  uint32_t t_char = simTempoCaractere(baud);
+  uint64_t latencia = alvo->latencia_us + config_.latencia_extra_us;
+  if (config_.jitter_us) latencia += rng_() % config_.jitter_us;
+  latencia = std::max<uint64_t>(latencia, t_char * 7 / 2);
+
+  uint64_t chegada = fim_us + latencia;
+  for (uint8_t b : resposta) {
+    chegada += t_char;
+    rx_.push_back({chegada, b});
+  }
+  stats_.respostas++;
+  stats_.bytes_linha += resposta.size();
+}
@@ -0,0 +1,193 @@
+#include "otimizador_baud.h"
+
+bool OtimizadorBaud::adicionarDispositivo(uint8_t id) {
+  if (num_ids_ >= OTIMIZADOR_MAX_DISPOSITIVOS) return false;
+  ids_[num_ids_++] = id;
+  return true;
+}
+
+void OtimizadorBaud::registrarPasso(AcaoOtimizador acao, uint8_t id, uint32_t de, uint32_t para,
+                                    uint8_t resultado) {
+  if (acao == OTM_SEM_RESPOSTA || acao == OTM_RETORNO_FALHOU) consistente_ = false;
+  if (num_passos_ < OTIMIZADOR_MAX_PASSOS) passos_[num_passos_++] = {acao, id, de, para, resultado};
+}
+
+void OtimizadorBaud::iniciarMedida(uint32_t baud) {
+  halRs485Iniciar(barramento_, baud);
+  latencia_.zerar();
+  medidas_[num_medidas_++] = {baud, 0, 0, 0, 0.0f, false};
+  leitura_ = 0;
+  tempo_medida_us_ = 0;
+}
+
+// Uma leitura de 0x0000 da medida em andamento, em rodízio pelos
+// dispositivos; false quando a medida terminou
+bool OtimizadorBaud::medir() {
+  MedidaEnlace& medida = medidas_[num_medidas_ - 1];
+  uint16_t valor;
+  uint32_t inicio = micros();
+  ResultadoLeitura r = modbusLerComTimeout(ids_[leitura_ % num_ids_], MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, 1,
+                                           &valor, config_.turnaround_us, barramento_);
+  tempo_medida_us_ += micros() - inicio;
+  medida.leituras++;
+  if (r.codigo == MB_SUCESSO) latencia_.registrar(r.latencia_us);
+  else medida.falhas++;
+  if (++leitura_ < config_.leituras_por_dispositivo * num_ids_) return true;
+
+  // Vazão sobre o tempo das leituras, sem as fatias da amostragem no meio
+  float segundos = tempo_medida_us_ / 1000000.0f;
+  medida.leituras_s = segundos > 0 ? (medida.leituras - medida.falhas) / segundos : 0.0f;
+  medida.p95_us = latencia_.percentil(95);
+  medida.aprovado = medida.erroPct() <= config_.erro_maximo;
+  return false;
+}
+
+bool OtimizadorBaud::lerCodigo(uint8_t id, uint32_t baud, uint16_t& codigo) {
+  halRs485Iniciar(barramento_, baud);
+  for (uint8_t t = 0; t < config_.tentativas_confirmacao; t++) {
+    if (modbusLerComTimeout(id, MB_FC_READ_HOLDING, PerfilConfiguracao::CodigoBaud::endereco, 1, &codigo, config_.turnaround_us,
+                            barramento_).codigo == MB_SUCESSO) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef ESCRITA_BAUD_RATE
+// Escreve o código de 'para' ainda em 'de' e confirma lendo de volta em
+// 'para'. A confirmação vale mesmo sem o eco: a resposta pode se perder
+// depois que o sensor já trocou.
+bool OtimizadorBaud::trocar(uint8_t id, uint32_t de, uint32_t para) {
+  halRs485Iniciar(barramento_, de);
+  uint8_t resultado = modbusEscreverCodigoBaud(id, codigoDoBaud(para), config_.turnaround_us, barramento_).codigo;
+
+  uint16_t codigo;
+  if (lerCodigo(id, para, codigo) && codigo == codigoDoBaud(para)) {
+    registrarPasso(OTM_CONFIRMADO, id, de, para, resultado);
+    return true;
+  }
+  if (!lerCodigo(id, de, codigo)) {
+    registrarPasso(OTM_SEM_RESPOSTA, id, de, para, resultado);
+  } else if (codigo == codigoDoBaud(para)) {
+    // Só troca ao religar: desfaz para não mudar de baud rate sozinho depois
+    modbusEscreverCodigoBaud(id, codigoDoBaud(de), config_.turnaround_us, barramento_);
+    registrarPasso(OTM_SO_AO_RELIGAR, id, de, para, resultado);
+  } else {
+    registrarPasso(OTM_RECUSADO, id, de, para, resultado);
+  }
+  return false;
+}
+#else
+bool OtimizadorBaud::trocar(uint8_t id, uint32_t de, uint32_t para) {
+  registrarPasso(OTM_ENSAIO, id, de, para, MB_SUCESSO);
+  return false;
+}
+#endif
+
+// O passo da troca vira o do retorno
+void OtimizadorBaud::voltar(uint8_t id, uint32_t de, uint32_t para) {
+  uint8_t passos_antes = num_passos_;
+  bool ok = trocar(id, de, para);
+  num_passos_ = passos_antes;
+  registrarPasso(ok ? OTM_RETORNO : OTM_RETORNO_FALHOU, id, de, para, MB_SUCESSO);
+}
+
+void OtimizadorBaud::iniciar(uint8_t barramento) {
+  barramento_ = barramento;
+  num_medidas_ = 0;
+  num_passos_ = 0;
+  consistente_ = true;
+  baud_inicial_ = baud_final_ = halRs485Baud(barramento);
+  escrever_ = config_.aplicar;
+#ifndef ESCRITA_BAUD_RATE
+  escrever_ = false;
+#endif
+  codigo_ = 0;
+  etapa_ = OTM_FIM;
+  if (!num_ids_) return;
+  iniciarMedida(baud_final_);
+  etapa_ = OTM_MEDINDO_ATUAL;
+}
+
+bool OtimizadorBaud::passo() {
+  switch (etapa_) {
+    case OTM_MEDINDO_ATUAL:
+      if (medir()) return true;
+      // Enlace ruim já no baud rate atual: subir só pioraria
+      if (!medidas_[num_medidas_ - 1].aprovado) return concluir();
+      return proximoDegrau();
+
+    case OTM_TROCANDO:
+      // Um dispositivo que não confirma interrompe o degrau
+      if (!trocar(ids_[movidos_], baud_final_, para_)) return iniciarRetorno();
+      if (++movidos_ < num_ids_) return true;
+      iniciarMedida(para_);
+      etapa_ = OTM_MEDINDO_NOVO;
+      return true;
+
+    case OTM_MEDINDO_NOVO:
+      if (medir()) return true;
+      if (!medidas_[num_medidas_ - 1].aprovado) return iniciarRetorno();
+      baud_final_ = para_;
+      return proximoDegrau();
+
+    case OTM_VOLTANDO:
+      voltar(ids_[voltados_], para_, baud_final_);
+      if (++voltados_ < movidos_) return true;
+      return concluir();
+
+    default:
+      return false;
+  }
+}
+
+// No meio de um degrau, os já movidos voltam (nos próximos passos) e o
+// barramento fica no último degrau aprovado
+void OtimizadorBaud::cancelar() {
+  if (etapa_ == OTM_MEDINDO_ATUAL) concluir();
+  else if (etapa_ == OTM_TROCANDO || etapa_ == OTM_MEDINDO_NOVO) iniciarRetorno();
+}
+
+// Prepara o próximo degrau acima do atual; false se não há. O ensaio só
+// anota as escritas que faria, sem tocar no barramento, e termina aqui.
+bool OtimizadorBaud::proximoDegrau() {
+  // BAUD_POR_CODIGO é crescente até 115200 (o 1200 do fim nunca é maior)
+  uint32_t ensaio = baud_final_;
+  for (; codigo_ < NUM_CODIGOS_BAUD; codigo_++) {
+    uint32_t para = BAUD_POR_CODIGO[codigo_];
+    if (para <= baud_final_ || para <= ensaio || para > config_.baud_maximo) continue;
+    if (!escrever_) {
+      for (uint8_t i = 0; i < num_ids_; i++) registrarPasso(OTM_ENSAIO, ids_[i], ensaio, para, MB_SUCESSO);
+      ensaio = para;
+      continue;
+    }
+    para_ = para;
+    movidos_ = 0;
+    codigo_++;
+    etapa_ = OTM_TROCANDO;
+    return true;
+  }
+  return concluir();
+}
+
+// Medindo o degrau novo, todos já foram movidos; trocando, os 'movidos_'
+bool OtimizadorBaud::iniciarRetorno() {
+  if (etapa_ == OTM_MEDINDO_NOVO) movidos_ = num_ids_;
+  if (!movidos_) return concluir();
+  voltados_ = 0;
+  etapa_ = OTM_VOLTANDO;
+  return true;
+}
+
+bool OtimizadorBaud::concluir() {
+  halRs485Iniciar(barramento_, baud_final_);
+  etapa_ = OTM_FIM;
+  return false;
+}
+
+uint32_t OtimizadorBaud::executar(uint8_t barramento) {
+  iniciar(barramento);
+  while (passo()) {
+  }
+  return baud_final_;
+}
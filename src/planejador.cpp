@@ -0,0 +1,224 @@
+#include "planejador.h"
+#include "hal.h"
+#include "metricas_modbus.h"
+#include "modbus_rtu.h"
+
+void PlanoLeitura::limpar() {
+  num_blocos_ = 0;
+  num_transacoes_ = 0;
+}
+
+bool PlanoLeitura::adicionar(const MapeamentoBloco& bloco) {
+  for (uint8_t i = 0; i < num_blocos_; i++) {
+    const MapeamentoBloco& b = blocos_[i];
+    if (b.id == bloco.id && b.funcao == bloco.funcao && b.inicio == bloco.inicio &&
+        b.quantidade == bloco.quantidade && b.decodificar == bloco.decodificar) {
+      return true;
+    }
+  }
+  if (num_blocos_ >= PLANO_MAX_BLOCOS) return false;
+  blocos_[num_blocos_++] = bloco;
+  return true;
+}
+
+static bool vemAntes(const MapeamentoBloco& a, const MapeamentoBloco& b) {
+  if (a.id != b.id) return a.id < b.id;
+  if (a.funcao != b.funcao) return a.funcao < b.funcao;
+  return a.inicio < b.inicio;
+}
+
+bool PlanoLeitura::compilar(uint16_t lacuna_max) {
+  num_transacoes_ = 0;
+
+  // Ordenação por inserção: poucos blocos por plano
+  for (uint8_t i = 1; i < num_blocos_; i++) {
+    MapeamentoBloco atual = blocos_[i];
+    int j = i - 1;
+    while (j >= 0 && vemAntes(atual, blocos_[j])) {
+      blocos_[j + 1] = blocos_[j];
+      j--;
+    }
+    blocos_[j + 1] = atual;
+  }
+
+  for (uint8_t i = 0; i < num_blocos_; i++) {
+    const MapeamentoBloco& b = blocos_[i];
+    LeituraPlanejada* t = num_transacoes_ ? &transacoes_[num_transacoes_ - 1] : nullptr;
+
+    if (t && t->id == b.id && t->funcao == b.funcao) {
+      uint16_t fim = t->inicio + t->quantidade - 1;
+      uint16_t novo_fim = b.fim() > fim ? b.fim() : fim;
+      uint16_t lacuna = b.inicio > fim ? b.inicio - fim - 1 : 0;   // Blocos sobrepostos: sem lacuna
+      if (lacuna <= lacuna_max && novo_fim - t->inicio + 1 <= MODBUS_MAX_REGISTRADORES) {
+        t->quantidade = novo_fim - t->inicio + 1;
+        t->num_blocos++;
+        continue;
+      }
+    }
+
+    if (num_transacoes_ >= PLANO_MAX_TRANSACOES) return false;   // O resto nunca seria lido
+    transacoes_[num_transacoes_++] = {b.id, b.funcao, b.inicio, b.quantidade, i, 1};
+  }
+  return true;
+}
+
+// Algum registrador da transação fora de todos os blocos dela
+bool PlanoLeitura::temLacuna(const LeituraPlanejada& t) const {
+  uint16_t proximo = t.inicio;
+  for (uint8_t k = 0; k < t.num_blocos; k++) {
+    const MapeamentoBloco& b = blocos_[t.primeiro + k];
+    if (b.inicio > proximo) return true;
+    if (b.fim() + 1 > proximo) proximo = b.fim() + 1;
+  }
+  return false;
+}
+
+// Troca a transação 'i' por faixas contíguas dos seus blocos, logo depois
+// dela; as demais transações não mudam. As novas ficam marcadas para
+// releitura. false se ela não tem lacuna ou se as faixas não cabem no plano.
+bool PlanoLeitura::dividir(uint8_t i) {
+  const LeituraPlanejada t = transacoes_[i];
+  if (!temLacuna(t)) return false;
+
+  LeituraPlanejada faixas[PLANO_MAX_TRANSACOES];
+  uint8_t num_faixas = 0;
+  for (uint8_t k = 0; k < t.num_blocos; k++) {
+    uint8_t indice = (uint8_t)(t.primeiro + k);
+    const MapeamentoBloco& b = blocos_[indice];
+    LeituraPlanejada* f = num_faixas ? &faixas[num_faixas - 1] : nullptr;
+    if (f && b.inicio <= f->inicio + f->quantidade) {
+      if (b.fim() + 1 > f->inicio + f->quantidade) f->quantidade = b.fim() - f->inicio + 1;
+      f->num_blocos++;
+    } else {
+      if (num_faixas >= PLANO_MAX_TRANSACOES) return false;
+      faixas[num_faixas++] = {t.id, t.funcao, b.inicio, b.quantidade, indice, 1};
+    }
+  }
+  if (num_transacoes_ + num_faixas - 1 > PLANO_MAX_TRANSACOES) return false;
+
+  for (uint8_t k = num_transacoes_; k-- > i + 1;) {
+    transacoes_[k + num_faixas - 1] = transacoes_[k];
+    reler_[k + num_faixas - 1] = reler_[k];
+  }
+  for (uint8_t k = 0; k < num_faixas; k++) {
+    transacoes_[i + k] = faixas[k];
+    reler_[i + k] = true;
+  }
+  num_transacoes_ = (uint8_t)(num_transacoes_ + num_faixas - 1);
+  return true;
+}
+
+// Um decodificador por bloco, cada um com a expansão do seu perfil
+void PlanoLeitura::aplicar(const LeituraPlanejada& t, const RespostaModbus& resposta, SensorData& destino) const {
+  for (uint8_t k = 0; k < t.num_blocos; k++) {
+    const MapeamentoBloco& b = blocos_[t.primeiro + k];
+    b.decodificar(resposta, b.inicio - t.inicio, destino);
+  }
+}
+
+uint8_t PlanoLeitura::executar(SensorData& destino, uint8_t barramento) {
+  uint8_t buffer[MODBUS_TAM_MAX_RESPOSTA];
+  uint8_t resultado = MB_SUCESSO;
+
+  uint8_t i = 0;
+  while (i < num_transacoes_) {
+    const LeituraPlanejada t = transacoes_[i];
+    RespostaModbus resposta;
+    uint8_t r = modbusLerQuadro(t.id, t.funcao, t.inicio, t.quantidade, MODBUS_TURNAROUND_COMANDOS_US,
+                                buffer, resposta, barramento).codigo;
+
+    if (r == MB_EXC_ENDERECO_ILEGAL && dividir(i)) {
+      // Lacuna com registrador inexistente: só esta transação vira faixas
+      // contíguas, lidas a seguir (mesmo 'i'); as já lidas ficam como estão
+      metricasModbus(barramento).registrarRetentativa(t.id, t.funcao);
+      continue;
+    }
+    reler_[i++] = false;
+    if (r != MB_SUCESSO) {
+      if (resultado == MB_SUCESSO) resultado = r;
+      continue;
+    }
+
+    aplicar(t, resposta, destino);
+  }
+  return resultado;
+}
+
+bool PlanoLeitura::enfileirar(MestreModbusAsync& mestre, SensorData& destino,
+                              CallbackPlano callback, void* contexto) {
+  if (faltam_ > 0 || FILA_MODBUS_MAX - mestre.pendentes() < num_transacoes_) return false;
+
+  mestre_ = &mestre;
+  destino_ = &destino;
+  callback_ = callback;
+  contexto_ = contexto;
+  resultado_ = MB_SUCESSO;
+  duracao_us_ = 0;
+  faltam_ = num_transacoes_;
+
+  if (num_transacoes_ == 0) {
+    if (callback_) callback_(resultado_, contexto_);
+    return true;
+  }
+
+  for (uint8_t i = 0; i < num_transacoes_; i++) enfileirarTransacao(i);
+  return true;
+}
+
+void PlanoLeitura::enfileirarTransacao(uint8_t i) {
+  const LeituraPlanejada& t = transacoes_[i];
+  reler_[i] = false;
+  contextos_[i] = {this, i};
+  mestre_->enfileirar({t.id, t.funcao, t.inicio, t.quantidade, aoConcluirTransacao, &contextos_[i]});
+}
+
+// Fim de uma rodada: as transações com lacuna recusada viram faixas
+// contíguas e só elas voltam para a fila. true se houve releitura.
+bool PlanoLeitura::relerLacunas() {
+  bool dividiu = false;
+  for (uint8_t i = num_transacoes_; i-- > 0;) {
+    if (!reler_[i]) continue;
+    const LeituraPlanejada t = transacoes_[i];
+    if (dividir(i)) {
+      metricasModbus(mestre_->barramento()).registrarRetentativa(t.id, t.funcao);
+      dividiu = true;
+    } else {
+      reler_[i] = false;
+      if (resultado_ == MB_SUCESSO) resultado_ = MB_EXC_ENDERECO_ILEGAL;
+    }
+  }
+  if (!dividiu) return false;
+
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < num_transacoes_; i++) n += reler_[i];
+  if (FILA_MODBUS_MAX - mestre_->pendentes() < n) {
+    for (uint8_t i = 0; i < num_transacoes_; i++) reler_[i] = false;
+    if (resultado_ == MB_SUCESSO) resultado_ = MB_EXC_ENDERECO_ILEGAL;
+    return false;
+  }
+  faltam_ = n;
+  for (uint8_t i = 0; i < num_transacoes_; i++) {
+    if (reler_[i]) enfileirarTransacao(i);
+  }
+  return true;
+}
+
+void PlanoLeitura::aoConcluirTransacao(const RequisicaoModbus& /*requisicao*/, uint8_t resultado,
+                                       const RespostaModbus& resposta, void* contexto) {
+  ContextoTransacao* ctx = static_cast<ContextoTransacao*>(contexto);
+  PlanoLeitura* plano = ctx->plano;
+  plano->duracao_us_ += plano->mestre_->duracaoUs();
+
+  const LeituraPlanejada& t = plano->transacoes_[ctx->indice];
+  if (resultado == MB_SUCESSO) {
+    plano->aplicar(t, resposta, *plano->destino_);
+  } else if (resultado == MB_EXC_ENDERECO_ILEGAL && plano->temLacuna(t)) {
+    plano->reler_[ctx->indice] = true;   // Lacuna com registrador inexistente
+  } else if (plano->resultado_ == MB_SUCESSO) {
+    plano->resultado_ = resultado;
+  }
+
+  if (--plano->faltam_ > 0) return;
+  if (plano->relerLacunas()) return;
+  if (plano->callback_) plano->callback_(plano->resultado_, plano->contexto_);
+}
@@ -0,0 +1,123 @@
+#include "registro_dispositivos.h"
+
+static const uint8_t TENTATIVAS_COPIA = 3;
+
+// Versão ímpar durante a mudança da partição (seqlock)
+static void iniciarMudanca(std::atomic<uint32_t>& versao) {
+  versao.store(versao.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+static void concluirMudanca(std::atomic<uint32_t>& versao) {
+  versao.store(versao.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Chamar com o mestre do barramento ocioso: uma leitura em andamento
+// apontaria para uma posição já reaproveitada
+void RegistroDispositivos::limpar(uint8_t barramento) {
+  iniciarMudanca(versao_[barramento]);
+  quantidade_[barramento].store(0, std::memory_order_relaxed);
+  cursor_[barramento] = 0;
+  leituras_pendentes_[barramento].dispositivo = nullptr;
+  concluirMudanca(versao_[barramento]);
+}
+
+bool RegistroDispositivos::adicionar(const Dispositivo& dispositivo) {
+  uint8_t barramento = dispositivo.info.barramento;
+  if (barramento >= HAL_MAX_BARRAMENTOS) return false;
+  uint16_t n = quantidade_[barramento].load(std::memory_order_relaxed);
+  if (n >= REGISTRO_MAX_POR_BARRAMENTO) return false;
+  iniciarMudanca(versao_[barramento]);
+  itens_[barramento][n] = dispositivo;
+  quantidade_[barramento].store((uint16_t)(n + 1), std::memory_order_relaxed);
+  concluirMudanca(versao_[barramento]);
+  return true;
+}
+
+void RegistroDispositivos::mudarBaud(uint8_t barramento, uint32_t de, uint32_t para) {
+  iniciarMudanca(versao_[barramento]);
+  uint16_t n = quantidade_[barramento].load(std::memory_order_relaxed);
+  for (uint16_t i = 0; i < n; i++) {
+    DeviceInfo& info = itens_[barramento][i].info;
+    if (info.baud_rate != de) continue;
+    info.baud_rate = para;
+    info.config_baud = codigoDoBaud(para);
+  }
+  concluirMudanca(versao_[barramento]);
+}
+
+uint16_t RegistroDispositivos::total() const {
+  uint16_t n = 0;
+  for (uint8_t b = 0; b < HAL_MAX_BARRAMENTOS; b++) n += quantidade(b);
+  return n;
+}
+
+bool RegistroDispositivos::copiar(uint8_t barramento, uint16_t i, Dispositivo& destino) const {
+  const std::atomic<uint32_t>& versao = versao_[barramento];
+  for (uint8_t t = 0; t < TENTATIVAS_COPIA; t++) {
+    uint32_t antes = versao.load(std::memory_order_acquire);
+    if (antes & 1) continue;
+    if (i >= quantidade_[barramento].load(std::memory_order_relaxed)) return false;
+    Dispositivo copia = itens_[barramento][i];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (versao.load(std::memory_order_relaxed) == antes) {
+      destino = copia;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RegistroDispositivos::lerProximo(uint8_t barramento, MestreModbusAsync& mestre,
+                                      CallbackRegistro callback, void* contexto) {
+  LeituraPendente& pendente = leituras_pendentes_[barramento];
+  if (pendente.dispositivo) return false;
+
+  // Rodízio a partir do cursor, pulando principais, baud rates diferentes e
+  // quem está em espera
+  uint16_t n = quantidade_[barramento].load(std::memory_order_relaxed);
+  uint32_t baud = halRs485Baud(barramento);
+  uint32_t agora = millis();
+  for (uint16_t k = 0; k < n; k++) {
+    uint16_t i = (uint16_t)((cursor_[barramento] + k) % n);
+    Dispositivo& d = itens_[barramento][i];
+    if (d.principal || d.info.baud_rate != baud) continue;
+    if (!d.saude.podeLer(agora) && !d.saude.sondaVencida(agora)) {
+      d.saude.pular();
+      continue;
+    }
+
+    pendente = {this, &mestre, &d, callback, contexto};
+    // Biruta: direção bruta e graus numa única transação
+    uint16_t quantidade = d.info.tipo == TIPO_BIRUTA ? PerfilBiruta::Dados::quantidade : PerfilAnemometro::Dados::quantidade;
+    if (!mestre.enfileirar({d.info.id, MB_FC_READ_INPUT, REGISTRADOR_PRINCIPAL, quantidade, aoLer, &pendente})) {
+      pendente.dispositivo = nullptr;
+      return false;
+    }
+    cursor_[barramento] = (uint16_t)((i + 1) % n);
+    return true;
+  }
+  return false;
+}
+
+void RegistroDispositivos::aoLer(const RequisicaoModbus& requisicao, uint8_t resultado,
+                                 const RespostaModbus& resposta, void* contexto) {
+  LeituraPendente& pendente = *static_cast<LeituraPendente*>(contexto);
+  Dispositivo* d = pendente.dispositivo;
+  if (!d) return;   // Partição limpa com a leitura na linha
+  pendente.dispositivo = nullptr;
+
+  d->resultado = resultado;
+  d->ultima_leitura_ms = millis();
+  d->saude.registrar(resultado, pendente.mestre->duracaoUs(), d->ultima_leitura_ms, pendente.registro->config_saude_);
+  if (resultado == MB_SUCESSO) {
+    d->leituras++;
+    for (uint16_t i = 0; i < requisicao.quantidade && i < resposta.num_registradores; i++) {
+      d->valores[i] = resposta.registrador(i);
+    }
+  } else {
+    d->falhas++;
+  }
+  pendente.registro->leituras_[d->info.barramento]++;
+  if (pendente.callback) pendente.callback(*d, pendente.contexto);
+}
@@ -0,0 +1,112 @@
+#include "relogio_amostragem.h"
+#include <math.h>
+
+bool RelogioAmostragem::iniciar(uint32_t periodo_us, CallbackTemporizador callback, PassoTarefa acordar) {
+  if (ativo() || periodo_us < 1000 || periodo_us % 1000) return false;
+  periodo_us_ = periodo_us;
+  ticks_.store(0, std::memory_order_relaxed);
+  atraso_max_us_ = 0;
+  soma_atraso_us_ = 0;
+  inicio_ms_ = millis();
+  inicio_us_ = micros();
+  ativo_.store(true, std::memory_order_release);
+  if (!halTemporizadorIniciar(periodo_us, callback, acordar)) {
+    ativo_.store(false, std::memory_order_release);
+    inicio_ms_ = inicio_us_ = 0;
+    return false;
+  }
+  return true;
+}
+
+// O esp_timer recupera disparos atrasados em rajada (alarme += período), então
+// o tick k é sempre o instante inicio + k * período
+void RelogioAmostragem::disparar(uint32_t agora_us) {
+  uint32_t tick = ticks_.load(std::memory_order_relaxed) + 1;
+  int32_t atraso = (int32_t)(agora_us - (inicio_us_ + tick * periodo_us_));
+  if (atraso < 0) atraso = 0;
+  if ((uint32_t)atraso > atraso_max_us_) atraso_max_us_ = (uint32_t)atraso;
+  soma_atraso_us_ += (uint32_t)atraso;
+  ticks_.store(tick, std::memory_order_release);
+}
+
+uint32_t RelogioAmostragem::agoraMs() const {
+  if (!ativo()) return millis();
+  uint32_t ticks = ticks_.load(std::memory_order_acquire);
+  return inicio_ms_ + (uint32_t)((uint64_t)ticks * periodo_us_ / 1000);
+}
+
+uint32_t RelogioAmostragem::atrasoMedioUs() const {
+  uint32_t n = disparos();
+  return n ? (uint32_t)(soma_atraso_us_ / n) : 0;
+}
+
+void JitterAmostragem::registrar(uint32_t programado_us, uint32_t captura_us, uint32_t periodo_us) {
+  int32_t atraso = (int32_t)(captura_us - programado_us);
+  if (atraso < 0) atraso = 0;
+  atraso_.registrar((uint32_t)atraso);
+
+  if (periodo_us != periodo_us_) reiniciarSerie(periodo_us);
+
+  if (anterior_) {
+    uint32_t passo = programado_us - programado_anterior_us_;
+    decorrido_us_ += passo;
+    if (passo == periodo_us) {
+      uint32_t intervalo = captura_us - captura_anterior_us_;
+      int32_t desvio = (int32_t)(intervalo - periodo_us);
+      intervalos_++;
+      soma_desvio_us_ += desvio;
+      soma_desvio_quad_ += (double)desvio * desvio;
+      if (intervalo < intervalo_min_us_) intervalo_min_us_ = intervalo;
+      if (intervalo > intervalo_max_us_) intervalo_max_us_ = intervalo;
+    } else if (passo > periodo_us && periodo_us) {
+      lacunas_ += passo / periodo_us - 1;
+    }
+  }
+  anterior_ = true;
+  programado_anterior_us_ = programado_us;
+  captura_anterior_us_ = captura_us;
+
+  double t = decorrido_us_ / 1e6;
+  n_ += 1;
+  soma_t_ += t;
+  soma_a_ += atraso;
+  soma_tt_ += t * t;
+  soma_ta_ += t * atraso;
+}
+
+// Período trocado ('periodo'): intervalos e deriva recomeçam
+void JitterAmostragem::reiniciarSerie(uint32_t periodo_us) {
+  periodo_us_ = periodo_us;
+  anterior_ = false;
+  intervalos_ = 0;
+  soma_desvio_us_ = 0;
+  soma_desvio_quad_ = 0;
+  intervalo_min_us_ = UINT32_MAX;
+  intervalo_max_us_ = 0;
+  decorrido_us_ = 0;
+  n_ = soma_t_ = soma_a_ = soma_tt_ = soma_ta_ = 0;
+}
+
+void JitterAmostragem::zerar() {
+  atraso_.zerar();
+  lacunas_ = 0;
+  reiniciarSerie(periodo_us_);
+}
+
+float JitterAmostragem::intervaloMedioUs() const {
+  if (!intervalos_) return 0.0f;
+  return (float)(periodo_us_ + (double)soma_desvio_us_ / intervalos_);
+}
+
+float JitterAmostragem::intervaloDesvioUs() const {
+  if (!intervalos_) return 0.0f;
+  double media = (double)soma_desvio_us_ / intervalos_;
+  double variancia = soma_desvio_quad_ / intervalos_ - media * media;
+  return variancia > 0 ? (float)sqrt(variancia) : 0.0f;
+}
+
+float JitterAmostragem::derivaPpm() const {
+  double denominador = n_ * soma_tt_ - soma_t_ * soma_t_;
+  if (n_ < 3 || denominador <= 0) return 0.0f;
+  return (float)((n_ * soma_ta_ - soma_t_ * soma_a_) / denominador);
+}
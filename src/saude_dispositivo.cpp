@@ -0,0 +1,69 @@
+#include "saude_dispositivo.h"
+
+// Comparação de instantes com millis() dando a volta (49 dias)
+static bool jaPassou(uint32_t agora_ms, uint32_t instante_ms) {
+  return (int32_t)(agora_ms - instante_ms) >= 0;
+}
+
+void SaudeDispositivo::reiniciar() {
+  *this = SaudeDispositivo();
+}
+
+bool SaudeDispositivo::podeLer(uint32_t agora_ms) const {
+  if (estado_ == SAUDE_OK) return true;
+  return estado_ == SAUDE_SUSPEITO && jaPassou(agora_ms, proxima_ms_);
+}
+
+bool SaudeDispositivo::sondaVencida(uint32_t agora_ms) const {
+  return estado_ == SAUDE_FORA && jaPassou(agora_ms, proxima_ms_);
+}
+
+bool SaudeDispositivo::registrar(uint8_t resultado, uint32_t duracao_us, uint32_t agora_ms,
+                                 const ConfigSaude& config) {
+  EstadoSaude anterior = estado_;
+  if (estado_ == SAUDE_FORA) sondas_++;
+
+  // Exceção: o dispositivo respondeu, o problema é o pedido
+  bool respondeu = resultado == MB_SUCESSO || resultado < MB_ERRO_ID_INVALIDO;
+  if (respondeu) {
+    if (estado_ == SAUDE_FORA) reconexoes_++;
+    estado_ = SAUDE_OK;
+    falhas_seguidas_ = 0;
+    mudou_ = estado_ != anterior;
+    return mudou_;
+  }
+
+  tempo_perdido_us_ += duracao_us;
+  if (falhas_seguidas_ < 0xFF) falhas_seguidas_++;
+  if (falhas_seguidas_ >= config.falhas_fora) {
+    if (estado_ != SAUDE_FORA) quedas_++;
+    estado_ = SAUDE_FORA;
+    proxima_ms_ = agora_ms + config.intervalo_sonda_ms;
+  } else {
+    // 1ª falha: espera inicial; cada falha seguinte dobra, até o máximo
+    uint32_t espera = config.espera_inicial_ms;
+    for (uint8_t i = 1; i < falhas_seguidas_ && espera < config.espera_max_ms; i++) espera *= 2;
+    if (espera > config.espera_max_ms) espera = config.espera_max_ms;
+    estado_ = SAUDE_SUSPEITO;
+    proxima_ms_ = agora_ms + espera;
+  }
+  mudou_ = estado_ != anterior;
+  return mudou_;
+}
+
+void SaudeDispositivo::zerarEstatisticas() {
+  quedas_ = 0;
+  reconexoes_ = 0;
+  sondas_ = 0;
+  pulos_ = 0;
+  tempo_perdido_us_ = 0;
+}
+
+const char* nomeSaude(EstadoSaude estado) {
+  switch (estado) {
+    case SAUDE_OK: return "ok";
+    case SAUDE_SUSPEITO: return "suspeito";
+    case SAUDE_FORA: return "fora";
+    default: return "?";
+  }
+}
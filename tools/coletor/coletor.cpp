@@ -0,0 +1,415 @@
+// Coletor Modbus RTU multi-porta para Linux: lê anemômetros e birutas em
+// vários adaptadores USB-RS485 ao mesmo tempo e escreve uma linha CSV por
+// leitura (stdout ou --saida); estatísticas no stderr ao final.
+//
+// Usa o codec do firmware (modbus_codec.h) e os mesmos perfis de
+// dispositivo, com registradores e decodificação (perfis_dispositivo.h). Uma só thread: cada porta é uma
+// máquina de estados (requisição -> resposta -> silêncio de 3,5 caracteres)
+// movida pelo epoll, com um timerfd por porta para o timeout e o silêncio.
+// As portas não esperam umas pelas outras: a taxa total cresce com o número
+// de adaptadores. A resposta termina pelo tamanho esperado (os adaptadores
+// USB entregam os bytes em rajadas, o silêncio entre eles não é confiável).
+//
+// Compilação (na raiz do projeto):
+//   g++ -std=c++17 -O2 -Iinclude src/modbus_codec.cpp tools/coletor/coletor.cpp -o coletor
+// Uso:
+//   ./coletor [--segundos N] [--intervalo MS] [--turnaround MS] [--saida ARQUIVO]
+//             --porta /dev/ttyUSB0 [--baud B] [--anemometro ID] [--biruta ID]
+//             [--porta /dev/ttyUSB1 ...]
+// --baud, --anemometro e --biruta valem para a última --porta. Sem
+// dispositivos, a porta lê a instalação padrão (anemômetro 1, biruta 2).
+// --intervalo 0 (padrão) lê sem pausa; Ctrl+C encerra.
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "modbus_codec.h"
+#include "perfis_dispositivo.h"
+#include "porta_serial.h"
+
+#define COLETOR_MAX_PORTAS 32
+#define COLETOR_MAX_DISPOSITIVOS 16
+
+enum ModeloSensor : uint8_t {
+  MODELO_ANEMOMETRO,
+  MODELO_BIRUTA
+};
+
+static const char* const NOMES_MODELO[] = {"anemometro", "biruta"};
+
+typedef void (*DecodificarBloco)(const RespostaModbus& resposta, SensorData& destino);
+
+struct Dispositivo {
+  uint8_t id;
+  ModeloSensor modelo;
+  uint8_t funcao;           // Bloco de dados do perfil: uma leitura por dispositivo
+  uint16_t inicio;
+  uint16_t quantidade;
+  DecodificarBloco decodificar;
+};
+
+enum EstadoPorta : uint8_t {
+  PORTA_OCIOSA,             // Esperando o próximo ciclo (--intervalo)
+  PORTA_AGUARDANDO,         // Requisição enviada, recebendo a resposta
+  PORTA_SILENCIO            // 3,5 caracteres antes da próxima requisição
+};
+
+struct EstatisticasPorta {
+  uint32_t transacoes = 0;
+  uint32_t sucessos = 0;
+  uint32_t timeouts = 0;
+  uint32_t erros_crc = 0;
+  uint32_t outros = 0;      // Exceções, id ou função errados
+  uint32_t bytes_fora = 0;  // Recebidos sem transação em andamento
+  uint64_t soma_latencia_us = 0;
+  uint32_t maior_latencia_us = 0;
+};
+
+struct Porta {
+  const char* caminho = nullptr;
+  uint32_t baud = 4800;
+  int fd = -1;
+  int timer = -1;
+  bool desconectada = false;
+  Dispositivo dispositivos[COLETOR_MAX_DISPOSITIVOS];
+  uint8_t num_dispositivos = 0;
+
+  EstadoPorta estado = PORTA_OCIOSA;
+  uint8_t atual = 0;
+  uint8_t requisicao[MODBUS_TAM_REQUISICAO];
+  size_t tamanho_requisicao = 0;
+  size_t enviados = 0;
+  uint8_t resposta[MODBUS_TAM_MAX_RESPOSTA];
+  size_t recebidos = 0;
+  uint64_t envio_us = 0;
+  uint64_t ciclo_us = 0;    // Início do ciclo atual
+  EstatisticasPorta stats;
+};
+
+static Porta portas[COLETOR_MAX_PORTAS];
+static uint8_t num_portas = 0;
+static int epoll_fd = -1;
+static FILE* saida = stdout;
+static uint64_t intervalo_us = 0;
+static uint64_t turnaround_us = 100000;
+static volatile sig_atomic_t encerrar = 0;
+
+static void aoSinal(int) { encerrar = 1; }
+
+template <typename Perfil>
+static void usarPerfil(Dispositivo& d) {
+  using Bloco = typename Perfil::Dados;
+  d.funcao = Bloco::funcao;
+  d.inicio = Bloco::inicio;
+  d.quantidade = Bloco::quantidade;
+  d.decodificar = [](const RespostaModbus& resposta, SensorData& destino) { Bloco::decodificar(resposta, destino); };
+}
+
+static bool adicionarDispositivo(Porta& p, uint8_t id, ModeloSensor modelo) {
+  if (p.num_dispositivos >= COLETOR_MAX_DISPOSITIVOS || id < 1 || id > MODBUS_ID_MAX) return false;
+  Dispositivo& d = p.dispositivos[p.num_dispositivos++];
+  d.id = id;
+  d.modelo = modelo;
+  if (modelo == MODELO_ANEMOMETRO) usarPerfil<PerfilAnemometro>(d);
+  else usarPerfil<PerfilBiruta>(d);
+  return true;
+}
+
+static void armarTimer(Porta& p, uint64_t instante_us) {
+  struct itimerspec t = instanteTimer(instante_us);
+  timerfd_settime(p.timer, TFD_TIMER_ABSTIME, &t, nullptr);
+}
+
+static void vigiarEscrita(Porta& p, bool escrever) {
+  if (p.desconectada) return;
+  struct epoll_event ev = {};
+  ev.events = escrever ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  ev.data.u64 = (uint64_t)(&p - portas) << 1;
+  epoll_ctl(epoll_fd, EPOLL_CTL_MOD, p.fd, &ev);
+}
+
+static void enviarRestante(Porta& p) {
+  while (p.enviados < p.tamanho_requisicao) {
+    ssize_t n = write(p.fd, p.requisicao + p.enviados, p.tamanho_requisicao - p.enviados);
+    if (n < 0) {
+      if (errno == EAGAIN) {
+        vigiarEscrita(p, true);
+        return;
+      }
+      break;   // Adaptador desconectado: a transação termina por timeout
+    }
+    p.enviados += (size_t)n;
+  }
+  if (p.enviados >= p.tamanho_requisicao) vigiarEscrita(p, false);
+}
+
+static void iniciarTransacao(Porta& p) {
+  const Dispositivo& d = p.dispositivos[p.atual];
+  tcflush(p.fd, TCIFLUSH);   // Restos de uma resposta atrasada
+  p.tamanho_requisicao = modbusMontarLeitura(p.requisicao, d.id, d.funcao, d.inicio, d.quantidade);
+  p.enviados = 0;
+  p.recebidos = 0;
+  p.estado = PORTA_AGUARDANDO;
+  p.envio_us = relogioUs();
+
+  // Como no firmware: requisição + turnaround + a resposta inteira no baud rate da porta
+  uint32_t t_char = modbusTempoCaractereUs(p.baud);
+  size_t caracteres = p.tamanho_requisicao + 5 + 2 * (size_t)d.quantidade;
+  armarTimer(p, p.envio_us + caracteres * t_char + modbusT35Us(p.baud) + turnaround_us);
+  enviarRestante(p);
+}
+
+static void registrarAmostra(const Porta& p, const Dispositivo& d, uint8_t codigo, uint32_t latencia_us,
+                             const RespostaModbus& resposta) {
+  struct timespec agora;
+  clock_gettime(CLOCK_REALTIME, &agora);
+  unsigned long long tempo_ms = (unsigned long long)agora.tv_sec * 1000ULL + (unsigned long long)agora.tv_nsec / 1000000;
+
+  if (codigo != MB_SUCESSO) {
+    fprintf(saida, "%llu,%s,%u,%s,0x%02X,,,,\n", tempo_ms, p.caminho, d.id, NOMES_MODELO[d.modelo], codigo);
+    return;
+  }
+  SensorData dados;
+  d.decodificar(resposta, dados);
+  if (d.modelo == MODELO_ANEMOMETRO) {
+    fprintf(saida, "%llu,%s,%u,%s,0x00,%u,%.1f,,\n", tempo_ms, p.caminho, d.id, NOMES_MODELO[d.modelo],
+            (unsigned)latencia_us, dados.wind_speed);
+  } else {
+    fprintf(saida, "%llu,%s,%u,%s,0x00,%u,,%u,%u\n", tempo_ms, p.caminho, d.id, NOMES_MODELO[d.modelo],
+            (unsigned)latencia_us, dados.wind_direction_raw, dados.wind_direction_degrees);
+  }
+}
+
+static void concluirTransacao(Porta& p) {
+  const Dispositivo& d = p.dispositivos[p.atual];
+  RespostaModbus resposta;
+  uint8_t codigo = modbusValidarResposta(p.resposta, p.recebidos, d.id, d.funcao, resposta);
+  uint64_t agora = relogioUs();
+
+  // Do fim da requisição ao último byte da resposta
+  uint64_t fim_envio = p.envio_us + (uint64_t)p.tamanho_requisicao * modbusTempoCaractereUs(p.baud);
+  uint32_t latencia_us = agora > fim_envio ? (uint32_t)(agora - fim_envio) : 0;
+
+  p.stats.transacoes++;
+  if (codigo == MB_SUCESSO) {
+    p.stats.sucessos++;
+    p.stats.soma_latencia_us += latencia_us;
+    if (latencia_us > p.stats.maior_latencia_us) p.stats.maior_latencia_us = latencia_us;
+  } else if (codigo == MB_ERRO_TIMEOUT) {
+    p.stats.timeouts++;
+  } else if (codigo == MB_ERRO_CRC) {
+    p.stats.erros_crc++;
+  } else {
+    p.stats.outros++;
+  }
+  registrarAmostra(p, d, codigo, latencia_us, resposta);
+
+  p.estado = PORTA_SILENCIO;
+  armarTimer(p, agora + modbusT35Us(p.baud));
+}
+
+// Fim do silêncio: próximo dispositivo, ou espera o próximo ciclo
+static void avancar(Porta& p) {
+  if (++p.atual < p.num_dispositivos) {
+    iniciarTransacao(p);
+    return;
+  }
+  p.atual = 0;
+  uint64_t agora = relogioUs();
+  uint64_t proximo = p.ciclo_us + intervalo_us;
+  if (intervalo_us && proximo > agora) {
+    p.ciclo_us = proximo;
+    p.estado = PORTA_OCIOSA;
+    armarTimer(p, proximo);
+    return;
+  }
+  p.ciclo_us = agora;
+  iniciarTransacao(p);
+}
+
+static void aoReceber(Porta& p) {
+  uint8_t lixo[64];
+  for (;;) {
+    ssize_t n;
+    if (p.estado == PORTA_AGUARDANDO && p.recebidos < sizeof(p.resposta)) {
+      n = read(p.fd, p.resposta + p.recebidos, sizeof(p.resposta) - p.recebidos);
+      if (n > 0) p.recebidos += (size_t)n;
+    } else {
+      n = read(p.fd, lixo, sizeof(lixo));
+      if (n > 0) p.stats.bytes_fora += (uint32_t)n;
+    }
+    if (n <= 0) break;
+  }
+  if (p.estado != PORTA_AGUARDANDO) return;
+  size_t esperados = modbusTamanhoResposta(p.resposta, p.recebidos);
+  if (esperados && p.recebidos >= esperados) concluirTransacao(p);
+}
+
+static void aoTimer(Porta& p) {
+  uint64_t expiracoes;
+  if (read(p.timer, &expiracoes, sizeof(expiracoes)) < 0) return;
+  switch (p.estado) {
+    case PORTA_AGUARDANDO:
+      concluirTransacao(p);   // Timeout ou resposta incompleta
+      break;
+    case PORTA_SILENCIO:
+      avancar(p);
+      break;
+    case PORTA_OCIOSA:
+      iniciarTransacao(p);
+      break;
+  }
+}
+
+static bool abrirPorta(Porta& p, uint8_t indice) {
+  p.fd = abrirPortaSerial(p.caminho, p.baud);
+  if (p.fd < 0) {
+    fprintf(stderr, "❌ %s: %s\n", p.caminho, strerror(errno));
+    return false;
+  }
+  p.timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = (uint64_t)indice << 1;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, p.fd, &ev);
+  ev.data.u64 = ((uint64_t)indice << 1) | 1;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, p.timer, &ev);
+  return true;
+}
+
+static void mostrarEstatisticas(double segundos) {
+  uint64_t total = 0, sucessos = 0;
+  fprintf(stderr, "\n📊 %.1f s de coleta\n", segundos);
+  for (uint8_t i = 0; i < num_portas; i++) {
+    const EstatisticasPorta& s = portas[i].stats;
+    total += s.transacoes;
+    sucessos += s.sucessos;
+    fprintf(stderr, "  %s @ %u bps: %u leituras (%.1f/s), %u ok, %u timeout, %u CRC, %u outras",
+            portas[i].caminho, (unsigned)portas[i].baud, (unsigned)s.transacoes,
+            segundos > 0 ? s.transacoes / segundos : 0.0, (unsigned)s.sucessos, (unsigned)s.timeouts,
+            (unsigned)s.erros_crc, (unsigned)s.outros);
+    if (s.sucessos) {
+      fprintf(stderr, "; latência média %u µs, máx %u µs", (unsigned)(s.soma_latencia_us / s.sucessos),
+              (unsigned)s.maior_latencia_us);
+    }
+    if (s.bytes_fora) fprintf(stderr, "; %u bytes fora de transação", (unsigned)s.bytes_fora);
+    fprintf(stderr, "\n");
+  }
+  fprintf(stderr, "  Total: %llu leituras, %llu ok (%.1f leituras/s)\n", (unsigned long long)total,
+          (unsigned long long)sucessos, segundos > 0 ? total / segundos : 0.0);
+}
+
+int main(int argc, char** argv) {
+  double segundos = -1;
+  uint32_t baud_padrao = 4800;
+  const char* arquivo = nullptr;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    Porta* ultima = num_portas ? &portas[num_portas - 1] : nullptr;
+    if (!strcmp(argv[i], "--segundos")) segundos = atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--intervalo")) intervalo_us = (uint64_t)atol(argv[i + 1]) * 1000;
+    else if (!strcmp(argv[i], "--turnaround")) turnaround_us = (uint64_t)atol(argv[i + 1]) * 1000;
+    else if (!strcmp(argv[i], "--saida")) arquivo = argv[i + 1];
+    else if (!strcmp(argv[i], "--porta")) {
+      if (num_portas >= COLETOR_MAX_PORTAS) {
+        fprintf(stderr, "❌ No máximo %d portas\n", COLETOR_MAX_PORTAS);
+        return 2;
+      }
+      portas[num_portas].caminho = argv[i + 1];
+      portas[num_portas].baud = baud_padrao;
+      num_portas++;
+    } else if (!strcmp(argv[i], "--baud")) {
+      uint32_t baud = (uint32_t)atol(argv[i + 1]);
+      if (!velocidadeTermios(baud)) {
+        fprintf(stderr, "❌ Baud rate não suportado: %s\n", argv[i + 1]);
+        return 2;
+      }
+      if (ultima) ultima->baud = baud;
+      else baud_padrao = baud;
+    } else if (!strcmp(argv[i], "--anemometro") || !strcmp(argv[i], "--biruta")) {
+      ModeloSensor modelo = !strcmp(argv[i], "--biruta") ? MODELO_BIRUTA : MODELO_ANEMOMETRO;
+      if (!ultima || !adicionarDispositivo(*ultima, (uint8_t)atoi(argv[i + 1]), modelo)) {
+        fprintf(stderr, "❌ %s %s: sem --porta antes, ID inválido ou dispositivos demais\n", argv[i], argv[i + 1]);
+        return 2;
+      }
+    } else {
+      fprintf(stderr, "❌ Opção desconhecida: %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (!num_portas) {
+    fprintf(stderr, "Uso: %s [--segundos N] [--intervalo MS] [--turnaround MS] [--saida ARQUIVO]\n"
+                    "       --porta DISPOSITIVO [--baud B] [--anemometro ID] [--biruta ID] [--porta ...]\n",
+            argv[0]);
+    return 2;
+  }
+
+  if (arquivo && !(saida = fopen(arquivo, "w"))) {
+    fprintf(stderr, "❌ %s: %s\n", arquivo, strerror(errno));
+    return 1;
+  }
+  static char buffer_saida[1 << 16];
+  setvbuf(saida, buffer_saida, _IOFBF, sizeof(buffer_saida));
+
+  struct sigaction sa = {};
+  sa.sa_handler = aoSinal;
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  for (uint8_t i = 0; i < num_portas; i++) {
+    Porta& p = portas[i];
+    if (!p.num_dispositivos) {
+      adicionarDispositivo(p, 1, MODELO_ANEMOMETRO);
+      adicionarDispositivo(p, 2, MODELO_BIRUTA);
+    }
+    if (!abrirPorta(p, i)) return 1;
+  }
+
+  fprintf(saida, "tempo_ms,porta,id,modelo,resultado,latencia_us,vento_ms,direcao_bruta,direcao_graus\n");
+  uint64_t inicio = relogioUs();
+  for (uint8_t i = 0; i < num_portas; i++) {
+    portas[i].ciclo_us = inicio;
+    iniciarTransacao(portas[i]);
+  }
+
+  uint64_t ultima_descarga = inicio;
+  struct epoll_event eventos[2 * COLETOR_MAX_PORTAS];
+  while (!encerrar) {
+    uint64_t agora = relogioUs();
+    if (segundos >= 0 && agora - inicio >= (uint64_t)(segundos * 1e6)) break;
+    if (agora - ultima_descarga >= 1000000) {   // Arquivo acompanhável (tail -f) sem uma escrita por linha
+      fflush(saida);
+      ultima_descarga = agora;
+    }
+
+    int n = epoll_wait(epoll_fd, eventos, 2 * COLETOR_MAX_PORTAS, 100);
+    if (n < 0 && errno != EINTR) {
+      perror("epoll_wait");
+      break;
+    }
+    for (int k = 0; k < n; k++) {
+      Porta& p = portas[eventos[k].data.u64 >> 1];
+      if (eventos[k].data.u64 & 1) {
+        aoTimer(p);
+      } else {
+        if (eventos[k].events & EPOLLOUT) enviarRestante(p);
+        if (eventos[k].events & EPOLLIN) aoReceber(p);
+        if (eventos[k].events & (EPOLLERR | EPOLLHUP) && !p.desconectada) {
+          // Adaptador removido: sai do epoll (senão acorda sem parar); as leituras viram timeout
+          fprintf(stderr, "⚠️  %s desconectada\n", p.caminho);
+          epoll_ctl(epoll_fd, EPOLL_CTL_DEL, p.fd, nullptr);
+          p.desconectada = true;
+        }
+      }
+    }
+  }
+
+  fflush(saida);
+  mostrarEstatisticas((relogioUs() - inicio) / 1e6);
+  if (saida != stdout) fclose(saida);
+  return 0;
+}
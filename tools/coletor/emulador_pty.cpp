@@ -0,0 +1,167 @@
+// Emulador de sensores em pseudo-terminais, para testar o coletor sem adaptadores
+//
+// Cada porta é um pty com um barramento simulado do build nativo
+// (BarramentoSimulado, rs485_sim.h): o mesmo mapa de registradores, latência,
+// perdas e CRC corrompido, agora no relógio real. Os bytes da resposta saem
+// um a um no instante em que chegariam pela linha, e um quadro num baud rate
+// diferente do sensor (lido do termios da porta) é ignorado como no hardware.
+// O emulador mantém o lado escravo aberto: o coletor pode abrir e fechar a
+// porta à vontade.
+//
+// Compilação (na raiz do projeto):
+//   g++ -std=c++17 -O2 -Iinclude/native src/native/rs485_sim.cpp
+//       tools/coletor/emulador_pty.cpp -o emulador_pty
+// Uso:
+//   ./emulador_pty [--portas N] [--baud B] [--latencia US] [--perda P] [--erro-crc P] [--extras N]
+// Escreve no stdout o caminho de cada porta (/dev/pts/N), um por linha, e
+// atende até Ctrl+C; estatísticas no stderr ao final. Em cada porta:
+// anemômetro ID 1, biruta ID 2 e 'extras' transmissores alternados a partir do ID 3.
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "porta_serial.h"
+#include "rs485_sim.h"
+
+#define EMULADOR_MAX_PORTAS 32
+
+struct PortaEmulada {
+  int mestre = -1;
+  int escravo = -1;          // Mantido aberto: sem ele o mestre acusa HUP a cada fechamento do coletor
+  int timer = -1;
+  char caminho[64] = "";
+  uint32_t baud = 4800;
+  BarramentoSimulado barramento;
+};
+
+static PortaEmulada portas[EMULADOR_MAX_PORTAS];
+static volatile sig_atomic_t encerrar = 0;
+
+static void aoSinal(int) { encerrar = 1; }
+
+static void rearmar(PortaEmulada& p) {
+  uint64_t proximo = p.barramento.proximoEvento();
+  struct itimerspec t = {};
+  if (proximo != UINT64_MAX) t = instanteTimer(proximo);
+  timerfd_settime(p.timer, TFD_TIMER_ABSTIME, &t, nullptr);
+}
+
+// Requisição do coletor: entra na linha agora, no baud rate que ele configurou
+static void aoReceber(PortaEmulada& p) {
+  uint8_t buffer[256];
+  ssize_t n;
+  while ((n = read(p.mestre, buffer, sizeof(buffer))) > 0) {
+    struct termios t;
+    uint32_t baud = tcgetattr(p.mestre, &t) == 0 ? baudTermios(cfgetospeed(&t)) : 0;
+    p.barramento.transmitir(buffer, (size_t)n, baud ? baud : p.baud, relogioUs());
+  }
+  rearmar(p);
+}
+
+static void aoTimer(PortaEmulada& p) {
+  uint64_t expiracoes;
+  if (read(p.timer, &expiracoes, sizeof(expiracoes)) < 0) return;
+  uint64_t agora = relogioUs();
+  uint8_t resposta[256];
+  size_t n = 0;
+  int byte;
+  while (n < sizeof(resposta) && (byte = p.barramento.ler(agora)) >= 0) resposta[n++] = (uint8_t)byte;
+  if (n && write(p.mestre, resposta, n) < 0 && errno != EAGAIN) perror(p.caminho);
+  rearmar(p);
+}
+
+static bool criarPorta(PortaEmulada& p, uint8_t indice, int epoll_fd) {
+  p.mestre = posix_openpt(O_RDWR | O_NOCTTY);
+  if (p.mestre < 0 || grantpt(p.mestre) != 0 || unlockpt(p.mestre) != 0) return false;
+  const char* nome = ptsname(p.mestre);
+  if (!nome) return false;
+  snprintf(p.caminho, sizeof(p.caminho), "%s", nome);
+  fcntl(p.mestre, F_SETFL, fcntl(p.mestre, F_GETFL) | O_NONBLOCK);
+
+  p.escravo = abrirPortaSerial(p.caminho, p.baud);
+  p.timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (p.escravo < 0 || p.timer < 0) return false;
+
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = (uint64_t)indice << 1;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, p.mestre, &ev);
+  ev.data.u64 = ((uint64_t)indice << 1) | 1;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, p.timer, &ev);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int num_portas = 1;
+  uint32_t baud = 4800;
+  uint32_t latencia_us = 8000;
+  int extras = 0;
+  SimConfig config;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--portas")) num_portas = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--baud")) baud = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--latencia")) latencia_us = (uint32_t)atol(argv[i + 1]);
+    else if (!strcmp(argv[i], "--perda")) config.prob_perda = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--erro-crc")) config.prob_erro_crc = (float)atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "--extras")) extras = atoi(argv[i + 1]);
+  }
+  if (num_portas < 1) num_portas = 1;
+  if (num_portas > EMULADOR_MAX_PORTAS) num_portas = EMULADOR_MAX_PORTAS;
+  if (extras < 0) extras = 0;
+  if (extras > 245) extras = 245;
+  if (!velocidadeTermios(baud)) {
+    fprintf(stderr, "❌ Baud rate não suportado: %u\n", (unsigned)baud);
+    return 2;
+  }
+
+  struct sigaction sa = {};
+  sa.sa_handler = aoSinal;
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  for (int i = 0; i < num_portas; i++) {
+    PortaEmulada& p = portas[i];
+    p.baud = baud;
+    config.semente = (uint32_t)(i + 1);
+    p.barramento.configurar(config);
+    p.barramento.adicionarSensor(1, SimModelo::ANEMOMETRO_FSJT, baud, latencia_us);
+    p.barramento.adicionarSensor(2, SimModelo::BIRUTA_FXJT, baud, latencia_us);
+    for (int k = 0; k < extras; k++) {
+      SimModelo modelo = k % 2 ? SimModelo::BIRUTA_FXJT : SimModelo::ANEMOMETRO_FSJT;
+      p.barramento.adicionarSensor((uint8_t)(3 + k), modelo, baud, latencia_us);
+    }
+    if (!criarPorta(p, (uint8_t)i, epoll_fd)) {
+      fprintf(stderr, "❌ pty %d: %s\n", i, strerror(errno));
+      return 1;
+    }
+    printf("%s\n", p.caminho);
+  }
+  fflush(stdout);
+
+  struct epoll_event eventos[2 * EMULADOR_MAX_PORTAS];
+  while (!encerrar) {
+    int n = epoll_wait(epoll_fd, eventos, 2 * EMULADOR_MAX_PORTAS, -1);
+    if (n < 0 && errno != EINTR) {
+      perror("epoll_wait");
+      break;
+    }
+    for (int k = 0; k < n; k++) {
+      PortaEmulada& p = portas[eventos[k].data.u64 >> 1];
+      if (eventos[k].data.u64 & 1) aoTimer(p);
+      else aoReceber(p);
+    }
+  }
+
+  for (int i = 0; i < num_portas; i++) {
+    const SimEstatisticas& s = portas[i].barramento.estatisticas();
+    fprintf(stderr, "%s: %u quadros, %u respostas, %u exceções, %u perdidas, %u corrompidas, %u em outro baud rate\n",
+            portas[i].caminho, (unsigned)s.quadros_recebidos, (unsigned)s.respostas, (unsigned)s.excecoes,
+            (unsigned)s.perdidas, (unsigned)s.corrompidas, (unsigned)s.ignorados_baud);
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+// Porta serial do host (Linux, termios) para o coletor e o emulador de sensores
+//
+// A porta abre sem bloquear e em modo bruto 8N1 (VMIN = VTIME = 0): read()
+// devolve o que já chegou e o epoll avisa quando há mais. Num pseudo-terminal
+// o baud rate não atrasa nada, mas fica gravado no termios e o emulador o lê
+// pelo lado mestre para rejeitar quadros num baud rate diferente do sensor.
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Baud rates dos sensores (NOMES_CODIGO_BAUD); 0 se o termios não tem a velocidade
+inline speed_t velocidadeTermios(uint32_t baud) {
+  switch (baud) {
+    case 1200: return B1200;
+    case 2400: return B2400;
+    case 4800: return B4800;
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return 0;
+  }
+}
+
+inline uint32_t baudTermios(speed_t velocidade) {
+  switch (velocidade) {
+    case B1200: return 1200;
+    case B2400: return 2400;
+    case B4800: return 4800;
+    case B9600: return 9600;
+    case B19200: return 19200;
+    case B38400: return 38400;
+    case B57600: return 57600;
+    case B115200: return 115200;
+    default: return 0;
+  }
+}
+
+// Modo bruto 8N1 no baud rate dado; false se a velocidade não existe ou o
+// descritor não é um terminal
+inline bool configurarPortaSerial(int fd, uint32_t baud) {
+  speed_t velocidade = velocidadeTermios(baud);
+  struct termios t;
+  if (!velocidade || tcgetattr(fd, &t) != 0) return false;
+  cfmakeraw(&t);
+  t.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+  t.c_cflag |= CLOCAL | CREAD | CS8;
+  t.c_cc[VMIN] = 0;
+  t.c_cc[VTIME] = 0;
+  cfsetispeed(&t, velocidade);
+  cfsetospeed(&t, velocidade);
+  return tcsetattr(fd, TCSANOW, &t) == 0;
+}
+
+// -1 em erro (errno)
+inline int abrirPortaSerial(const char* caminho, uint32_t baud) {
+  int fd = open(caminho, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) return -1;
+  if (!configurarPortaSerial(fd, baud)) {
+    close(fd);
+    return -1;
+  }
+  tcflush(fd, TCIOFLUSH);
+  return fd;
+}
+
+// Relógio monotônico em µs (o mesmo dos timerfd)
+inline uint64_t relogioUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+inline struct itimerspec instanteTimer(uint64_t us) {
+  struct itimerspec t = {};
+  t.it_value.tv_sec = (time_t)(us / 1000000ULL);
+  t.it_value.tv_nsec = (long)(us % 1000000ULL) * 1000;
+  if (!t.it_value.tv_sec && !t.it_value.tv_nsec) t.it_value.tv_nsec = 1;   // 0 desarmaria o timer
+  return t;
+}